@@ -6,38 +6,18 @@ const double ADS1115::PGAGAINS[6] = { 6.144, 4.096, 2.048, 1.024, 0.512, 0.256 }
 
 int16_t ADS1115::readADC(unsigned int channel)
 {
-	uint8_t writeBuf[3];		// Buffer to store the 3 bytes that we write to the I2C device
 	uint8_t readBuf[2];		// 2 byte buffer to store the data read from the I2C device  
 	int16_t val;			// Stores the 16 bit value of our ADC conversion
-							//  uint8_t fDataRate = 0x07; // 860 SPS
-							//  uint8_t fDataRate = 0x01; // 16 SPS
-	uint8_t fDataRate = fRate & 0x07;
 
-	
 	std::lock_guard<std::mutex> lock(fMutex);
 	startTimer();
 
-	// These three bytes are written to the ADS1115 to set the config register and start a conversion 
-	writeBuf[0] = 0x01;		// This sets the pointer register so that the following two bytes write to the config register
-	writeBuf[1] = 0x80;		// OS bit
-	if (!fDiffMode) writeBuf[1] |= 0x40; // single ended mode channels
-	writeBuf[1] |= (channel & 0x03) << 4; // channel select
-	writeBuf[1] |= 0x01; // single shot mode
-	writeBuf[1] |= ((uint8_t)fPga[channel]) << 1; // PGA gain select
-
-	// This sets the 8 LSBs of the config register (bits 7-0)
-//	writeBuf[2] = 0x03;  // disable ALERT/RDY pin
-	writeBuf[2] = 0x00;  // enable ALERT/RDY pin
-	writeBuf[2] |= ((uint8_t)fDataRate) << 5;
-
-
 	// Initialize the buffer used to read data from the ADS1115 to 0
 	readBuf[0] = 0;
 	readBuf[1] = 0;
 
-	// Write writeBuf to the ADS1115, the 3 specifies the number of bytes we are writing,
-	// this begins a single conversion	
-	write(writeBuf, 3);
+	// this begins a single conversion
+	writeConfig(channel, fPga[channel]);
 
 	// Wait for the conversion to complete, this requires bit 15 to change from 0->1
 	int nloops = 0;
@@ -77,6 +57,91 @@ int16_t ADS1115::readADC(unsigned int channel)
 	return val;
 }
 
+void ADS1115::configBytes(unsigned int channel, CFG_PGA pga, uint8_t* writeBuf) const
+{
+	// These three bytes are written to the ADS1115 to set the config register and start a conversion 
+	writeBuf[0] = 0x01;		// This sets the pointer register so that the following two bytes write to the config register
+	writeBuf[1] = 0x80;		// OS bit
+	if (!fDiffMode) writeBuf[1] |= 0x40; // single ended mode channels
+	writeBuf[1] |= (channel & 0x03) << 4; // channel select
+	writeBuf[1] |= 0x01; // single shot mode
+	writeBuf[1] |= ((uint8_t)pga) << 1; // PGA gain select
+
+	// This sets the 8 LSBs of the config register (bits 7-0)
+//	writeBuf[2] = 0x03;  // disable ALERT/RDY pin
+	writeBuf[2] = 0x00;  // enable ALERT/RDY pin, asserted (low) after each conversion
+	writeBuf[2] |= ((uint8_t)(fRate & 0x07)) << 5;
+}
+
+bool ADS1115::writeConfig(unsigned int channel, CFG_PGA pga)
+{
+	uint8_t writeBuf[3];		// Buffer to store the 3 bytes that we write to the I2C device
+	configBytes(channel, pga, writeBuf);
+	// Write writeBuf to the ADS1115, the 3 specifies the number of bytes we are writing
+	return (write(writeBuf, 3) == 3);
+}
+
+bool ADS1115::startConversion(unsigned int channel, CFG_PGA& pga)
+{
+	std::lock_guard<std::mutex> lock(fMutex);
+	pga = fPga[channel & 0x03];
+	return writeConfig(channel, pga);
+}
+
+bool ADS1115::readConversion(unsigned int channel, CFG_PGA pga, int16_t& adc, double& voltage)
+{
+	uint8_t readBuf[2] { 0, 0 };
+	{
+		std::lock_guard<std::mutex> lock(fMutex);
+		// no polling of the OS bit, the completion was signalled through the ALERT/RDY pin
+		if (readReg(0x00, readBuf, 2) != 2) return false;
+	}
+	convertResult(channel, pga, readBuf, adc, voltage);
+	return true;
+}
+
+bool ADS1115::startAndReadConversion(unsigned int nextChannel, CFG_PGA& nextPga, unsigned int channel, CFG_PGA pga, int16_t& adc, double& voltage)
+{
+	uint8_t configBuf[3];
+	uint8_t pointer = 0x00;
+	uint8_t readBuf[2] { 0, 0 };
+	{
+		std::lock_guard<std::mutex> lock(fMutex);
+		nextPga = fPga[nextChannel & 0x03];
+		configBytes(nextChannel, nextPga, configBuf);
+		// the conversion register keeps the finished result until the started conversion completes
+		Message msgs[3] = { { configBuf, 3, false }, { &pointer, 1, false }, { readBuf, 2, true } };
+		if (transfer(msgs, 3) != 3) return false;
+	}
+	convertResult(channel, pga, readBuf, adc, voltage);
+	return true;
+}
+
+void ADS1115::convertResult(unsigned int channel, CFG_PGA pga, const uint8_t* readBuf, int16_t& adc, double& voltage)
+{
+	adc = readBuf[0] << 8 | readBuf[1];
+	fLastADCValue = adc;
+	voltage = PGAGAINS[pga] * adc / 32767.0;
+	if (fAGC) adaptPga(channel & 0x03, adc);
+	fLastVoltage = voltage;
+}
+
+void ADS1115::adaptPga(unsigned int channel, int16_t adc)
+{
+	int eadc = abs(adc);
+	if (eadc > 0.8 * 32767 && (unsigned int)fPga[channel] > 0) {
+		fPga[channel] = CFG_PGA((unsigned int)fPga[channel] - 1);
+		if (fDebugLevel > 1)
+			printf("ADC input high...setting PGA to level %d\n", fPga[channel]);
+	}
+	else if (eadc < 0.2 * 32767 && (unsigned int)fPga[channel] < 5) {
+		fPga[channel] = CFG_PGA((unsigned int)fPga[channel] + 1);
+		if (fDebugLevel > 1)
+			printf("ADC input low...setting PGA to level %d\n", fPga[channel]);
+
+	}
+}
+
 bool ADS1115::setLowThreshold(int16_t thr)
 {
 	uint8_t writeBuf[3];	// Buffer to store the 3 bytes that we write to the I2C device
@@ -86,7 +151,7 @@ bool ADS1115::setLowThreshold(int16_t thr)
 	// These three bytes are written to the ADS1115 to set the Lo_thresh register
 	writeBuf[0] = 0x02;		// This sets the pointer register to Lo_thresh register
 	writeBuf[1] = (thr & 0xff00) >> 8;
-	writeBuf[2] |= (thr & 0x00ff);
+	writeBuf[2] = (thr & 0x00ff);
 
 	// Initialize the buffer used to read data from the ADS1115 to 0
 	readBuf[0] = 0;
@@ -113,7 +178,7 @@ bool ADS1115::setHighThreshold(int16_t thr)
 	// These three bytes are written to the ADS1115 to set the Hi_thresh register
 	writeBuf[0] = 0x03;		// This sets the pointer register to Hi_thresh register
 	writeBuf[1] = (thr & 0xff00) >> 8;
-	writeBuf[2] |= (thr & 0x00ff);
+	writeBuf[2] = (thr & 0x00ff);
 
 	// Initialize the buffer used to read data from the ADS1115 to 0
 	readBuf[0] = 0;
@@ -138,8 +203,9 @@ bool ADS1115::setDataReadyPinMode()
 	// set MSB of Lo_thresh reg to 0
 	// set MSB of Hi_thresh reg to 1
 	// set COMP_QUE[1:0] to any value other than '11' (default value)
-	bool ok = setLowThreshold(0b00000000);
-	ok = ok && setHighThreshold(0b11111111);
+	std::lock_guard<std::mutex> lock(fMutex);
+	bool ok = setLowThreshold(0x0000);
+	ok = ok && setHighThreshold(INT16_MIN);
 	return ok;
 }
 
@@ -167,20 +233,7 @@ void ADS1115::readVoltage(unsigned int channel, int16_t& adc, double& voltage)
 	adc = readADC(channel);
 	voltage = PGAGAINS[fPga[channel]] * adc / 32767.0;
 
-	if (fAGC) {
-		int eadc = abs(adc);
-		if (eadc > 0.8 * 32767 && (unsigned int)fPga[channel] > 0) {
-			fPga[channel] = CFG_PGA((unsigned int)fPga[channel] - 1);
-			if (fDebugLevel > 1)
-				printf("ADC input high...setting PGA to level %d\n", fPga[channel]);
-		}
-		else if (eadc < 0.2 * 32767 && (unsigned int)fPga[channel] < 5) {
-			fPga[channel] = CFG_PGA((unsigned int)fPga[channel] + 1);
-			if (fDebugLevel > 1)
-				printf("ADC input low...setting PGA to level %d\n", fPga[channel]);
-
-		}
-	}
+	if (fAGC) adaptPga(channel, adc);
 	fLastVoltage = voltage;
 	return;
 }
@@ -26,6 +26,7 @@ public:
 	ADS1115() : i2cDevice("/dev/i2c-1", 0x48) { init(); }
 	ADS1115(uint8_t slaveAddress) : i2cDevice(slaveAddress) { init(); }
 	ADS1115(const char* busAddress, uint8_t slaveAddress) : i2cDevice(busAddress, slaveAddress) { init(); }
+	ADS1115(std::shared_ptr<I2cBus> bus, uint8_t slaveAddress) : i2cDevice(bus, slaveAddress) { init(); }
 	ADS1115(const char* busAddress, uint8_t slaveAddress, CFG_PGA pga) : i2cDevice(busAddress, slaveAddress)
 	{
 		init();
@@ -49,7 +50,29 @@ public:
 	void readVoltage(unsigned int channel, int16_t& adc, double& voltage);
 	bool devicePresent();
 	void setDiffMode(bool mode) { fDiffMode = mode; }
+	/**
+	 * @brief Configure the ALERT/RDY pin as conversion ready output.
+	 * The pin is pulled low for about 8us at the end of each conversion (open drain, needs a pull-up).
+	 */
 	bool setDataReadyPinMode();
+	/**
+	 * @brief Start a single-shot conversion without waiting for its completion.
+	 * For the split readout with the conversion ready signalled by the ALERT/RDY pin.
+	 * @param channel the input channel
+	 * @param pga returns the PGA setting of the conversion, which is needed to scale the result
+	 */
+	bool startConversion(unsigned int channel, CFG_PGA& pga);
+	/**
+	 * @brief Read the result of the last conversion started with {@link ADS1115::startConversion}.
+	 * The conversion register is read without polling the conversion status.
+	 */
+	bool readConversion(unsigned int channel, CFG_PGA pga, int16_t& adc, double& voltage);
+	/**
+	 * @brief Start the next conversion and read the result of the finished one in a single bus transaction.
+	 * Combines {@link ADS1115::startConversion} and {@link ADS1115::readConversion} into one I2C_RDWR transfer
+	 * (config write, pointer write and conversion register read separated by repeated starts).
+	 */
+	bool startAndReadConversion(unsigned int nextChannel, CFG_PGA& nextPga, unsigned int channel, CFG_PGA pga, int16_t& adc, double& voltage);
 	unsigned int getReadWaitDelay() const { return fReadWaitDelay; }
 	double getLastConvTime() const { return fLastConvTime; }
 
@@ -63,6 +86,11 @@ protected:
 	bool fAGC {false };	///< software agc which switches over to a better pga setting if voltage too low/high
 	bool fDiffMode { false };	///< measure differential input signals (true) or single ended (false=default)
 	std::mutex fMutex { };
+
+	void configBytes(unsigned int channel, CFG_PGA pga, uint8_t* writeBuf) const;
+	bool writeConfig(unsigned int channel, CFG_PGA pga);
+	void convertResult(unsigned int channel, CFG_PGA pga, const uint8_t* readBuf, int16_t& adc, double& voltage);
+	void adaptPga(unsigned int channel, int16_t adc);
 	
 	inline virtual void init() {
 		fPga[0] = fPga[1] = fPga[2] = fPga[3] = PGA4V;
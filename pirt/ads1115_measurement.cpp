@@ -5,15 +5,21 @@
 #include <chrono>
 #include <memory>
 #include <cassert>
+#include <cmath>
 
-#include <ads1115.h>
 #include "ads1115_measurement.h"
 
 #define DEFAULT_VERBOSITY 1
 
 namespace PiRaTe {
 	
-constexpr std::chrono::microseconds loop_delay { 10000L };
+constexpr double capacity_margin { 1.25 }; //< headroom of the integration window capacity for sample rate jitter
+
+// number of samples the integration accumulator must hold for the given integration time and sample rate
+auto windowCapacity( std::chrono::milliseconds int_time, double rate ) -> std::size_t
+{
+	return static_cast<std::size_t>( std::chrono::duration<double>(int_time).count() * rate * capacity_margin ) + 16;
+}
 
 // helper functions for compilation with c++11
 // remove, when compiling with c++14 and add std:: to the lines where these functions are used
@@ -29,7 +35,7 @@ template <typename T> constexpr int sgn(T val) {
 }
 
 Ads1115Measurement::Ads1115Measurement(std::string name, 
-										std::shared_ptr<ADS1115> adc, 
+										std::shared_ptr<Ads1115Scheduler> adc, 
 										std::uint8_t adc_channel, 
 										double factor,
 										std::chrono::milliseconds integration_time
@@ -37,63 +43,38 @@ Ads1115Measurement::Ads1115Measurement(std::string name,
 	: 	fName { std::move(name) }, 
 		fAdc { adc }, 
 		fAdcChannel { adc_channel }, 
+		fIntegration { windowCapacity(integration_time, MEASUREMENT_SAMPLE_RATE_DEFAULT), integration_time },
 		fFactor { factor },
 		fIntTime { integration_time }
 {
-	// initialize ADC if one was supplied in the argument list
-	if ( fAdc != nullptr && fAdc->devicePresent() ) {
-		//fAdc->setPga(ADS1115::PGA4V);
-		//fAdc->setRate(ADS1115::RATE860);
-		//fAdc->setAGC(true);
-	} else {
+	// subscribe to the ADC channel if an ADC was supplied in the argument list
+	if ( fAdc == nullptr || !fAdc->isInitialized() ) {
+		fAdc.reset();
 		return;
 	}
-	fActiveLoop=true;
-// since C++14 using std::make_unique
-	// fThread = std::make_unique<std::thread>( [this]() { this->readLoop(); } );
-// C++11 is unfortunately more unconvenient with move from a locally generated pointer
-	std::unique_ptr<std::thread> thread( new std::thread( [this]() { this->threadLoop(); } ));
-	fThread = std::move(thread);
+	fSubscription = fAdc->subscribe( fAdcChannel, fSampleRate, ADC_PRIORITY_MEASUREMENT,
+		[this](const Ads1115Scheduler::Sample& sample) { this->processSample(sample); } );
 }
 
 Ads1115Measurement::~Ads1115Measurement()
 {
-	if (!fActiveLoop) return;
-	fActiveLoop = false;
-	if (fThread!=nullptr) fThread->join();
+	if ( hasAdc() ) fAdc->unsubscribe(fSubscription);
 }
 
 
-// this is the background thread loop
-void Ads1115Measurement::threadLoop()
+// called by the conversion scheduler for every sample, which is time stamped at the middle of the conversion
+void Ads1115Measurement::processSample(const Ads1115Scheduler::Sample& sample)
 {
-	auto lastReadOutTime = std::chrono::system_clock::now();
-	bool errorFlag = true;
-	while (fActiveLoop) {
-		if ( hasAdc() ) {
-			double conv_time { 0. };
-			if ( bool readout_guard = true ) {
-				//std::lock_guard<std::mutex> lock(fMutex);
-				// read current voltage from adc
-				fMutex.lock();
-				fValue = fAdc->readVoltage(fAdcChannel) * fFactor;
-				auto currentTime = std::chrono::system_clock::now();
-				conv_time = fAdc->getLastConvTime();
-				while ( !fIntegrationBuffer.empty() && fIntegrationBuffer.front().time < (currentTime - fIntTime) ) {
-					fIntegrationBuffer.pop_front();
-				}
-				fIntegrationBuffer.push_back( { std::move(currentTime), fValue } );
-				fUpdated = true;
-				fMutex.unlock();
-			}
-			if (fVoltageReadyFn) fVoltageReadyFn(fValue);
-			auto actual_loop_delay = 
-				std::chrono::microseconds( std::max( loop_delay.count() - static_cast<long long int>(conv_time*1000), 1000LL) );
-			std::this_thread::sleep_for( actual_loop_delay );
-		} else {
-			std::this_thread::sleep_for( loop_delay );
-		}
+	double value { 0. };
+	{
+		std::lock_guard<std::mutex> lock(fMutex);
+		fValue = value = sample.voltage * fFactor;
+		fTime = sample.time;
+		fIntegration.add( sample.time, fValue );
+		fUpdated = true;
+		if (fSampleFn) fSampleFn( { sample.time, fValue } );
 	}
+	if (fVoltageReadyFn) fVoltageReadyFn(value);
 }
 
 
@@ -108,18 +89,64 @@ auto Ads1115Measurement::meanValue() -> double
 { 
 	std::lock_guard<std::mutex> lock(fMutex);
 	fUpdated = false;
-	if ( fIntegrationBuffer.empty() ) return 0.;
-	if ( fIntegrationBuffer.size() == 1 ) return fValue;
-	double mean = std::accumulate(fIntegrationBuffer.begin(), fIntegrationBuffer.end(), 0.0, [](double sum, Sample s) {
-			return sum + s.value;
-		}		
-	) / fIntegrationBuffer.size();
-	return mean;
+	return fIntegration.mean();
+}
+
+auto Ads1115Measurement::currentSample() -> Sample
+{
+	std::lock_guard<std::mutex> lock(fMutex);
+	fUpdated = false;
+	return { fTime, fValue };
+}
+
+auto Ads1115Measurement::meanSample() -> Sample
+{
+	std::lock_guard<std::mutex> lock(fMutex);
+	fUpdated = false;
+	if ( fIntegration.entries() == 0 ) return { fTime, 0. };
+	return { fIntegration.meanTime(), fIntegration.mean() };
+}
+
+auto Ads1115Measurement::windowStatistics() -> WindowStatistics
+{
+	std::lock_guard<std::mutex> lock(fMutex);
+	WindowStatistics stats { };
+	stats.mean = fIntegration.mean();
+	stats.stddev = fIntegration.stddev();
+	stats.min = fIntegration.min();
+	stats.max = fIntegration.max();
+	const double error { fIntegration.standardError() };
+	stats.snr = ( error > 0. ) ? std::abs(stats.mean) / error : 0.;
+	stats.entries = fIntegration.entries();
+	return stats;
 }
 
 void Ads1115Measurement::setIntTime( std::chrono::milliseconds ms ) {
 	std::lock_guard<std::mutex> lock(fMutex);
 	fIntTime = ms;
+	// the accumulator is only reallocated when it grows, the sample path never allocates
+	if ( windowCapacity(ms, fSampleRate) > fIntegration.capacity() ) {
+		fIntegration = SlidingWindowStats( windowCapacity(ms, fSampleRate), ms );
+	} else {
+		fIntegration.setWindow(ms);
+	}
+}
+
+void Ads1115Measurement::setSampleRate( double rate ) {
+	if ( rate <= 0. ) return;
+	{
+		std::lock_guard<std::mutex> lock(fMutex);
+		fSampleRate = rate;
+		if ( windowCapacity(fIntTime, rate) > fIntegration.capacity() ) {
+			fIntegration = SlidingWindowStats( windowCapacity(fIntTime, rate), fIntTime );
+		}
+	}
+	if ( hasAdc() ) fAdc->setRate(fSubscription, rate);
+}
+
+void Ads1115Measurement::registerSampleCallback(std::function<void(const Sample&)> fn) {
+	std::lock_guard<std::mutex> lock(fMutex);
+	fSampleFn = std::move(fn);
 }
 
 } // namespace PiRaTe
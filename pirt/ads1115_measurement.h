@@ -15,27 +15,44 @@
 #include <queue>
 #include <list>
 #include <mutex>
+#include <atomic>
 #include <functional>
 
 #include "gpioif.h"
 #include "utility.h"
-
-class ADS1115;
+#include "ads1115_scheduler.h"
 
 namespace PiRaTe {
 
+constexpr double MEASUREMENT_SAMPLE_RATE_DEFAULT { 100. }; ///< sample rate of the measurement channels in Hz
+
+/**
+ * @brief Measurement of an analog signal sampled by an ADS1115 ADC.
+ * The measurement subscribes to the ADC channel at its {@link Ads1115Scheduler} with {@link ADC_PRIORITY_MEASUREMENT}
+ * and integrates the pushed samples over a sliding time window. The statistics of the window are maintained
+ * incrementally by a {@link SlidingWindowStats} accumulator, so that neither adding a sample nor querying the mean
+ * depends on the length of the integration time.
+ */
 class Ads1115Measurement {
 public:
     
 	struct Sample {
-		std::chrono::time_point<std::chrono::system_clock> time;
+		std::chrono::steady_clock::time_point time; ///< time stamp at the middle of the ADC conversion
 		double value;
 	};
+	struct WindowStatistics {
+		double mean { 0. };
+		double stddev { 0. }; ///< standard deviation of the single samples
+		double min { 0. };
+		double max { 0. };
+		double snr { 0. }; ///< signal-to-noise ratio of the mean, i.e. |mean|/(stddev/sqrt(n))
+		std::size_t entries { 0 };
+	};
 	
 	Ads1115Measurement()=delete;
 
     Ads1115Measurement(	std::string name,
-						std::shared_ptr<ADS1115> adc,
+						std::shared_ptr<Ads1115Scheduler> adc,
 						std::uint8_t adc_channel,
 						double factor = 1.,
 						std::chrono::milliseconds integration_time = std::chrono::milliseconds(1000)
@@ -44,35 +61,70 @@ public:
     ~Ads1115Measurement();
 
 	[[nodiscard]] auto isFault() -> bool;
-    [[nodiscard]] auto isInitialized() const -> bool { return fActiveLoop; }
+    [[nodiscard]] auto isInitialized() const -> bool { return (fSubscription >= 0); }
     [[nodiscard]] auto hasAdc() const -> bool { return (fAdc != nullptr); }
     [[nodiscard]] auto currentValue() -> double;
     [[nodiscard]] auto meanValue() -> double;
+	/**
+	 * @brief The most recent sample with its time stamp.
+	 */
+    [[nodiscard]] auto currentSample() -> Sample;
+	/**
+	 * @brief The mean over the integration window.
+	 * @return the mean value together with the mean time stamp of the integrated samples, i.e. the instant
+	 * the mean value refers to
+	 */
+    [[nodiscard]] auto meanSample() -> Sample;
+	/**
+	 * @brief The statistics of the samples in the integration window.
+	 */
+    [[nodiscard]] auto windowStatistics() -> WindowStatistics;
 	[[nodiscard]] auto factor() const -> double { return fFactor; }
 	[[nodiscard]] auto name() const -> std::string { return fName; }
+	/**
+	 * @brief Set the integration time.
+	 * @note If the new window holds more samples than the current accumulator capacity, the accumulator is
+	 * reallocated and the integration restarts.
+	 */
 	void setIntTime( std::chrono::milliseconds ms );
+	/**
+	 * @brief Change the rate at which the channel is sampled.
+	 * The rate is requested from the conversion scheduler, the achieved rate depends on the load of the ADC
+	 * (see {@link Ads1115Measurement::statistics}).
+	 */
+	void setSampleRate( double rate );
+	[[nodiscard]] auto sampleRate() const -> double { return fSampleRate; }
 
 	void registerVoltageReadyCallback(std::function<void(double)> fn) {	fVoltageReadyFn = fn; }
+	/**
+	 * @brief Register a function which receives every raw (scaled) sample with its time stamp.
+	 * The function is called from the conversion thread of the ADC with the internal lock held, it must
+	 * return immediately. Pass an empty function to unregister; after the call returned, the previous function
+	 * is not called anymore.
+	 */
+	void registerSampleCallback(std::function<void(const Sample&)> fn);
+	[[nodiscard]] auto statistics() const -> Ads1115Scheduler::Statistics { return (hasAdc()) ? fAdc->statistics(fSubscription) : Ads1115Scheduler::Statistics { }; }
 
   private:
-    void threadLoop();
+    void processSample(const Ads1115Scheduler::Sample& sample);
 
 	std::string fName { "GND" };
-	std::shared_ptr<ADS1115> fAdc { nullptr };
+	std::shared_ptr<Ads1115Scheduler> fAdc { nullptr };
+	Ads1115Scheduler::SubscriptionId fSubscription { -1 };
 	bool fUpdated { false };
-    bool fActiveLoop { false };
 	std::uint8_t fAdcChannel { 0 };
 
-    std::unique_ptr<std::thread> fThread { nullptr };
-
 	std::mutex fMutex;
 	std::function<void(double)> fVoltageReadyFn { };
+	std::function<void(const Sample&)> fSampleFn { };
 	
 	double fValue { 0. };
-	std::deque<Sample> fIntegrationBuffer { };
+	std::chrono::steady_clock::time_point fTime { };
+	SlidingWindowStats fIntegration;
 
 	double fFactor { 1. };
 	std::chrono::milliseconds fIntTime { 1000 };
+	std::atomic<double> fSampleRate { MEASUREMENT_SAMPLE_RATE_DEFAULT };
 	
 };
 
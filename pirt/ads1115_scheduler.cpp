@@ -0,0 +1,396 @@
+#include <iostream>
+#include <algorithm>
+#include <climits>
+#include <future>
+#include <vector>
+
+#include "ads1115.h"
+#include "gpioif.h"
+#include "ads1115_scheduler.h"
+
+namespace PiRaTe {
+
+constexpr std::chrono::milliseconds IDLE_WAIT { 100 }; ///< wake-up interval of the scheduler without subscriptions
+constexpr double MAX_SAMPLE_RATE { 1000. }; ///< upper limit of the sample rate of a subscription in Hz
+constexpr double I2C_OVERHEAD { 300e-6 }; ///< estimate of the I2C transfer time of one conversion in s
+constexpr double ADS1115_SAMPLE_RATES[8] { 8., 16., 32., 64., 128., 250., 475., 860. };
+constexpr std::chrono::milliseconds READY_TIMEOUT_MARGIN { 5 }; ///< added to four nominal conversion times before a missing ready edge is assumed
+constexpr std::chrono::seconds IMMEDIATE_READ_TIMEOUT { 1 }; ///< maximum wait for an immediate conversion in data ready mode
+
+namespace {
+auto periodFromRate(double rate) -> std::chrono::steady_clock::duration
+{
+	return std::chrono::duration_cast<std::chrono::steady_clock::duration>( std::chrono::duration<double>( 1. / std::min(rate, MAX_SAMPLE_RATE) ) );
+}
+} // namespace
+
+Ads1115Scheduler::Ads1115Scheduler(std::shared_ptr<ADS1115> adc, std::shared_ptr<GPIO> gpio, int readyPin)
+	: fAdc { adc }, fGpio { gpio }, fReadyPin { readyPin }
+{
+	if ( fAdc == nullptr || !fAdc->devicePresent() ) {
+		std::cerr<<"Error: ADC for conversion scheduler not present.\n";
+		return;
+	}
+	fConversionTime = 1. / ADS1115_SAMPLE_RATES[fAdc->getRate() & 0x07] + I2C_OVERHEAD;
+	if ( fGpio != nullptr && fReadyPin >= 0 ) {
+		const unsigned int pin { static_cast<unsigned int>(fReadyPin) };
+		if ( !fAdc->setDataReadyPinMode() ) {
+			std::cerr<<"Warning: failed to configure the ALERT/RDY pin of the ADS1115 at 0x"<<std::hex<<static_cast<int>(fAdc->getAddress())<<std::dec<<", polling the conversion status.\n";
+		} else if ( !fGpio->set_gpio_direction(pin, false) || !fGpio->set_gpio_pullup(pin) ) {
+			std::cerr<<"Warning: failed to set up GPIO"<<fReadyPin<<" as ADC ready input, polling the conversion status.\n";
+		} else {
+			fReadyCallbackId = fGpio->register_edge_callback( pin,
+				[this](unsigned int, bool level, std::chrono::steady_clock::time_point time) { this->onReadyEdge(level, time); } );
+			if ( fReadyCallbackId < 0 ) {
+				std::cerr<<"Warning: no edge events on GPIO"<<fReadyPin<<", polling the conversion status.\n";
+			}
+		}
+		// the time of the I2C status polling does not apply anymore
+		if ( isDataReadyDriven() ) fConversionTime = 1. / ADS1115_SAMPLE_RATES[fAdc->getRate() & 0x07];
+	}
+	fWindowStart = std::chrono::steady_clock::now();
+	fActiveLoop = true;
+	if ( isDataReadyDriven() ) {
+		fThread = std::make_unique<std::thread>( [this]() { this->readyLoop(); } );
+	} else {
+		fThread = std::make_unique<std::thread>( [this]() { this->threadLoop(); } );
+	}
+}
+
+Ads1115Scheduler::~Ads1115Scheduler()
+{
+	if ( !fActiveLoop ) return;
+	fActiveLoop = false;
+	if ( isDataReadyDriven() ) fGpio->cancel_edge_callback(fReadyCallbackId);
+	fCondition.notify_all();
+	fReadyCondition.notify_all();
+	if ( fThread != nullptr ) fThread->join();
+}
+
+auto Ads1115Scheduler::subscribe(std::uint8_t channel, double rate, int priority, Callback callback) -> SubscriptionId
+{
+	if ( !fActiveLoop || channel > 3 || rate <= 0. || !callback ) return -1;
+	std::lock_guard<std::mutex> lock(fMutex);
+	const SubscriptionId id { fNextId++ };
+	Subscription subscription { };
+	subscription.channel = channel;
+	subscription.period = periodFromRate(rate);
+	subscription.priority = priority;
+	subscription.callback = std::move(callback);
+	subscription.deadline = std::chrono::steady_clock::now();
+	fSubscriptions.emplace(id, std::move(subscription));
+	if ( demandLocked() > 1. ) {
+		std::cerr<<"Warning: ADS1115 at 0x"<<std::hex<<static_cast<int>(fAdc->getAddress())<<std::dec
+			<<" oversubscribed ("<<100. * demandLocked()<<"% of its capacity requested)\n";
+	}
+	fCondition.notify_all();
+	return id;
+}
+
+void Ads1115Scheduler::unsubscribe(SubscriptionId id)
+{
+	{
+		std::lock_guard<std::mutex> lock(fMutex);
+		fSubscriptions.erase(id);
+	}
+	// wait for a callback which may be in progress
+	std::lock_guard<std::mutex> callback_lock(fCallbackMutex);
+}
+
+void Ads1115Scheduler::setRate(SubscriptionId id, double rate)
+{
+	if ( rate <= 0. ) return;
+	std::lock_guard<std::mutex> lock(fMutex);
+	auto it = fSubscriptions.find(id);
+	if ( it == fSubscriptions.end() ) return;
+	Subscription& subscription { it->second };
+	subscription.period = periodFromRate(rate);
+	if ( subscription.lastSample != std::chrono::steady_clock::time_point { } ) {
+		subscription.deadline = subscription.lastSample + subscription.period;
+	}
+	fCondition.notify_all();
+}
+
+auto Ads1115Scheduler::statistics(SubscriptionId id) const -> Statistics
+{
+	std::lock_guard<std::mutex> lock(fMutex);
+	auto it = fSubscriptions.find(id);
+	if ( it == fSubscriptions.end() ) return Statistics { };
+	const Subscription& subscription { it->second };
+	return Statistics { ( subscription.interval > 0. ) ? 1. / subscription.interval : 0., subscription.samples, subscription.late };
+}
+
+auto Ads1115Scheduler::readVoltage(std::uint8_t channel) -> double
+{
+	// the ADC serialises the conversions internally
+	if ( !isDataReadyDriven() || !fActiveLoop ) return fAdc->readVoltage(channel);
+	// a polled conversion would interfere with the pipelined ones, so it is requested from the scheduler thread
+	auto promise { std::make_shared<std::promise<double>>() };
+	auto done { std::make_shared<std::atomic<bool>>(false) };
+	std::future<double> result { promise->get_future() };
+	const SubscriptionId id { subscribe( channel, 1., INT_MAX, [promise, done](const Sample& sample) {
+		if ( !done->exchange(true) ) promise->set_value(sample.voltage);
+	} ) };
+	double voltage { 0. };
+	if ( result.wait_for(IMMEDIATE_READ_TIMEOUT) == std::future_status::ready ) voltage = result.get();
+	else std::cerr<<"Error: immediate conversion of ADC channel "<<static_cast<int>(channel)<<" timed out.\n";
+	unsubscribe(id);
+	return voltage;
+}
+
+auto Ads1115Scheduler::channelRate(std::uint8_t channel) const -> double
+{
+	if ( channel > 3 ) return 0.;
+	std::lock_guard<std::mutex> lock(fMutex);
+	return fChannelRates[channel];
+}
+
+auto Ads1115Scheduler::demand() const -> double
+{
+	std::lock_guard<std::mutex> lock(fMutex);
+	return demandLocked();
+}
+
+auto Ads1115Scheduler::demandLocked() const -> double
+{
+	double conversions_per_s { 0. };
+	for ( const auto& item: fSubscriptions ) {
+		conversions_per_s += 1. / std::chrono::duration<double>( item.second.period ).count();
+	}
+	return conversions_per_s * fConversionTime;
+}
+
+void Ads1115Scheduler::onReadyEdge(bool level, std::chrono::steady_clock::time_point time)
+{
+	// the ALERT/RDY output is pulled low at the end of a conversion
+	if ( level ) return;
+	{
+		std::lock_guard<std::mutex> lock(fReadyMutex);
+		fReady = true;
+		fReadyTime = time;
+	}
+	fReadyCondition.notify_one();
+}
+
+// called with fMutex held
+void Ads1115Scheduler::updateRates(std::chrono::steady_clock::time_point now, std::chrono::steady_clock::duration& busy)
+{
+	if ( now - fWindowStart < std::chrono::seconds(1) ) return;
+	const double window { std::chrono::duration<double>(now - fWindowStart).count() };
+	fUtilization = std::chrono::duration<double>(busy).count() / window;
+	for (std::size_t channel = 0; channel < fChannelCounts.size(); channel++) {
+		fChannelRates[channel] = fChannelCounts[channel] / window;
+		fChannelCounts[channel] = 0;
+	}
+	fWindowStart = now;
+	busy = std::chrono::steady_clock::duration { };
+}
+
+// called with fMutex held, returns the channel of the most urgent due subscription or -1 if none is due
+auto Ads1115Scheduler::nextChannel(std::chrono::steady_clock::time_point now, std::chrono::steady_clock::time_point& earliest) const -> int
+{
+	const Subscription* next { nullptr };
+	earliest = std::chrono::steady_clock::time_point::max();
+	for ( const auto& item: fSubscriptions ) {
+		const Subscription& subscription { item.second };
+		earliest = std::min(earliest, subscription.deadline);
+		if ( subscription.deadline > now ) continue;
+		if ( next == nullptr || subscription.priority > next->priority
+			|| ( subscription.priority == next->priority && subscription.deadline < next->deadline ) )
+		{
+			next = &subscription;
+		}
+	}
+	return ( next == nullptr ) ? -1 : next->channel;
+}
+
+// called with fMutex held, one conversion serves all due subscriptions of the channel
+// the schedule is advanced here, whether the conversion can be read or not
+void Ads1115Scheduler::serve(std::uint8_t channel, std::chrono::steady_clock::time_point end, std::vector<SubscriptionId>& served)
+{
+	served.clear();
+	for ( auto& item: fSubscriptions ) {
+		Subscription& subscription { item.second };
+		if ( subscription.channel != channel || subscription.deadline > end ) continue;
+		if ( end - subscription.deadline > subscription.period ) subscription.late++;
+		subscription.deadline += subscription.period;
+		if ( subscription.deadline < end ) subscription.deadline = end;
+		served.push_back(item.first);
+	}
+}
+
+// called with fMutex held, which is released during the callbacks
+// only delivered samples are counted, subscriptions removed since serve() are skipped
+void Ads1115Scheduler::deliver(std::unique_lock<std::mutex>& lock, std::uint8_t channel, const std::vector<SubscriptionId>& served,
+							   const Sample& sample, std::vector<Callback>& callbacks)
+{
+	callbacks.clear();
+	fChannelCounts[channel]++;
+	for ( SubscriptionId id: served ) {
+		auto it = fSubscriptions.find(id);
+		if ( it == fSubscriptions.end() ) continue;
+		Subscription& subscription { it->second };
+		if ( subscription.lastSample != std::chrono::steady_clock::time_point { } ) {
+			const double interval { std::chrono::duration<double>( sample.time - subscription.lastSample ).count() };
+			subscription.interval = ( subscription.interval > 0. ) ? subscription.interval + 0.1 * ( interval - subscription.interval ) : interval;
+		}
+		subscription.lastSample = sample.time;
+		subscription.samples++;
+		callbacks.push_back(subscription.callback);
+	}
+	// the callback lock is taken before releasing the subscriptions, so that an unsubscribe can wait for the delivery
+	std::unique_lock<std::mutex> callback_lock(fCallbackMutex);
+	lock.unlock();
+	for ( const auto& callback: callbacks ) callback(sample);
+	callback_lock.unlock();
+	lock.lock();
+}
+
+// this is the background thread loop polling the conversion status
+void Ads1115Scheduler::threadLoop()
+{
+	std::chrono::steady_clock::duration busy { };
+	std::vector<SubscriptionId> served { };
+	std::vector<Callback> callbacks { };
+	std::unique_lock<std::mutex> lock(fMutex);
+	while ( fActiveLoop ) {
+		const auto now { std::chrono::steady_clock::now() };
+		updateRates(now, busy);
+		if ( fSubscriptions.empty() ) {
+			fCondition.wait_for(lock, IDLE_WAIT);
+			continue;
+		}
+		auto earliest { std::chrono::steady_clock::time_point::max() };
+		const int next { nextChannel(now, earliest) };
+		if ( next < 0 ) {
+			fCondition.wait_until(lock, earliest);
+			continue;
+		}
+		const std::uint8_t channel { static_cast<std::uint8_t>(next) };
+		lock.unlock();
+
+		const auto start { std::chrono::steady_clock::now() };
+		const double voltage { fAdc->readVoltage(channel) };
+		const auto end { std::chrono::steady_clock::now() };
+		busy += end - start;
+		const Sample sample { start + ( end - start ) / 2, voltage };
+
+		lock.lock();
+		fConversionTime += 0.1 * ( std::chrono::duration<double>(end - start).count() - fConversionTime );
+		serve(channel, end, served);
+		deliver(lock, channel, served, sample, callbacks);
+	}
+}
+
+// this is the background thread loop driven by the ALERT/RDY edges
+void Ads1115Scheduler::readyLoop()
+{
+	struct Conversion {
+		std::uint8_t channel { 0 };
+		ADS1115::CFG_PGA pga { ADS1115::PGA4V };
+		std::chrono::steady_clock::time_point start { };
+	};
+	std::chrono::steady_clock::duration busy { };
+	std::vector<SubscriptionId> served { };
+	std::vector<Callback> callbacks { };
+	Conversion running { };
+	bool in_flight { false };
+	const auto nominal { std::chrono::duration<double>( 1. / ADS1115_SAMPLE_RATES[fAdc->getRate() & 0x07] ) };
+	const auto ready_timeout { std::chrono::duration_cast<std::chrono::steady_clock::duration>(4 * nominal) + READY_TIMEOUT_MARGIN };
+
+	// starts the most urgent due conversion while no conversion is running, called with fMutex held
+	auto startNext = [&](std::unique_lock<std::mutex>& lock, std::chrono::steady_clock::time_point now,
+						 std::chrono::steady_clock::time_point& earliest) -> bool {
+		const int next { nextChannel(now, earliest) };
+		if ( next < 0 ) return false;
+		lock.unlock();
+		{
+			std::lock_guard<std::mutex> ready_lock(fReadyMutex);
+			fReady = false;
+		}
+		running.channel = static_cast<std::uint8_t>(next);
+		running.start = std::chrono::steady_clock::now();
+		in_flight = fAdc->startConversion(running.channel, running.pga);
+		lock.lock();
+		return in_flight;
+	};
+
+	std::unique_lock<std::mutex> lock(fMutex);
+	while ( fActiveLoop ) {
+		updateRates(std::chrono::steady_clock::now(), busy);
+		if ( !in_flight ) {
+			if ( fSubscriptions.empty() ) {
+				fCondition.wait_for(lock, IDLE_WAIT);
+				continue;
+			}
+			auto earliest { std::chrono::steady_clock::time_point::max() };
+			if ( !startNext(lock, std::chrono::steady_clock::now(), earliest) ) {
+				if ( earliest == std::chrono::steady_clock::time_point::max() ) earliest = std::chrono::steady_clock::now() + IDLE_WAIT;
+				fCondition.wait_until(lock, earliest);
+			}
+			continue;
+		}
+
+		// wait for the end of the running conversion
+		lock.unlock();
+		std::chrono::steady_clock::time_point ready_time { };
+		{
+			std::unique_lock<std::mutex> ready_lock(fReadyMutex);
+			if ( fReadyCondition.wait_for(ready_lock, ready_timeout, [this]() { return fReady || !fActiveLoop; }) && fReady ) {
+				ready_time = fReadyTime;
+			} else {
+				ready_time = std::chrono::steady_clock::now();
+				if ( fActiveLoop ) fReadyTimeouts++;
+			}
+		}
+		if ( !fActiveLoop ) break;
+		const Conversion finished { running };
+		in_flight = false;
+		Sample sample { finished.start + ( ready_time - finished.start ) / 2, 0. };
+
+		// the schedule of the finished channel is advanced before the next conversion is selected
+		lock.lock();
+		busy += ready_time - finished.start;
+		fConversionTime += 0.1 * ( std::chrono::duration<double>(ready_time - finished.start).count() - fConversionTime );
+		serve(finished.channel, ready_time, served);
+		auto earliest { std::chrono::steady_clock::time_point::max() };
+		const int next { nextChannel(std::chrono::steady_clock::now(), earliest) };
+		lock.unlock();
+
+		std::int16_t adc_value { 0 };
+		double voltage { 0. };
+		bool ok { false };
+		if ( next >= 0 ) {
+			// start of the next conversion and readout of the finished one in one bus transaction
+			{
+				std::lock_guard<std::mutex> ready_lock(fReadyMutex);
+				fReady = false;
+			}
+			running.channel = static_cast<std::uint8_t>(next);
+			running.start = std::chrono::steady_clock::now();
+			ok = fAdc->startAndReadConversion(running.channel, running.pga, finished.channel, finished.pga, adc_value, voltage);
+			in_flight = ok;
+		} else {
+			ok = fAdc->readConversion(finished.channel, finished.pga, adc_value, voltage);
+		}
+		bool overwritten { false };
+		if ( in_flight ) {
+			// the conversion register is updated at the end of the next conversion; if that has already ended
+			// (possible when the adapter executes the transfer segments separately), it is not known which of both
+			// results was read
+			std::lock_guard<std::mutex> ready_lock(fReadyMutex);
+			overwritten = fReady;
+		}
+		sample.voltage = voltage;
+
+		lock.lock();
+		if ( !ok ) continue;
+		if ( overwritten ) {
+			fDiscarded++;
+			continue;
+		}
+		deliver(lock, finished.channel, served, sample, callbacks);
+	}
+}
+
+} // namespace PiRaTe
@@ -0,0 +1,160 @@
+#ifndef ADS1115_SCHEDULER_H
+#define ADS1115_SCHEDULER_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "thread_policy.h"
+
+class ADS1115;
+class GPIO;
+
+namespace PiRaTe {
+
+constexpr int ADC_PRIORITY_MONITOR { 0 }; ///< subscription priority of slow supervision channels
+constexpr int ADC_PRIORITY_MEASUREMENT { 10 }; ///< subscription priority of measurement channels
+constexpr int ADC_PRIORITY_MOTOR { 20 }; ///< subscription priority of the motor current sense
+
+/**
+ * @brief Conversion scheduler owning one ADS1115 ADC, which is shared by several consumers.
+ * Instead of each consumer polling the ADC from its own thread, the consumers subscribe to a channel with the
+ * desired sample rate and priority and get the results pushed through a callback. A single thread runs the
+ * single-shot conversions back-to-back: of all subscriptions whose deadline has expired, the one with the highest
+ * priority is served first, subscriptions of equal priority in the order of their deadlines (earliest deadline first).
+ * Thus the motor currents are sampled with precedence, while the remaining capacity of the ADC is distributed over the
+ * other channels at their requested rates. One conversion serves all due subscriptions of the same channel.
+ * Deadlines which were missed by more than one period are counted and the schedule of the subscription is
+ * re-anchored instead of catching up with a burst of conversions.
+ * If the ALERT/RDY output of the ADC is wired to a GPIO input, the completion of a conversion is signalled by an edge
+ * event instead of polling the status register over the bus. The conversions are then pipelined: after the ready edge,
+ * the next conversion is started and the result of the finished one is read in a single combined bus transaction.
+ * Thus the ADC converts back-to-back at its nominal data rate without wasting bus cycles.
+ * @note The callbacks are executed in the scheduler thread and must return quickly. They must neither subscribe nor
+ * unsubscribe. After {@link Ads1115Scheduler::unsubscribe} returned, the callback of the subscription is not called anymore.
+ * @author HG Zaunick
+ */
+class Ads1115Scheduler {
+public:
+	struct Sample {
+		std::chrono::steady_clock::time_point time { }; ///< time stamp at the middle of the conversion
+		double voltage { 0. }; ///< input voltage in V
+	};
+	struct Statistics {
+		double rate { 0. }; ///< achieved sample rate in Hz
+		unsigned long samples { 0 }; ///< number of samples delivered, without failed and discarded readouts
+		unsigned long late { 0 }; ///< number of samples delayed by more than one period
+	};
+	using Callback = std::function<void(const Sample&)>;
+	using SubscriptionId = int;
+
+	Ads1115Scheduler() = delete;
+	/**
+	 * @brief The main constructor.
+	 * Starts the scheduler thread, if the ADC is present.
+	 * @param adc the ADC, which must not be read by other objects than the scheduler from now on
+	 * @param gpio the GPIO interface for the ready signal, nullptr for polling the conversion status
+	 * @param readyPin the GPIO input connected to the ALERT/RDY pin of the ADC, -1 for polling the conversion status
+	 * @note The scheduler falls back to polling, if the ready pin can not be set up or the GPIO interface does not
+	 * support edge events.
+	 */
+	explicit Ads1115Scheduler(std::shared_ptr<ADS1115> adc, std::shared_ptr<GPIO> gpio = nullptr, int readyPin = -1);
+	~Ads1115Scheduler();
+
+	[[nodiscard]] auto isInitialized() const -> bool { return fActiveLoop; }
+	[[nodiscard]] auto adc() const -> std::shared_ptr<ADS1115> { return fAdc; }
+	/// the conversions are driven by the ALERT/RDY edge events
+	[[nodiscard]] auto isDataReadyDriven() const -> bool { return fReadyCallbackId >= 0; }
+	/**
+	 * @brief Subscribe to the conversions of an ADC channel.
+	 * @param channel the ADC channel (0...3)
+	 * @param rate the requested sample rate in Hz
+	 * @param priority the priority of the subscription, larger values are served first
+	 * @param callback called with every sample of the subscription
+	 * @return the id of the subscription, -1 if the scheduler is not running or the arguments are invalid
+	 */
+	auto subscribe(std::uint8_t channel, double rate, int priority, Callback callback) -> SubscriptionId;
+	void unsubscribe(SubscriptionId id);
+	/// change the sample rate of a subscription, the next sample is scheduled one new period after the last one
+	void setRate(SubscriptionId id, double rate);
+	[[nodiscard]] auto statistics(SubscriptionId id) const -> Statistics;
+	/**
+	 * @brief Immediate conversion outside of the schedule.
+	 * The conversion is serialised with the scheduled ones, it is meant for calibrations during the setup of a consumer.
+	 */
+	[[nodiscard]] auto readVoltage(std::uint8_t channel) -> double;
+	/// fraction of time the ADC was busy with conversions during the last second
+	[[nodiscard]] auto utilization() const -> double { return fUtilization; }
+	/// delivered conversions per second of the given channel during the last second
+	[[nodiscard]] auto channelRate(std::uint8_t channel) const -> double;
+	/// number of conversions whose ready edge did not arrive in time
+	[[nodiscard]] auto readyTimeouts() const -> unsigned long { return fReadyTimeouts; }
+	/// number of pipelined results discarded, because the next conversion may have overwritten them before the readout
+	[[nodiscard]] auto discardedSamples() const -> unsigned long { return fDiscarded; }
+	/**
+	 * @brief Sum of the requested sample rates times the mean conversion time.
+	 * Values above 1 mean that the ADC can not satisfy all subscriptions, the subscriptions of lowest priority are
+	 * then sampled at lower rates than requested.
+	 */
+	[[nodiscard]] auto demand() const -> double;
+	/// apply scheduling policy and CPU affinity to the conversion thread
+	auto setThreadPolicy(const ThreadPolicy& policy) -> bool { return applyThreadPolicy(fThread.get(), policy); }
+
+private:
+	struct Subscription {
+		std::uint8_t channel { 0 };
+		std::chrono::steady_clock::duration period { };
+		int priority { 0 };
+		Callback callback { };
+		std::chrono::steady_clock::time_point deadline { };
+		std::chrono::steady_clock::time_point lastSample { };
+		double interval { 0. }; ///< smoothed interval between samples in s
+		unsigned long samples { 0 };
+		unsigned long late { 0 };
+	};
+
+	void threadLoop();
+	void readyLoop();
+	[[nodiscard]] auto nextChannel(std::chrono::steady_clock::time_point now, std::chrono::steady_clock::time_point& earliest) const -> int;
+	void serve(std::uint8_t channel, std::chrono::steady_clock::time_point end, std::vector<SubscriptionId>& served);
+	void deliver(std::unique_lock<std::mutex>& lock, std::uint8_t channel, const std::vector<SubscriptionId>& served,
+				 const Sample& sample, std::vector<Callback>& callbacks);
+	void updateRates(std::chrono::steady_clock::time_point now, std::chrono::steady_clock::duration& busy);
+	void onReadyEdge(bool level, std::chrono::steady_clock::time_point time);
+	[[nodiscard]] auto demandLocked() const -> double;
+
+	std::shared_ptr<ADS1115> fAdc { nullptr };
+	std::shared_ptr<GPIO> fGpio { nullptr };
+	int fReadyPin { -1 };
+	int fReadyCallbackId { -1 };
+	std::map<SubscriptionId, Subscription> fSubscriptions { };
+	SubscriptionId fNextId { 0 };
+	double fConversionTime { 0. }; ///< smoothed duration of a conversion in s
+	std::atomic<double> fUtilization { 0. };
+	std::chrono::steady_clock::time_point fWindowStart { };
+	std::array<unsigned long, 4> fChannelCounts { }; ///< delivered conversions per channel in the current window
+	std::array<double, 4> fChannelRates { }; ///< delivered conversions per second and channel in the last window
+	std::atomic<unsigned long> fReadyTimeouts { 0 };
+	std::atomic<unsigned long> fDiscarded { 0 };
+	std::atomic<bool> fActiveLoop { false };
+	mutable std::mutex fMutex;
+	std::mutex fCallbackMutex; ///< held while callbacks are executed
+	std::condition_variable fCondition;
+	std::mutex fReadyMutex; ///< protects the ready flag set by the edge callback
+	std::condition_variable fReadyCondition;
+	bool fReady { false };
+	std::chrono::steady_clock::time_point fReadyTime { };
+	std::unique_ptr<std::thread> fThread { nullptr };
+};
+
+} // namespace PiRaTe
+
+#endif // ADS1115_SCHEDULER_H
@@ -0,0 +1,184 @@
+#include <cmath>
+#include <algorithm>
+
+#include "axis_estimator.h"
+
+namespace PiRaTe {
+
+namespace {
+// initial standard deviations of velocity and acceleration after (re-)initialization
+constexpr double initial_velocity_sigma { 0.5 }; // rev/s
+constexpr double initial_acceleration_sigma { 5. }; // rev/s^2
+
+// row-major 3x3 matrix product
+auto multiply(const std::array<double, 9>& a, const std::array<double, 9>& b) -> std::array<double, 9>
+{
+	std::array<double, 9> c { };
+	for (int i = 0; i < 3; i++) {
+		for (int j = 0; j < 3; j++) {
+			c[3*i+j] = a[3*i] * b[j] + a[3*i+1] * b[3+j] + a[3*i+2] * b[6+j];
+		}
+	}
+	return c;
+}
+
+auto transpose(const std::array<double, 9>& a) -> std::array<double, 9>
+{
+	return { a[0], a[3], a[6], a[1], a[4], a[7], a[2], a[5], a[8] };
+}
+} // anonymous namespace
+
+auto AxisEstimator::State::positionError() const -> double { return std::sqrt( std::max( covariance[0], 0. ) ); }
+auto AxisEstimator::State::velocityError() const -> double { return std::sqrt( std::max( covariance[4], 0. ) ); }
+auto AxisEstimator::State::accelerationError() const -> double { return std::sqrt( std::max( covariance[8], 0. ) ); }
+
+AxisEstimator::AxisEstimator(const Config& config)
+	: fConfig { config }
+{
+}
+
+void AxisEstimator::setConfig(const Config& config)
+{
+	std::lock_guard<std::mutex> lock(fMutex);
+	fConfig = config;
+}
+
+auto AxisEstimator::config() const -> Config
+{
+	std::lock_guard<std::mutex> lock(fMutex);
+	return fConfig;
+}
+
+void AxisEstimator::setResolution(std::uint8_t st_bits)
+{
+	const double lsb { std::ldexp(1., -static_cast<int>(st_bits)) };
+	std::lock_guard<std::mutex> lock(fMutex);
+	fConfig.measurementVariance = lsb * lsb / 12.;
+}
+
+void AxisEstimator::reset()
+{
+	std::lock_guard<std::mutex> lock(fMutex);
+	fState = State { };
+	fStatistics = Statistics { };
+	fConsecutiveRejects = 0;
+}
+
+void AxisEstimator::initialize(std::chrono::steady_clock::time_point time, double position)
+{
+	fState = State { };
+	fState.time = time;
+	fState.position = position;
+	fState.covariance[0] = fConfig.measurementVariance;
+	fState.covariance[4] = initial_velocity_sigma * initial_velocity_sigma;
+	fState.covariance[8] = initial_acceleration_sigma * initial_acceleration_sigma;
+	fState.valid = true;
+	fConsecutiveRejects = 0;
+}
+
+auto AxisEstimator::propagate(const State& state, double dt, double duty) const -> State
+{
+	State next { state };
+	if (dt <= 0.) return next;
+	const double dt2 { dt * dt };
+	// state transition of the white-jerk kinematic model
+	Matrix F { 1., dt, 0.5 * dt2,
+			   0., 1., dt,
+			   0., 0., 1. };
+	double control { 0. };
+	if (fConfig.tau > 0.) {
+		// second-order lag of the motor speed following the duty cycle
+		const double tau2 { fConfig.tau * fConfig.tau };
+		F[7] = -dt / tau2;
+		F[8] = 1. - dt / fConfig.tau;
+		control = fConfig.gain * std::min( std::max( duty, -1. ), 1. ) * dt / tau2;
+	}
+	next.position = F[0] * state.position + F[1] * state.velocity + F[2] * state.acceleration;
+	next.velocity = F[4] * state.velocity + F[5] * state.acceleration;
+	next.acceleration = F[7] * state.velocity + F[8] * state.acceleration + control;
+
+	// process noise of a continuous white jerk with spectral density q
+	const double q { fConfig.jerkNoise };
+	const double dt3 { dt2 * dt };
+	const Matrix Q { q * dt3 * dt2 / 20., q * dt2 * dt2 / 8., q * dt3 / 6.,
+					 q * dt2 * dt2 / 8., q * dt3 / 3., q * dt2 / 2.,
+					 q * dt3 / 6., q * dt2 / 2., q * dt };
+	next.covariance = multiply( multiply( F, state.covariance ), transpose(F) );
+	for (std::size_t i = 0; i < next.covariance.size(); i++) next.covariance[i] += Q[i];
+	next.time = state.time + std::chrono::duration_cast<std::chrono::steady_clock::duration>( std::chrono::duration<double>(dt) );
+	return next;
+}
+
+auto AxisEstimator::update(std::chrono::steady_clock::time_point time, double position, double duty) -> bool
+{
+	std::lock_guard<std::mutex> lock(fMutex);
+	if (!fState.valid) {
+		initialize(time, position);
+		fStatistics.accepted++;
+		return true;
+	}
+	const double dt { std::chrono::duration<double>( time - fState.time ).count() };
+	if (dt < 0.) {
+		// out-of-order sample, ignore
+		return false;
+	}
+	if (dt > fConfig.maxInterval) {
+		initialize(time, position);
+		fStatistics.relocks++;
+		fStatistics.accepted++;
+		return true;
+	}
+	State predicted { propagate(fState, dt, duty) };
+	predicted.time = time;
+	const Matrix& P { predicted.covariance };
+	// innovation and its variance for the measurement matrix H = [1, 0, 0]
+	const double y { position - predicted.position };
+	const double S { P[0] + fConfig.measurementVariance };
+	fStatistics.nis = y * y / S;
+	if (fStatistics.nis > fConfig.gate) {
+		fStatistics.rejected++;
+		if (++fConsecutiveRejects > fConfig.maxRejects) {
+			initialize(time, position);
+			fStatistics.relocks++;
+			return true;
+		}
+		// keep the prediction, so that the uncertainty grows until the next valid measurement
+		fState = predicted;
+		return false;
+	}
+	fConsecutiveRejects = 0;
+	const std::array<double, 3> K { P[0] / S, P[3] / S, P[6] / S };
+	fState = predicted;
+	fState.position += K[0] * y;
+	fState.velocity += K[1] * y;
+	fState.acceleration += K[2] * y;
+	// P = (I - K H) P
+	for (int i = 0; i < 3; i++) {
+		for (int j = 0; j < 3; j++) {
+			fState.covariance[3*i+j] = P[3*i+j] - K[i] * P[j];
+		}
+	}
+	fStatistics.accepted++;
+	return true;
+}
+
+auto AxisEstimator::state() const -> State
+{
+	std::lock_guard<std::mutex> lock(fMutex);
+	return fState;
+}
+
+auto AxisEstimator::predict(std::chrono::steady_clock::time_point time, double duty) const -> State
+{
+	std::lock_guard<std::mutex> lock(fMutex);
+	if (!fState.valid) return fState;
+	return propagate( fState, std::chrono::duration<double>( time - fState.time ).count(), duty );
+}
+
+auto AxisEstimator::statistics() const -> Statistics
+{
+	std::lock_guard<std::mutex> lock(fMutex);
+	return fStatistics;
+}
+
+} // namespace PiRaTe
@@ -0,0 +1,96 @@
+#ifndef AXIS_ESTIMATOR_H
+#define AXIS_ESTIMATOR_H
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+
+namespace PiRaTe {
+
+/**
+ * @brief Kalman filter estimating position, velocity and acceleration of one mount axis.
+ * The state vector [x, v, a] (revolutions, rev/s, rev/s^2) is propagated with a white-jerk kinematic model.
+ * When a motor model is configured ({@link AxisEstimator::Config::tau} > 0), the acceleration additionally
+ * follows the commanded duty cycle u as a second-order lag:
+ * a' = -a/tau - v/tau^2 + gain*u/tau^2, i.e. in steady state v = gain*u.
+ * Position measurements are fused with the quantisation noise of the encoder as measurement variance.
+ * Each measurement is gated by its normalized innovation squared (NIS = y^2/S); samples exceeding
+ * {@link AxisEstimator::Config::gate} are rejected as glitches. After {@link AxisEstimator::Config::maxRejects}
+ * consecutive rejects the filter re-locks onto the measurement, since the rejects then indicate a real
+ * jump (or a model mismatch) rather than isolated glitches.
+ * @note update() and reset() must be called from a single thread, state() and predict() may be called from any thread.
+ * @author HG Zaunick
+ */
+class AxisEstimator {
+public:
+	struct Config {
+		double tau { 0. }; ///< time constant of the motor model in s, 0 disables the motor model
+		double gain { 0. }; ///< steady-state speed at full duty cycle in rev/s (sign according to the motor direction)
+		double jerkNoise { 1e-2 }; ///< spectral density of the white-jerk process noise in rev^2/s^5
+		double measurementVariance { 1./(4096.*4096.*12.) }; ///< variance of the position measurement in rev^2
+		double gate { 25. }; ///< NIS threshold for glitch rejection (25 corresponds to 5 sigma)
+		unsigned int maxRejects { 5 }; ///< number of consecutive rejects after which the filter re-locks
+		double maxInterval { 1. }; ///< maximum time between updates in s, the filter is re-initialized after longer gaps
+	};
+
+	struct State {
+		std::chrono::steady_clock::time_point time { }; ///< time of validity
+		double position { 0. }; ///< position in revolutions
+		double velocity { 0. }; ///< velocity in rev/s
+		double acceleration { 0. }; ///< acceleration in rev/s^2
+		std::array<double, 9> covariance { }; ///< row-major 3x3 covariance of [x, v, a]
+		bool valid { false }; ///< false until the first measurement was fused
+		[[nodiscard]] auto positionError() const -> double;
+		[[nodiscard]] auto velocityError() const -> double;
+		[[nodiscard]] auto accelerationError() const -> double;
+	};
+
+	struct Statistics {
+		unsigned long accepted { 0 }; ///< number of fused measurements
+		unsigned long rejected { 0 }; ///< number of measurements rejected by the innovation gate
+		unsigned long relocks { 0 }; ///< number of re-initializations after consecutive rejects or gaps
+		double nis { 0. }; ///< NIS of the last measurement
+	};
+
+	AxisEstimator() = default;
+	explicit AxisEstimator(const Config& config);
+
+	void setConfig(const Config& config);
+	[[nodiscard]] auto config() const -> Config;
+	/**
+	 * @brief Set the measurement variance from the encoder resolution.
+	 * @param st_bits the single-turn bit width of the encoder, the variance is set to the quantisation noise (2^-st_bits)^2/12
+	 */
+	void setResolution(std::uint8_t st_bits);
+	void reset();
+
+	/**
+	 * @brief Propagate the state to the time of a measurement and fuse it.
+	 * @param time the time stamp of the measurement
+	 * @param position the measured position in revolutions
+	 * @param duty the duty cycle commanded to the motor since the previous update (-1...1)
+	 * @return false if the measurement was rejected as a glitch
+	 */
+	auto update(std::chrono::steady_clock::time_point time, double position, double duty = 0.) -> bool;
+	/// the state after the last update
+	[[nodiscard]] auto state() const -> State;
+	/// the state propagated to the given time assuming the duty cycle stays constant
+	[[nodiscard]] auto predict(std::chrono::steady_clock::time_point time, double duty = 0.) const -> State;
+	[[nodiscard]] auto statistics() const -> Statistics;
+
+private:
+	using Matrix = std::array<double, 9>;
+	void initialize(std::chrono::steady_clock::time_point time, double position);
+	[[nodiscard]] auto propagate(const State& state, double dt, double duty) const -> State;
+
+	Config fConfig { };
+	State fState { };
+	Statistics fStatistics { };
+	unsigned int fConsecutiveRejects { 0 };
+	mutable std::mutex fMutex;
+};
+
+} // namespace PiRaTe
+
+#endif // AXIS_ESTIMATOR_H
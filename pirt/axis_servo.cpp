@@ -0,0 +1,222 @@
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+
+#include "axis_servo.h"
+#include "axis_estimator.h"
+#include "encoder.h"
+#include "motordriver.h"
+
+namespace PiRaTe {
+
+constexpr double MOTOR_LAG_TOLERANCE { 0.02 }; ///< deviation of the applied from the commanded duty cycle at which the motor counts as saturated
+constexpr double MIN_OUTPUT { 1e-3 }; ///< outputs below this duty cycle are treated as zero (no deadband compensation)
+
+template <typename T> constexpr int sgn(T val) {
+    return (T(0) < val) - (val < T(0));
+}
+
+namespace {
+auto periodFromRate(double rate) -> std::chrono::microseconds
+{
+	rate = std::min( std::max( rate, SERVO_MIN_RATE ), SERVO_MAX_RATE );
+	return std::chrono::microseconds( static_cast<long>( 1e6 / rate ) );
+}
+} // namespace
+
+AxisServo::AxisServo(SsiPosEncoder& encoder, AxisEstimator& estimator, MotorDriver& motor)
+	: fEncoder { encoder }, fEstimator { estimator }, fMotor { motor }, fLoopTimer { periodFromRate(fConfig.rate) }
+{
+	fSampleCursor = fEncoder.sampleBuffer().head();
+	fActiveLoop = true;
+	fThread.reset( new std::thread( [this]() { this->threadLoop(); } ));
+}
+
+AxisServo::~AxisServo()
+{
+	disengage();
+	fActiveLoop = false;
+	if (fThread != nullptr) fThread->join();
+	fThread.reset();
+}
+
+void AxisServo::setConfig(const Config& config)
+{
+	std::lock_guard<std::mutex> lock(fMutex);
+	fConfig = config;
+	fLoopTimer.setPeriod( periodFromRate(config.rate) );
+	if ( fConfig.motorGain == 0. && fEngaged ) {
+		// without motor model the loop can not be closed
+		fEngaged = false;
+		resetIntegrators();
+		fMotor.stop();
+	}
+}
+
+auto AxisServo::config() const -> Config
+{
+	std::lock_guard<std::mutex> lock(fMutex);
+	return fConfig;
+}
+
+auto AxisServo::setSetpoint(const Setpoint& setpoint) -> bool
+{
+	std::lock_guard<std::mutex> lock(fMutex);
+	if ( fConfig.motorGain == 0. ) return false;
+	fSetpoint = setpoint;
+	fFollowTrajectory = false;
+	if ( !fEngaged ) {
+		resetIntegrators();
+		fEngaged = true;
+	}
+	return true;
+}
+
+auto AxisServo::setTrajectory(const SCurveProfile& profile, std::chrono::steady_clock::time_point start) -> bool
+{
+	std::lock_guard<std::mutex> lock(fMutex);
+	if ( fConfig.motorGain == 0. ) return false;
+	fTrajectory = profile;
+	fTrajectoryStart = start;
+	fFollowTrajectory = true;
+	if ( !fEngaged ) {
+		resetIntegrators();
+		fEngaged = true;
+	}
+	return true;
+}
+
+void AxisServo::disengage()
+{
+	std::lock_guard<std::mutex> lock(fMutex);
+	fEngaged = false;
+	fFollowTrajectory = false;
+	resetIntegrators();
+	fState.output = 0.;
+	fState.engaged = false;
+	fState.trajectory = false;
+	fMotor.stop();
+}
+
+auto AxisServo::state() const -> State
+{
+	std::lock_guard<std::mutex> lock(fMutex);
+	return fState;
+}
+
+void AxisServo::resetIntegrators()
+{
+	fPositionIntegral = 0.;
+	fVelocityIntegral = 0.;
+}
+
+// this is the background thread loop
+void AxisServo::threadLoop()
+{
+	fLoopTimer.reset();
+	while (fActiveLoop) {
+		// sleep until the next absolute control deadline
+		fLoopTimer.wait();
+		updateEstimator();
+		control( std::chrono::steady_clock::now() );
+	}
+}
+
+void AxisServo::updateEstimator()
+{
+	// the duty cycle applied by the motor driver since the previous cycle
+	const double duty { fMotor.currentSpeed() };
+	fEncoder.sampleBuffer().readSince( fSampleCursor, [this, duty](const SsiPosEncoder::Sample& sample) {
+		if ( sample.valid() ) fEstimator.update(sample.time, sample.position, duty);
+	} );
+}
+
+void AxisServo::control(std::chrono::steady_clock::time_point now)
+{
+	const double duty { fMotor.currentSpeed() };
+	// compensate the age of the last encoder sample by propagating the state to the current instant
+	const AxisEstimator::State estimate { fEstimator.predict(now, duty) };
+
+	std::lock_guard<std::mutex> lock(fMutex);
+	const double lastOutput { fState.output };
+	fState.time = now;
+	fState.position = estimate.position;
+	fState.velocity = estimate.velocity;
+	fState.engaged = fEngaged;
+	fState.trajectory = fFollowTrajectory;
+	fState.saturated = false;
+	if ( !fEngaged ) {
+		fState.positionError = 0.;
+		fState.velocityCommand = 0.;
+		fState.output = 0.;
+		return;
+	}
+	if ( !estimate.valid ) {
+		// no position feedback, hold the motor until the estimator has locked
+		resetIntegrators();
+		fState.output = 0.;
+		fMotor.stop();
+		return;
+	}
+
+	const double period { std::chrono::duration<double>( fLoopTimer.period() ).count() };
+	if ( fFollowTrajectory ) {
+		// stream the setpoints from the trajectory, at its end the target position is held
+		const double t { std::chrono::duration<double>( now - fTrajectoryStart ).count() };
+		const SCurveProfile::Sample sample { fTrajectory.sample(t) };
+		fSetpoint = Setpoint { now, sample.position, sample.velocity, sample.acceleration };
+		if ( t >= fTrajectory.duration() ) fFollowTrajectory = false;
+	}
+	const double dt { std::chrono::duration<double>( now - fSetpoint.time ).count() };
+	const double setpointPosition { fSetpoint.position + fSetpoint.velocity * dt + 0.5 * fSetpoint.acceleration * dt * dt };
+	const double setpointVelocity { fSetpoint.velocity + fSetpoint.acceleration * dt };
+	const double setpointAcceleration { fSetpoint.acceleration };
+	const double positionError { setpointPosition - estimate.position };
+	fState.setpoint = setpointPosition;
+	fState.positionError = positionError;
+
+	if ( setpointVelocity == 0. && setpointAcceleration == 0. && std::abs(positionError) < fConfig.tolerance ) {
+		// in position and at rest
+		resetIntegrators();
+		fState.velocityCommand = 0.;
+		fState.output = 0.;
+		fMotor.stop();
+		return;
+	}
+
+	// position loop
+	const double maxVelocity { ( fConfig.maxVelocity > 0. ) ? fConfig.maxVelocity : std::abs(fConfig.motorGain) };
+	const double unlimitedVelocity { setpointVelocity + fConfig.positionKp * positionError + fPositionIntegral };
+	const double velocityCommand { std::min( std::max( unlimitedVelocity, -maxVelocity ), maxVelocity ) };
+	const bool velocityLimited { velocityCommand != unlimitedVelocity };
+	if ( !velocityLimited || sgn(positionError) != sgn(unlimitedVelocity) ) {
+		fPositionIntegral += fConfig.positionKi * positionError * period;
+	}
+	fState.velocityCommand = velocityCommand;
+
+	// velocity loop with feed-forward through the motor model
+	const double velocityError { velocityCommand - estimate.velocity };
+	const double normalizedOutput {
+		velocityCommand + fConfig.motorTau * setpointAcceleration
+		+ fConfig.velocityKp * velocityError
+		+ fVelocityIntegral
+		+ fConfig.velocityKd * ( setpointAcceleration - estimate.acceleration ) };
+	double output { normalizedOutput / fConfig.motorGain };
+	// the motor does not move below the deadband, so every non-zero output is shifted beyond it
+	if ( std::abs(output) > MIN_OUTPUT ) {
+		output = sgn(output) * ( fConfig.deadband + ( 1. - fConfig.deadband ) * std::abs(output) );
+	} else {
+		output = 0.;
+	}
+	const double limitedOutput { std::min( std::max( output, -1. ), 1. ) };
+	// the motor driver ramps the duty cycle, a motor lagging behind the previous command is saturated as well
+	const bool outputLimited { limitedOutput != output || std::abs(lastOutput - duty) > MOTOR_LAG_TOLERANCE };
+	if ( !outputLimited || sgn(velocityError) != sgn(normalizedOutput) ) {
+		fVelocityIntegral += fConfig.velocityKi * velocityError * period;
+	}
+	fState.saturated = velocityLimited || outputLimited;
+	fState.output = limitedOutput;
+	fMotor.move( static_cast<float>(limitedOutput) );
+}
+
+} // namespace PiRaTe
@@ -0,0 +1,155 @@
+#ifndef AXIS_SERVO_H
+#define AXIS_SERVO_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "loop_timer.h"
+#include "trajectory.h"
+#include "thread_policy.h"
+
+namespace PiRaTe {
+
+class SsiPosEncoder;
+class AxisEstimator;
+class MotorDriver;
+
+constexpr double SERVO_MIN_RATE { 100. }; ///< minimum servo loop rate in Hz
+constexpr double SERVO_MAX_RATE { 500. }; ///< maximum servo loop rate in Hz
+
+/**
+ * @brief Closed-loop position controller of one mount axis running in its own thread.
+ * The servo loop is executed at a fixed rate ({@link AxisServo::Config::rate}). In every cycle all encoder
+ * samples recorded since the previous cycle are fused into the axis' {@link AxisEstimator}, the estimated state
+ * is propagated to the current instant and compared with the setpoint, which is extrapolated to the same instant.
+ * The controller is a cascade of a position loop (PI) generating a velocity command and a velocity loop (PID)
+ * generating the duty cycle of the motor. The velocity and acceleration of the setpoint are fed forward through
+ * the motor model (steady-state speed at full duty and time constant), so that the feedback terms only have to
+ * correct deviations from the model. The velocity loop gains are normalized to the motor gain, i.e. they are
+ * dimensionless (P) or in 1/s (I) and s (D) and do not depend on the units of the axis.
+ * Both integrators are protected against windup by conditional integration: they are frozen while the respective
+ * output is saturated and the error would drive it further into saturation. Saturation of the velocity loop
+ * includes the ramp limitation of the {@link MotorDriver}, since the duty cycle actually applied is compared with the command.
+ * Alternatively, the servo follows a planned {@link SCurveProfile}, which is evaluated in every control cycle.
+ * After the end of the profile the servo holds its target position.
+ * The servo is engaged by supplying a setpoint or a trajectory and stays engaged until {@link AxisServo::disengage} is called.
+ * While disengaged, the servo keeps feeding the estimator but does not command the motor, so that it may be driven manually.
+ * All positions are in the units of the estimator, i.e. encoder revolutions.
+ * @note The servo is the only thread updating the estimator. It must be destroyed before the encoder, estimator and motor driver.
+ * @author HG Zaunick
+ */
+class AxisServo {
+public:
+	struct Config {
+		double rate { 200. }; ///< loop rate in Hz, clamped to {@link SERVO_MIN_RATE}...{@link SERVO_MAX_RATE}
+		double positionKp { 2. }; ///< proportional gain of the position loop in 1/s
+		double positionKi { 0. }; ///< integral gain of the position loop in 1/s^2
+		double velocityKp { 2. }; ///< proportional gain of the velocity loop (normalized to the motor gain)
+		double velocityKi { 4. }; ///< integral gain of the velocity loop in 1/s (normalized to the motor gain)
+		double velocityKd { 0. }; ///< derivative gain of the velocity loop in s (normalized to the motor gain)
+		double motorGain { 0. }; ///< steady-state speed at full duty cycle in rev/s (sign according to the motor direction), the servo does not engage while 0
+		double motorTau { 0. }; ///< time constant of the motor in s for the acceleration feed-forward
+		double maxVelocity { 0. }; ///< limit of the velocity command in rev/s, 0 limits to the motor gain
+		double deadband { 0. }; ///< minimum duty cycle (0...1) at which the motor starts to move, added to every non-zero output
+		double tolerance { 0. }; ///< position tolerance in rev, within which the motor is stopped while the setpoint is at rest
+	};
+
+	/**
+	 * @brief Target trajectory of the axis.
+	 * The servo extrapolates the setpoint to the instant of each control cycle with constant acceleration.
+	 */
+	struct Setpoint {
+		std::chrono::steady_clock::time_point time { }; ///< time of validity
+		double position { 0. }; ///< target position in rev
+		double velocity { 0. }; ///< target velocity in rev/s
+		double acceleration { 0. }; ///< target acceleration in rev/s^2
+	};
+
+	struct State {
+		std::chrono::steady_clock::time_point time { }; ///< time of the last control cycle
+		double setpoint { 0. }; ///< setpoint position extrapolated to the control cycle in rev
+		double position { 0. }; ///< estimated position in rev
+		double velocity { 0. }; ///< estimated velocity in rev/s
+		double positionError { 0. }; ///< setpoint minus estimated position in rev
+		double velocityCommand { 0. }; ///< output of the position loop in rev/s
+		double output { 0. }; ///< duty cycle commanded to the motor (-1...1)
+		bool saturated { false }; ///< true if the output was limited in the last cycle
+		bool engaged { false }; ///< true while the servo controls the motor
+		bool trajectory { false }; ///< true while the servo follows a trajectory
+	};
+
+	AxisServo() = delete;
+	/**
+	 * @brief The main constructor.
+	 * Starts the servo thread in disengaged state. The estimator is fed from the current head of the encoder's sample buffer on.
+	 * @param encoder the position encoder of the axis
+	 * @param estimator the state estimator of the axis, updated exclusively by the servo from now on
+	 * @param motor the motor driver of the axis
+	 * @note The servo runs with the default {@link AxisServo::Config}, until it is configured with {@link AxisServo::setConfig}.
+	 */
+	AxisServo(SsiPosEncoder& encoder, AxisEstimator& estimator, MotorDriver& motor);
+	~AxisServo();
+
+	void setConfig(const Config& config);
+	[[nodiscard]] auto config() const -> Config;
+	/**
+	 * @brief Set a new target trajectory.
+	 * Engages the servo, if it was disengaged.
+	 * @return false if the servo can not engage since the motor gain is not configured
+	 */
+	auto setSetpoint(const Setpoint& setpoint) -> bool;
+	/**
+	 * @brief Follow a planned trajectory.
+	 * Replaces the current setpoint and engages the servo, if it was disengaged. A later call of
+	 * {@link AxisServo::setSetpoint} aborts the trajectory.
+	 * @param profile the motion profile in rev
+	 * @param start the instant corresponding to the beginning of the profile
+	 * @return false if the servo can not engage since the motor gain is not configured
+	 */
+	auto setTrajectory(const SCurveProfile& profile, std::chrono::steady_clock::time_point start) -> bool;
+	[[nodiscard]] auto isFollowingTrajectory() const -> bool { return fFollowTrajectory; }
+	/// stop the motor and release it for manual operation
+	void disengage();
+	[[nodiscard]] auto isEngaged() const -> bool { return fEngaged; }
+	[[nodiscard]] auto state() const -> State;
+	[[nodiscard]] auto loopStatistics() const -> LoopTimer::Statistics { return fLoopTimer.statistics(); }
+	/// distribution of the wake-up latency of the control loop in us
+	[[nodiscard]] auto loopLatency() const -> const LoopTimer::LatencyHistogram& { return fLoopTimer.latency(); }
+	void clearLoopLatency() { fLoopTimer.clearLatency(); }
+	/// apply scheduling policy and CPU affinity to the control loop thread
+	auto setThreadPolicy(const ThreadPolicy& policy) -> bool { return applyThreadPolicy(fThread.get(), policy); }
+
+private:
+	void threadLoop();
+	void updateEstimator();
+	void control(std::chrono::steady_clock::time_point now);
+	void resetIntegrators();
+
+	SsiPosEncoder& fEncoder;
+	AxisEstimator& fEstimator;
+	MotorDriver& fMotor;
+	std::uint64_t fSampleCursor { 0 };
+
+	Config fConfig { };
+	Setpoint fSetpoint { };
+	SCurveProfile fTrajectory { };
+	std::chrono::steady_clock::time_point fTrajectoryStart { };
+	State fState { };
+	double fPositionIntegral { 0. };
+	double fVelocityIntegral { 0. };
+	std::atomic<bool> fEngaged { false };
+	std::atomic<bool> fFollowTrajectory { false };
+	std::atomic<bool> fActiveLoop { false };
+	mutable std::mutex fMutex;
+
+	LoopTimer fLoopTimer;
+	std::unique_ptr<std::thread> fThread { nullptr };
+};
+
+} // namespace PiRaTe
+
+#endif // AXIS_SERVO_H
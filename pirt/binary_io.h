@@ -0,0 +1,74 @@
+#ifndef BINARY_IO_H
+#define BINARY_IO_H
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <iostream>
+#include <type_traits>
+
+namespace PiRaTe {
+
+/**
+ * @brief Helpers for the little-endian serialization of the binary data files written by the driver.
+ */
+namespace BinaryIo {
+
+template <typename T>
+void writeLe(std::ostream& out, T value)
+{
+	static_assert(std::is_integral<T>::value, "little-endian serialization of integral types only");
+	for (std::size_t i = 0; i < sizeof(T); i++) {
+		out.put( static_cast<char>( ( static_cast<std::uint64_t>(value) >> (8 * i) ) & 0xff ) );
+	}
+}
+
+template <typename T>
+auto readLe(std::istream& in, T& value) -> bool
+{
+	static_assert(std::is_integral<T>::value, "little-endian serialization of integral types only");
+	std::uint64_t result { 0 };
+	for (std::size_t i = 0; i < sizeof(T); i++) {
+		const int c { in.get() };
+		if ( c == std::char_traits<char>::eof() ) return false;
+		result |= static_cast<std::uint64_t>( static_cast<unsigned char>(c) ) << (8 * i);
+	}
+	value = static_cast<T>(result);
+	return true;
+}
+
+inline void writeFloat(std::ostream& out, float value)
+{
+	std::uint32_t bits { 0 };
+	std::memcpy( &bits, &value, sizeof(bits) );
+	writeLe(out, bits);
+}
+
+inline auto readFloat(std::istream& in, float& value) -> bool
+{
+	std::uint32_t bits { 0 };
+	if ( !readLe(in, bits) ) return false;
+	std::memcpy( &value, &bits, sizeof(value) );
+	return true;
+}
+
+inline void writeString(std::ostream& out, const std::string& str)
+{
+	writeLe( out, static_cast<std::uint32_t>( str.size() ) );
+	out.write( str.data(), static_cast<std::streamsize>( str.size() ) );
+}
+
+/// read a length-prefixed string of at most maxLength characters
+inline auto readString(std::istream& in, std::string& str, std::uint32_t maxLength) -> bool
+{
+	std::uint32_t length { 0 };
+	if ( !readLe(in, length) || length > maxLength ) return false;
+	str.resize(length);
+	in.read( &str[0], length );
+	return static_cast<bool>(in);
+}
+
+} // namespace BinaryIo
+} // namespace PiRaTe
+
+#endif // BINARY_IO_H
@@ -4,6 +4,7 @@
 #include <string>
 #include <chrono>
 #include <memory>
+#include <algorithm>
 
 #include "gpioif.h"
 #include "encoder.h"
@@ -13,7 +14,6 @@
 namespace PiRaTe {
 
 unsigned int SsiPosEncoder::fNrInstances = 0;
-constexpr std::chrono::milliseconds loop_delay { 50 };
 constexpr double MAX_TURNS_PER_SECOND { 10. };
 
 template <typename T> constexpr int sgn(T val) {
@@ -29,15 +29,6 @@ auto SsiPosEncoder::intToBinaryString(unsigned long number) -> std::string
   return numStr;
 }
 
-auto SsiPosEncoder::gray_decode(std::uint32_t g) -> std::uint32_t
-{
-    for (std::uint32_t bit = 1U << 31; bit > 1; bit >>= 1)
-    {
-        if (g & bit) g ^= bit >> 1;
-    }
-    return g;
-}
-
 SsiPosEncoder::SsiPosEncoder(std::shared_ptr<GPIO> gpio, GPIO::SPI_INTERFACE spi_interface, unsigned int baudrate, std::uint8_t spi_channel,  GPIO::SPI_MODE spi_mode)
 	: fGpio { gpio }
 {
@@ -53,6 +44,33 @@ SsiPosEncoder::SsiPosEncoder(std::shared_ptr<GPIO> gpio, GPIO::SPI_INTERFACE spi
 		throw std::exception();
 	}
 
+	startReadLoop();
+	fNrInstances++;
+}
+
+SsiPosEncoder::SsiPosEncoder(std::shared_ptr<SpiDev> spidev)
+	: fSpiDev { spidev }
+{
+	if (fSpiDev == nullptr || !fSpiDev->isInitialized()) {
+		std::cerr<<"Error: no valid spidev instance.\n";
+		throw std::exception();
+	}
+	startReadLoop();
+	fNrInstances++;
+}
+
+SsiPosEncoder::~SsiPosEncoder()
+{
+  stopReadLoop();
+  fNrInstances--;
+  // close SPI device, a spidev transport is closed by its owner
+  if ( fSpiHandle>=0 && fGpio != nullptr ) fGpio->spi_close(fSpiHandle);
+}
+
+
+void SsiPosEncoder::startReadLoop()
+{
+	if (fThread != nullptr) return;
 	fActiveLoop=true;
 // since C++14 using std::make_unique
 	// fThread = std::make_unique<std::thread>( [this]() { this->readLoop(); } );
@@ -61,120 +79,147 @@ SsiPosEncoder::SsiPosEncoder(std::shared_ptr<GPIO> gpio, GPIO::SPI_INTERFACE spi
 	//fThread = std::move(thread);
 // or with the reset method of smart pointers
 	fThread.reset( new std::thread( [this]() { this->readLoop(); } ));
-	fNrInstances++;
+	if ( fThreadPolicy.scheduling != ThreadPolicy::Scheduling::Normal || fThreadPolicy.cpu >= 0 ) {
+		applyThreadPolicy(fThread.get(), fThreadPolicy);
+	}
 }
 
-SsiPosEncoder::~SsiPosEncoder()
+void SsiPosEncoder::stopReadLoop()
 {
-  fActiveLoop = false;
-  if (fThread!=nullptr) fThread->join();
-  fNrInstances--;
-  // close SPI device
-  if ( fSpiHandle>=0 && fGpio != nullptr ) fGpio->spi_close(fSpiHandle);
+	fActiveLoop = false;
+	if (fThread!=nullptr) fThread->join();
+	fThread.reset();
 }
 
+auto SsiPosEncoder::setThreadPolicy(const ThreadPolicy& policy) -> bool
+{
+	fThreadPolicy = policy;
+	// while grouped, the read-out thread is stopped and the policy is applied on restart
+	if (fThread == nullptr) return true;
+	return applyThreadPolicy(fThread.get(), policy);
+}
 
 // this is the background thread loop
 void SsiPosEncoder::readLoop()
 {
-	bool errorFlag { true };
-	auto lastReadOutTime = std::chrono::system_clock::now();
+	fErrorFlag = true;
+	fLoopTimer.reset();
 	while (fActiveLoop) {
+		// sleep until the next absolute read-out deadline
+		fLoopTimer.wait();
 		std::uint32_t data { 0 };
-		auto currentReadOutTime = std::chrono::system_clock::now();
+		auto startReadOutTime = std::chrono::steady_clock::now();
 		bool ok = readDataWord(data);
-		if (!ok) {
-			errorFlag = true;
-			if (fConErrorCountdown) fConErrorCountdown--;
-		} else {
-			auto readOutDuration { std::chrono::system_clock::now() - std::chrono::system_clock::time_point { currentReadOutTime } };
-			fConErrorCountdown++;
-			// check if MSB is 1
-			// this should always be the case
-			// comment out, if your encoder behaves differently
-			if ( !(data & (1<<31)) ) {
-				fBitErrors++;
-				errorFlag = true;
-				lastReadOutTime = currentReadOutTime;
-				std::this_thread::sleep_for(loop_delay);
-				continue;
-			}
-//			std::cout<<" raw: "<<intToBinaryString(data)<<"\n";
-			std::uint32_t temp = data >> (32 - fStBits - fMtBits - 1);
-			temp &= (1 << (fStBits + fMtBits - 1))-1;
-			temp = gray_decode(temp);
-			std::uint32_t st = temp & ((1 << (fStBits)) - 1);
-//			std::cout<<" st: "<<intToBinaryString(st)<<"\n";
-			
-			std::int32_t mt = (temp >> fStBits) & ((1 << (fMtBits)) - 1);
-//			std::cout<<" mt: "<<intToBinaryString(mt)<<"\n";
-			
-			// add sign bit to MT value
-			// negative counts have to be offset by -1. Otherwise one had to 
-			// distinguish between -0 and +0 rotations
-			if ( data & (1<<30) ) mt = -mt-1;
-			//std::cout<<" MT="<<mt;
-			
-			if (errorFlag) {
-				fLastPos=st; fLastTurns=mt;
-				lastReadOutTime = currentReadOutTime;
-				std::this_thread::sleep_for(loop_delay);
-				errorFlag=false;
-				continue;
-			}
-			
-			int turnDiff = mt - fLastTurns;
-			if ( std::abs(turnDiff) > 1 ) 
-			{
-				//std::cout<<" st diff: "<<posDiff<<"\n";
-				fBitErrors++;
-				errorFlag = true;
-				lastReadOutTime = currentReadOutTime;
-				std::this_thread::sleep_for(loop_delay);
-				continue;
-			}
+		auto readOutDuration { std::chrono::steady_clock::now() - startReadOutTime };
+		// time stamp the sample at the middle of the transfer
+		processDataWord(ok, data, startReadOutTime + readOutDuration / 2, readOutDuration);
+	}
+}
 
-			int posDiff = st - fLastPos;
-			
-			if (std::abs(posDiff) > ( 1 << ( fStBits-1 ) ) ) {
-				posDiff -= sgn(posDiff) * ( 1 << ( fStBits ) );
-			}
-			double speed = static_cast<double>(posDiff) / (1<<fStBits);
-			auto diffTime { currentReadOutTime - lastReadOutTime };
-			
-			speed *= 1000./std::chrono::duration_cast<std::chrono::milliseconds>(diffTime).count();
-			if ( std::abs(speed) > MAX_TURNS_PER_SECOND ) {
-				fBitErrors++;
-				errorFlag = true;
-				lastReadOutTime = currentReadOutTime;
-				std::this_thread::sleep_for(loop_delay);
-				continue;
-			}
-			
-			speed *= 360.;
-			
-			fLastPos=st; fLastTurns=mt;
-						
-			fMutex.lock();
-			fPos = st;
-			fTurns = mt;
-			fCurrentSpeed = speed;
-			fUpdated = true;
-			fReadOutDuration = std::chrono::duration_cast<std::chrono::microseconds>(readOutDuration);
-			fMutex.unlock();
-			lastReadOutTime = currentReadOutTime;
-		}
-		if (fConErrorCountdown > MAX_CONN_ERRORS) fConErrorCountdown = MAX_CONN_ERRORS;
-		std::this_thread::sleep_for(loop_delay);
+void SsiPosEncoder::processDataWord(bool ok, std::uint32_t data, std::chrono::steady_clock::time_point time, std::chrono::steady_clock::duration readOutDuration)
+{
+	Sample sample { };
+	sample.time = time;
+	auto currentReadOutTime = sample.time;
+	if (!ok) {
+		fErrorFlag = true;
+		if (fConErrorCountdown) fConErrorCountdown--;
+		sample.flags = SAMPLE_READ_ERROR;
+		fSamples.push(sample);
+		return;
+	}
+	if (fConErrorCountdown < MAX_CONN_ERRORS) fConErrorCountdown++;
+	fLatency.fill( std::chrono::duration<double, std::micro>(readOutDuration).count() );
+	const std::uint16_t bitWidths { fBitWidths };
+	const std::uint8_t stBits { static_cast<std::uint8_t>( bitWidths >> 8 ) };
+	const std::uint8_t mtBits { static_cast<std::uint8_t>( bitWidths & 0xff ) };
+	// check if MSB is 1
+	// this should always be the case
+	// comment out, if your encoder behaves differently
+	// also reject bit width settings for which the frame does not fit into the data word
+	if ( !(data & (1U<<31)) || stBits == 0 || stBits + mtBits > 31 ) {
+		fBitErrors++;
+		fErrorFlag = true;
+		fLastReadOutTime = currentReadOutTime;
+		sample.flags = SAMPLE_FRAME_ERROR;
+		fSamples.push(sample);
+		return;
+	}
+//	std::cout<<" raw: "<<intToBinaryString(data)<<"\n";
+	const SsiFrame frame { decodeSsiFrame(data, stBits, mtBits) };
+	const std::uint32_t st { frame.st };
+	const std::int32_t mt { frame.mt };
+//	std::cout<<" st: "<<intToBinaryString(st)<<" mt: "<<intToBinaryString(mt)<<"\n";
+	sample.st = st;
+	sample.mt = mt;
+	sample.position = toRevolutions(st, mt, stBits);
+	
+	if (fErrorFlag) {
+		fLastPos=st; fLastTurns=mt;
+		fLastReadOutTime = currentReadOutTime;
+		sample.flags = SAMPLE_RESYNC;
+		fSamples.push(sample);
+		fErrorFlag=false;
+		return;
 	}
+	
+	int turnDiff = mt - fLastTurns;
+	if ( std::abs(turnDiff) > 1 ) 
+	{
+		//std::cout<<" st diff: "<<posDiff<<"\n";
+		fBitErrors++;
+		fErrorFlag = true;
+		fLastReadOutTime = currentReadOutTime;
+		sample.flags = SAMPLE_TURN_ERROR;
+		fSamples.push(sample);
+		return;
+	}
+
+	int posDiff = st - fLastPos;
+	
+	if (std::abs(posDiff) > ( 1 << ( stBits-1 ) ) ) {
+		posDiff -= sgn(posDiff) * ( 1 << ( stBits ) );
+	}
+	double speed = static_cast<double>(posDiff) / (1<<stBits);
+	// use the full time resolution here, at high sampling rates
+	// the interval is in the order of a millisecond
+	const double diffTime { std::chrono::duration<double>( currentReadOutTime - fLastReadOutTime ).count() };
+	if ( diffTime > 0. ) speed /= diffTime;
+	if ( std::abs(speed) > MAX_TURNS_PER_SECOND ) {
+		fBitErrors++;
+		fErrorFlag = true;
+		fLastReadOutTime = currentReadOutTime;
+		sample.flags = SAMPLE_SPEED_ERROR;
+		fSamples.push(sample);
+		return;
+	}
+	
+	speed *= 360.;
+	
+	fLastPos=st; fLastTurns=mt;
+	
+	fSamples.push(sample);
+	fCurrentSpeed = speed;
+	fReadOutDuration = std::chrono::duration_cast<std::chrono::microseconds>(readOutDuration);
+	fUpdated = true;
+	fLastReadOutTime = currentReadOutTime;
 }
 
 
 auto SsiPosEncoder::readDataWord(std::uint32_t& data) -> bool
 {
-	if (fSpiHandle < 0 || fGpio == nullptr) return false;
 	constexpr unsigned int nBytes = 4;
+	if (fSpiDev != nullptr) {
+		return toDataWord(fSpiDev->read(nBytes), data);
+	}
+	if (fSpiHandle < 0 || fGpio == nullptr) return false;
 	std::vector<std::uint8_t> bytevec = fGpio->spi_read(fSpiHandle, nBytes);
+	return toDataWord(bytevec, data);
+}
+
+auto SsiPosEncoder::toDataWord(const std::vector<std::uint8_t>& bytevec, std::uint32_t& data) -> bool
+{
+	constexpr unsigned int nBytes = 4;
 	if (bytevec.size() != nBytes) {
 		std::cout<<"error reading correct number of bytes from encoder.\n";
 		return false;
@@ -184,19 +229,216 @@ auto SsiPosEncoder::readDataWord(std::uint32_t& data) -> bool
 }
 
 
-auto SsiPosEncoder::absolutePosition() -> double {
-	fUpdated=false; 
-	double pos = static_cast<double>( fPos ) / ( 1<<fStBits );
-	if ( fTurns < 0 ) {
+void SsiPosEncoder::setStBitWidth(std::uint8_t st_bits)
+{
+	std::uint16_t widths { fBitWidths };
+	while ( !fBitWidths.compare_exchange_weak( widths, static_cast<std::uint16_t>( (st_bits << 8) | (widths & 0xff) ) ) ) { }
+}
+
+void SsiPosEncoder::setMtBitWidth(std::uint8_t mt_bits)
+{
+	std::uint16_t widths { fBitWidths };
+	while ( !fBitWidths.compare_exchange_weak( widths, static_cast<std::uint16_t>( (widths & 0xff00) | mt_bits ) ) ) { }
+}
+
+auto SsiPosEncoder::toRevolutions(std::uint32_t st, std::int32_t mt, std::uint8_t st_bits) -> double
+{
+	double pos = static_cast<double>( st ) / ( 1<<st_bits );
+	if ( mt < 0 ) {
 		pos = 1. - pos;
 	}
-	pos += static_cast<double>( fTurns );
+	pos += static_cast<double>( mt );
 	return pos;
 }
 
+auto SsiPosEncoder::latestSample(Sample& sample) const -> bool
+{
+	// walk backwards from the newest entry until a valid sample is found
+	const std::uint64_t head { fSamples.head() };
+	const std::uint64_t tail { ( head > SampleBuffer::capacity() ) ? head - SampleBuffer::capacity() : 0 };
+	for ( std::uint64_t index = head; index > tail; index-- ) {
+		if ( fSamples.read(index - 1, sample) && sample.valid() ) return true;
+	}
+	return false;
+}
+
+auto SsiPosEncoder::samplesSince(std::uint64_t& cursor, std::vector<Sample>& samples) const -> std::size_t
+{
+	return fSamples.readSince(cursor, samples);
+}
+
+auto SsiPosEncoder::positionAt(std::chrono::steady_clock::time_point time, double& position, std::chrono::steady_clock::duration maxExtrapolation) const -> bool
+{
+	const std::uint64_t head { fSamples.head() };
+	const std::uint64_t tail { ( head > SampleBuffer::capacity() ) ? head - SampleBuffer::capacity() : 0 };
+	Sample later { };
+	bool haveLater { false };
+	Sample newest { };
+	bool haveNewest { false };
+	Sample sample { };
+	for ( std::uint64_t index = head; index > tail; index-- ) {
+		if ( !fSamples.read(index - 1, sample) || !sample.valid() ) continue;
+		if ( haveNewest ) {
+			// extrapolate linearly from the two most recent valid samples
+			const double span { std::chrono::duration<double>( newest.time - sample.time ).count() };
+			const double dt { std::chrono::duration<double>( time - newest.time ).count() };
+			position = newest.position + ( (span > 0.) ? dt / span * ( newest.position - sample.position ) : 0. );
+			return true;
+		}
+		if ( sample.time > time ) {
+			later = sample;
+			haveLater = true;
+			continue;
+		}
+		if ( !haveLater ) {
+			// requested time is newer than the newest sample
+			if ( sample.time == time ) {
+				position = sample.position;
+				return true;
+			}
+			if ( time - sample.time > maxExtrapolation ) return false;
+			newest = sample;
+			haveNewest = true;
+			continue;
+		}
+		const double span { std::chrono::duration<double>( later.time - sample.time ).count() };
+		const double frac { std::chrono::duration<double>( time - sample.time ).count() / span };
+		position = sample.position + frac * ( later.position - sample.position );
+		return true;
+	}
+	if ( haveNewest ) {
+		// only a single valid sample available
+		position = newest.position;
+		return true;
+	}
+	return false;
+}
+
+auto SsiPosEncoder::position() -> unsigned int
+{
+	fUpdated = false;
+	Sample sample { };
+	if ( !latestSample(sample) ) return 0;
+	return sample.st;
+}
+
+auto SsiPosEncoder::nrTurns() -> int
+{
+	fUpdated = false;
+	Sample sample { };
+	if ( !latestSample(sample) ) return 0;
+	return sample.mt;
+}
+
+auto SsiPosEncoder::absolutePosition() -> double {
+	fUpdated = false; 
+	Sample sample { };
+	if ( !latestSample(sample) ) return 0.;
+	return sample.position;
+}
+
+void SsiPosEncoder::setSampleRate(double rate)
+{
+	rate = std::min( std::max( rate, 1. ), MAX_SAMPLE_RATE );
+	fLoopTimer.setPeriod( std::chrono::microseconds( static_cast<long>( 1e6 / rate ) ) );
+}
+
+auto SsiPosEncoder::sampleRate() const -> double
+{
+	return 1e6 / fLoopTimer.period().count();
+}
+
 auto SsiPosEncoder::statusOk() const -> bool {
-	if (!fActiveLoop) return false;
+	if (!fActiveLoop && !fGrouped) return false;
 	return (fConErrorCountdown>0);
 }
 
+
+SsiEncoderGroup::SsiEncoderGroup(std::vector<SsiPosEncoder*> encoders, double rate)
+	: fEncoders { std::move(encoders) }
+{
+	if (fEncoders.empty()) {
+		std::cerr<<"Error: no encoders supplied for group read-out.\n";
+		throw std::exception();
+	}
+	for ( auto encoder: fEncoders ) {
+		if ( encoder == nullptr || !encoder->isInitialized() || encoder->isGrouped() ) {
+			std::cerr<<"Error: invalid encoder supplied for group read-out.\n";
+			throw std::exception();
+		}
+	}
+	fGpio = fEncoders.front()->fGpio;
+	fCommonGpio = (fGpio != nullptr) && std::all_of( fEncoders.begin(), fEncoders.end(), [this](const SsiPosEncoder* encoder) { return encoder->fGpio == fGpio; } );
+	for ( auto encoder: fEncoders ) {
+		// take over the read-out from the encoder's own thread
+		encoder->stopReadLoop();
+		encoder->fErrorFlag = true;
+		encoder->fGrouped = true;
+		fSpiHandles.push_back( static_cast<unsigned int>( encoder->fSpiHandle ) );
+	}
+	setSampleRate(rate);
+	fActiveLoop = true;
+	fThread.reset( new std::thread( [this]() { this->readLoop(); } ));
+}
+
+SsiEncoderGroup::~SsiEncoderGroup()
+{
+	fActiveLoop = false;
+	if (fThread!=nullptr) fThread->join();
+	// hand the read-out back to the encoders
+	for ( auto encoder: fEncoders ) {
+		encoder->fGrouped = false;
+		encoder->fErrorFlag = true;
+		encoder->startReadLoop();
+	}
+}
+
+void SsiEncoderGroup::setSampleRate(double rate)
+{
+	rate = std::min( std::max( rate, 1. ), MAX_SAMPLE_RATE );
+	fLoopTimer.setPeriod( std::chrono::microseconds( static_cast<long>( 1e6 / rate ) ) );
+}
+
+auto SsiEncoderGroup::sampleRate() const -> double
+{
+	return 1e6 / fLoopTimer.period().count();
+}
+
+// this is the background thread loop
+void SsiEncoderGroup::readLoop()
+{
+	constexpr unsigned int nBytes = 4;
+	std::vector<std::uint32_t> data( fEncoders.size(), 0 );
+	std::vector<bool> ok( fEncoders.size(), false );
+	std::vector<std::chrono::steady_clock::duration> durations( fEncoders.size() );
+	fLoopTimer.reset();
+	while (fActiveLoop) {
+		fLoopTimer.wait();
+		auto startReadOutTime = std::chrono::steady_clock::now();
+		if ( fCommonGpio ) {
+			// one batched request for all encoders
+			const std::vector<std::vector<std::uint8_t>> words { fGpio->spi_read_multi(fSpiHandles, nBytes) };
+			for ( std::size_t i = 0; i < fEncoders.size(); i++ ) {
+				ok[i] = SsiPosEncoder::toDataWord(words[i], data[i]);
+			}
+		} else {
+			for ( std::size_t i = 0; i < fEncoders.size(); i++ ) {
+				const auto start { std::chrono::steady_clock::now() };
+				std::uint32_t word { 0 };
+				ok[i] = fEncoders[i]->readDataWord(word);
+				data[i] = word;
+				durations[i] = std::chrono::steady_clock::now() - start;
+			}
+		}
+		auto readOutDuration { std::chrono::steady_clock::now() - startReadOutTime };
+		fReadOutDuration = std::chrono::duration_cast<std::chrono::microseconds>(readOutDuration);
+		// all samples of this cycle share the same time stamp
+		const auto time { startReadOutTime + readOutDuration / 2 };
+		for ( std::size_t i = 0; i < fEncoders.size(); i++ ) {
+			// attribute the individual transfer time to each encoder if the reads were separate
+			fEncoders[i]->processDataWord(ok[i], data[i], time, fCommonGpio ? readOutDuration : durations[i]);
+		}
+	}
+}
+
 } // namespace PiRaTe
@@ -14,8 +14,15 @@
 #include <queue>
 #include <list>
 #include <mutex>
+#include <atomic>
+#include <chrono>
 
 #include "gpioif.h"
+#include "spidev.h"
+#include "utility.h"
+#include "loop_timer.h"
+#include "thread_policy.h"
+#include "ssi_decoder.h"
 
 //namespace {
 //	class GPIO;
@@ -23,20 +30,67 @@
 
 namespace PiRaTe {
 
+class SsiEncoderGroup;
+
 constexpr unsigned int SPI_BAUD_DEFAULT { 500000U };
 constexpr unsigned int MAX_CONN_ERRORS { 10U };
+constexpr std::size_t ENCODER_SAMPLE_BUFFER_DEPTH { 4096 };
+constexpr double DEFAULT_SAMPLE_RATE { 20. }; ///< default encoder read-out rate in Hz
+constexpr double MAX_SAMPLE_RATE { 1000. }; ///< maximum encoder read-out rate in Hz
+constexpr std::size_t LATENCY_HISTOGRAM_BINS { 1000 };
+constexpr double LATENCY_HISTOGRAM_RANGE { 5000. }; ///< upper limit of the read-out latency histogram in us
 
 
 /**
  * @brief Interface class for reading out SSI-interface based positional encoders.
  * This class manages the read-out of absolute position encoders connected to the SPI interface.
  * The interface to be utilized is set in the constructor call together with baud rate and SPI mode settings. 
+ * The data words are transferred either through the pigpiod daemon ({@link GPIO}) or directly through the
+ * kernel's spidev driver ({@link SpiDev}), depending on the constructor used.
  * The absolute position is obtained with {@link SsiPosEncoder::absolutePosition} with the return value in evolutions.
- * @note The class launches a separate thread loop upon successfull construction which reads the encoder's data word every 10 ms.
+ * Every read-out is stored as {@link SsiPosEncoder::Sample} in a lock-free ring buffer, so that consumers can
+ * fetch the complete sample history with {@link SsiPosEncoder::samplesSince} or obtain the position at an arbitrary
+ * instant with {@link SsiPosEncoder::positionAt} without contending with the read-out thread.
+ * @note The class launches a separate thread loop upon successfull construction which reads the encoder's data word
+ * at a configurable rate (default 20 Hz, max. 1 kHz) driven by absolute deadlines, see {@link SsiPosEncoder::setSampleRate}.
  * @author HG Zaunick
  */
 class SsiPosEncoder {
   public:
+	/**
+	 * @brief Error flags attached to each encoder sample.
+	 */
+	enum SampleFlags : std::uint8_t {
+		SAMPLE_OK = 0x00,
+		SAMPLE_READ_ERROR = 0x01, ///< the SPI transfer failed
+		SAMPLE_FRAME_ERROR = 0x02, ///< the data word did not start with the mandatory MSB
+		SAMPLE_TURN_ERROR = 0x04, ///< implausible jump of the multi-turn counter
+		SAMPLE_SPEED_ERROR = 0x08, ///< implausible angular speed with respect to the previous sample
+		SAMPLE_RESYNC = 0x10 ///< first valid word after an error, no speed information available
+	};
+
+	/**
+	 * @brief A single encoder read-out.
+	 */
+	struct Sample {
+		std::chrono::steady_clock::time_point time { }; ///< time stamp at the middle of the SPI transfer
+		std::uint32_t st { 0 }; ///< single-turn value
+		std::int32_t mt { 0 }; ///< multi-turn value
+		double position { 0. }; ///< absolute position in revolutions
+		std::uint8_t flags { SAMPLE_OK }; ///< combination of {@link SsiPosEncoder::SampleFlags}
+		[[nodiscard]] auto valid() const -> bool { return ( (flags & ~SAMPLE_RESYNC) == SAMPLE_OK ); }
+	};
+	using SampleBuffer = SampleRing<Sample, ENCODER_SAMPLE_BUFFER_DEPTH>;
+	using LatencyHistogram = Histogram<LATENCY_HISTOGRAM_BINS>;
+
+	/**
+	 * @brief The transport used for the SPI transfers.
+	 */
+	enum class Transport {
+		Pigpiod, ///< SPI access via the pigpiod daemon
+		SpiDev ///< direct SPI access via the spidev kernel driver
+	};
+
     SsiPosEncoder()=delete;
 	/**
 	 * @brief The main constructor.
@@ -53,48 +107,173 @@ class SsiPosEncoder {
 				  unsigned int baudrate = SPI_BAUD_DEFAULT,
 				  std::uint8_t spi_channel = 0,  
 				  GPIO::SPI_MODE spi_mode = GPIO::SPI_MODE::POL1PHA1);
+	/**
+	 * @brief Constructor for the spidev transport.
+	 * Initializes an object which reads the encoder directly through the supplied spidev device.
+	 * @param spidev shared pointer to an initialized SpiDev object
+	 * @throws std::exception if the supplied spidev object is not initialized
+	 */
+	SsiPosEncoder(std::shared_ptr<SpiDev> spidev);
     ~SsiPosEncoder();
 
-    [[nodiscard]] auto isInitialized() const -> bool { return (fSpiHandle>=0); }
+    [[nodiscard]] auto isInitialized() const -> bool { return ( (fSpiHandle>=0) || (fSpiDev != nullptr && fSpiDev->isInitialized()) ); }
+	[[nodiscard]] auto transport() const -> Transport { return (fSpiDev != nullptr) ? Transport::SpiDev : Transport::Pigpiod; }
     
-    [[nodiscard]] auto position() -> unsigned int { fUpdated=false; return fPos; }
-    [[nodiscard]] auto nrTurns() -> int { fUpdated=false; return fTurns; }
+    [[nodiscard]] auto position() -> unsigned int;
+    [[nodiscard]] auto nrTurns() -> int;
     [[nodiscard]] auto absolutePosition() -> double;
     
     [[nodiscard]] auto isUpdated() const -> bool { return fUpdated; }
-    void setStBitWidth(std::uint8_t st_bits) { fStBits = st_bits; }
-    void setMtBitWidth(std::uint8_t mt_bits) { fMtBits = mt_bits; }
+    void setStBitWidth(std::uint8_t st_bits);
+    void setMtBitWidth(std::uint8_t mt_bits);
     [[nodiscard]] auto bitErrorCount() const -> unsigned long { return fBitErrors; }
     [[nodiscard]] auto currentSpeed() const -> double { return fCurrentSpeed; }
     [[nodiscard]] auto lastReadOutDuration() const -> std::chrono::duration<int, std::micro> { return fReadOutDuration; }
+	/**
+	 * @brief Distribution of the read-out latency.
+	 * The duration of every successful transfer is filled in us into the histogram.
+	 */
+	[[nodiscard]] auto readOutLatency() const -> const LatencyHistogram& { return fLatency; }
+	void clearReadOutLatency() { fLatency.clear(); }
     [[nodiscard]] auto statusOk() const -> bool;
+	/**
+	 * @brief Set the target read-out rate.
+	 * @param rate the sampling rate in Hz, clamped to the range 1 Hz...{@link MAX_SAMPLE_RATE}
+	 */
+	void setSampleRate(double rate);
+	[[nodiscard]] auto sampleRate() const -> double;
+	/**
+	 * @brief Timing statistics of the read-out loop.
+	 * @return the achieved sampling rate, rms and max wake-up jitter and the total number of overruns
+	 */
+	[[nodiscard]] auto loopStatistics() const -> LoopTimer::Statistics { return fLoopTimer.statistics(); }
+	/// distribution of the wake-up latency of the read-out loop in us
+	[[nodiscard]] auto loopLatency() const -> const LoopTimer::LatencyHistogram& { return fLoopTimer.latency(); }
+	void clearLoopLatency() { fLoopTimer.clearLatency(); }
+	/**
+	 * @brief Apply scheduling policy and CPU affinity to the read-out thread.
+	 * The policy is kept and applied again whenever the read-out thread is restarted,
+	 * e.g. after a synchronous group read-out ended.
+	 */
+	auto setThreadPolicy(const ThreadPolicy& policy) -> bool;
+
+	/**
+	 * @brief The most recent valid sample.
+	 * @param sample the sample which is filled upon success
+	 * @return false if no valid sample is available in the buffer
+	 */
+	[[nodiscard]] auto latestSample(Sample& sample) const -> bool;
+	/**
+	 * @brief Fetch all samples (valid and invalid) recorded since the given cursor.
+	 * The cursor is advanced to the sequence index of the next sample to come. Start with a cursor of 0 to
+	 * fetch the complete buffered history.
+	 * @param cursor the consumer's read position in the sample stream
+	 * @param samples vector to which the new samples are appended
+	 * @return the number of appended samples
+	 */
+	auto samplesSince(std::uint64_t& cursor, std::vector<Sample>& samples) const -> std::size_t;
+	/**
+	 * @brief Interpolate the absolute position at the given instant.
+	 * The position is linearly interpolated between the two valid samples enclosing the requested time.
+	 * Instants after the newest valid sample are extrapolated from the two newest valid samples, as long
+	 * as they are not more than maxExtrapolation ahead of the newest sample.
+	 * @param time the instant of interest
+	 * @param position the interpolated absolute position in revolutions
+	 * @param maxExtrapolation the maximum time span to extrapolate beyond the newest sample
+	 * @return false if the time is neither enclosed by buffered valid samples nor within the extrapolation range
+	 */
+	[[nodiscard]] auto positionAt(std::chrono::steady_clock::time_point time, double& position, std::chrono::steady_clock::duration maxExtrapolation = std::chrono::steady_clock::duration::zero()) const -> bool;
+	[[nodiscard]] auto sampleBuffer() const -> const SampleBuffer& { return fSamples; }
+	[[nodiscard]] static auto toRevolutions(std::uint32_t st, std::int32_t mt, std::uint8_t st_bits) -> double;
+	[[nodiscard]] auto isGrouped() const -> bool { return fGrouped; }
     
   private:
+	friend class SsiEncoderGroup;
+
     void readLoop();
+	void startReadLoop();
+	void stopReadLoop();
 	auto readDataWord(std::uint32_t& data) -> bool;
-	[[nodiscard]] auto gray_decode(std::uint32_t g) -> std::uint32_t;
+	[[nodiscard]] static auto toDataWord(const std::vector<std::uint8_t>& bytes, std::uint32_t& data) -> bool;
+	/**
+	 * @brief Decode and validate one data word and publish the resulting sample.
+	 * @param ok false if the transfer failed, the data word is ignored then
+	 * @param data the raw SSI data word
+	 * @param time the time stamp of the transfer
+	 * @param readOutDuration the duration of the transfer
+	 */
+	void processDataWord(bool ok, std::uint32_t data, std::chrono::steady_clock::time_point time, std::chrono::steady_clock::duration readOutDuration);
     [[nodiscard]] auto intToBinaryString(unsigned long number) -> std::string;
 
     int fSpiHandle { -1 };
-    std::uint8_t fStBits { 12 };
-    std::uint8_t fMtBits { 12 };
-    unsigned int fPos { 0 };
-    int fTurns { 0 };
+	/// ST bit width in the upper, MT bit width in the lower byte, so that the read thread always sees a consistent pair
+	std::atomic<std::uint16_t> fBitWidths { (12 << 8) | 12 };
 	unsigned int fLastPos { 0 };
 	unsigned int fLastTurns { 0 };
-	unsigned long fBitErrors { 0 };
-	double fCurrentSpeed { 0. };
-	std::chrono::duration<int, std::micro > fReadOutDuration { };
+	bool fErrorFlag { true };
+	std::chrono::steady_clock::time_point fLastReadOutTime { };
+	std::atomic<unsigned long> fBitErrors { 0 };
+	std::atomic<double> fCurrentSpeed { 0. };
+	std::atomic<std::chrono::duration<int, std::micro>> fReadOutDuration { std::chrono::duration<int, std::micro> { 0 } };
 	
-	bool fUpdated { false };
-    bool fActiveLoop { false };
-   	unsigned int fConErrorCountdown { MAX_CONN_ERRORS };
+	std::atomic<bool> fUpdated { false };
+    std::atomic<bool> fActiveLoop { false };
+	std::atomic<bool> fGrouped { false };
+	ThreadPolicy fThreadPolicy { };
+   	std::atomic<unsigned int> fConErrorCountdown { MAX_CONN_ERRORS };
 
     static unsigned int fNrInstances;
     std::unique_ptr<std::thread> fThread { nullptr };
 	std::shared_ptr<GPIO> fGpio { nullptr };
+	std::shared_ptr<SpiDev> fSpiDev { nullptr };
+
+	SampleBuffer fSamples { };
+	LatencyHistogram fLatency { 0., LATENCY_HISTOGRAM_RANGE };
+	LoopTimer fLoopTimer { std::chrono::microseconds( static_cast<long>( 1e6 / DEFAULT_SAMPLE_RATE ) ) };
+};
+
+/**
+ * @brief Synchronous read-out of several SSI encoders.
+ * The group takes over the read-out of the supplied encoders from their individual threads and reads all of
+ * them in a single thread. When all encoders share the same {@link GPIO} instance, the data words are
+ * fetched in one batched request ({@link GPIO::spi_read_multi}), otherwise (e.g. with the spidev transport)
+ * the encoders are read back-to-back. All samples of one cycle carry the same time stamp, so that
+ * e.g. Az/Alt pairs are time-coherent.
+ * On destruction, the encoders resume their individual read-out threads.
+ * @note The encoders must outlive the group object.
+ * @author HG Zaunick
+ */
+class SsiEncoderGroup {
+  public:
+	SsiEncoderGroup() = delete;
+	/**
+	 * @brief The main constructor.
+	 * @param encoders pointers to the initialized encoders which shall be read out synchronously
+	 * @param rate the read-out rate in Hz
+	 * @throws std::exception if the list is empty or contains uninitialized encoders
+	 */
+	SsiEncoderGroup(std::vector<SsiPosEncoder*> encoders, double rate = DEFAULT_SAMPLE_RATE);
+	~SsiEncoderGroup();
+
+	void setSampleRate(double rate);
+	[[nodiscard]] auto sampleRate() const -> double;
+	[[nodiscard]] auto loopStatistics() const -> LoopTimer::Statistics { return fLoopTimer.statistics(); }
+	[[nodiscard]] auto loopLatency() const -> const LoopTimer::LatencyHistogram& { return fLoopTimer.latency(); }
+	void clearLoopLatency() { fLoopTimer.clearLatency(); }
+	[[nodiscard]] auto lastReadOutDuration() const -> std::chrono::duration<int, std::micro> { return fReadOutDuration; }
+	auto setThreadPolicy(const ThreadPolicy& policy) -> bool { return applyThreadPolicy(fThread.get(), policy); }
 
-	std::mutex fMutex;
+  private:
+	void readLoop();
+
+	std::vector<SsiPosEncoder*> fEncoders { };
+	std::vector<unsigned int> fSpiHandles { };
+	std::shared_ptr<GPIO> fGpio { nullptr };
+	bool fCommonGpio { false };
+	std::atomic<bool> fActiveLoop { false };
+	std::atomic<std::chrono::duration<int, std::micro>> fReadOutDuration { std::chrono::duration<int, std::micro> { 0 } };
+	std::unique_ptr<std::thread> fThread { nullptr };
+	LoopTimer fLoopTimer { std::chrono::microseconds( static_cast<long>( 1e6 / DEFAULT_SAMPLE_RATE ) ) };
 };
 
 } // namespace PiRaTe
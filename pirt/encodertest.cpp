@@ -1,4 +1,7 @@
 /* simple program to read out absolute position encoder via SSI/SPI interface
+ * usage: encodertest [az_spidev el_spidev]
+ * without arguments, the encoders are read through the pigpiod daemon, otherwise
+ * directly through the given spidev devices (or replayed from regular files)
  * compile with:
  g++ -std=gnu++14 -Wall -pthread -c gpioif.cpp
  g++ -std=gnu++14 -Wall -pthread -c encoder.cpp
@@ -14,6 +17,8 @@
 #include <iomanip>
 
 #include "gpioif.h"
+#include "gpio_pigpiod.h"
+#include "spidev.h"
 #include "encoder.h"
 
 constexpr unsigned int CE0 { 8 };
@@ -35,18 +40,38 @@ std::string intToBinaryString(unsigned long number) {
 
 std::atomic<bool> stop { false };
 
-int main(void) {
-    std::shared_ptr<GPIO> gpio(new GPIO("localhost"));
-	
-	if (!gpio->isInitialized()) {
-        std::cerr<<"Could not connect to pigpio daemon. Is pigpiod running?\n";
-        return -1;
-    }
+void printLatency(const std::string& name, const PiRaTe::SsiPosEncoder::LatencyHistogram& histo) {
+	std::cout<<name<<" r/o latency: n="<<histo.entries()<<" mean="<<histo.mean()<<"us";
+	std::cout<<" median="<<histo.quantile(0.5)<<"us p99="<<histo.quantile(0.99)<<"us max="<<histo.maximum()<<"us\n";
+}
 
-//	gpio->set_gpio_direction(CLK1, true);
-//	gpio->set_gpio_direction(CLK2, true);
-	PiRaTe::SsiPosEncoder az_encoder(gpio, GPIO::SPI_INTERFACE::Main, baud_rate);
-	PiRaTe::SsiPosEncoder el_encoder(gpio, GPIO::SPI_INTERFACE::Aux, baud_rate);
+int main(int argc, char* argv[]) {
+	std::shared_ptr<GPIO> gpio { nullptr };
+	std::unique_ptr<PiRaTe::SsiPosEncoder> az_encoder_ptr { nullptr };
+	std::unique_ptr<PiRaTe::SsiPosEncoder> el_encoder_ptr { nullptr };
+	try {
+		if (argc == 3) {
+			std::shared_ptr<SpiDev> az_spidev(new SpiDev(argv[1], GPIO::SPI_MODE::POL1PHA1, baud_rate, false, false));
+			std::shared_ptr<SpiDev> el_spidev(new SpiDev(argv[2], GPIO::SPI_MODE::POL1PHA1, baud_rate, false, false));
+			az_encoder_ptr.reset(new PiRaTe::SsiPosEncoder(az_spidev));
+			el_encoder_ptr.reset(new PiRaTe::SsiPosEncoder(el_spidev));
+		} else {
+			gpio.reset(new PigpiodGPIO("localhost"));
+			if (!gpio->isInitialized()) {
+				std::cerr<<"Could not connect to pigpio daemon. Is pigpiod running?\n";
+				return -1;
+			}
+//			gpio->set_gpio_direction(CLK1, true);
+//			gpio->set_gpio_direction(CLK2, true);
+			az_encoder_ptr.reset(new PiRaTe::SsiPosEncoder(gpio, GPIO::SPI_INTERFACE::Main, baud_rate));
+			el_encoder_ptr.reset(new PiRaTe::SsiPosEncoder(gpio, GPIO::SPI_INTERFACE::Aux, baud_rate));
+		}
+	} catch (std::exception& e) {
+		std::cerr<<"Could not initialize the encoders.\n";
+		return -1;
+	}
+	PiRaTe::SsiPosEncoder& az_encoder { *az_encoder_ptr };
+	PiRaTe::SsiPosEncoder& el_encoder { *el_encoder_ptr };
 	//gpio->set_gpio_pullup(DATA1);
 	//gpio->set_gpio_pullup(DATA2);
 	el_encoder.setStBitWidth(13);
@@ -80,6 +105,10 @@ int main(void) {
 	
 	thr.join();
 	
+	std::cout<<"\n";
+	printLatency("Az", az_encoder.readOutLatency());
+	printLatency("El", el_encoder.readOutLatency());
+	
 	return EXIT_SUCCESS;
 	
 /*
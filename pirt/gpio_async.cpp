@@ -0,0 +1,246 @@
+#include <iostream>
+#include <stdexcept>
+
+#include "gpio_async.h"
+
+// namespace PiRaTe {
+
+namespace {
+// maximum number of commands handed to the backend at once
+constexpr std::size_t max_batch_size { 256 };
+} // anonymous namespace
+
+AsyncGPIO::AsyncGPIO(std::shared_ptr<GPIO> backend)
+	: fBackend { backend }
+{
+	if (fBackend == nullptr) {
+		std::cerr<<"Error: no GPIO backend for the asynchronous command layer.\n";
+		throw std::exception();
+	}
+	fActiveLoop = true;
+	fThread = std::make_unique<std::thread>( [this]() { this->ioLoop(); } );
+}
+
+AsyncGPIO::~AsyncGPIO()
+{
+	{
+		std::lock_guard<std::mutex> lock(fMutex);
+		fActiveLoop = false;
+	}
+	fCondition.notify_all();
+	if (fThread != nullptr) fThread->join();
+}
+
+auto AsyncGPIO::submit(const Command& command) -> std::future<int>
+{
+	Waiter waiter { std::make_shared<std::promise<int>>(), Callback { }, std::chrono::steady_clock::now() };
+	std::future<int> result { waiter.promise->get_future() };
+	enqueue(command, std::move(waiter));
+	return result;
+}
+
+void AsyncGPIO::submit(const Command& command, Callback callback)
+{
+	enqueue(command, Waiter { nullptr, std::move(callback), std::chrono::steady_clock::now() });
+}
+
+void AsyncGPIO::enqueue(const Command& command, Waiter waiter)
+{
+	{
+		std::lock_guard<std::mutex> lock(fMutex);
+		fStatistics.submitted++;
+		if (command.isWrite()) {
+			// merge with the pin's latest pending command if it is a write of the same kind
+			for (auto it = fQueue.rbegin(); it != fQueue.rend(); ++it) {
+				if (it->command.gpio_pin != command.gpio_pin) continue;
+				if (it->command.type == command.type) {
+					it->command.arg = command.arg;
+					it->command.duty = command.duty;
+					it->waiters.push_back(std::move(waiter));
+					fStatistics.coalesced++;
+					return;
+				}
+				break;
+			}
+		}
+		Request request { command, { } };
+		request.waiters.push_back(std::move(waiter));
+		fQueue.push_back(std::move(request));
+		fStatistics.queueDepth = fQueue.size();
+		fStatistics.maxQueueDepth = std::max(fStatistics.maxQueueDepth, fQueue.size());
+	}
+	fCondition.notify_one();
+}
+
+void AsyncGPIO::ioLoop()
+{
+	std::vector<Request> batch { };
+	std::vector<Command> commands { };
+	while (true) {
+		{
+			std::unique_lock<std::mutex> lock(fMutex);
+			fCondition.wait(lock, [this]() { return !fQueue.empty() || !fActiveLoop; });
+			// drain the queue before terminating, so that no caller waits forever
+			if (fQueue.empty()) break;
+			batch.clear();
+			while (!fQueue.empty() && batch.size() < max_batch_size) {
+				batch.push_back(std::move(fQueue.front()));
+				fQueue.pop_front();
+			}
+			fStatistics.queueDepth = fQueue.size();
+		}
+		commands.clear();
+		for (const Request& request: batch) commands.push_back(request.command);
+		fBackend->execute(commands);
+		const auto now { std::chrono::steady_clock::now() };
+		unsigned long errors { 0 };
+		for (std::size_t i = 0; i < batch.size(); i++) {
+			const int result { commands[i].result };
+			if (result < 0) errors++;
+			for (Waiter& waiter: batch[i].waiters) {
+				fLatency.fill( std::chrono::duration<double, std::micro>( now - waiter.submitted ).count() );
+				if (waiter.promise != nullptr) waiter.promise->set_value(result);
+				if (waiter.callback) waiter.callback(result);
+			}
+		}
+		std::lock_guard<std::mutex> lock(fMutex);
+		fStatistics.executed += batch.size();
+		fStatistics.batches++;
+		fStatistics.errors += errors;
+	}
+}
+
+auto AsyncGPIO::set_gpio_state_async(unsigned int gpio_pin, bool state) -> std::future<int>
+{
+	return submit( Command::make(Command::Type::SetState, gpio_pin, state) );
+}
+
+auto AsyncGPIO::get_gpio_state_async(unsigned int gpio_pin) -> std::future<int>
+{
+	return submit( Command::make(Command::Type::GetState, gpio_pin) );
+}
+
+auto AsyncGPIO::pwm_set_value_async(unsigned int gpio_pin, unsigned int value) -> std::future<int>
+{
+	return submit( Command::make(Command::Type::PwmValue, gpio_pin, value) );
+}
+
+auto AsyncGPIO::hw_pwm_set_value_async(unsigned int gpio_pin, unsigned int freq, std::uint32_t value) -> std::future<int>
+{
+	return submit( Command::make(Command::Type::HwPwmValue, gpio_pin, freq, value) );
+}
+
+auto AsyncGPIO::statistics() const -> Statistics
+{
+	std::lock_guard<std::mutex> lock(fMutex);
+	return fStatistics;
+}
+
+void AsyncGPIO::clearStatistics()
+{
+	std::lock_guard<std::mutex> lock(fMutex);
+	fStatistics = Statistics { fQueue.size() };
+	fLatency.clear();
+}
+
+auto AsyncGPIO::spi_init(SPI_INTERFACE interface, std::uint8_t channel, SPI_MODE mode, unsigned int baudrate, bool lsb_first, bool use_cs) -> int
+{
+	return fBackend->spi_init(interface, channel, mode, baudrate, lsb_first, use_cs);
+}
+
+auto AsyncGPIO::spi_read(unsigned int spi_handle, unsigned int nBytes) -> std::vector<std::uint8_t>
+{
+	return fBackend->spi_read(spi_handle, nBytes);
+}
+
+auto AsyncGPIO::spi_read_multi(const std::vector<unsigned int>& spi_handles, unsigned int nBytes) -> std::vector<std::vector<std::uint8_t>>
+{
+	return fBackend->spi_read_multi(spi_handles, nBytes);
+}
+
+auto AsyncGPIO::spi_write(unsigned int spi_handle, const std::vector<std::uint8_t>& data) -> bool
+{
+	return fBackend->spi_write(spi_handle, data);
+}
+
+void AsyncGPIO::spi_close(int spi_handle)
+{
+	fBackend->spi_close(spi_handle);
+}
+
+auto AsyncGPIO::pwm_set_frequency(unsigned int gpio_pin, unsigned int freq) -> bool
+{
+	return ( submit( Command::make(Command::Type::PwmFrequency, gpio_pin, freq) ).get() >= 0 );
+}
+
+auto AsyncGPIO::pwm_set_range(unsigned int gpio_pin, unsigned int range) -> bool
+{
+	return ( submit( Command::make(Command::Type::PwmRange, gpio_pin, range) ).get() >= 0 );
+}
+
+auto AsyncGPIO::pwm_set_value(unsigned int gpio_pin, unsigned int value) -> bool
+{
+	return ( pwm_set_value_async(gpio_pin, value).get() >= 0 );
+}
+
+void AsyncGPIO::pwm_off(unsigned int gpio_pin)
+{
+	pwm_set_value_async(gpio_pin, 0).wait();
+}
+
+auto AsyncGPIO::hw_pwm_set_value(unsigned int gpio_pin, unsigned int freq, std::uint32_t value) -> bool
+{
+	return ( hw_pwm_set_value_async(gpio_pin, freq, value).get() >= 0 );
+}
+
+auto AsyncGPIO::set_gpio_direction(unsigned int gpio_pin, bool output) -> bool
+{
+	return ( submit( Command::make(Command::Type::SetDirection, gpio_pin, output) ).get() >= 0 );
+}
+
+auto AsyncGPIO::set_gpio_state(unsigned int gpio_pin, bool state) -> bool
+{
+	return ( set_gpio_state_async(gpio_pin, state).get() >= 0 );
+}
+
+auto AsyncGPIO::get_gpio_state(unsigned int gpio_pin, bool* err) -> bool
+{
+	const int result { get_gpio_state_async(gpio_pin).get() };
+	if (err != nullptr) *err = (result < 0);
+	return (result > 0);
+}
+
+auto AsyncGPIO::set_gpio_pullup(unsigned int gpio_pin, bool pullup_enable) -> bool
+{
+	return ( submit( Command::make(Command::Type::SetPullUp, gpio_pin, pullup_enable) ).get() >= 0 );
+}
+
+auto AsyncGPIO::set_gpio_pulldown(unsigned int gpio_pin, bool pulldown_enable) -> bool
+{
+	return ( submit( Command::make(Command::Type::SetPullDown, gpio_pin, pulldown_enable) ).get() >= 0 );
+}
+
+void AsyncGPIO::execute(std::vector<Command>& commands)
+{
+	std::vector<std::future<int>> results { };
+	results.reserve(commands.size());
+	for (const Command& cmd: commands) results.push_back(submit(cmd));
+	for (std::size_t i = 0; i < commands.size(); i++) commands[i].result = results[i].get();
+}
+
+auto AsyncGPIO::register_edge_callback(unsigned int gpio_pin, EdgeCallback callback) -> int
+{
+	return fBackend->register_edge_callback(gpio_pin, std::move(callback));
+}
+
+void AsyncGPIO::cancel_edge_callback(int callback_id)
+{
+	fBackend->cancel_edge_callback(callback_id);
+}
+
+auto AsyncGPIO::set_glitch_filter(unsigned int gpio_pin, unsigned int steady_us) -> bool
+{
+	return fBackend->set_glitch_filter(gpio_pin, steady_us);
+}
+
+//} // namespace PiRaTe
@@ -0,0 +1,134 @@
+#ifndef GPIO_ASYNC_H
+#define GPIO_ASYNC_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <future>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+
+#include "gpioif.h"
+#include "utility.h"
+#include "thread_policy.h"
+
+// namespace PiRaTe {
+
+constexpr std::size_t GPIO_LATENCY_HISTOGRAM_BINS { 1000 };
+constexpr double GPIO_LATENCY_HISTOGRAM_RANGE { 10000. }; // us
+
+/**
+ * @brief Asynchronous command layer on top of a GPIO backend.
+ * Pin and PWM commands are queued and executed by a dedicated I/O thread, which hands all pending
+ * commands as one batch to {@link GPIO::execute} of the backend (pipelined over the socket by {@link PigpiodGPIO}).
+ * Callers receive the results through futures or callbacks instead of blocking on each request.
+ * A write which is submitted while an earlier write of the same type to the same pin is still pending
+ * (and is the pin's latest queued command) replaces the earlier one, both requests then complete with
+ * the result of the coalesced command.
+ * The synchronous methods of the GPIO interface submit a command and wait for its completion, so that
+ * they keep their order with respect to the asynchronous ones. SPI transfers and edge callbacks bypass the queue.
+ * @author HG Zaunick
+ */
+class AsyncGPIO : public GPIO {
+public:
+	using Callback = std::function<void(int result)>;
+	using LatencyHistogram = PiRaTe::Histogram<GPIO_LATENCY_HISTOGRAM_BINS>;
+
+	struct Statistics {
+		std::size_t queueDepth { 0 }; ///< number of currently pending commands
+		std::size_t maxQueueDepth { 0 }; ///< maximum number of pending commands since the last clear
+		unsigned long submitted { 0 }; ///< number of submitted commands
+		unsigned long executed { 0 }; ///< number of commands sent to the backend
+		unsigned long coalesced { 0 }; ///< number of submitted commands merged into a pending one
+		unsigned long batches { 0 }; ///< number of batches executed by the backend
+		unsigned long errors { 0 }; ///< number of commands which failed
+	};
+
+	AsyncGPIO() = delete;
+	explicit AsyncGPIO(std::shared_ptr<GPIO> backend);
+	~AsyncGPIO() override;
+
+	[[nodiscard]] auto isInitialized() const -> bool override { return fBackend->isInitialized(); }
+	[[nodiscard]] auto backendName() const -> std::string override { return fBackend->backendName() + "/async"; }
+	[[nodiscard]] auto backend() const -> std::shared_ptr<GPIO> { return fBackend; }
+
+	/**
+	 * @brief Queue a command for execution by the I/O thread.
+	 * @return future of the command's result (negative on error, the level for GetState)
+	 */
+	auto submit(const Command& command) -> std::future<int>;
+	/**
+	 * @brief Queue a command for execution by the I/O thread.
+	 * @param callback called from the I/O thread with the command's result, must not block
+	 */
+	void submit(const Command& command, Callback callback);
+
+	auto set_gpio_state_async(unsigned int gpio_pin, bool state) -> std::future<int>;
+	auto get_gpio_state_async(unsigned int gpio_pin) -> std::future<int>;
+	auto pwm_set_value_async(unsigned int gpio_pin, unsigned int value) -> std::future<int>;
+	auto hw_pwm_set_value_async(unsigned int gpio_pin, unsigned int freq, std::uint32_t value) -> std::future<int>;
+
+	[[nodiscard]] auto statistics() const -> Statistics;
+	/// time from submission to completion of the commands in us
+	[[nodiscard]] auto latency() const -> const LatencyHistogram& { return fLatency; }
+	void clearStatistics();
+	/// apply scheduling policy and CPU affinity to the I/O thread
+	auto setThreadPolicy(const PiRaTe::ThreadPolicy& policy) -> bool { return PiRaTe::applyThreadPolicy(fThread.get(), policy); }
+
+	[[nodiscard]] auto spi_init(SPI_INTERFACE interface, std::uint8_t channel, SPI_MODE mode, unsigned int baudrate, bool lsb_first = false, bool use_cs = true) -> int override;
+	[[nodiscard]] auto spi_read(unsigned int spi_handle, unsigned int nBytes) -> std::vector<std::uint8_t> override;
+	[[nodiscard]] auto spi_read_multi(const std::vector<unsigned int>& spi_handles, unsigned int nBytes) -> std::vector<std::vector<std::uint8_t>> override;
+	[[nodiscard]] auto spi_write(unsigned int spi_handle, const std::vector<std::uint8_t>& data) -> bool override;
+	void spi_close(int spi_handle) override;
+
+	auto pwm_set_frequency(unsigned int gpio_pin, unsigned int freq) -> bool override;
+	auto pwm_set_range(unsigned int gpio_pin, unsigned int range) -> bool override;
+	auto pwm_set_value(unsigned int gpio_pin, unsigned int value) -> bool override;
+	void pwm_off(unsigned int gpio_pin) override;
+	auto hw_pwm_set_value(unsigned int gpio_pin, unsigned int freq, std::uint32_t value) -> bool override;
+
+	auto set_gpio_direction(unsigned int gpio_pin, bool output) -> bool override;
+	auto set_gpio_state(unsigned int gpio_pin, bool state) -> bool override;
+	auto get_gpio_state(unsigned int gpio_pin, bool* err) -> bool override;
+	auto set_gpio_pullup(unsigned int gpio_pin, bool pullup_enable=true) -> bool override;
+	auto set_gpio_pulldown(unsigned int gpio_pin, bool pulldown_enable=true) -> bool override;
+
+	/// queue the commands and wait until all of them completed
+	void execute(std::vector<Command>& commands) override;
+
+	auto register_edge_callback(unsigned int gpio_pin, EdgeCallback callback) -> int override;
+	void cancel_edge_callback(int callback_id) override;
+	auto set_glitch_filter(unsigned int gpio_pin, unsigned int steady_us) -> bool override;
+
+private:
+	struct Waiter {
+		std::shared_ptr<std::promise<int>> promise { };
+		Callback callback { };
+		std::chrono::steady_clock::time_point submitted { };
+	};
+	struct Request {
+		Command command { };
+		std::vector<Waiter> waiters { };
+	};
+
+	void enqueue(const Command& command, Waiter waiter);
+	void ioLoop();
+
+	std::shared_ptr<GPIO> fBackend { };
+	std::deque<Request> fQueue { };
+	Statistics fStatistics { };
+	LatencyHistogram fLatency { 0., GPIO_LATENCY_HISTOGRAM_RANGE };
+	std::atomic<bool> fActiveLoop { false };
+	std::unique_ptr<std::thread> fThread { nullptr };
+	mutable std::mutex fMutex;
+	std::condition_variable fCondition;
+};
+
+//} // namespace PiRaTe
+
+#endif
@@ -0,0 +1,272 @@
+#include <iostream>
+#include <stdexcept>
+#include <set>
+
+#include "gpio_cached.h"
+
+// namespace PiRaTe {
+
+CachedGPIO::CachedGPIO(std::shared_ptr<GPIO> backend)
+	: fBackend { backend }
+{
+	if (fBackend == nullptr) {
+		std::cerr<<"Error: no GPIO backend for the write cache.\n";
+		throw std::exception();
+	}
+}
+
+void CachedGPIO::invalidate()
+{
+	std::lock_guard<std::mutex> lock(fMutex);
+	fShadow.clear();
+}
+
+auto CachedGPIO::statistics() -> Statistics
+{
+	Statistics stats { };
+	stats.forwarded = fForwarded;
+	stats.suppressed = fSuppressed;
+	std::lock_guard<std::mutex> lock(fMutex);
+	const auto now { std::chrono::steady_clock::now() };
+	const double dt { std::chrono::duration<double>( now - fLastStatistics ).count() };
+	if (dt > 0.) stats.suppressedRate = ( stats.suppressed - fLastSuppressed ) / dt;
+	fLastSuppressed = stats.suppressed;
+	fLastStatistics = now;
+	return stats;
+}
+
+auto CachedGPIO::isNoOp(const Command& command) const -> bool
+{
+	auto it = fShadow.find(command.gpio_pin);
+	if (it == fShadow.end()) return false;
+	const Shadow& shadow { it->second };
+	switch (command.type) {
+		case Command::Type::SetDirection:
+			return ( shadow.output == (command.arg != 0) );
+		case Command::Type::SetState:
+			return ( shadow.output == true && shadow.level == (command.arg != 0) );
+		case Command::Type::GetState:
+			return false;
+		case Command::Type::SetPullUp:
+			return ( shadow.pull == ( (command.arg) ? Pull::Up : Pull::Off ) );
+		case Command::Type::SetPullDown:
+			return ( shadow.pull == ( (command.arg) ? Pull::Down : Pull::Off ) );
+		case Command::Type::PwmFrequency:
+			return ( shadow.pwmFrequency == command.arg );
+		case Command::Type::PwmRange:
+			return ( shadow.pwmRange == command.arg );
+		case Command::Type::PwmValue:
+			return ( shadow.pwmValue == command.arg );
+		case Command::Type::HwPwmValue:
+			return ( shadow.hwPwm == std::make_pair(command.arg, command.duty) );
+	}
+	return false;
+}
+
+void CachedGPIO::apply(const Command& command)
+{
+	Shadow& shadow { fShadow[command.gpio_pin] };
+	switch (command.type) {
+		case Command::Type::SetDirection:
+			// a mode change may stop a running pwm and leaves the output latch undefined
+			shadow.output = (command.arg != 0);
+			shadow.level.reset();
+			shadow.pwmValue.reset();
+			shadow.hwPwm.reset();
+			break;
+		case Command::Type::SetState:
+			// writing a level switches the pin to output and stops the pwm
+			shadow.output = true;
+			shadow.level = (command.arg != 0);
+			shadow.pwmValue.reset();
+			shadow.hwPwm.reset();
+			break;
+		case Command::Type::GetState:
+			break;
+		case Command::Type::SetPullUp:
+			shadow.pull = (command.arg) ? Pull::Up : Pull::Off;
+			break;
+		case Command::Type::SetPullDown:
+			shadow.pull = (command.arg) ? Pull::Down : Pull::Off;
+			break;
+		case Command::Type::PwmFrequency:
+			shadow.pwmFrequency = command.arg;
+			break;
+		case Command::Type::PwmRange:
+			shadow.pwmRange = command.arg;
+			break;
+		case Command::Type::PwmValue:
+			shadow.output = true;
+			shadow.level.reset();
+			shadow.pwmValue = command.arg;
+			shadow.hwPwm.reset();
+			break;
+		case Command::Type::HwPwmValue:
+			shadow.output = true;
+			shadow.level.reset();
+			shadow.pwmValue.reset();
+			shadow.hwPwm = std::make_pair(command.arg, command.duty);
+			break;
+	}
+}
+
+auto CachedGPIO::write(const Command& command) -> bool
+{
+	std::lock_guard<std::mutex> pin_lock(pinMutex(command.gpio_pin));
+	{
+		std::lock_guard<std::mutex> lock(fMutex);
+		if (isNoOp(command)) {
+			fSuppressed++;
+			return true;
+		}
+	}
+	fForwarded++;
+	bool ok { false };
+	switch (command.type) {
+		case Command::Type::SetDirection: ok = fBackend->set_gpio_direction(command.gpio_pin, command.arg != 0); break;
+		case Command::Type::SetState: ok = fBackend->set_gpio_state(command.gpio_pin, command.arg != 0); break;
+		case Command::Type::GetState: return false;
+		case Command::Type::SetPullUp: ok = fBackend->set_gpio_pullup(command.gpio_pin, command.arg != 0); break;
+		case Command::Type::SetPullDown: ok = fBackend->set_gpio_pulldown(command.gpio_pin, command.arg != 0); break;
+		case Command::Type::PwmFrequency: ok = fBackend->pwm_set_frequency(command.gpio_pin, command.arg); break;
+		case Command::Type::PwmRange: ok = fBackend->pwm_set_range(command.gpio_pin, command.arg); break;
+		case Command::Type::PwmValue: ok = fBackend->pwm_set_value(command.gpio_pin, command.arg); break;
+		case Command::Type::HwPwmValue: ok = fBackend->hw_pwm_set_value(command.gpio_pin, command.arg, command.duty); break;
+	}
+	std::lock_guard<std::mutex> lock(fMutex);
+	if (ok) apply(command);
+	// the state after a failed write is unknown
+	else fShadow.erase(command.gpio_pin);
+	return ok;
+}
+
+void CachedGPIO::execute(std::vector<Command>& commands)
+{
+	// lock the involved pins in ascending order to avoid deadlocks with concurrent batches
+	std::set<std::mutex*> pin_mutexes { };
+	for (const Command& cmd: commands) pin_mutexes.insert(&pinMutex(cmd.gpio_pin));
+	for (std::mutex* mutex: pin_mutexes) mutex->lock();
+
+	std::vector<Command> forwarded { };
+	std::vector<std::size_t> forwarded_index { };
+	{
+		std::lock_guard<std::mutex> lock(fMutex);
+		// evaluate the no-ops against the state which the preceding commands of the batch will establish
+		std::map<unsigned int, Shadow> saved { fShadow };
+		for (std::size_t i = 0; i < commands.size(); i++) {
+			if (commands[i].isWrite() && isNoOp(commands[i])) {
+				commands[i].result = 0;
+				fSuppressed++;
+				continue;
+			}
+			apply(commands[i]);
+			forwarded.push_back(commands[i]);
+			forwarded_index.push_back(i);
+		}
+		fShadow.swap(saved);
+	}
+	fForwarded += forwarded.size();
+	if (!forwarded.empty()) fBackend->execute(forwarded);
+	{
+		std::lock_guard<std::mutex> lock(fMutex);
+		for (std::size_t i = 0; i < forwarded.size(); i++) {
+			commands[forwarded_index[i]].result = forwarded[i].result;
+			if (!forwarded[i].isWrite()) continue;
+			if (forwarded[i].result >= 0) apply(forwarded[i]);
+			else fShadow.erase(forwarded[i].gpio_pin);
+		}
+	}
+	for (auto it = pin_mutexes.rbegin(); it != pin_mutexes.rend(); ++it) (*it)->unlock();
+}
+
+auto CachedGPIO::spi_init(SPI_INTERFACE interface, std::uint8_t channel, SPI_MODE mode, unsigned int baudrate, bool lsb_first, bool use_cs) -> int
+{
+	return fBackend->spi_init(interface, channel, mode, baudrate, lsb_first, use_cs);
+}
+
+auto CachedGPIO::spi_read(unsigned int spi_handle, unsigned int nBytes) -> std::vector<std::uint8_t>
+{
+	return fBackend->spi_read(spi_handle, nBytes);
+}
+
+auto CachedGPIO::spi_read_multi(const std::vector<unsigned int>& spi_handles, unsigned int nBytes) -> std::vector<std::vector<std::uint8_t>>
+{
+	return fBackend->spi_read_multi(spi_handles, nBytes);
+}
+
+auto CachedGPIO::spi_write(unsigned int spi_handle, const std::vector<std::uint8_t>& data) -> bool
+{
+	return fBackend->spi_write(spi_handle, data);
+}
+
+void CachedGPIO::spi_close(int spi_handle)
+{
+	fBackend->spi_close(spi_handle);
+}
+
+auto CachedGPIO::pwm_set_frequency(unsigned int gpio_pin, unsigned int freq) -> bool
+{
+	return write( Command::make(Command::Type::PwmFrequency, gpio_pin, freq) );
+}
+
+auto CachedGPIO::pwm_set_range(unsigned int gpio_pin, unsigned int range) -> bool
+{
+	return write( Command::make(Command::Type::PwmRange, gpio_pin, range) );
+}
+
+auto CachedGPIO::pwm_set_value(unsigned int gpio_pin, unsigned int value) -> bool
+{
+	return write( Command::make(Command::Type::PwmValue, gpio_pin, value) );
+}
+
+void CachedGPIO::pwm_off(unsigned int gpio_pin)
+{
+	write( Command::make(Command::Type::PwmValue, gpio_pin, 0) );
+}
+
+auto CachedGPIO::hw_pwm_set_value(unsigned int gpio_pin, unsigned int freq, std::uint32_t value) -> bool
+{
+	return write( Command::make(Command::Type::HwPwmValue, gpio_pin, freq, value) );
+}
+
+auto CachedGPIO::set_gpio_direction(unsigned int gpio_pin, bool output) -> bool
+{
+	return write( Command::make(Command::Type::SetDirection, gpio_pin, output) );
+}
+
+auto CachedGPIO::set_gpio_state(unsigned int gpio_pin, bool state) -> bool
+{
+	return write( Command::make(Command::Type::SetState, gpio_pin, state) );
+}
+
+auto CachedGPIO::get_gpio_state(unsigned int gpio_pin, bool* err) -> bool
+{
+	return fBackend->get_gpio_state(gpio_pin, err);
+}
+
+auto CachedGPIO::set_gpio_pullup(unsigned int gpio_pin, bool pullup_enable) -> bool
+{
+	return write( Command::make(Command::Type::SetPullUp, gpio_pin, pullup_enable) );
+}
+
+auto CachedGPIO::set_gpio_pulldown(unsigned int gpio_pin, bool pulldown_enable) -> bool
+{
+	return write( Command::make(Command::Type::SetPullDown, gpio_pin, pulldown_enable) );
+}
+
+auto CachedGPIO::register_edge_callback(unsigned int gpio_pin, EdgeCallback callback) -> int
+{
+	return fBackend->register_edge_callback(gpio_pin, std::move(callback));
+}
+
+void CachedGPIO::cancel_edge_callback(int callback_id)
+{
+	fBackend->cancel_edge_callback(callback_id);
+}
+
+auto CachedGPIO::set_glitch_filter(unsigned int gpio_pin, unsigned int steady_us) -> bool
+{
+	return fBackend->set_glitch_filter(gpio_pin, steady_us);
+}
+
+//} // namespace PiRaTe
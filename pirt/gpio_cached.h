@@ -0,0 +1,103 @@
+#ifndef GPIO_CACHED_H
+#define GPIO_CACHED_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <array>
+#include <memory>
+#include <optional>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+
+#include "gpioif.h"
+
+// namespace PiRaTe {
+/**
+ * @brief Write-through shadow register cache on top of a GPIO backend.
+ * The cache tracks the last written direction, level, pull resistor and PWM settings of each pin.
+ * Writes which would not change the pin's state are dropped without calling the backend,
+ * all others are forwarded and update the shadow state upon success. Batches passed to
+ * {@link CachedGPIO::execute} are stripped of no-op writes and forwarded as one batch.
+ * Reads and SPI transfers are always forwarded.
+ * @note The shadow state assumes that the pins are not changed by other clients of the hardware.
+ * Call {@link CachedGPIO::invalidate} if that may have happened.
+ * @author HG Zaunick
+ */
+class CachedGPIO : public GPIO {
+public:
+	struct Statistics {
+		unsigned long forwarded { 0 }; ///< number of writes passed to the backend
+		unsigned long suppressed { 0 }; ///< number of writes dropped as no-ops
+		double suppressedRate { 0. }; ///< dropped writes per second since the previous call of statistics()
+	};
+
+	CachedGPIO() = delete;
+	explicit CachedGPIO(std::shared_ptr<GPIO> backend);
+	~CachedGPIO() override = default;
+
+	[[nodiscard]] auto isInitialized() const -> bool override { return fBackend->isInitialized(); }
+	[[nodiscard]] auto backendName() const -> std::string override { return fBackend->backendName(); }
+	[[nodiscard]] auto backend() const -> std::shared_ptr<GPIO> { return fBackend; }
+
+	/// forget the shadow state of all pins, so that the next writes are forwarded unconditionally
+	void invalidate();
+	[[nodiscard]] auto statistics() -> Statistics;
+
+	[[nodiscard]] auto spi_init(SPI_INTERFACE interface, std::uint8_t channel, SPI_MODE mode, unsigned int baudrate, bool lsb_first = false, bool use_cs = true) -> int override;
+	[[nodiscard]] auto spi_read(unsigned int spi_handle, unsigned int nBytes) -> std::vector<std::uint8_t> override;
+	[[nodiscard]] auto spi_read_multi(const std::vector<unsigned int>& spi_handles, unsigned int nBytes) -> std::vector<std::vector<std::uint8_t>> override;
+	[[nodiscard]] auto spi_write(unsigned int spi_handle, const std::vector<std::uint8_t>& data) -> bool override;
+	void spi_close(int spi_handle) override;
+
+	auto pwm_set_frequency(unsigned int gpio_pin, unsigned int freq) -> bool override;
+	auto pwm_set_range(unsigned int gpio_pin, unsigned int range) -> bool override;
+	auto pwm_set_value(unsigned int gpio_pin, unsigned int value) -> bool override;
+	void pwm_off(unsigned int gpio_pin) override;
+	auto hw_pwm_set_value(unsigned int gpio_pin, unsigned int freq, std::uint32_t value) -> bool override;
+
+	auto set_gpio_direction(unsigned int gpio_pin, bool output) -> bool override;
+	auto set_gpio_state(unsigned int gpio_pin, bool state) -> bool override;
+	auto get_gpio_state(unsigned int gpio_pin, bool* err) -> bool override;
+	auto set_gpio_pullup(unsigned int gpio_pin, bool pullup_enable=true) -> bool override;
+	auto set_gpio_pulldown(unsigned int gpio_pin, bool pulldown_enable=true) -> bool override;
+
+	void execute(std::vector<Command>& commands) override;
+
+	auto register_edge_callback(unsigned int gpio_pin, EdgeCallback callback) -> int override;
+	void cancel_edge_callback(int callback_id) override;
+	auto set_glitch_filter(unsigned int gpio_pin, unsigned int steady_us) -> bool override;
+
+private:
+	enum class Pull { Off, Up, Down };
+	struct Shadow {
+		std::optional<bool> output { };
+		std::optional<bool> level { };
+		std::optional<Pull> pull { };
+		std::optional<unsigned int> pwmFrequency { };
+		std::optional<unsigned int> pwmRange { };
+		std::optional<unsigned int> pwmValue { };
+		std::optional<std::pair<unsigned int, std::uint32_t>> hwPwm { }; ///< frequency and duty cycle of the hardware PWM
+	};
+	/// true if the command would not change the shadow state of the pin
+	[[nodiscard]] auto isNoOp(const Command& command) const -> bool;
+	/// record the effect of a successfully executed command
+	void apply(const Command& command);
+	/// execute a single command through the cache
+	auto write(const Command& command) -> bool;
+	[[nodiscard]] auto pinMutex(unsigned int gpio_pin) -> std::mutex& { return fPinMutex[gpio_pin % fPinMutex.size()]; }
+
+	std::shared_ptr<GPIO> fBackend { };
+	std::map<unsigned int, Shadow> fShadow { };
+	std::atomic<unsigned long> fForwarded { 0 };
+	std::atomic<unsigned long> fSuppressed { 0 };
+	unsigned long fLastSuppressed { 0 };
+	std::chrono::steady_clock::time_point fLastStatistics { std::chrono::steady_clock::now() };
+	mutable std::mutex fMutex; ///< protects the shadow state
+	std::array<std::mutex, 64> fPinMutex; ///< serializes check and write on the same pin
+};
+
+//} // namespace PiRaTe
+
+#endif
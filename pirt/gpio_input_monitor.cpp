@@ -0,0 +1,106 @@
+#include <iostream>
+#include <algorithm>
+
+#include "gpio_input_monitor.h"
+
+namespace PiRaTe {
+
+GpioInputMonitor::GpioInputMonitor(std::shared_ptr<GPIO> gpio, const std::vector<unsigned int>& pins, std::chrono::microseconds debounce)
+	: fGpio { gpio }, fDebounce { debounce }
+{
+	if (fGpio == nullptr || !fGpio->isInitialized()) {
+		std::cerr<<"Error: no valid GPIO interface for input monitoring.\n";
+		throw std::exception();
+	}
+	for (unsigned int pin: pins) {
+		Input input { };
+		input.gpio_pin = pin;
+		input.state = input.rawLevel = fGpio->get_gpio_state(pin, nullptr);
+		input.glitchFilter = fGpio->set_glitch_filter(pin, static_cast<unsigned int>(fDebounce.count()));
+		fInputs.push_back(input);
+	}
+	fEventDriven = true;
+	for (Input& input: fInputs) {
+		input.callbackId = fGpio->register_edge_callback(input.gpio_pin,
+			[this](unsigned int gpio_pin, bool level, std::chrono::steady_clock::time_point time) { this->onEdge(gpio_pin, level, time); });
+		if (input.callbackId < 0) fEventDriven = false;
+	}
+	if (!fEventDriven) {
+		// fall back to polling all inputs
+		for (Input& input: fInputs) {
+			if (input.callbackId >= 0) fGpio->cancel_edge_callback(input.callbackId);
+			input.callbackId = -1;
+		}
+	}
+}
+
+GpioInputMonitor::~GpioInputMonitor()
+{
+	for (const Input& input: fInputs) {
+		if (input.callbackId >= 0) fGpio->cancel_edge_callback(input.callbackId);
+	}
+}
+
+auto GpioInputMonitor::state(unsigned int gpio_pin) const -> bool
+{
+	std::lock_guard<std::mutex> lock(fMutex);
+	auto it = std::find_if(fInputs.begin(), fInputs.end(), [gpio_pin](const Input& input) { return input.gpio_pin == gpio_pin; });
+	return (it != fInputs.end()) && it->state;
+}
+
+void GpioInputMonitor::accept(Input& input, bool level, std::chrono::steady_clock::time_point time)
+{
+	input.state = level;
+	const Edge edge { input.gpio_pin, level, time };
+	fPending.push_back(edge);
+	fLog.push_back(edge);
+	if (fLog.size() > EDGE_LOG_SIZE) fLog.pop_front();
+}
+
+void GpioInputMonitor::onEdge(unsigned int gpio_pin, bool level, std::chrono::steady_clock::time_point time)
+{
+	std::lock_guard<std::mutex> lock(fMutex);
+	auto it = std::find_if(fInputs.begin(), fInputs.end(), [gpio_pin](const Input& input) { return input.gpio_pin == gpio_pin; });
+	if (it == fInputs.end()) return;
+	Input& input { *it };
+	// the first edge after a stable period is taken immediately with its exact time stamp,
+	// the bounces following it within the debounce time are ignored
+	const bool stable { input.glitchFilter || time - input.lastRawEdge >= fDebounce };
+	input.rawLevel = level;
+	input.lastRawEdge = time;
+	if (stable && level != input.state) accept(input, level, time);
+}
+
+auto GpioInputMonitor::update() -> std::vector<Edge>
+{
+	if (!fEventDriven) {
+		// read all inputs as one batch
+		std::vector<GPIO::Command> commands(fInputs.size());
+		for (std::size_t i = 0; i < fInputs.size(); i++) {
+			commands[i].type = GPIO::Command::Type::GetState;
+			commands[i].gpio_pin = fInputs[i].gpio_pin;
+		}
+		fGpio->execute(commands);
+		const auto now { std::chrono::steady_clock::now() };
+		for (std::size_t i = 0; i < fInputs.size(); i++) {
+			if (commands[i].result >= 0 && (commands[i].result > 0) != fInputs[i].rawLevel) onEdge(fInputs[i].gpio_pin, commands[i].result > 0, now);
+		}
+	}
+	std::lock_guard<std::mutex> lock(fMutex);
+	const auto now { std::chrono::steady_clock::now() };
+	for (Input& input: fInputs) {
+		// adopt the final level of a bounce burst once the pin settled
+		if (input.rawLevel != input.state && now - input.lastRawEdge >= fDebounce) accept(input, input.rawLevel, input.lastRawEdge);
+	}
+	std::vector<Edge> edges { };
+	edges.swap(fPending);
+	return edges;
+}
+
+auto GpioInputMonitor::edgeLog() const -> std::vector<Edge>
+{
+	std::lock_guard<std::mutex> lock(fMutex);
+	return std::vector<Edge>(fLog.begin(), fLog.end());
+}
+
+} // namespace PiRaTe
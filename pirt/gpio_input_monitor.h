@@ -0,0 +1,82 @@
+#ifndef GPIO_INPUT_MONITOR_H
+#define GPIO_INPUT_MONITOR_H
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <chrono>
+#include <mutex>
+
+#include "gpioif.h"
+
+namespace PiRaTe {
+
+/**
+ * @brief Event-driven monitoring of digital input pins.
+ * The monitor registers edge callbacks with the GPIO backend, so that level changes are captured
+ * with the time stamp of the edge, including pulses shorter than the driver's poll period.
+ * Bouncing contacts are debounced by the backend's glitch filter if available. Otherwise edges are accepted
+ * only after the pin was stable for the debounce time and the final level of a bounce burst is adopted
+ * by {@link GpioInputMonitor::update} once the pin settled.
+ * Backends without edge events are polled in {@link GpioInputMonitor::update}.
+ * Accepted edges are kept in a log of the last {@link GpioInputMonitor::EDGE_LOG_SIZE} entries.
+ * @author HG Zaunick
+ */
+class GpioInputMonitor {
+public:
+	static constexpr std::size_t EDGE_LOG_SIZE { 256 };
+
+	struct Edge {
+		unsigned int gpio_pin { 0 };
+		bool level { false }; ///< the level after the edge
+		std::chrono::steady_clock::time_point time { };
+	};
+
+	GpioInputMonitor() = delete;
+	/**
+	 * @brief The main constructor.
+	 * @param gpio the GPIO interface, the pins must already be configured as inputs
+	 * @param pins the input pins to monitor
+	 * @param debounce the minimum duration of a stable level
+	 */
+	GpioInputMonitor(std::shared_ptr<GPIO> gpio, const std::vector<unsigned int>& pins, std::chrono::microseconds debounce);
+	~GpioInputMonitor();
+
+	/// true if the backend supports edge events, false if the inputs are polled
+	[[nodiscard]] auto isEventDriven() const -> bool { return fEventDriven; }
+	/// the debounced level of the pin
+	[[nodiscard]] auto state(unsigned int gpio_pin) const -> bool;
+	/**
+	 * @brief Collect the edges accepted since the previous call.
+	 * Settles pins whose last bounce is older than the debounce time and polls the pins
+	 * if the backend does not deliver edge events.
+	 */
+	auto update() -> std::vector<Edge>;
+	/// the most recent edges, oldest first
+	[[nodiscard]] auto edgeLog() const -> std::vector<Edge>;
+
+private:
+	struct Input {
+		unsigned int gpio_pin { 0 };
+		bool state { false }; ///< debounced level
+		bool rawLevel { false }; ///< level after the last reported edge
+		std::chrono::steady_clock::time_point lastRawEdge { };
+		bool glitchFilter { false }; ///< the backend filters the pin's glitches
+		int callbackId { -1 };
+	};
+
+	void onEdge(unsigned int gpio_pin, bool level, std::chrono::steady_clock::time_point time);
+	void accept(Input& input, bool level, std::chrono::steady_clock::time_point time);
+
+	std::shared_ptr<GPIO> fGpio { nullptr };
+	std::vector<Input> fInputs { };
+	std::chrono::microseconds fDebounce { 0 };
+	bool fEventDriven { false };
+	std::vector<Edge> fPending { };
+	std::deque<Edge> fLog { };
+	mutable std::mutex fMutex;
+};
+
+} // namespace PiRaTe
+
+#endif // GPIO_INPUT_MONITOR_H
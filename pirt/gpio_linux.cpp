@@ -0,0 +1,404 @@
+#include <iostream>
+#include <stdio.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <cstring>
+#include <algorithm>
+#include <sys/ioctl.h>
+#include <sys/eventfd.h>
+#include <poll.h>
+#include <linux/gpio.h>
+
+#include "gpio_linux.h"
+#include "spidev.h"
+
+// namespace PiRaTe {
+
+namespace {
+constexpr char consumer_name[] { "indi_pirt" };
+constexpr std::uint64_t ns_per_s { 1000000000ULL };
+constexpr std::uint32_t hw_pwm_full_scale { 1000000U };
+}
+
+LinuxGPIO::LinuxGPIO(const std::string& chip, const std::string& pwmchip)
+	: fPwmChip { pwmchip }
+{
+	fChipHandle = ::open(chip.c_str(), O_RDWR | O_CLOEXEC);
+	if (fChipHandle < 0) {
+		std::cerr<<"Error opening gpio chip "<<chip<<": "<<std::strerror(errno)<<"\n";
+	}
+}
+
+LinuxGPIO::~LinuxGPIO()
+{
+	if (fEventThread != nullptr) {
+		fActiveLoop = false;
+		wakeEventLoop();
+		fEventThread->join();
+	}
+	if (fWakeupHandle >= 0) ::close(fWakeupHandle);
+	fSpiDevs.clear();
+	for (unsigned int channel = 0; channel < fPwmChannels.size(); channel++) {
+		if (fPwmChannels[channel].dutyHandle < 0) continue;
+		writeAttribute(fPwmChip + "/pwm" + std::to_string(channel) + "/enable", "0");
+		::close(fPwmChannels[channel].dutyHandle);
+	}
+	for (auto& [pin, line]: fLines) {
+		// releasing the line request returns the pin to the kernel
+		if (line.handle >= 0) ::close(line.handle);
+	}
+	if (fChipHandle >= 0) ::close(fChipHandle);
+	fChipHandle = -1;
+}
+
+auto LinuxGPIO::spi_init(SPI_INTERFACE interface, std::uint8_t channel, SPI_MODE mode, unsigned int baudrate, bool lsb_first, bool use_cs) -> int
+{
+	const std::string device { "/dev/spidev" + std::to_string( (interface == SPI_INTERFACE::Aux) ? 1 : 0 ) + "." + std::to_string(channel) };
+	std::shared_ptr<SpiDev> spidev { new SpiDev(device, mode, baudrate, lsb_first, use_cs) };
+	if (!spidev->isInitialized()) {
+		std::cerr<<"Error opening spi interface.\n";
+		return -1;
+	}
+	std::lock_guard<std::mutex> guard(fMutex);
+	const int handle { fNextSpiHandle++ };
+	fSpiDevs.emplace(handle, std::move(spidev));
+	return handle;
+}
+
+auto LinuxGPIO::spi_read(unsigned int spi_handle, unsigned int nBytes) -> std::vector<std::uint8_t>
+{
+	std::shared_ptr<SpiDev> spidev { };
+	{
+		std::lock_guard<std::mutex> guard(fMutex);
+		auto it = fSpiDevs.find(static_cast<int>(spi_handle));
+		if (it == fSpiDevs.end()) return std::vector<std::uint8_t> {};
+		spidev = it->second;
+	}
+	return spidev->read(nBytes);
+}
+
+auto LinuxGPIO::spi_write(unsigned int spi_handle, const std::vector<std::uint8_t>& data) -> bool
+{
+	std::shared_ptr<SpiDev> spidev { };
+	{
+		std::lock_guard<std::mutex> guard(fMutex);
+		auto it = fSpiDevs.find(static_cast<int>(spi_handle));
+		if (it == fSpiDevs.end()) return false;
+		spidev = it->second;
+	}
+	std::vector<SpiDev::Transfer> transfers(1);
+	transfers[0].tx = data;
+	transfers[0].length = data.size();
+	return spidev->transfer(transfers);
+}
+
+void LinuxGPIO::spi_close(int spi_handle)
+{
+	std::lock_guard<std::mutex> guard(fMutex);
+	fSpiDevs.erase(spi_handle);
+}
+
+auto LinuxGPIO::pwmChannel(unsigned int gpio_pin) -> int
+{
+	switch (gpio_pin) {
+		case 12:
+		case 18:
+			return 0;
+		case 13:
+		case 19:
+			return 1;
+		default:
+			return -1;
+	}
+}
+
+auto LinuxGPIO::writeAttribute(const std::string& path, const std::string& value) -> bool
+{
+	int fd = ::open(path.c_str(), O_WRONLY | O_CLOEXEC);
+	if (fd < 0) return false;
+	const bool ok { ::write(fd, value.c_str(), value.size()) == static_cast<ssize_t>(value.size()) };
+	::close(fd);
+	return ok;
+}
+
+auto LinuxGPIO::hw_pwm_set_value(unsigned int gpio_pin, unsigned int freq, std::uint32_t value) -> bool
+{
+	const int channel { pwmChannel(gpio_pin) };
+	if (channel < 0 || freq == 0) return false;
+	std::lock_guard<std::mutex> guard(fMutex);
+	PwmChannel& pwm { fPwmChannels[channel] };
+	const std::string dir { fPwmChip + "/pwm" + std::to_string(channel) };
+	if (pwm.dutyHandle < 0) {
+		// export the channel, the write fails harmlessly if it is already exported
+		writeAttribute(fPwmChip + "/export", std::to_string(channel));
+		pwm.dutyHandle = ::open((dir + "/duty_cycle").c_str(), O_WRONLY | O_CLOEXEC);
+		if (pwm.dutyHandle < 0) {
+			std::cerr<<"Error opening pwm channel "<<dir<<": "<<std::strerror(errno)<<"\n";
+			return false;
+		}
+		pwm.period_ns = 0;
+	}
+	const std::uint64_t period_ns { ns_per_s / freq };
+	const std::uint64_t duty_ns { period_ns * std::min(value, hw_pwm_full_scale) / hw_pwm_full_scale };
+	if (period_ns != pwm.period_ns) {
+		// the duty cycle must never exceed the period, so clear it before changing the period
+		const std::string zero { "0" };
+		if (::pwrite(pwm.dutyHandle, zero.c_str(), zero.size(), 0) < 0
+			|| !writeAttribute(dir + "/period", std::to_string(period_ns))
+			|| !writeAttribute(dir + "/enable", "1"))
+		{
+			std::cerr<<"Error configuring pwm channel "<<dir<<"\n";
+			return false;
+		}
+		pwm.period_ns = period_ns;
+	}
+	const std::string duty { std::to_string(duty_ns) };
+	return ( ::pwrite(pwm.dutyHandle, duty.c_str(), duty.size(), 0) == static_cast<ssize_t>(duty.size()) );
+}
+
+auto LinuxGPIO::pwm_set_frequency(unsigned int gpio_pin, unsigned int freq) -> bool
+{
+	if (freq == 0) return false;
+	std::lock_guard<std::mutex> guard(fMutex);
+	fSoftPwm[gpio_pin].freq = freq;
+	return true;
+}
+
+auto LinuxGPIO::pwm_set_range(unsigned int gpio_pin, unsigned int range) -> bool
+{
+	if (range == 0) return false;
+	std::lock_guard<std::mutex> guard(fMutex);
+	fSoftPwm[gpio_pin].range = range;
+	return true;
+}
+
+auto LinuxGPIO::pwm_set_value(unsigned int gpio_pin, unsigned int value) -> bool
+{
+	SoftPwm settings { };
+	{
+		std::lock_guard<std::mutex> guard(fMutex);
+		settings = fSoftPwm[gpio_pin];
+	}
+	if (pwmChannel(gpio_pin) >= 0) {
+		// pins with a hardware pwm channel are served by it
+		const std::uint64_t duty { static_cast<std::uint64_t>(std::min(value, settings.range)) * hw_pwm_full_scale / settings.range };
+		return hw_pwm_set_value(gpio_pin, settings.freq, static_cast<std::uint32_t>(duty));
+	}
+	if (value == 0 || value >= settings.range) {
+		return ( set_gpio_direction(gpio_pin, true) && set_gpio_state(gpio_pin, value != 0) );
+	}
+	std::cerr<<"Error: no software pwm available on gpio "<<gpio_pin<<" with the linux gpio backend\n";
+	return false;
+}
+
+void LinuxGPIO::pwm_off(unsigned int gpio_pin)
+{
+	if (pwmChannel(gpio_pin) >= 0) {
+		std::lock_guard<std::mutex> guard(fMutex);
+		if (fPwmChannels[pwmChannel(gpio_pin)].dutyHandle < 0) return;
+	}
+	pwm_set_value(gpio_pin, 0);
+}
+
+auto LinuxGPIO::configureLine(unsigned int gpio_pin, Line& line) -> bool
+{
+	struct gpio_v2_line_config config;
+	std::memset(&config, 0, sizeof(config));
+	config.flags = (line.output) ? GPIO_V2_LINE_FLAG_OUTPUT : GPIO_V2_LINE_FLAG_INPUT;
+	if (!line.output && line.edges) config.flags |= GPIO_V2_LINE_FLAG_EDGE_RISING | GPIO_V2_LINE_FLAG_EDGE_FALLING;
+	switch (line.bias) {
+		case Bias::PullUp: config.flags |= GPIO_V2_LINE_FLAG_BIAS_PULL_UP; break;
+		case Bias::PullDown: config.flags |= GPIO_V2_LINE_FLAG_BIAS_PULL_DOWN; break;
+		default: config.flags |= GPIO_V2_LINE_FLAG_BIAS_DISABLED; break;
+	}
+	if (line.output) {
+		// keep the output level when (re-)configuring the line
+		config.num_attrs = 1;
+		config.attrs[0].attr.id = GPIO_V2_LINE_ATTR_ID_OUTPUT_VALUES;
+		config.attrs[0].attr.values = (line.state) ? 1 : 0;
+		config.attrs[0].mask = 1;
+	} else if (line.debounce_us > 0) {
+		config.num_attrs = 1;
+		config.attrs[0].attr.id = GPIO_V2_LINE_ATTR_ID_DEBOUNCE;
+		config.attrs[0].attr.debounce_period_us = line.debounce_us;
+		config.attrs[0].mask = 1;
+	}
+	if (line.handle >= 0) {
+		return ( ::ioctl(line.handle, GPIO_V2_LINE_SET_CONFIG_IOCTL, &config) >= 0 );
+	}
+	if (fChipHandle < 0) return false;
+	struct gpio_v2_line_request request;
+	std::memset(&request, 0, sizeof(request));
+	request.offsets[0] = gpio_pin;
+	request.num_lines = 1;
+	std::strncpy(request.consumer, consumer_name, sizeof(request.consumer) - 1);
+	request.config = config;
+	if (::ioctl(fChipHandle, GPIO_V2_GET_LINE_IOCTL, &request) < 0) {
+		std::cerr<<"Error requesting gpio line "<<gpio_pin<<": "<<std::strerror(errno)<<"\n";
+		return false;
+	}
+	line.handle = request.fd;
+	return true;
+}
+
+auto LinuxGPIO::set_gpio_direction(unsigned int gpio_pin, bool output) -> bool
+{
+	std::lock_guard<std::mutex> guard(fMutex);
+	Line& line { fLines[gpio_pin] };
+	if (line.handle >= 0 && line.output == output) return true;
+	line.output = output;
+	return configureLine(gpio_pin, line);
+}
+
+auto LinuxGPIO::set_gpio_state(unsigned int gpio_pin, bool state) -> bool
+{
+	std::lock_guard<std::mutex> guard(fMutex);
+	Line& line { fLines[gpio_pin] };
+	line.state = state;
+	if (line.handle < 0 || !line.output) {
+		// writing to an input switches the pin to output, as pigpio does
+		line.output = true;
+		return configureLine(gpio_pin, line);
+	}
+	struct gpio_v2_line_values values { (state) ? 1ULL : 0ULL, 1ULL };
+	return ( ::ioctl(line.handle, GPIO_V2_LINE_SET_VALUES_IOCTL, &values) >= 0 );
+}
+
+auto LinuxGPIO::get_gpio_state(unsigned int gpio_pin, bool* err) -> bool
+{
+	std::lock_guard<std::mutex> guard(fMutex);
+	Line& line { fLines[gpio_pin] };
+	bool ok { line.handle >= 0 || configureLine(gpio_pin, line) };
+	struct gpio_v2_line_values values { 0ULL, 1ULL };
+	if (ok) ok = ( ::ioctl(line.handle, GPIO_V2_LINE_GET_VALUES_IOCTL, &values) >= 0 );
+	if (err != nullptr) *err = !ok;
+	return ( ok && (values.bits & 1ULL) );
+}
+
+auto LinuxGPIO::set_gpio_pullup(unsigned int gpio_pin, bool pullup_enable) -> bool
+{
+	std::lock_guard<std::mutex> guard(fMutex);
+	Line& line { fLines[gpio_pin] };
+	line.bias = (pullup_enable) ? Bias::PullUp : Bias::Disabled;
+	return configureLine(gpio_pin, line);
+}
+
+auto LinuxGPIO::set_gpio_pulldown(unsigned int gpio_pin, bool pulldown_enable) -> bool
+{
+	std::lock_guard<std::mutex> guard(fMutex);
+	Line& line { fLines[gpio_pin] };
+	line.bias = (pulldown_enable) ? Bias::PullDown : Bias::Disabled;
+	return configureLine(gpio_pin, line);
+}
+
+auto LinuxGPIO::register_edge_callback(unsigned int gpio_pin, EdgeCallback callback) -> int
+{
+	if (!callback) return -1;
+	std::lock_guard<std::mutex> guard(fMutex);
+	Line& line { fLines[gpio_pin] };
+	if (line.handle < 0 || line.output || !line.edges) {
+		line.output = false;
+		line.edges = true;
+		if (!configureLine(gpio_pin, line)) return -1;
+	}
+	if (fEventThread == nullptr) {
+		fWakeupHandle = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+		if (fWakeupHandle < 0) {
+			std::cerr<<"Error creating gpio event notifier: "<<std::strerror(errno)<<"\n";
+			return -1;
+		}
+		fActiveLoop = true;
+		fEventThread = std::make_unique<std::thread>( [this]() { this->eventLoop(); } );
+	}
+	const int id { fNextCallbackId++ };
+	fEdgeCallbacks.emplace(id, std::make_pair(gpio_pin, std::move(callback)));
+	wakeEventLoop();
+	return id;
+}
+
+void LinuxGPIO::cancel_edge_callback(int callback_id)
+{
+	// wait for a callback which may be in progress
+	std::lock_guard<std::mutex> callback_lock(fCallbackMutex);
+	std::lock_guard<std::mutex> guard(fMutex);
+	auto it = fEdgeCallbacks.find(callback_id);
+	if (it == fEdgeCallbacks.end()) return;
+	const unsigned int gpio_pin { it->second.first };
+	fEdgeCallbacks.erase(it);
+	const bool pin_in_use { std::any_of(fEdgeCallbacks.begin(), fEdgeCallbacks.end(), [gpio_pin](const auto& item) { return item.second.first == gpio_pin; }) };
+	if (!pin_in_use) {
+		Line& line { fLines[gpio_pin] };
+		line.edges = false;
+		configureLine(gpio_pin, line);
+	}
+	wakeEventLoop();
+}
+
+auto LinuxGPIO::set_glitch_filter(unsigned int gpio_pin, unsigned int steady_us) -> bool
+{
+	std::lock_guard<std::mutex> guard(fMutex);
+	Line& line { fLines[gpio_pin] };
+	line.output = false;
+	line.debounce_us = steady_us;
+	return configureLine(gpio_pin, line);
+}
+
+void LinuxGPIO::wakeEventLoop()
+{
+	if (fWakeupHandle < 0) return;
+	const std::uint64_t one { 1 };
+	(void)::write(fWakeupHandle, &one, sizeof(one));
+}
+
+void LinuxGPIO::eventLoop()
+{
+	std::vector<struct pollfd> fds { };
+	std::vector<unsigned int> pins { };
+	struct gpio_v2_line_event events[16];
+	while (fActiveLoop) {
+		fds.assign(1, pollfd { fWakeupHandle, POLLIN, 0 });
+		pins.assign(1, 0);
+		{
+			std::lock_guard<std::mutex> guard(fMutex);
+			for (const auto& [pin, line]: fLines) {
+				if (!line.edges || line.handle < 0) continue;
+				fds.push_back(pollfd { line.handle, POLLIN, 0 });
+				pins.push_back(pin);
+			}
+		}
+		if (::poll(fds.data(), fds.size(), -1) < 0) {
+			if (errno == EINTR) continue;
+			std::cerr<<"Error waiting for gpio events: "<<std::strerror(errno)<<"\n";
+			return;
+		}
+		if (fds[0].revents & POLLIN) {
+			// the set of monitored lines changed, rebuild the poll list
+			std::uint64_t count { 0 };
+			(void)::read(fWakeupHandle, &count, sizeof(count));
+			continue;
+		}
+		for (std::size_t i = 1; i < fds.size(); i++) {
+			if (!(fds[i].revents & POLLIN)) continue;
+			const ssize_t res = ::read(fds[i].fd, events, sizeof(events));
+			if (res < static_cast<ssize_t>(sizeof(events[0]))) continue;
+			std::vector<EdgeCallback> callbacks { };
+			// the callback lock is taken before the callbacks are copied, so that a cancellation can wait for the delivery
+			std::lock_guard<std::mutex> callback_lock(fCallbackMutex);
+			{
+				std::lock_guard<std::mutex> guard(fMutex);
+				for (const auto& [id, item]: fEdgeCallbacks) {
+					if (item.first == pins[i]) callbacks.push_back(item.second);
+				}
+			}
+			for (std::size_t n = 0; n < res / sizeof(events[0]); n++) {
+				// event time stamps are taken from CLOCK_MONOTONIC, the clock underlying steady_clock
+				const std::chrono::steady_clock::time_point time { std::chrono::duration_cast<std::chrono::steady_clock::duration>( std::chrono::nanoseconds(events[n].timestamp_ns) ) };
+				const bool level { events[n].id == GPIO_V2_LINE_EVENT_RISING_EDGE };
+				for (const auto& callback: callbacks) callback(pins[i], level, time);
+			}
+		}
+	}
+}
+
+//} // namespace PiRaTe
@@ -0,0 +1,113 @@
+#ifndef GPIO_LINUX_H
+#define GPIO_LINUX_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <array>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <atomic>
+
+#include "gpioif.h"
+
+class SpiDev;
+
+// namespace PiRaTe {
+/**
+ * @brief GPIO backend using the native Linux kernel interfaces.
+ * GPIO pins are requested as lines from the GPIO character device (/dev/gpiochipN, uapi v2),
+ * the hardware PWM channels are driven through the sysfs PWM interface (/sys/class/pwm/pwmchipN)
+ * and SPI devices are accessed through the spidev driver (/dev/spidevX.Y, see {@link SpiDev}).
+ * No daemon is involved, so each access is a single system call.
+ * Edge events of input lines are read by a background thread and carry the kernel's time stamp of the edge.
+ * @note The kernel offers no software PWM. {@link LinuxGPIO::pwm_set_value} on pins without hardware PWM
+ * therefore only supports fully off (0) and fully on (>= range) and fails for intermediate values.
+ * @note The hardware PWM channels require the pwm-2chan overlay (dtoverlay=pwm-2chan,pin=12,func=4,pin2=13,func=4).
+ * @author HG Zaunick
+ */
+class LinuxGPIO : public GPIO {
+public:
+	/**
+	 * @brief The main constructor.
+	 * @param chip the GPIO character device
+	 * @param pwmchip the sysfs directory of the PWM controller
+	 */
+	LinuxGPIO(const std::string& chip = "/dev/gpiochip0", const std::string& pwmchip = "/sys/class/pwm/pwmchip0");
+	~LinuxGPIO() override;
+
+	[[nodiscard]] auto isInitialized() const -> bool override { return (fChipHandle>=0); }
+	[[nodiscard]] auto backendName() const -> std::string override { return "linux"; }
+
+	/**
+	 * @brief Open the spidev device of the given interface and chip select.
+	 * The main interface maps to /dev/spidev0.Y, the aux interface to /dev/spidev1.Y.
+	 */
+	[[nodiscard]] auto spi_init(SPI_INTERFACE interface, std::uint8_t channel, SPI_MODE mode, unsigned int baudrate, bool lsb_first = false, bool use_cs = true) -> int override;
+	[[nodiscard]] auto spi_read(unsigned int spi_handle, unsigned int nBytes) -> std::vector<std::uint8_t> override;
+	[[nodiscard]] auto spi_write(unsigned int spi_handle, const std::vector<std::uint8_t>& data) -> bool override;
+	void spi_close(int spi_handle) override;
+
+	auto pwm_set_frequency(unsigned int gpio_pin, unsigned int freq) -> bool override;
+	auto pwm_set_range(unsigned int gpio_pin, unsigned int range) -> bool override;
+	auto pwm_set_value(unsigned int gpio_pin, unsigned int value) -> bool override;
+	void pwm_off(unsigned int gpio_pin) override;
+	auto hw_pwm_set_value(unsigned int gpio_pin, unsigned int freq, std::uint32_t value) -> bool override;
+
+	auto set_gpio_direction(unsigned int gpio_pin, bool output) -> bool override;
+	auto set_gpio_state(unsigned int gpio_pin, bool state) -> bool override;
+	auto get_gpio_state(unsigned int gpio_pin, bool* err) -> bool override;
+	auto set_gpio_pullup(unsigned int gpio_pin, bool pullup_enable=true) -> bool override;
+	auto set_gpio_pulldown(unsigned int gpio_pin, bool pulldown_enable=true) -> bool override;
+
+	auto register_edge_callback(unsigned int gpio_pin, EdgeCallback callback) -> int override;
+	void cancel_edge_callback(int callback_id) override;
+	/// uses the debounce attribute of the line, which the kernel emulates if the chip lacks hardware debouncing
+	auto set_glitch_filter(unsigned int gpio_pin, unsigned int steady_us) -> bool override;
+
+private:
+	enum class Bias { Disabled, PullUp, PullDown };
+	struct Line {
+		int handle { -1 }; ///< file descriptor of the line request
+		bool output { false };
+		bool state { false }; ///< last written output state
+		Bias bias { Bias::Disabled };
+		bool edges { false }; ///< edge detection on both edges enabled
+		unsigned int debounce_us { 0 };
+	};
+	struct PwmChannel {
+		int dutyHandle { -1 }; ///< open file descriptor of the channel's duty_cycle attribute
+		std::uint64_t period_ns { 0 };
+	};
+	struct SoftPwm {
+		unsigned int range { 255 };
+		unsigned int freq { 800 };
+	};
+
+	/// request the line with its current configuration or apply the configuration to an already requested line
+	auto configureLine(unsigned int gpio_pin, Line& line) -> bool;
+	[[nodiscard]] static auto pwmChannel(unsigned int gpio_pin) -> int;
+	auto writeAttribute(const std::string& path, const std::string& value) -> bool;
+	void eventLoop();
+	void wakeEventLoop();
+
+	std::string fPwmChip { };
+	int fChipHandle { -1 };
+	std::map<unsigned int, Line> fLines { };
+	std::array<PwmChannel, 2> fPwmChannels { };
+	std::map<unsigned int, SoftPwm> fSoftPwm { };
+	std::map<int, std::shared_ptr<SpiDev>> fSpiDevs { };
+	int fNextSpiHandle { 0 };
+	std::map<int, std::pair<unsigned int, EdgeCallback>> fEdgeCallbacks { };
+	int fNextCallbackId { 0 };
+	int fWakeupHandle { -1 }; ///< eventfd to interrupt the event thread's poll
+	std::atomic<bool> fActiveLoop { false };
+	std::unique_ptr<std::thread> fEventThread { nullptr };
+	std::mutex fMutex;
+	std::mutex fCallbackMutex; ///< held while edge callbacks are executed
+};
+
+//} // namespace PiRaTe
+
+#endif
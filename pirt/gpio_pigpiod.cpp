@@ -0,0 +1,398 @@
+#include <iostream>
+#include <stdio.h>
+//#include <pigpio.h>
+
+//#include <stdint.h>
+#include <unistd.h>
+//#include <stdlib.h>
+//#include <getopt.h>
+#include <cstring>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+#include "gpio_pigpiod.h"
+
+extern "C" {
+#include <pigpiod_if2.h>
+}
+
+#define DEFAULT_VERBOSITY 1
+
+namespace {
+// maximum number of commands sent before the responses are collected,
+// keeps the pending responses well within the socket buffers
+constexpr std::size_t max_pipeline_depth { 64 };
+// a pigpiod socket command/response consists of four 32 bit words: cmd, p1, p2, p3 (p3 carries the result in responses)
+constexpr std::size_t pigpiod_message_size { 16 };
+
+auto sendAll(int socket, const std::uint8_t* data, std::size_t size) -> bool
+{
+	while (size > 0) {
+		const ssize_t res = ::send(socket, data, size, MSG_NOSIGNAL);
+		if (res <= 0) return false;
+		data += res;
+		size -= res;
+	}
+	return true;
+}
+
+auto receiveAll(int socket, std::uint8_t* data, std::size_t size) -> bool
+{
+	while (size > 0) {
+		const ssize_t res = ::recv(socket, data, size, MSG_WAITALL);
+		if (res <= 0) return false;
+		data += res;
+		size -= res;
+	}
+	return true;
+}
+
+void appendWord(std::vector<std::uint8_t>& buffer, std::uint32_t word)
+{
+	const auto* bytes = reinterpret_cast<const std::uint8_t*>(&word);
+	buffer.insert(buffer.end(), bytes, bytes + sizeof(word));
+}
+} // anonymous namespace
+
+// namespace PiRaTe {
+
+PigpiodGPIO::PigpiodGPIO(const std::string& host, const std::string& port) 
+{
+    if (fHandle<0) {
+		char* addrStr = const_cast<char*>(host.c_str());
+		char* portStr = const_cast<char*>(port.c_str());
+//		fHandle = pigpio_start((char*)"127.0.0.1", (char*)"8888");
+		fHandle = pigpio_start(addrStr, portStr);
+		if (fHandle < 0) {
+			std::cerr<<"Could not connect to pigpio daemon. Is pigpiod running?\n";
+			return;
+		}
+	}
+	if (!openPipe(host, port)) {
+		std::cerr<<"Could not open pipeline connection to pigpio daemon, commands are executed sequentially.\n";
+	}
+}
+
+
+PigpiodGPIO::~PigpiodGPIO() {
+	{
+		std::lock_guard<std::mutex> guard(fEdgeMutex);
+		for (auto& [id, handler]: fEdgeHandlers) ::callback_cancel(id);
+	}
+	closePipe();
+    if (fHandle>=0) {
+		pigpio_stop(fHandle);
+	}
+    fHandle = -1;
+	// the callback thread is stopped now, no handler can be entered any more
+	std::lock_guard<std::mutex> guard(fEdgeMutex);
+	fEdgeHandlers.clear();
+	fCancelledHandlers.clear();
+}
+
+
+auto PigpiodGPIO::spi_init(SPI_INTERFACE interface, std::uint8_t channel, SPI_MODE mode, unsigned int baudrate, bool lsb_first, bool use_cs) -> int
+{
+	unsigned int spi_flags = static_cast<unsigned int>(mode) | (static_cast<unsigned int>(lsb_first) << 15);
+	if (interface == SPI_INTERFACE::Aux) {
+		spi_flags |= 1 << 8;
+		//std::cout<<"spi flags: "<<spi_flags<<"\n";
+	}
+	if (!use_cs) {
+		spi_flags |= 0b111 << 5;
+	}
+	int handle = ::spi_open(fHandle, channel, baudrate, spi_flags);
+	if (handle < 0) {
+		std::cerr<<"Error opening spi interface.\n";
+	}
+	return handle;
+}
+
+auto PigpiodGPIO::spi_read(unsigned int spi_handle, unsigned int nBytes) -> std::vector<std::uint8_t>
+{
+	char rx_buffer[nBytes];
+	std::lock_guard<std::mutex> guard(fMutex);
+	int count = ::spi_read(fHandle, spi_handle, rx_buffer, nBytes);
+	if (count<=0) return std::vector<std::uint8_t> {};
+	std::vector<std::uint8_t> data(rx_buffer,rx_buffer+std::min(static_cast<unsigned int>(count),nBytes));
+	return data;
+}
+
+auto PigpiodGPIO::spi_read_multi(const std::vector<unsigned int>& spi_handles, unsigned int nBytes) -> std::vector<std::vector<std::uint8_t>>
+{
+	std::vector<std::vector<std::uint8_t>> result( spi_handles.size() );
+	std::size_t first { 0 };
+	std::unique_lock<std::mutex> pipe_lock(fPipeMutex);
+	if (fPipeSocket >= 0) {
+		std::vector<std::uint8_t> request { };
+		std::uint8_t header[pigpiod_message_size];
+		for ( ; first < spi_handles.size(); first += max_pipeline_depth) {
+			const std::size_t last { std::min(first + max_pipeline_depth, spi_handles.size()) };
+			request.clear();
+			for (std::size_t i = first; i < last; i++) {
+				appendWord(request, PI_CMD_SPIR);
+				appendWord(request, spi_handles[i]);
+				appendWord(request, nBytes);
+				appendWord(request, 0);
+			}
+			// all requests are sent before the first reply is awaited, so that the daemon
+			// executes the transfers one after the other without a round trip in between
+			bool ok { sendAll(fPipeSocket, request.data(), request.size()) };
+			for (std::size_t i = first; ok && i < last; i++) {
+				ok = receiveAll(fPipeSocket, header, sizeof(header));
+				if (!ok) break;
+				std::int32_t count { 0 };
+				std::memcpy(&count, header + 3 * sizeof(std::uint32_t), sizeof(count));
+				if (count <= 0) {
+					result[i].clear();
+					continue;
+				}
+				// the reply carries the received bytes as extension
+				result[i].resize(count);
+				ok = receiveAll(fPipeSocket, result[i].data(), result[i].size());
+				if (result[i].size() > nBytes) result[i].resize(nBytes);
+			}
+			if (!ok) {
+				std::cerr<<"Error on pipeline connection to pigpio daemon, falling back to sequential SPI reads.\n";
+				closePipe();
+				break;
+			}
+		}
+	}
+	pipe_lock.unlock();
+	if (first >= spi_handles.size()) return result;
+
+	char rx_buffer[nBytes];
+	std::lock_guard<std::mutex> guard(fMutex);
+	for ( std::size_t i = first; i < spi_handles.size(); i++ ) {
+		result[i].clear();
+		int count = ::spi_read(fHandle, spi_handles[i], rx_buffer, nBytes);
+		if (count<=0) continue;
+		result[i].assign(rx_buffer, rx_buffer+std::min(static_cast<unsigned int>(count),nBytes));
+	}
+	return result;
+}
+
+auto PigpiodGPIO::spi_write(unsigned int spi_handle, const std::vector<std::uint8_t>& data) -> bool
+{
+	unsigned int nBytes = data.size();
+	char tx_buffer[nBytes];
+	std::copy(data.begin(), data.end(), tx_buffer);
+	std::lock_guard<std::mutex> guard(fMutex);
+	int count = ::spi_write(fHandle, spi_handle, tx_buffer, nBytes);
+	return (count == static_cast<int>(nBytes));
+}
+
+void PigpiodGPIO::spi_close(int spi_handle)
+{
+	::spi_close(fHandle, spi_handle);
+}
+
+auto PigpiodGPIO::pwm_set_frequency(unsigned int gpio_pin, unsigned int freq) -> bool {
+	int res = ::set_PWM_frequency(fHandle, gpio_pin, freq);
+	return (res >= 0);
+}
+
+auto PigpiodGPIO::pwm_set_range(unsigned int gpio_pin, unsigned int range) -> bool {
+	int res = ::set_PWM_range(fHandle, gpio_pin, range);
+	return (res == 0);
+}
+
+auto PigpiodGPIO::pwm_set_value(unsigned int gpio_pin, unsigned int value) -> bool {
+	int res = ::set_PWM_dutycycle(fHandle, gpio_pin, value);
+	return (res == 0);
+}
+
+void PigpiodGPIO::pwm_off(unsigned int gpio_pin) {
+	::set_PWM_dutycycle(fHandle, gpio_pin, 0);
+}
+
+auto PigpiodGPIO::hw_pwm_set_value(unsigned int gpio_pin, unsigned int freq, std::uint32_t value) -> bool {
+	int res = ::hardware_PWM(fHandle, gpio_pin, freq, value);
+	return (res == 0);
+}
+
+auto PigpiodGPIO::set_gpio_direction(unsigned int gpio_pin, bool output) -> bool {
+	int res = ::set_mode(fHandle, gpio_pin, (output) ? PI_OUTPUT : PI_INPUT );
+	return (res == 0);
+}
+
+auto PigpiodGPIO::set_gpio_state(unsigned int gpio_pin, bool state) -> bool {
+	int res = ::gpio_write(fHandle, gpio_pin, (state) ? 1U : 0U );
+	return (res == 0);
+}
+
+auto PigpiodGPIO::get_gpio_state(unsigned int gpio_pin, bool* err) -> bool {
+	int res = ::gpio_read(fHandle, gpio_pin);
+	if (err != nullptr) *err = (res < 0);
+	return (res > 0);
+}
+
+auto PigpiodGPIO::set_gpio_pullup(unsigned int gpio_pin, bool pullup_enable) -> bool {
+	int res = ::set_pull_up_down(fHandle, gpio_pin, (pullup_enable) ? PI_PUD_UP : PI_PUD_OFF);
+	return (res == 0);
+}
+
+auto PigpiodGPIO::set_gpio_pulldown(unsigned int gpio_pin, bool pulldown_enable) -> bool {
+	int res = ::set_pull_up_down(fHandle, gpio_pin, (pulldown_enable) ? PI_PUD_DOWN : PI_PUD_OFF);
+	return (res == 0);
+}
+
+auto PigpiodGPIO::openPipe(const std::string& host, const std::string& port) -> bool
+{
+	struct addrinfo hints;
+	std::memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+	struct addrinfo* addresses { nullptr };
+	if (::getaddrinfo(host.c_str(), port.c_str(), &hints, &addresses) != 0) return false;
+	for (struct addrinfo* addr = addresses; addr != nullptr; addr = addr->ai_next) {
+		int sock = ::socket(addr->ai_family, addr->ai_socktype | SOCK_CLOEXEC, addr->ai_protocol);
+		if (sock < 0) continue;
+		if (::connect(sock, addr->ai_addr, addr->ai_addrlen) == 0) {
+			int flag = 1;
+			::setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+			fPipeSocket = sock;
+			break;
+		}
+		::close(sock);
+	}
+	::freeaddrinfo(addresses);
+	return (fPipeSocket >= 0);
+}
+
+void PigpiodGPIO::closePipe()
+{
+	if (fPipeSocket >= 0) ::close(fPipeSocket);
+	fPipeSocket = -1;
+}
+
+void PigpiodGPIO::execute(std::vector<Command>& commands)
+{
+	std::unique_lock<std::mutex> lock(fPipeMutex);
+	if (fPipeSocket < 0) {
+		lock.unlock();
+		GPIO::execute(commands);
+		return;
+	}
+	std::vector<std::uint8_t> request { };
+	std::vector<std::uint8_t> response { };
+	for (std::size_t first = 0; first < commands.size(); first += max_pipeline_depth) {
+		const std::size_t last { std::min(first + max_pipeline_depth, commands.size()) };
+		request.clear();
+		for (std::size_t i = first; i < last; i++) {
+			const Command& cmd { commands[i] };
+			std::uint32_t code { 0 };
+			std::uint32_t p2 { cmd.arg };
+			switch (cmd.type) {
+				case Command::Type::SetDirection: code = PI_CMD_MODES; p2 = (cmd.arg) ? PI_OUTPUT : PI_INPUT; break;
+				case Command::Type::SetState: code = PI_CMD_WRITE; p2 = (cmd.arg) ? 1U : 0U; break;
+				case Command::Type::GetState: code = PI_CMD_READ; p2 = 0; break;
+				case Command::Type::SetPullUp: code = PI_CMD_PUD; p2 = (cmd.arg) ? PI_PUD_UP : PI_PUD_OFF; break;
+				case Command::Type::SetPullDown: code = PI_CMD_PUD; p2 = (cmd.arg) ? PI_PUD_DOWN : PI_PUD_OFF; break;
+				case Command::Type::PwmFrequency: code = PI_CMD_PFS; break;
+				case Command::Type::PwmRange: code = PI_CMD_PRS; break;
+				case Command::Type::PwmValue: code = PI_CMD_PWM; break;
+				case Command::Type::HwPwmValue: code = PI_CMD_HP; break;
+			}
+			appendWord(request, code);
+			appendWord(request, cmd.gpio_pin);
+			appendWord(request, p2);
+			if (cmd.type == Command::Type::HwPwmValue) {
+				// the duty cycle is sent as 4 byte extension
+				appendWord(request, sizeof(std::uint32_t));
+				appendWord(request, cmd.duty);
+			} else {
+				appendWord(request, 0);
+			}
+		}
+		response.resize( (last - first) * pigpiod_message_size );
+		if ( !sendAll(fPipeSocket, request.data(), request.size())
+			|| !receiveAll(fPipeSocket, response.data(), response.size()) )
+		{
+			std::cerr<<"Error on pipeline connection to pigpio daemon, falling back to sequential commands.\n";
+			closePipe();
+			lock.unlock();
+			std::vector<Command> remaining(commands.begin() + first, commands.end());
+			GPIO::execute(remaining);
+			std::copy(remaining.begin(), remaining.end(), commands.begin() + first);
+			return;
+		}
+		for (std::size_t i = first; i < last; i++) {
+			std::int32_t res { 0 };
+			std::memcpy(&res, response.data() + (i - first) * pigpiod_message_size + 3 * sizeof(std::uint32_t), sizeof(res));
+			if (res < 0) commands[i].result = -1;
+			else commands[i].result = (commands[i].type == Command::Type::GetState) ? static_cast<int>(res > 0) : 0;
+		}
+	}
+}
+
+auto PigpiodGPIO::register_edge_callback(unsigned int gpio_pin, EdgeCallback callback) -> int
+{
+	if (fHandle < 0 || !callback) return -1;
+	std::unique_ptr<EdgeHandler> handler { new EdgeHandler { this, std::move(callback) } };
+	std::lock_guard<std::mutex> guard(fEdgeMutex);
+	if (fEdgeHandlers.empty()) {
+		const std::uint32_t tick { ::get_current_tick(fHandle) };
+		std::lock_guard<std::mutex> dispatch_lock(fDispatchMutex);
+		fTickReference = tick;
+		fTimeReference = std::chrono::steady_clock::now();
+	}
+	const int id = ::callback_ex(fHandle, gpio_pin, EITHER_EDGE, &PigpiodGPIO::edgeHandler, handler.get());
+	if (id < 0) {
+		std::cerr<<"Error registering edge callback for gpio "<<gpio_pin<<"\n";
+		return -1;
+	}
+	fEdgeHandlers.emplace(id, std::move(handler));
+	return id;
+}
+
+void PigpiodGPIO::cancel_edge_callback(int callback_id)
+{
+	std::lock_guard<std::mutex> guard(fEdgeMutex);
+	auto it = fEdgeHandlers.find(callback_id);
+	if (it == fEdgeHandlers.end()) return;
+	::callback_cancel(callback_id);
+	{
+		// a callback in progress has returned once the lock is taken, later dispatches are dropped
+		std::lock_guard<std::mutex> dispatch_lock(fDispatchMutex);
+		it->second->active = false;
+	}
+	// the dispatch thread of pigpiod_if2 may still have picked up the pointer, it is freed on destruction
+	fCancelledHandlers.emplace_back( std::move(it->second) );
+	fEdgeHandlers.erase(it);
+}
+
+auto PigpiodGPIO::set_glitch_filter(unsigned int gpio_pin, unsigned int steady_us) -> bool
+{
+	int res = ::set_glitch_filter(fHandle, gpio_pin, steady_us);
+	return (res == 0);
+}
+
+void PigpiodGPIO::edgeHandler(int /*pi*/, unsigned int gpio_pin, unsigned int level, std::uint32_t tick, void* userdata)
+{
+	// level 2 signals a watchdog timeout, not an edge
+	if (level > 1 || userdata == nullptr) return;
+	EdgeHandler* handler { static_cast<EdgeHandler*>(userdata) };
+	std::lock_guard<std::mutex> dispatch_lock(handler->gpio->fDispatchMutex);
+	if (!handler->active) return;
+	handler->callback(gpio_pin, level == 1, handler->gpio->tickToTime(tick));
+}
+
+// called with fDispatchMutex held
+auto PigpiodGPIO::tickToTime(std::uint32_t tick) -> std::chrono::steady_clock::time_point
+{
+	const auto now { std::chrono::steady_clock::now() };
+	auto time { fTimeReference + std::chrono::microseconds( static_cast<std::uint32_t>(tick - fTickReference) ) };
+	if (time > now || now - time > std::chrono::minutes(1)) {
+		// the tick wrapped around or the reference is stale, the edge was reported just now
+		time = now;
+	}
+	fTickReference = tick;
+	fTimeReference = time;
+	return time;
+}
+
+//} // namespace PiRaTe
@@ -0,0 +1,99 @@
+#ifndef GPIO_PIGPIOD_H
+#define GPIO_PIGPIOD_H
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <map>
+#include <memory>
+#include <chrono>
+
+#include "gpioif.h"
+
+// namespace PiRaTe {
+/**
+ * @brief GPIO backend based on the pigpiod daemon.
+ * @note The class will connect via TCP socket to a running instance of the pigpiod daemon with 
+ * the network address and port as constructor arguments.
+ * @author HG Zaunick
+ */
+class PigpiodGPIO : public GPIO {
+public:
+	PigpiodGPIO() = delete;
+	PigpiodGPIO(const std::string& host, const std::string& port = "8888");
+	~PigpiodGPIO() override;
+
+	[[nodiscard]] auto isInitialized() const -> bool override { return (fHandle>=0); }
+	[[nodiscard]] auto backendName() const -> std::string override { return "pigpiod"; }
+	[[nodiscard]] auto handle() const -> int { return fHandle; }
+
+	[[nodiscard]] auto spi_init(SPI_INTERFACE interface, std::uint8_t channel, SPI_MODE mode, unsigned int baudrate, bool lsb_first = false, bool use_cs = true) -> int override;
+	[[nodiscard]] auto spi_read(unsigned int spi_handle, unsigned int nBytes) -> std::vector<std::uint8_t> override;
+	/**
+	 * @brief Read from several SPI devices in one go.
+	 * The read requests of all devices are sent at once over the pipeline connection and the replies
+	 * are collected afterwards, so that the transfers follow each other without a network round trip
+	 * in between. Without pipeline connection the reads are issued sequentially under one lock.
+	 */
+	[[nodiscard]] auto spi_read_multi(const std::vector<unsigned int>& spi_handles, unsigned int nBytes) -> std::vector<std::vector<std::uint8_t>> override;
+	[[nodiscard]] auto spi_write(unsigned int spi_handle, const std::vector<std::uint8_t>& data) -> bool override;
+	void spi_close(int spi_handle) override;
+
+	auto pwm_set_frequency(unsigned int gpio_pin, unsigned int freq) -> bool override;
+	auto pwm_set_range(unsigned int gpio_pin, unsigned int range) -> bool override;
+	auto pwm_set_value(unsigned int gpio_pin, unsigned int value) -> bool override;
+	void pwm_off(unsigned int gpio_pin) override;
+	auto hw_pwm_set_value(unsigned int gpio_pin, unsigned int freq, std::uint32_t value) -> bool override;
+
+	auto set_gpio_direction(unsigned int gpio_pin, bool output) -> bool override;
+	auto set_gpio_state(unsigned int gpio_pin, bool state) -> bool override;
+	auto get_gpio_state(unsigned int gpio_pin, bool* err) -> bool override;
+	auto set_gpio_pullup(unsigned int gpio_pin, bool pullup_enable=true) -> bool override;
+	auto set_gpio_pulldown(unsigned int gpio_pin, bool pulldown_enable=true) -> bool override;
+
+	/**
+	 * @brief Execute a batch of commands pipelined over a dedicated socket to the daemon.
+	 * All requests of the batch are sent before the responses are collected, so that the whole
+	 * batch costs a single network round trip instead of one per command.
+	 * Falls back to sequential execution if the pipeline connection is not available.
+	 */
+	void execute(std::vector<Command>& commands) override;
+	/// true if the pipeline connection to the daemon is established
+	[[nodiscard]] auto isPipelined() const -> bool { return (fPipeSocket>=0); }
+
+	/**
+	 * @brief Register a pigpio callback for both edges of the pin.
+	 * The edge times are derived from the daemon's microsecond tick of the level change.
+	 */
+	auto register_edge_callback(unsigned int gpio_pin, EdgeCallback callback) -> int override;
+	void cancel_edge_callback(int callback_id) override;
+	auto set_glitch_filter(unsigned int gpio_pin, unsigned int steady_us) -> bool override;
+protected:
+	struct EdgeHandler {
+		PigpiodGPIO* gpio { nullptr };
+		EdgeCallback callback { };
+		bool active { true }; ///< cleared on cancellation, protected by fDispatchMutex
+	};
+	static void edgeHandler(int pi, unsigned int gpio_pin, unsigned int level, std::uint32_t tick, void* userdata);
+	/// convert a pigpio tick (us, wrapping after 72 min) to a steady_clock time
+	auto tickToTime(std::uint32_t tick) -> std::chrono::steady_clock::time_point;
+
+	auto openPipe(const std::string& host, const std::string& port) -> bool;
+	void closePipe();
+
+	int fHandle { -1 };
+	std::mutex fMutex;
+	int fPipeSocket { -1 }; ///< raw socket to the daemon for pipelined command batches
+	std::mutex fPipeMutex;
+	std::map<int, std::unique_ptr<EdgeHandler>> fEdgeHandlers { };
+	/// cancelled handlers, kept until the callback thread of pigpiod_if2 is stopped, since it may still hold a pointer
+	std::vector<std::unique_ptr<EdgeHandler>> fCancelledHandlers { };
+	std::mutex fEdgeMutex;
+	std::mutex fDispatchMutex; ///< held while a callback is executed, protects the tick reference
+	std::uint32_t fTickReference { 0 };
+	std::chrono::steady_clock::time_point fTimeReference { };
+};
+
+//} // namespace PiRaTe
+
+#endif
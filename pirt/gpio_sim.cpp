@@ -0,0 +1,247 @@
+#include <algorithm>
+
+#include "gpio_sim.h"
+
+// namespace PiRaTe {
+
+auto SimGPIO::PinState::dutyCycle() const -> double
+{
+	if (hwPwmFrequency > 0) return std::min(hwPwmValue, 1000000U) / 1e6;
+	if (pwmRange == 0) return 0.;
+	return std::min(pwmValue, pwmRange) / static_cast<double>(pwmRange);
+}
+
+auto SimGPIO::spi_init(SPI_INTERFACE interface, std::uint8_t channel, SPI_MODE /*mode*/, unsigned int /*baudrate*/, bool /*lsb_first*/, bool /*use_cs*/) -> int
+{
+	std::lock_guard<std::mutex> guard(fMutex);
+	const int handle { fNextSpiHandle++ };
+	fSpiHandles.emplace(handle, SpiDevice { interface, channel });
+	return handle;
+}
+
+auto SimGPIO::spi_read(unsigned int spi_handle, unsigned int nBytes) -> std::vector<std::uint8_t>
+{
+	SpiResponder responder { };
+	{
+		std::lock_guard<std::mutex> guard(fMutex);
+		auto it = fSpiHandles.find(static_cast<int>(spi_handle));
+		if (it == fSpiHandles.end()) return std::vector<std::uint8_t> {};
+		fSpiReads++;
+		auto responder_it = fSpiResponders.find(it->second);
+		if (responder_it != fSpiResponders.end()) responder = responder_it->second;
+	}
+	// the responder is called without holding the lock, so that it may access the simulated pins
+	std::vector<std::uint8_t> data { (responder) ? responder(nBytes) : std::vector<std::uint8_t>(nBytes, 0) };
+	data.resize(nBytes, 0);
+	return data;
+}
+
+auto SimGPIO::spi_write(unsigned int spi_handle, const std::vector<std::uint8_t>& data) -> bool
+{
+	std::lock_guard<std::mutex> guard(fMutex);
+	auto it = fSpiHandles.find(static_cast<int>(spi_handle));
+	if (it == fSpiHandles.end()) return false;
+	std::vector<std::uint8_t>& written { fSpiWritten[it->second] };
+	written.insert(written.end(), data.begin(), data.end());
+	return true;
+}
+
+void SimGPIO::spi_close(int spi_handle)
+{
+	std::lock_guard<std::mutex> guard(fMutex);
+	fSpiHandles.erase(spi_handle);
+}
+
+auto SimGPIO::pwm_set_frequency(unsigned int gpio_pin, unsigned int freq) -> bool
+{
+	if (freq == 0) return false;
+	{
+		std::lock_guard<std::mutex> guard(fMutex);
+		fPins[gpio_pin].pwmFrequency = freq;
+	}
+	notify(gpio_pin);
+	return true;
+}
+
+auto SimGPIO::pwm_set_range(unsigned int gpio_pin, unsigned int range) -> bool
+{
+	if (range == 0) return false;
+	{
+		std::lock_guard<std::mutex> guard(fMutex);
+		fPins[gpio_pin].pwmRange = range;
+	}
+	notify(gpio_pin);
+	return true;
+}
+
+auto SimGPIO::pwm_set_value(unsigned int gpio_pin, unsigned int value) -> bool
+{
+	{
+		std::lock_guard<std::mutex> guard(fMutex);
+		PinState& pin { fPins[gpio_pin] };
+		pin.output = true;
+		pin.pwmValue = std::min(value, pin.pwmRange);
+		pin.hwPwmFrequency = 0;
+	}
+	notify(gpio_pin);
+	return true;
+}
+
+void SimGPIO::pwm_off(unsigned int gpio_pin)
+{
+	pwm_set_value(gpio_pin, 0);
+}
+
+auto SimGPIO::hw_pwm_set_value(unsigned int gpio_pin, unsigned int freq, std::uint32_t value) -> bool
+{
+	if (gpio_pin != 12 && gpio_pin != 13 && gpio_pin != 18 && gpio_pin != 19) return false;
+	{
+		std::lock_guard<std::mutex> guard(fMutex);
+		PinState& pin { fPins[gpio_pin] };
+		pin.output = true;
+		pin.hwPwmFrequency = freq;
+		pin.hwPwmValue = std::min(value, 1000000U);
+	}
+	notify(gpio_pin);
+	return true;
+}
+
+auto SimGPIO::set_gpio_direction(unsigned int gpio_pin, bool output) -> bool
+{
+	{
+		std::lock_guard<std::mutex> guard(fMutex);
+		fPins[gpio_pin].output = output;
+	}
+	notify(gpio_pin);
+	return true;
+}
+
+auto SimGPIO::set_gpio_state(unsigned int gpio_pin, bool state) -> bool
+{
+	{
+		std::lock_guard<std::mutex> guard(fMutex);
+		PinState& pin { fPins[gpio_pin] };
+		pin.output = true;
+		pin.state = state;
+		pin.pwmValue = 0;
+		pin.hwPwmFrequency = 0;
+	}
+	notify(gpio_pin);
+	return true;
+}
+
+auto SimGPIO::get_gpio_state(unsigned int gpio_pin, bool* err) -> bool
+{
+	if (err != nullptr) *err = false;
+	std::lock_guard<std::mutex> guard(fMutex);
+	const PinState& pin { fPins[gpio_pin] };
+	if (pin.output) return pin.state;
+	auto it = fInputs.find(gpio_pin);
+	if (it != fInputs.end() && it->second.lastChange != std::chrono::steady_clock::time_point { }) return it->second.state;
+	return pin.pullup;
+}
+
+auto SimGPIO::set_gpio_pullup(unsigned int gpio_pin, bool pullup_enable) -> bool
+{
+	std::lock_guard<std::mutex> guard(fMutex);
+	PinState& pin { fPins[gpio_pin] };
+	pin.pullup = pullup_enable;
+	if (pullup_enable) pin.pulldown = false;
+	return true;
+}
+
+auto SimGPIO::set_gpio_pulldown(unsigned int gpio_pin, bool pulldown_enable) -> bool
+{
+	std::lock_guard<std::mutex> guard(fMutex);
+	PinState& pin { fPins[gpio_pin] };
+	pin.pulldown = pulldown_enable;
+	if (pulldown_enable) pin.pullup = false;
+	return true;
+}
+
+void SimGPIO::setSpiResponder(SPI_INTERFACE interface, std::uint8_t channel, SpiResponder responder)
+{
+	std::lock_guard<std::mutex> guard(fMutex);
+	fSpiResponders[SpiDevice { interface, channel }] = std::move(responder);
+}
+
+void SimGPIO::setInput(unsigned int gpio_pin, bool state, std::chrono::steady_clock::time_point time)
+{
+	std::vector<EdgeCallback> callbacks { };
+	// the callback lock is taken before the callbacks are copied, so that a cancellation can wait for the delivery
+	std::lock_guard<std::mutex> callback_lock(fCallbackMutex);
+	{
+		std::lock_guard<std::mutex> guard(fMutex);
+		Input& input { fInputs[gpio_pin] };
+		const bool previous { (input.lastChange != std::chrono::steady_clock::time_point { }) ? input.state : fPins[gpio_pin].pullup };
+		if (previous == state && input.lastChange != std::chrono::steady_clock::time_point { }) return;
+		input.state = state;
+		input.lastChange = time;
+		if (previous == state || fPins[gpio_pin].output) return;
+		for (const auto& [id, item]: fEdgeCallbacks) {
+			if (item.first == gpio_pin) callbacks.push_back(item.second);
+		}
+	}
+	for (const auto& callback: callbacks) callback(gpio_pin, state, time);
+}
+
+auto SimGPIO::register_edge_callback(unsigned int gpio_pin, EdgeCallback callback) -> int
+{
+	if (!callback) return -1;
+	std::lock_guard<std::mutex> guard(fMutex);
+	const int id { fNextCallbackId++ };
+	fEdgeCallbacks.emplace(id, std::make_pair(gpio_pin, std::move(callback)));
+	return id;
+}
+
+void SimGPIO::cancel_edge_callback(int callback_id)
+{
+	// wait for a callback which may be in progress
+	std::lock_guard<std::mutex> callback_lock(fCallbackMutex);
+	std::lock_guard<std::mutex> guard(fMutex);
+	fEdgeCallbacks.erase(callback_id);
+}
+
+
+void SimGPIO::setOutputCallback(OutputCallback callback)
+{
+	std::lock_guard<std::mutex> guard(fMutex);
+	fOutputCallback = std::move(callback);
+}
+
+auto SimGPIO::pin(unsigned int gpio_pin) const -> PinState
+{
+	std::lock_guard<std::mutex> guard(fMutex);
+	auto it = fPins.find(gpio_pin);
+	if (it == fPins.end()) return PinState { };
+	return it->second;
+}
+
+auto SimGPIO::spiWritten(SPI_INTERFACE interface, std::uint8_t channel) const -> std::vector<std::uint8_t>
+{
+	std::lock_guard<std::mutex> guard(fMutex);
+	auto it = fSpiWritten.find(SpiDevice { interface, channel });
+	if (it == fSpiWritten.end()) return std::vector<std::uint8_t> {};
+	return it->second;
+}
+
+auto SimGPIO::spiReadCount() const -> unsigned long
+{
+	std::lock_guard<std::mutex> guard(fMutex);
+	return fSpiReads;
+}
+
+void SimGPIO::notify(unsigned int gpio_pin)
+{
+	OutputCallback callback { };
+	PinState state { };
+	{
+		std::lock_guard<std::mutex> guard(fMutex);
+		if (!fOutputCallback) return;
+		callback = fOutputCallback;
+		state = fPins[gpio_pin];
+	}
+	callback(gpio_pin, state);
+}
+
+//} // namespace PiRaTe
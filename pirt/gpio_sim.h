@@ -0,0 +1,114 @@
+#ifndef GPIO_SIM_H
+#define GPIO_SIM_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <functional>
+#include <mutex>
+
+#include "gpioif.h"
+
+// namespace PiRaTe {
+/**
+ * @brief Deterministic in-memory GPIO backend for running the driver without hardware.
+ * All pin, PWM and SPI accesses operate on an internal state which can be inspected and scripted:
+ * the levels of input pins are injected with {@link SimGPIO::setInput}, the data returned by SPI reads
+ * is supplied by a responder function per SPI device and changes of outputs are reported through
+ * an optional callback. No time-dependent or random behaviour is involved, so identical call sequences
+ * yield identical results.
+ * @author HG Zaunick
+ */
+class SimGPIO : public GPIO {
+public:
+	/**
+	 * @brief State of a simulated GPIO pin.
+	 */
+	struct PinState {
+		bool output { false }; ///< pin is configured as output
+		bool state { false }; ///< current logic level
+		bool pullup { false };
+		bool pulldown { false };
+		unsigned int pwmRange { 255 }; ///< range of the software PWM
+		unsigned int pwmFrequency { 800 }; ///< frequency of the software PWM in Hz
+		unsigned int pwmValue { 0 }; ///< duty cycle value of the software PWM (0...range)
+		unsigned int hwPwmFrequency { 0 }; ///< frequency of the hardware PWM in Hz, 0 if not in use
+		std::uint32_t hwPwmValue { 0 }; ///< duty cycle of the hardware PWM in parts per million
+		/// the effective duty cycle (0...1) of the active PWM output
+		[[nodiscard]] auto dutyCycle() const -> double;
+	};
+	/// supplies the bytes returned by an SPI read of nBytes
+	using SpiResponder = std::function<std::vector<std::uint8_t>(unsigned int nBytes)>;
+	/// called after an output level or PWM setting of a pin changed
+	using OutputCallback = std::function<void(unsigned int gpio_pin, const PinState& state)>;
+
+	SimGPIO() = default;
+	~SimGPIO() override = default;
+
+	[[nodiscard]] auto isInitialized() const -> bool override { return true; }
+	[[nodiscard]] auto backendName() const -> std::string override { return "sim"; }
+
+	[[nodiscard]] auto spi_init(SPI_INTERFACE interface, std::uint8_t channel, SPI_MODE mode, unsigned int baudrate, bool lsb_first = false, bool use_cs = true) -> int override;
+	/// returns the responder's data for the device, zeros if no responder is set
+	[[nodiscard]] auto spi_read(unsigned int spi_handle, unsigned int nBytes) -> std::vector<std::uint8_t> override;
+	[[nodiscard]] auto spi_write(unsigned int spi_handle, const std::vector<std::uint8_t>& data) -> bool override;
+	void spi_close(int spi_handle) override;
+
+	auto pwm_set_frequency(unsigned int gpio_pin, unsigned int freq) -> bool override;
+	auto pwm_set_range(unsigned int gpio_pin, unsigned int range) -> bool override;
+	auto pwm_set_value(unsigned int gpio_pin, unsigned int value) -> bool override;
+	void pwm_off(unsigned int gpio_pin) override;
+	auto hw_pwm_set_value(unsigned int gpio_pin, unsigned int freq, std::uint32_t value) -> bool override;
+
+	auto set_gpio_direction(unsigned int gpio_pin, bool output) -> bool override;
+	auto set_gpio_state(unsigned int gpio_pin, bool state) -> bool override;
+	/// returns the injected level of inputs (or the level of the pull resistor) and the driven level of outputs
+	auto get_gpio_state(unsigned int gpio_pin, bool* err) -> bool override;
+	auto set_gpio_pullup(unsigned int gpio_pin, bool pullup_enable=true) -> bool override;
+	auto set_gpio_pulldown(unsigned int gpio_pin, bool pulldown_enable=true) -> bool override;
+
+	/// edge callbacks are invoked synchronously by {@link SimGPIO::setInput}, no glitch filter is simulated
+	auto register_edge_callback(unsigned int gpio_pin, EdgeCallback callback) -> int override;
+	void cancel_edge_callback(int callback_id) override;
+
+	/**
+	 * @brief Set the data source of an SPI device.
+	 * The responder applies to devices opened before and after the call.
+	 */
+	void setSpiResponder(SPI_INTERFACE interface, std::uint8_t channel, SpiResponder responder);
+	/**
+	 * @brief Inject the external level of an input pin.
+	 * @param time the time of the level change reported to edge callbacks
+	 */
+	void setInput(unsigned int gpio_pin, bool state, std::chrono::steady_clock::time_point time = std::chrono::steady_clock::now());
+	void setOutputCallback(OutputCallback callback);
+	[[nodiscard]] auto pin(unsigned int gpio_pin) const -> PinState;
+	/// data written to the SPI device so far
+	[[nodiscard]] auto spiWritten(SPI_INTERFACE interface, std::uint8_t channel) const -> std::vector<std::uint8_t>;
+	[[nodiscard]] auto spiReadCount() const -> unsigned long;
+
+private:
+	using SpiDevice = std::pair<SPI_INTERFACE, std::uint8_t>;
+	void notify(unsigned int gpio_pin);
+
+	std::map<unsigned int, PinState> fPins { };
+	struct Input {
+		bool state { false };
+		std::chrono::steady_clock::time_point lastChange { }; ///< time of the last injected level, zero if never set
+	};
+	std::map<unsigned int, Input> fInputs { };
+	std::map<int, std::pair<unsigned int, EdgeCallback>> fEdgeCallbacks { };
+	int fNextCallbackId { 0 };
+	std::map<int, SpiDevice> fSpiHandles { };
+	std::map<SpiDevice, SpiResponder> fSpiResponders { };
+	std::map<SpiDevice, std::vector<std::uint8_t>> fSpiWritten { };
+	int fNextSpiHandle { 0 };
+	unsigned long fSpiReads { 0 };
+	OutputCallback fOutputCallback { };
+	mutable std::mutex fMutex;
+	std::mutex fCallbackMutex; ///< held while edge callbacks are executed
+};
+
+//} // namespace PiRaTe
+
+#endif
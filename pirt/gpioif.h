@@ -14,13 +14,15 @@
 #include <queue>
 #include <list>
 #include <mutex>
+#include <functional>
 
 // namespace PiRaTe {
 /**
  * @brief GPIO interface class.
- * This class encapsulates access to the Raspberry Pi GPIO interface based on the pigpiod daemon.
- * @note The class will connect via TCP socket to a running instance of the pigpiod daemon with 
- * the network address and port as constructor arguments.
+ * This abstract class defines the access to the GPIO pins, SPI interfaces and PWM outputs of the Raspberry Pi.
+ * The actual hardware access is implemented by the backends:
+ * {@link PigpiodGPIO} (via the pigpiod daemon), {@link LinuxGPIO} (via the kernel's GPIO character device,
+ * sysfs PWM and spidev drivers) and {@link SimGPIO} (deterministic in-memory simulation without any hardware).
  * @author HG Zaunick
  */
 class GPIO {
@@ -33,33 +35,102 @@ public:
 	enum class SPI_MODE : std::uint8_t {
 		POL0PHA0=0, POL0PHA1=1, POL1PHA0=2, POL1PHA1=3
 	};
+
+	/**
+	 * @brief A single pin or PWM command for batched execution with {@link GPIO::execute}.
+	 */
+	struct Command {
+		enum class Type {
+			SetDirection, SetState, GetState, SetPullUp, SetPullDown, PwmFrequency, PwmRange, PwmValue, HwPwmValue
+		};
+		Type type { Type::GetState };
+		unsigned int gpio_pin { 0 };
+		unsigned int arg { 0 }; ///< direction, level, enable flag, frequency, range or value depending on the type
+		std::uint32_t duty { 0 }; ///< duty cycle of the hardware PWM in parts per million
+		int result { -1 }; ///< negative on error, otherwise 0 or the level for GetState
+		/// true for commands which only set state and may be coalesced with a later command of the same type
+		[[nodiscard]] auto isWrite() const -> bool { return type != Type::GetState; }
+		[[nodiscard]] static auto make(Type type, unsigned int gpio_pin, unsigned int arg = 0, std::uint32_t duty = 0) -> Command
+		{
+			Command cmd { };
+			cmd.type = type;
+			cmd.gpio_pin = gpio_pin;
+			cmd.arg = arg;
+			cmd.duty = duty;
+			return cmd;
+		}
+	};
+
+	/// called on a level change of an input pin with the new level and the time of the edge
+	using EdgeCallback = std::function<void(unsigned int gpio_pin, bool level, std::chrono::steady_clock::time_point time)>;
 	
-	GPIO() = delete;
-	GPIO(const std::string& host, const std::string& port = "8888");
-    virtual ~GPIO();
+	GPIO() = default;
+	GPIO(const GPIO&) = delete;
+	auto operator=(const GPIO&) -> GPIO& = delete;
+	virtual ~GPIO() = default;
 
-    virtual bool isInitialized() const { return (fHandle>=0); }
+	[[nodiscard]] virtual auto isInitialized() const -> bool = 0;
+	/// short name of the backend for diagnostic messages
+	[[nodiscard]] virtual auto backendName() const -> std::string = 0;
 
-    [[nodiscard]] auto spi_init(SPI_INTERFACE interface, std::uint8_t channel, SPI_MODE mode, unsigned int baudrate, bool lsb_first = false, bool use_cs = true) -> int;
-	[[nodiscard]] auto spi_read(unsigned int spi_handle, unsigned int nBytes) -> std::vector<std::uint8_t>;
-	[[nodiscard]] auto spi_write(unsigned int spi_handle, const std::vector<std::uint8_t>& data) -> bool;
-    void spi_close(int spi_handle);
-	[[nodiscard]] auto handle() const -> int { return fHandle; }
+	[[nodiscard]] virtual auto spi_init(SPI_INTERFACE interface, std::uint8_t channel, SPI_MODE mode, unsigned int baudrate, bool lsb_first = false, bool use_cs = true) -> int = 0;
+	[[nodiscard]] virtual auto spi_read(unsigned int spi_handle, unsigned int nBytes) -> std::vector<std::uint8_t> = 0;
+	/**
+	 * @brief Read from several SPI devices in one go.
+	 * The reads are issued back-to-back, backends serialize the transfers so that no other
+	 * request can be interleaved between them.
+	 * The default implementation calls {@link GPIO::spi_read} for each handle.
+	 * @param spi_handles the handles of the SPI devices to read from
+	 * @param nBytes the number of bytes to read from each device
+	 * @return one byte vector per handle in the same order, empty if the transfer of that device failed
+	 */
+	[[nodiscard]] virtual auto spi_read_multi(const std::vector<unsigned int>& spi_handles, unsigned int nBytes) -> std::vector<std::vector<std::uint8_t>>;
+	[[nodiscard]] virtual auto spi_write(unsigned int spi_handle, const std::vector<std::uint8_t>& data) -> bool = 0;
+	virtual void spi_close(int spi_handle) = 0;
 
-	auto pwm_set_frequency(unsigned int gpio_pin, unsigned int freq) -> bool;
-	auto pwm_set_range(unsigned int gpio_pin, unsigned int range) -> bool;
-	auto pwm_set_value(unsigned int gpio_pin, unsigned int value) -> bool;
-	void pwm_off(unsigned int gpio_pin);
-	auto hw_pwm_set_value(unsigned int gpio_pin, unsigned int freq, std::uint32_t value) -> bool;
+	virtual auto pwm_set_frequency(unsigned int gpio_pin, unsigned int freq) -> bool = 0;
+	virtual auto pwm_set_range(unsigned int gpio_pin, unsigned int range) -> bool = 0;
+	virtual auto pwm_set_value(unsigned int gpio_pin, unsigned int value) -> bool = 0;
+	virtual void pwm_off(unsigned int gpio_pin) = 0;
+	/**
+	 * @brief Set the hardware PWM output of a pin.
+	 * @param gpio_pin the pin, must be capable of hardware PWM (GPIO 12, 13, 18 or 19)
+	 * @param freq the PWM frequency in Hz
+	 * @param value the duty cycle in parts per million (0...1000000)
+	 */
+	virtual auto hw_pwm_set_value(unsigned int gpio_pin, unsigned int freq, std::uint32_t value) -> bool = 0;
 	
-	auto set_gpio_direction(unsigned int gpio_pin, bool output) -> bool;
-	auto set_gpio_state(unsigned int gpio_pin, bool state) -> bool;
-	auto get_gpio_state(unsigned int gpio_pin, bool* err) -> bool;
-	auto set_gpio_pullup(unsigned int gpio_pin, bool pullup_enable=true) -> bool;
-	auto set_gpio_pulldown(unsigned int gpio_pin, bool pulldown_enable=true) -> bool;
-protected:
-    int fHandle { -1 };
-	std::mutex fMutex;
+	virtual auto set_gpio_direction(unsigned int gpio_pin, bool output) -> bool = 0;
+	virtual auto set_gpio_state(unsigned int gpio_pin, bool state) -> bool = 0;
+	virtual auto get_gpio_state(unsigned int gpio_pin, bool* err) -> bool = 0;
+	virtual auto set_gpio_pullup(unsigned int gpio_pin, bool pullup_enable=true) -> bool = 0;
+	virtual auto set_gpio_pulldown(unsigned int gpio_pin, bool pulldown_enable=true) -> bool = 0;
+
+	/**
+	 * @brief Execute a batch of commands in order and fill in their results.
+	 * The default implementation issues the commands one by one through the methods above,
+	 * backends may override it to pipeline the batch.
+	 */
+	virtual void execute(std::vector<Command>& commands);
+
+	/**
+	 * @brief Register a function to be called on every edge of an input pin.
+	 * The callback is invoked from a thread of the backend and must not block.
+	 * The default implementation does not support edge events.
+	 * @return an id for {@link GPIO::cancel_edge_callback}, negative if edge events are not supported
+	 */
+	virtual auto register_edge_callback(unsigned int gpio_pin, EdgeCallback callback) -> int;
+	/**
+	 * @brief Remove an edge callback.
+	 * Returns only after an execution of the callback in progress has finished, so that the objects
+	 * captured by the callback may be destroyed afterwards. Must not be called from within an edge callback.
+	 */
+	virtual void cancel_edge_callback(int callback_id);
+	/**
+	 * @brief Suppress level changes of an input pin which are shorter than steady_us.
+	 * @return false if the backend does not provide a glitch filter
+	 */
+	virtual auto set_glitch_filter(unsigned int gpio_pin, unsigned int steady_us) -> bool;
 };
 
 //} // namespace PiRaTe
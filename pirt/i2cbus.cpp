@@ -0,0 +1,218 @@
+#include <iostream>
+#include <algorithm>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+
+#include "i2cbus.h"
+
+namespace {
+// heap order: the most urgent request is at the front
+auto lessUrgent = [](const auto& a, const auto& b) -> bool {
+	if (a.priority != b.priority) return a.priority < b.priority;
+	if (a.deadline != b.deadline) return a.deadline > b.deadline;
+	return a.sequence > b.sequence;
+};
+} // anonymous namespace
+
+I2cBus::I2cBus(const std::string& busName)
+	: fName { busName }
+{
+	fHandle = open(fName.c_str(), O_RDWR);
+	if (fHandle <= 0) {
+		std::cerr<<"Error: could not open I2C bus "<<fName<<".\n";
+		return;
+	}
+	unsigned long funcs { 0 };
+	fRdwrSupported = ( ioctl(fHandle, I2C_FUNCS, &funcs) >= 0 && (funcs & I2C_FUNC_I2C) );
+	fWindowStart = std::chrono::steady_clock::now();
+	fActiveLoop = true;
+	fThread = std::make_unique<std::thread>( [this]() { this->ioLoop(); } );
+}
+
+I2cBus::~I2cBus()
+{
+	{
+		std::lock_guard<std::mutex> lock(fMutex);
+		fActiveLoop = false;
+	}
+	fCondition.notify_all();
+	if (fThread != nullptr) fThread->join();
+	if (fHandle > 0) close(fHandle);
+}
+
+auto I2cBus::transfer(std::uint8_t address, i2cDevice::Message* msgs, unsigned int nMsgs, int priority,
+					  std::chrono::steady_clock::time_point deadline, unsigned int* syscalls) -> int
+{
+	Request request { address, msgs, nMsgs, priority, deadline };
+	request.syscalls = syscalls;
+	return enqueue(std::move(request)).get();
+}
+
+auto I2cBus::submit(std::uint8_t address, i2cDevice::Message* msgs, unsigned int nMsgs, int priority,
+					std::chrono::steady_clock::time_point deadline) -> std::future<int>
+{
+	return enqueue( Request { address, msgs, nMsgs, priority, deadline } );
+}
+
+auto I2cBus::enqueue(Request request) -> std::future<int>
+{
+	request.promise = std::make_shared<std::promise<int>>();
+	std::future<int> result { request.promise->get_future() };
+	if (!fActiveLoop || request.nMsgs == 0) {
+		request.promise->set_value( (request.nMsgs == 0) ? 0 : -1 );
+		return result;
+	}
+	{
+		std::lock_guard<std::mutex> lock(fMutex);
+		request.submitted = std::chrono::steady_clock::now();
+		request.sequence = fSequence++;
+		fQueue.push_back(std::move(request));
+		std::push_heap(fQueue.begin(), fQueue.end(), lessUrgent);
+		fStatistics.queueDepth = fQueue.size();
+		fStatistics.maxQueueDepth = std::max(fStatistics.maxQueueDepth, fQueue.size());
+	}
+	fCondition.notify_one();
+	return result;
+}
+
+void I2cBus::ioLoop()
+{
+	while (true) {
+		Request request { };
+		{
+			std::unique_lock<std::mutex> lock(fMutex);
+			fCondition.wait(lock, [this]() { return !fQueue.empty() || !fActiveLoop; });
+			// drain the queue before terminating, so that no caller waits forever
+			if (fQueue.empty()) break;
+			std::pop_heap(fQueue.begin(), fQueue.end(), lessUrgent);
+			request = std::move(fQueue.back());
+			fQueue.pop_back();
+			fStatistics.queueDepth = fQueue.size();
+		}
+		const auto start { std::chrono::steady_clock::now() };
+		unsigned int syscalls { 0 };
+		const int result { execute(request, syscalls) };
+		const auto end { std::chrono::steady_clock::now() };
+		const double latency { std::chrono::duration<double, std::micro>( end - request.submitted ).count() };
+		fLatency.fill(latency);
+		{
+			std::lock_guard<std::mutex> lock(fMutex);
+			DeviceRecord& device { fDevices[request.address] };
+			fStatistics.transactions++;
+			fStatistics.syscalls += syscalls;
+			device.statistics.transactions++;
+			device.busy += end - start;
+			fBusy += end - start;
+			if (result != static_cast<int>(request.nMsgs)) {
+				fStatistics.errors++;
+				device.statistics.errors++;
+				device.windowErrors++;
+			} else {
+				for (unsigned int i = 0; i < request.nMsgs; i++) {
+					if (request.msgs[i].read) device.statistics.bytesRead += request.msgs[i].len;
+					else device.statistics.bytesWritten += request.msgs[i].len;
+				}
+			}
+			if (start > request.deadline) {
+				fStatistics.deadlineMisses++;
+				device.statistics.deadlineMisses++;
+			}
+			device.latencySum += latency;
+			device.statistics.meanLatency = device.latencySum / device.statistics.transactions;
+			device.statistics.maxLatency = std::max(device.statistics.maxLatency, latency);
+			updateWindow(end);
+		}
+		if (request.syscalls != nullptr) *request.syscalls = syscalls;
+		request.promise->set_value(result);
+	}
+}
+
+// called with fMutex held
+void I2cBus::updateWindow(std::chrono::steady_clock::time_point now)
+{
+	if (now - fWindowStart < std::chrono::seconds(1)) return;
+	const double window { std::chrono::duration<double>(now - fWindowStart).count() };
+	fStatistics.utilization = std::chrono::duration<double>(fBusy).count() / window;
+	for (auto& item: fDevices) {
+		DeviceRecord& device { item.second };
+		device.statistics.utilization = std::chrono::duration<double>(device.busy).count() / window;
+		device.statistics.errorRate = device.windowErrors / window;
+		device.busy = std::chrono::steady_clock::duration { };
+		device.windowErrors = 0;
+	}
+	fBusy = std::chrono::steady_clock::duration { };
+	fWindowStart = now;
+}
+
+auto I2cBus::selectAddress(std::uint8_t address, unsigned int& syscalls) -> bool
+{
+	if (fCurrentAddress == address) return true;
+	syscalls++;
+	if (ioctl(fHandle, I2C_SLAVE, address) < 0 && ioctl(fHandle, I2C_SLAVE_FORCE, address) < 0) {
+		fCurrentAddress = -1;
+		return false;
+	}
+	fCurrentAddress = address;
+	return true;
+}
+
+auto I2cBus::execute(const Request& request, unsigned int& syscalls) -> int
+{
+	if (fRdwrSupported && request.nMsgs <= I2C_RDWR_IOCTL_MAX_MSGS) {
+		struct i2c_msg i2cmsgs[I2C_RDWR_IOCTL_MAX_MSGS];
+		for (unsigned int i = 0; i < request.nMsgs; i++) {
+			i2cmsgs[i].addr = request.address;
+			i2cmsgs[i].flags = (request.msgs[i].read) ? I2C_M_RD : 0;
+			i2cmsgs[i].len = request.msgs[i].len;
+			i2cmsgs[i].buf = request.msgs[i].buf;
+		}
+		struct i2c_rdwr_ioctl_data data;
+		data.msgs = i2cmsgs;
+		data.nmsgs = request.nMsgs;
+		syscalls++;
+		const int res { ioctl(fHandle, I2C_RDWR, &data) };
+		if (res >= 0 || (errno != EOPNOTSUPP && errno != ENOTTY && errno != EINVAL)) return (res < 0) ? -1 : res;
+		// the adapter driver refuses combined transfers, use separate calls from now on
+		std::cerr<<"Warning: I2C_RDWR not supported on "<<fName<<", falling back to read/write.\n";
+		fRdwrSupported = false;
+	}
+	if (!selectAddress(request.address, syscalls)) return -1;
+	for (unsigned int i = 0; i < request.nMsgs; i++) {
+		const i2cDevice::Message& msg { request.msgs[i] };
+		syscalls++;
+		const ssize_t n { (msg.read) ? ::read(fHandle, msg.buf, msg.len) : ::write(fHandle, msg.buf, msg.len) };
+		if (n != msg.len) return -1;
+	}
+	return request.nMsgs;
+}
+
+auto I2cBus::statistics() const -> Statistics
+{
+	std::lock_guard<std::mutex> lock(fMutex);
+	return fStatistics;
+}
+
+auto I2cBus::deviceStatistics(std::uint8_t address) const -> DeviceStatistics
+{
+	std::lock_guard<std::mutex> lock(fMutex);
+	auto it = fDevices.find(address);
+	return ( it == fDevices.end() ) ? DeviceStatistics { } : it->second.statistics;
+}
+
+auto I2cBus::devices() const -> std::vector<std::uint8_t>
+{
+	std::lock_guard<std::mutex> lock(fMutex);
+	std::vector<std::uint8_t> addresses { };
+	for (const auto& item: fDevices) addresses.push_back(item.first);
+	return addresses;
+}
+
+void I2cBus::clearStatistics()
+{
+	std::lock_guard<std::mutex> lock(fMutex);
+	fStatistics = Statistics { fQueue.size() };
+	fDevices.clear();
+	fLatency.clear();
+}
@@ -0,0 +1,147 @@
+#ifndef I2CBUS_H
+#define I2CBUS_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <future>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "i2cdevice.h"
+#include "utility.h"
+#include "thread_policy.h"
+
+constexpr std::size_t I2C_LATENCY_HISTOGRAM_BINS { 1000 };
+constexpr double I2C_LATENCY_HISTOGRAM_RANGE { 10000. }; // us
+constexpr int I2C_PRIORITY_DEFAULT { 0 }; ///< transaction priority of devices without explicit setting
+constexpr std::chrono::milliseconds I2C_DEADLINE_DEFAULT { 100 }; ///< time after submission by which a transaction should have been executed
+
+/**
+ * @brief Transaction manager owning the file descriptor of one I2C bus.
+ * The devices on the bus do not access the bus device file themselves but submit their transactions
+ * (lists of read/write segments, see {@link i2cDevice::transfer}) to the manager, which executes them one after
+ * the other from a dedicated I/O thread. Pending transactions are served in the order of their priority, transactions
+ * of equal priority in the order of their deadlines. A transaction whose deadline expired before it was started is
+ * executed anyway and counted as deadline miss. Transactions are not preempted, i.e. a long transfer of low priority
+ * delays the following ones by its duration.
+ * The manager keeps statistics of the bus utilisation, the queueing latency and the errors per device address.
+ * @author HG Zaunick
+ */
+class I2cBus {
+public:
+	using LatencyHistogram = PiRaTe::Histogram<I2C_LATENCY_HISTOGRAM_BINS>;
+
+	struct Statistics {
+		std::size_t queueDepth { 0 }; ///< number of currently pending transactions
+		std::size_t maxQueueDepth { 0 }; ///< maximum number of pending transactions since the last clear
+		unsigned long transactions { 0 }; ///< number of executed transactions
+		unsigned long errors { 0 }; ///< number of failed transactions
+		unsigned long deadlineMisses { 0 }; ///< number of transactions started after their deadline
+		unsigned long syscalls { 0 }; ///< number of system calls issued on the bus device file
+		double utilization { 0. }; ///< fraction of time the bus was busy during the last second
+	};
+	struct DeviceStatistics {
+		unsigned long transactions { 0 };
+		unsigned long errors { 0 };
+		unsigned long deadlineMisses { 0 };
+		unsigned long bytesRead { 0 };
+		unsigned long bytesWritten { 0 };
+		double utilization { 0. }; ///< fraction of the bus time used by the device during the last second
+		double errorRate { 0. }; ///< failed transactions per second during the last second
+		double meanLatency { 0. }; ///< mean time from submission to completion in us
+		double maxLatency { 0. }; ///< maximum time from submission to completion in us
+	};
+
+	I2cBus() = delete;
+	/**
+	 * @brief The main constructor.
+	 * Opens the bus device file and starts the I/O thread.
+	 * @param busName path of the bus device file
+	 */
+	explicit I2cBus(const std::string& busName);
+	~I2cBus();
+
+	[[nodiscard]] auto isInitialized() const -> bool { return fHandle > 0; }
+	[[nodiscard]] auto name() const -> const std::string& { return fName; }
+	/// the adapter executes combined transfers with repeated starts (I2C_RDWR)
+	[[nodiscard]] auto combinedTransfersSupported() const -> bool { return fRdwrSupported; }
+
+	/**
+	 * @brief Queue a transaction and wait for its completion.
+	 * @param address the 7-bit slave address
+	 * @param msgs the segments of the transaction
+	 * @param nMsgs the number of segments
+	 * @param priority larger values are served first
+	 * @param deadline the time by which the transaction should have been started
+	 * @param syscalls if not nullptr, returns the number of system calls needed for the transaction
+	 * @return the number of segments transferred, -1 on error
+	 */
+	auto transfer(std::uint8_t address, i2cDevice::Message* msgs, unsigned int nMsgs, int priority,
+				  std::chrono::steady_clock::time_point deadline, unsigned int* syscalls = nullptr) -> int;
+	/**
+	 * @brief Queue a transaction for execution by the I/O thread.
+	 * @note The segment list and the buffers it points to must stay valid until the future is ready.
+	 * @return future of the number of segments transferred, -1 on error
+	 */
+	auto submit(std::uint8_t address, i2cDevice::Message* msgs, unsigned int nMsgs, int priority,
+				std::chrono::steady_clock::time_point deadline) -> std::future<int>;
+
+	[[nodiscard]] auto statistics() const -> Statistics;
+	[[nodiscard]] auto deviceStatistics(std::uint8_t address) const -> DeviceStatistics;
+	/// addresses of all devices which submitted transactions
+	[[nodiscard]] auto devices() const -> std::vector<std::uint8_t>;
+	/// time from submission to completion of the transactions in us
+	[[nodiscard]] auto latency() const -> const LatencyHistogram& { return fLatency; }
+	void clearStatistics();
+	/// apply scheduling policy and CPU affinity to the I/O thread
+	auto setThreadPolicy(const PiRaTe::ThreadPolicy& policy) -> bool { return PiRaTe::applyThreadPolicy(fThread.get(), policy); }
+
+private:
+	struct Request {
+		std::uint8_t address { 0 };
+		i2cDevice::Message* msgs { nullptr };
+		unsigned int nMsgs { 0 };
+		int priority { I2C_PRIORITY_DEFAULT };
+		std::chrono::steady_clock::time_point deadline { };
+		std::chrono::steady_clock::time_point submitted { };
+		unsigned long sequence { 0 };
+		std::shared_ptr<std::promise<int>> promise { };
+		unsigned int* syscalls { nullptr };
+	};
+	struct DeviceRecord {
+		DeviceStatistics statistics { };
+		std::chrono::steady_clock::duration busy { }; ///< bus time used in the current window
+		unsigned long windowErrors { 0 };
+		double latencySum { 0. };
+	};
+
+	auto enqueue(Request request) -> std::future<int>;
+	void ioLoop();
+	auto execute(const Request& request, unsigned int& syscalls) -> int;
+	auto selectAddress(std::uint8_t address, unsigned int& syscalls) -> bool;
+	void updateWindow(std::chrono::steady_clock::time_point now);
+
+	std::string fName { };
+	int fHandle { -1 };
+	std::atomic<bool> fRdwrSupported { false };
+	int fCurrentAddress { -1 }; ///< slave address bound to the file descriptor for plain read/write calls
+	std::vector<Request> fQueue { }; ///< heap ordered by priority, deadline and submission
+	unsigned long fSequence { 0 };
+	Statistics fStatistics { };
+	std::map<std::uint8_t, DeviceRecord> fDevices { };
+	std::chrono::steady_clock::time_point fWindowStart { };
+	std::chrono::steady_clock::duration fBusy { };
+	LatencyHistogram fLatency { 0., I2C_LATENCY_HISTOGRAM_RANGE };
+	std::atomic<bool> fActiveLoop { false };
+	std::unique_ptr<std::thread> fThread { nullptr };
+	mutable std::mutex fMutex;
+	std::condition_variable fCondition;
+};
+
+#endif // I2CBUS_H
@@ -1,7 +1,9 @@
 #include "i2cdevice.h"
+#include "i2cbus.h"
 #include <iostream>
 #include <algorithm>
 #include <cstring>
+#include <cerrno>
 #include <fcntl.h>     // open
 
 using namespace std;
@@ -72,10 +74,25 @@ i2cDevice::i2cDevice(const char* busAddress, uint8_t slaveAddress) : fAddress(sl
 	else fMode = MODE_FAILED;
 }
 
+i2cDevice::i2cDevice(std::shared_ptr<I2cBus> bus, uint8_t slaveAddress) : fAddress(slaveAddress) {
+	fNrBytesRead = 0;
+	fNrBytesWritten = 0;
+	fDebugLevel = DEFAULT_DEBUG_LEVEL;
+	fHandle = -1;
+	if (bus != nullptr && bus->isInitialized()) {
+		fBus = bus;
+		fRdwrMode = (fBus->combinedTransfersSupported()) ? RDWR_SUPPORTED : RDWR_UNSUPPORTED;
+		fMode = MODE_NORMAL;
+		fNrDevices++;
+		fGlobalDeviceList.push_back(this);
+	}
+	else fMode = MODE_FAILED;
+}
+
 i2cDevice::~i2cDevice() {
 	//destructor of the opening part from above
-	if (fHandle > 0) fNrDevices--;
-	close(fHandle);
+	if (isOpen()) fNrDevices--;
+	if (fHandle > 0) close(fHandle);
 	std::vector<i2cDevice*>::iterator it;
 	it = std::find(fGlobalDeviceList.begin(), fGlobalDeviceList.end(), this);
 	if (it != fGlobalDeviceList.end()) fGlobalDeviceList.erase(it);
@@ -99,6 +116,8 @@ bool i2cDevice::devicePresent()
 
 void i2cDevice::setAddress(uint8_t address) {		        //pointer to our device on the i2c-bus
 	fAddress = address;
+	// the bus manager addresses each transaction individually
+	if (fBus != nullptr) return;
 	int res = ioctl(fHandle, I2C_SLAVE, fAddress);	//i.g. Specify the address of the I2C Slave to communicate with
 	if (res<0) {
 		res = ioctl(fHandle, I2C_SLAVE_FORCE, fAddress);
@@ -121,7 +140,18 @@ void i2cDevice::setAddress(uint8_t address) {		        //pointer to our device o
 
 int i2cDevice::read(uint8_t* buf, int nBytes) {		//defines a function with a pointer buf as buffer and the number of bytes which 
 													//we want to read.
-	if (fHandle <= 0 || (fMode & MODE_LOCKED)) return 0;
+	if (!isOpen() || (fMode & MODE_LOCKED)) return 0;
+	fNrOperations++;
+	return rawRead(buf, nBytes);
+}
+
+int i2cDevice::rawRead(uint8_t* buf, int nBytes) {
+	if (fBus != nullptr) {
+		Message msg = { buf, static_cast<uint16_t>(nBytes), true };
+		return (busTransfer(&msg, 1) == 1) ? nBytes : -1;
+	}
+	fNrSyscalls++;
+	fNrBusBytes += nBytes + 1;
 	int nread = ::read(fHandle, buf, nBytes);		//"::" declares that the functions does not call itself again, but instead
 	if (nread > 0) {
 		fNrBytesRead += nread;
@@ -136,7 +166,18 @@ int i2cDevice::read(uint8_t* buf, int nBytes) {		//defines a function with a poi
 }
 
 int i2cDevice::write(uint8_t* buf, int nBytes) {
-	if (fHandle <= 0 || (fMode & MODE_LOCKED)) return 0;
+	if (!isOpen() || (fMode & MODE_LOCKED)) return 0;
+	fNrOperations++;
+	return rawWrite(buf, nBytes);
+}
+
+int i2cDevice::rawWrite(uint8_t* buf, int nBytes) {
+	if (fBus != nullptr) {
+		Message msg = { buf, static_cast<uint16_t>(nBytes), false };
+		return (busTransfer(&msg, 1) == 1) ? nBytes : -1;
+	}
+	fNrSyscalls++;
+	fNrBusBytes += nBytes + 1;
 	int nwritten = ::write(fHandle, buf, nBytes);
 	if (nwritten > 0) {
 		fNrBytesWritten += nwritten;
@@ -202,10 +243,94 @@ int i2cDevice::readReg(uint8_t reg, uint8_t* buf, int nBytes)
 	//int _n = i2c_smbus_read_i2c_block_data(fHandle, reg, (uint8_t)nBytes, buf);
 	//return _n;
 
-	int n = write(&reg, 1);
-	if (n != 1) return -1;
-	n = read(buf, nBytes);
-	return n;
+	// register pointer write and data read with a repeated start in between
+	Message msgs[2] = { { &reg, 1, false }, { buf, static_cast<uint16_t>(nBytes), true } };
+	if (transfer(msgs, 2) != 2) return -1;
+	return nBytes;
+}
+
+bool i2cDevice::combinedTransfersSupported()
+{
+	if (fBus != nullptr) return fBus->combinedTransfersSupported();
+	if (fRdwrMode == RDWR_UNKNOWN && fHandle > 0) {
+		unsigned long funcs = 0;
+		fRdwrMode = (ioctl(fHandle, I2C_FUNCS, &funcs) >= 0 && (funcs & I2C_FUNC_I2C)) ? RDWR_SUPPORTED : RDWR_UNSUPPORTED;
+	}
+	return (fRdwrMode == RDWR_SUPPORTED);
+}
+
+int i2cDevice::transfer(Message* msgs, unsigned int nMsgs)
+{
+	if (!isOpen() || (fMode & MODE_LOCKED)) return 0;
+	if (nMsgs == 0) return 0;
+	fNrOperations++;
+	if (fBus != nullptr) return busTransfer(msgs, nMsgs);
+	if (nMsgs <= I2C_RDWR_IOCTL_MAX_MSGS && combinedTransfersSupported()) {
+		struct i2c_msg i2cmsgs[I2C_RDWR_IOCTL_MAX_MSGS];
+		unsigned long nread = 0, nwritten = 0;
+		for (unsigned int i = 0; i < nMsgs; i++) {
+			i2cmsgs[i].addr = fAddress;
+			i2cmsgs[i].flags = (msgs[i].read) ? I2C_M_RD : 0;
+			i2cmsgs[i].len = msgs[i].len;
+			i2cmsgs[i].buf = msgs[i].buf;
+			if (msgs[i].read) nread += msgs[i].len;
+			else nwritten += msgs[i].len;
+		}
+		struct i2c_rdwr_ioctl_data data;
+		data.msgs = i2cmsgs;
+		data.nmsgs = nMsgs;
+		fNrSyscalls++;
+		fNrBusBytes += nread + nwritten + nMsgs;
+		int res = ioctl(fHandle, I2C_RDWR, &data);
+		if (res == static_cast<int>(nMsgs)) {
+			fNrBytesRead += nread;
+			fGlobalNrBytesRead += nread;
+			fNrBytesWritten += nwritten;
+			fGlobalNrBytesWritten += nwritten;
+			fMode &= ~((uint8_t)MODE_UNREACHABLE);
+			return res;
+		}
+		if (res < 0 && (errno == EOPNOTSUPP || errno == ENOTTY || errno == EINVAL)) {
+			// the adapter driver refuses combined transfers, use separate calls from now on
+			if (fDebugLevel > 0)
+				cerr << "I2C_RDWR not supported for device 0x" << hex << (int)fAddress << dec << ", falling back to read/write" << endl;
+			fRdwrMode = RDWR_UNSUPPORTED;
+		} else {
+			fIOErrors++;
+			fMode |= MODE_UNREACHABLE;
+			return -1;
+		}
+	}
+	// fallback: one system call per segment, each with its own start and stop condition
+	for (unsigned int i = 0; i < nMsgs; i++) {
+		int n = (msgs[i].read) ? rawRead(msgs[i].buf, msgs[i].len) : rawWrite(msgs[i].buf, msgs[i].len);
+		if (n != msgs[i].len) return -1;
+	}
+	return nMsgs;
+}
+
+int i2cDevice::busTransfer(Message* msgs, unsigned int nMsgs)
+{
+	unsigned int syscalls = 0;
+	int res = fBus->transfer(fAddress, msgs, nMsgs, fBusPriority, std::chrono::steady_clock::now() + fBusDeadline, &syscalls);
+	fNrSyscalls += syscalls;
+	unsigned long nread = 0, nwritten = 0;
+	for (unsigned int i = 0; i < nMsgs; i++) {
+		if (msgs[i].read) nread += msgs[i].len;
+		else nwritten += msgs[i].len;
+	}
+	fNrBusBytes += nread + nwritten + nMsgs;
+	if (res != static_cast<int>(nMsgs)) {
+		fIOErrors++;
+		fMode |= MODE_UNREACHABLE;
+		return -1;
+	}
+	fNrBytesRead += nread;
+	fGlobalNrBytesRead += nread;
+	fNrBytesWritten += nwritten;
+	fGlobalNrBytesWritten += nwritten;
+	fMode &= ~((uint8_t)MODE_UNREACHABLE);
+	return res;
 }
 
 int8_t i2cDevice::readBit(uint8_t regAddr, uint8_t bitNum, uint8_t *data) {
@@ -4,10 +4,13 @@
 #include <sys/ioctl.h> // ioctl
 #include <inttypes.h>  	    // uint8_t, etc
 #include "linux/i2c-dev.h" // I2C bus definitions for linux like systems
+#include "linux/i2c.h"     // struct i2c_msg for combined transfers
 #include <sys/time.h>                // for gettimeofday()
 #include <vector>
 #include <string>
 #include <iostream>
+#include <memory>
+#include <chrono>
 
 #ifndef _I2CDEVICE_H_
 #define _I2CDEVICE_H_
@@ -15,6 +18,7 @@
 
 #define DEFAULT_DEBUG_LEVEL 0
 
+class I2cBus;
 
 //We define a class named i2cDevices to outsource the hardware dependent program parts. We want to 
 //access components of integrated curcuits, like the ads1115 or other subdevices via i2c-bus.
@@ -29,12 +33,21 @@ public:
 
 	enum MODE { MODE_NONE=0, MODE_NORMAL=0x01, MODE_FORCE=0x02, MODE_UNREACHABLE=0x04, MODE_FAILED=0x08, MODE_LOCKED=0x10 };
 
+	/// one segment of a combined transfer, consecutive segments are separated by a repeated start
+	struct Message {
+		uint8_t* buf;	///< data to write or buffer for the data to read
+		uint16_t len;	///< number of bytes
+		bool read;		///< read (true) or write (false) segment
+	};
+
 	//using I2C_DEVICE_MODE;
 
 	i2cDevice();
 	i2cDevice(const char* busAddress);
 	i2cDevice(uint8_t slaveAddress);
 	i2cDevice(const char* busAddress, uint8_t slaveAddress);
+	// the device does not open the bus device file itself but submits all transfers to the bus manager
+	i2cDevice(std::shared_ptr<I2cBus> bus, uint8_t slaveAddress);
 	virtual ~i2cDevice();
 
 	void setAddress(uint8_t address);
@@ -43,6 +56,23 @@ public:
 	unsigned int getNrBytesRead() const { return fNrBytesRead; }
 	unsigned int getNrBytesWritten() const { return fNrBytesWritten; }
 	unsigned int getNrIOErrors() const { return fIOErrors; }
+	/// number of logical operations (read, write, readReg, transfer calls) since construction
+	unsigned long getNrOperations() const { return fNrOperations; }
+	/// number of read/write/ioctl system calls issued for the operations
+	unsigned long getNrSyscalls() const { return fNrSyscalls; }
+	/// number of bytes on the bus including the address byte of every (repeated) start
+	unsigned long getNrBusBytes() const { return fNrBusBytes; }
+	double getSyscallsPerOperation() const { return (fNrOperations > 0) ? static_cast<double>(fNrSyscalls) / fNrOperations : 0.; }
+	double getBusBytesPerOperation() const { return (fNrOperations > 0) ? static_cast<double>(fNrBusBytes) / fNrOperations : 0.; }
+	/// combined transfers are executed as one I2C_RDWR ioctl (true) or as separate read/write calls (false)
+	bool combinedTransfersSupported();
+	/// the bus manager executing the transfers, nullptr if the device accesses the bus device file directly
+	std::shared_ptr<I2cBus> getBus() const { return fBus; }
+	/// priority of the transactions queued at the bus manager, larger values are served first
+	void setBusPriority(int priority) { fBusPriority = priority; }
+	int getBusPriority() const { return fBusPriority; }
+	/// time after submission by which the transactions queued at the bus manager should have been started
+	void setBusDeadline(std::chrono::microseconds deadline) { fBusDeadline = deadline; }
 	static unsigned int getGlobalNrBytesRead() { return fGlobalNrBytesRead; }
 	static unsigned int getGlobalNrBytesWritten() { return fGlobalNrBytesWritten; }
 	static std::vector<i2cDevice*>& getGlobalDeviceList() { return fGlobalDeviceList; }
@@ -94,6 +124,15 @@ public:
 	// refer to the device's datasheet
 	int readReg(uint8_t reg, uint8_t* buf, int nBytes);
 
+	// execute a sequence of read and write segments as one bus transaction with repeated starts
+	// and a single stop at the end, using one I2C_RDWR ioctl
+	// return value:
+	// 	the number of segments transferred if successful
+	//	-1 on error
+	// note: if the adapter does not support I2C_RDWR, the segments are executed
+	// with one read/write call each and a stop in between
+	int transfer(Message* msgs, unsigned int nMsgs);
+
 	/** Read a single bit from an 8-bit device register.
 	* @param regAddr Register regAddr to read from
 	* @param bitNum Bit position to read (0-7)
@@ -191,6 +230,20 @@ protected:
 	std::string fTitle="I2C device";
 	uint8_t fMode = MODE_NONE;
 	unsigned int fIOErrors=0;
+	unsigned long fNrOperations=0;
+	unsigned long fNrSyscalls=0;
+	unsigned long fNrBusBytes=0;
+	enum { RDWR_UNKNOWN, RDWR_SUPPORTED, RDWR_UNSUPPORTED } fRdwrMode = RDWR_UNKNOWN;
+	std::shared_ptr<I2cBus> fBus { nullptr };
+	int fBusPriority = 0;
+	std::chrono::microseconds fBusDeadline { 100000 };
+
+	// the system calls behind read(), write() and transfer(), which do not count as operations
+	int rawRead(uint8_t* buf, int nBytes);
+	int rawWrite(uint8_t* buf, int nBytes);
+	// queue the segments at the bus manager and wait for their execution
+	int busTransfer(Message* msgs, unsigned int nMsgs);
+	bool isOpen() const { return (fHandle > 0 || fBus != nullptr); }
 
 	// functions for measuring time intervals
 	void startTimer();
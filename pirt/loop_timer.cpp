@@ -0,0 +1,84 @@
+#include <thread>
+#include <cmath>
+#include <algorithm>
+
+#include "loop_timer.h"
+
+namespace PiRaTe {
+
+constexpr std::chrono::seconds statistics_window { 1 };
+
+LoopTimer::LoopTimer(std::chrono::microseconds period)
+	: fPeriod { std::max<std::chrono::microseconds::rep>( period.count(), 1 ) }
+{
+}
+
+void LoopTimer::setPeriod(std::chrono::microseconds period)
+{
+	fPeriod = std::max<std::chrono::microseconds::rep>( period.count(), 1 );
+}
+
+void LoopTimer::reset()
+{
+	fStarted = false;
+	fOverruns = 0;
+	fLatency.clear();
+	std::lock_guard<std::mutex> lock(fMutex);
+	fStatistics = Statistics { };
+}
+
+void LoopTimer::wait()
+{
+	auto now { std::chrono::steady_clock::now() };
+	if ( !fStarted ) {
+		fDeadline = now;
+		fWindowStart = now;
+		fWindowCycles = 0;
+		fWindowSumSq = fWindowMax = 0.;
+		fStarted = true;
+	}
+	fDeadline += std::chrono::microseconds( fPeriod.load() );
+	if ( fDeadline < now ) {
+		// the loop body took longer than one period, skip the missed deadlines
+		fOverruns++;
+		fDeadline = now;
+	} else {
+		std::this_thread::sleep_until( fDeadline );
+		now = std::chrono::steady_clock::now();
+	}
+	updateStatistics( now, now - fDeadline );
+}
+
+void LoopTimer::updateStatistics(std::chrono::steady_clock::time_point now, std::chrono::steady_clock::duration latency)
+{
+	const double latency_us { std::chrono::duration<double, std::micro>( latency ).count() };
+	fWindowCycles++;
+	fWindowSumSq += latency_us * latency_us;
+	fWindowMax = std::max( fWindowMax, latency_us );
+	fLatency.fill( latency_us );
+	const auto window_length { now - fWindowStart };
+	if ( window_length < statistics_window ) return;
+
+	Statistics stats { };
+	stats.rate = fWindowCycles / std::chrono::duration<double>( window_length ).count();
+	stats.jitter = std::sqrt( fWindowSumSq / fWindowCycles );
+	stats.maxJitter = fWindowMax;
+	stats.overruns = fOverruns;
+	{
+		std::lock_guard<std::mutex> lock(fMutex);
+		fStatistics = stats;
+	}
+	fWindowStart = now;
+	fWindowCycles = 0;
+	fWindowSumSq = fWindowMax = 0.;
+}
+
+auto LoopTimer::statistics() const -> Statistics
+{
+	std::lock_guard<std::mutex> lock(fMutex);
+	Statistics stats { fStatistics };
+	stats.overruns = fOverruns;
+	return stats;
+}
+
+} // namespace PiRaTe
@@ -0,0 +1,73 @@
+#ifndef LOOPTIMER_H
+#define LOOPTIMER_H
+
+#include <chrono>
+#include <atomic>
+#include <mutex>
+
+#include "utility.h"
+
+namespace PiRaTe {
+
+constexpr std::size_t LOOP_LATENCY_HISTOGRAM_BINS { 500 };
+constexpr double LOOP_LATENCY_HISTOGRAM_RANGE { 50000. }; // us
+
+/**
+ * @brief Deadline-driven timer for periodic thread loops.
+ * The timer sleeps until absolute deadlines spaced by the configured period, so that the loop rate
+ * does not drift with the execution time of the loop body. Missed deadlines are counted as overruns
+ * and the schedule is re-anchored to the current time instead of trying to catch up.
+ * The achieved loop rate and the wake-up latency (jitter) are evaluated over windows of one second
+ * and may be read from any thread with {@link LoopTimer::statistics}. Additionally, the wake-up latencies of all cycles
+ * are accumulated in a histogram, which reveals the tail of the distribution (e.g. the 99% quantile).
+ * @author HG Zaunick
+ */
+class LoopTimer {
+public:
+	using LatencyHistogram = Histogram<LOOP_LATENCY_HISTOGRAM_BINS>;
+
+	struct Statistics {
+		double rate { 0. }; ///< achieved loop rate in Hz
+		double jitter { 0. }; ///< rms wake-up latency in us
+		double maxJitter { 0. }; ///< maximum wake-up latency in us
+		unsigned long overruns { 0 }; ///< total number of missed deadlines
+	};
+
+	LoopTimer() = delete;
+	explicit LoopTimer(std::chrono::microseconds period);
+
+	void setPeriod(std::chrono::microseconds period);
+	[[nodiscard]] auto period() const -> std::chrono::microseconds { return std::chrono::microseconds(fPeriod.load()); }
+	/**
+	 * @brief Sleep until the next deadline.
+	 * The first call after construction or {@link LoopTimer::reset} anchors the schedule at the current time.
+	 */
+	void wait();
+	/// restart the schedule and the statistics
+	void reset();
+	[[nodiscard]] auto statistics() const -> Statistics;
+	/// distribution of the wake-up latency in us of all cycles since the last reset
+	[[nodiscard]] auto latency() const -> const LatencyHistogram& { return fLatency; }
+	void clearLatency() { fLatency.clear(); }
+
+private:
+	void updateStatistics(std::chrono::steady_clock::time_point now, std::chrono::steady_clock::duration latency);
+
+	std::atomic<std::chrono::microseconds::rep> fPeriod { 0 };
+	std::chrono::steady_clock::time_point fDeadline { };
+	std::atomic<bool> fStarted { false };
+
+	std::chrono::steady_clock::time_point fWindowStart { };
+	unsigned long fWindowCycles { 0 };
+	double fWindowSumSq { 0. };
+	double fWindowMax { 0. };
+	std::atomic<unsigned long> fOverruns { 0 };
+
+	mutable std::mutex fMutex;
+	Statistics fStatistics { };
+	LatencyHistogram fLatency { 0., LOOP_LATENCY_HISTOGRAM_RANGE };
+};
+
+} // namespace PiRaTe
+
+#endif // LOOPTIMER_H
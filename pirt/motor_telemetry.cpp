@@ -0,0 +1,100 @@
+#include <fstream>
+#include <iomanip>
+#include <array>
+
+#include "motor_telemetry.h"
+#include "binary_io.h"
+
+namespace PiRaTe {
+
+constexpr std::array<char, 8> TELEMETRY_MAGIC { 'P', 'I', 'R', 'T', 'M', 'T', 'E', 'L' };
+constexpr std::uint16_t TELEMETRY_FORMAT_VERSION { 1 };
+constexpr std::uint32_t MAX_TELEMETRY_STRING_LENGTH { 1024 };
+constexpr std::uint32_t MAX_TELEMETRY_RECORDS { 1U << 24 };
+
+using namespace BinaryIo;
+
+auto writeMotorTelemetry(const std::string& path, const MotorTelemetryDump& dump) -> bool
+{
+	std::ofstream out( path, std::ios::binary | std::ios::trunc );
+	if ( !out ) {
+		std::cerr<<"Error opening telemetry dump file "<<path<<"\n";
+		return false;
+	}
+	out.write( TELEMETRY_MAGIC.data(), TELEMETRY_MAGIC.size() );
+	writeLe( out, TELEMETRY_FORMAT_VERSION );
+	writeString( out, dump.name );
+	writeString( out, dump.reason );
+	writeLe( out, dump.steadyReference );
+	writeLe( out, dump.systemReference );
+	writeLe( out, static_cast<std::uint32_t>( dump.records.size() ) );
+	for ( const auto& record: dump.records ) {
+		writeLe( out, record.time );
+		writeFloat( out, record.commanded );
+		writeFloat( out, record.duty );
+		writeFloat( out, record.current );
+		writeFloat( out, record.offset );
+		writeLe( out, record.flags );
+	}
+	if ( !out ) {
+		std::cerr<<"Error writing telemetry dump file "<<path<<"\n";
+		return false;
+	}
+	return true;
+}
+
+auto readMotorTelemetry(const std::string& path, MotorTelemetryDump& dump) -> bool
+{
+	std::ifstream in( path, std::ios::binary );
+	if ( !in ) {
+		std::cerr<<"Error opening telemetry dump file "<<path<<"\n";
+		return false;
+	}
+	std::array<char, TELEMETRY_MAGIC.size()> magic { };
+	in.read( magic.data(), magic.size() );
+	std::uint16_t version { 0 };
+	if ( !in || magic != TELEMETRY_MAGIC || !readLe(in, version) || version != TELEMETRY_FORMAT_VERSION ) {
+		std::cerr<<path<<" is no motor telemetry dump of a known format\n";
+		return false;
+	}
+	std::uint32_t nr_records { 0 };
+	if ( !readString(in, dump.name, MAX_TELEMETRY_STRING_LENGTH) || !readString(in, dump.reason, MAX_TELEMETRY_STRING_LENGTH)
+		|| !readLe(in, dump.steadyReference) || !readLe(in, dump.systemReference)
+		|| !readLe(in, nr_records) || nr_records > MAX_TELEMETRY_RECORDS )
+	{
+		std::cerr<<"Error reading header of telemetry dump "<<path<<"\n";
+		return false;
+	}
+	dump.records.clear();
+	dump.records.reserve(nr_records);
+	for (std::uint32_t i = 0; i < nr_records; i++) {
+		MotorTelemetryRecord record { };
+		if ( !readLe(in, record.time) || !readFloat(in, record.commanded) || !readFloat(in, record.duty)
+			|| !readFloat(in, record.current) || !readFloat(in, record.offset) || !readLe(in, record.flags) )
+		{
+			std::cerr<<"Telemetry dump "<<path<<" is truncated after "<<i<<" records\n";
+			return false;
+		}
+		dump.records.push_back(record);
+	}
+	return true;
+}
+
+void writeMotorTelemetryCsv(std::ostream& out, const MotorTelemetryDump& dump)
+{
+	out<<"# motor: "<<dump.name<<", trigger: "<<dump.reason<<"\n";
+	out<<"time_s,commanded,duty,current_a,offset_v,direction,fault,tripped,current_sampled\n";
+	out<<std::fixed;
+	for ( const auto& record: dump.records ) {
+		const std::int64_t utc_us { record.time - dump.steadyReference + dump.systemReference };
+		out<<std::setprecision(6)<<utc_us * 1e-6<<","
+			<<std::setprecision(4)<<record.commanded<<","<<record.duty<<","
+			<<record.current<<","<<record.offset<<","
+			<<( (record.flags & MotorTelemetryRecord::DIRECTION) ? 1 : 0 )<<","
+			<<( (record.flags & MotorTelemetryRecord::FAULT) ? 1 : 0 )<<","
+			<<( (record.flags & MotorTelemetryRecord::TRIPPED) ? 1 : 0 )<<","
+			<<( (record.flags & MotorTelemetryRecord::CURRENT_SAMPLED) ? 1 : 0 )<<"\n";
+	}
+}
+
+} // namespace PiRaTe
@@ -0,0 +1,61 @@
+#ifndef MOTOR_TELEMETRY_H
+#define MOTOR_TELEMETRY_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <iostream>
+
+namespace PiRaTe {
+
+/**
+ * @brief One cycle of the motor driver's ramp loop as recorded by the flight recorder.
+ */
+struct MotorTelemetryRecord {
+	enum Flags : std::uint8_t {
+		DIRECTION = 0x01, ///< the direction output is set (negative direction)
+		FAULT = 0x02, ///< the fault input of the driver is active
+		TRIPPED = 0x04, ///< the current limit has tripped
+		CURRENT_SAMPLED = 0x08 ///< the current was measured in this cycle
+	};
+	std::int64_t time { 0 }; ///< steady clock time in us
+	float commanded { 0. }; ///< commanded (target) duty cycle
+	float duty { 0. }; ///< duty cycle currently applied by the ramp
+	float current { 0. }; ///< last measured motor current in A
+	float offset { 0. }; ///< estimated offset voltage of the current sense in V
+	std::uint8_t flags { 0 };
+};
+
+/**
+ * @brief Description of a telemetry dump file.
+ */
+struct MotorTelemetryDump {
+	std::string name { }; ///< name of the motor
+	std::string reason { }; ///< event which triggered the dump
+	std::int64_t steadyReference { 0 }; ///< steady clock time in us at the time of the dump...
+	std::int64_t systemReference { 0 }; ///< ...and the corresponding system (UTC) time in us since the epoch
+	std::vector<MotorTelemetryRecord> records { }; ///< the records, oldest first
+};
+
+/**
+ * @brief Write a telemetry dump to a compact binary file.
+ * The file starts with the magic "PIRTMTEL", a format version, the name, reason and time references as
+ * length-prefixed strings resp. 64 bit integers, followed by the number of records and the packed records
+ * (25 bytes each). All numbers are stored little-endian.
+ * @return false if the file could not be written
+ */
+auto writeMotorTelemetry(const std::string& path, const MotorTelemetryDump& dump) -> bool;
+/**
+ * @brief Read a telemetry dump written by {@link writeMotorTelemetry}.
+ * @return false if the file could not be read or has an unknown format
+ */
+auto readMotorTelemetry(const std::string& path, MotorTelemetryDump& dump) -> bool;
+/**
+ * @brief Write the records as CSV with a header line.
+ * The time column is the UTC time in seconds since the epoch, reconstructed through the time references of the dump.
+ */
+void writeMotorTelemetryCsv(std::ostream& out, const MotorTelemetryDump& dump);
+
+} // namespace PiRaTe
+
+#endif // MOTOR_TELEMETRY_H
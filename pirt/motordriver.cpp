@@ -16,7 +16,8 @@ namespace PiRaTe {
 	
 constexpr std::chrono::milliseconds loop_delay { 10 };
 constexpr std::chrono::milliseconds ramp_time { 1000 };
-constexpr std::size_t adc_measurement_rate_loop_cycles { 10 };
+constexpr double adc_rate_energized { 1000. / loop_delay.count() }; //< sample rate of the motor current while energized in Hz
+constexpr double adc_rate_idle { 10. }; //< sample rate of the motor current at rest in Hz
 constexpr double ramp_increment { static_cast<double>(loop_delay.count())/ramp_time.count() };
 constexpr unsigned int HW_PWM1_PIN { 12 };
 constexpr unsigned int HW_PWM2_PIN { 13 };
@@ -35,8 +36,8 @@ template <typename T> constexpr int sgn(T val) {
     return (T(0) < val) - (val < T(0));
 }
 
-MotorDriver::MotorDriver(std::shared_ptr<GPIO> gpio, Pins pins, bool invertDirection, std::shared_ptr<ADS1115> adc, std::uint8_t adc_channel)
-	: fGpio { gpio }, fPins { pins }, fAdc { adc }, fCurrentDir { false }, fInverted { invertDirection }, fAdcChannel { adc_channel }
+MotorDriver::MotorDriver(std::shared_ptr<GPIO> gpio, Pins pins, bool invertDirection, std::shared_ptr<Ads1115Scheduler> adc, std::uint8_t adc_channel)
+	: fGpio { gpio }, fPins { pins }, fAdc { adc }, fCurrentDir { false }, fInverted { invertDirection }, fAdcChannel { adc_channel }, fLoopTimer { loop_delay }
 {
 	if (fGpio == nullptr) {
 		std::cerr<<"Error: no valid GPIO instance.\n";
@@ -77,12 +78,18 @@ MotorDriver::MotorDriver(std::shared_ptr<GPIO> gpio, Pins pins, bool invertDirec
 	}	
 	
 	// initialize ADC if one was supplied in the argument list
-	if ( fAdc != nullptr && fAdc->devicePresent() ) {
+	if ( fAdc != nullptr && fAdc->isInitialized() ) {
 		//fAdc->setPga(ADS1115::PGA4V);
 		//fAdc->setRate(ADS1115::RATE860);
 		//fAdc->setAGC(true);
 		const std::lock_guard<std::mutex> lock(fMutex);
 		measureVoltageOffset();
+	} else {
+		fAdc.reset();
+	}
+	if ( hasAdc() ) {
+		fAdcSubscription = fAdc->subscribe( fAdcChannel, adc_rate_idle, ADC_PRIORITY_MOTOR,
+			[this](const Ads1115Scheduler::Sample& sample) { this->processCurrentSample(sample); } );
 	}
 	
 	fActiveLoop=true;
@@ -98,6 +105,7 @@ MotorDriver::~MotorDriver()
 	if (!fActiveLoop) return;
 	fActiveLoop = false;
 	if (fThread!=nullptr) fThread->join();
+	if ( hasAdc() ) fAdc->unsubscribe(fAdcSubscription);
 	if (fGpio != nullptr && fGpio->isInitialized()) {
 		if (fPins.Dir > 0) fGpio->set_gpio_direction(static_cast<unsigned int>(fPins.Dir), false);
 		if (fPins.DirA > 0) fGpio->set_gpio_direction(static_cast<unsigned int>(fPins.DirA), false);
@@ -116,15 +124,21 @@ MotorDriver::~MotorDriver()
 // this is the background thread loop
 void MotorDriver::threadLoop()
 {
-	std::size_t cycle_counter { adc_measurement_rate_loop_cycles };
 	auto lastReadOutTime = std::chrono::system_clock::now();
 	bool errorFlag = true;
+	bool lastFault { false };
+	fLoopTimer.reset();
 	while (fActiveLoop) {
+		// the ramp is stepped at absolute deadlines, the ADC conversion time is absorbed by the timer
+		fLoopTimer.wait();
 		auto currentTime = std::chrono::system_clock::now();
 		
-		if (hasFaultSense() && isFault()) {
+		const bool fault { hasFaultSense() && isFault() };
+		bool sampled { false };
+		if (fault) {
 			// fault condition, switch off and deactivate everything
 			emergencyStop();
+			if ( !lastFault ) triggerTelemetry("driver fault");
 		} else {
 			const std::lock_guard<std::mutex> lock(fMutex);
 			//fMutex.lock();
@@ -137,30 +151,161 @@ void MotorDriver::threadLoop()
 			}
 			//fMutex.unlock();
 		}
-		if ( hasAdc() && !cycle_counter-- ) {
-			double voltage { 0. };
-			double conv_time { 0. };
-			if ( bool readout_guard = true ) {
-				//std::lock_guard<std::mutex> lock(fMutex);
-				// read current from adc
-				fMutex.lock();
-				voltage = fAdc->readVoltage(fAdcChannel);
-				conv_time = fAdc->getLastConvTime();
-				fMutex.unlock();
-			}
-			if ( std::abs(fCurrentDutyCycle) < ramp_increment ) fOffsetBuffer.add(voltage);
-			double _current = ( voltage - fOffsetBuffer.mean() ) * MOTOR_CURRENT_FACTOR;
-			fMutex.lock();
-			fCurrent = _current;
-			if ( _current > fMaxCurrent ) fMaxCurrent = _current;
-			fUpdated = true;
-			fMutex.unlock();
-			cycle_counter = adc_measurement_rate_loop_cycles;
-			std::this_thread::sleep_for( std::chrono::milliseconds( std::max( loop_delay.count() - static_cast<long long int>(conv_time), 1LL) ) );
-		} else {
-			std::this_thread::sleep_for(loop_delay);
+		// while the motor is energized, the current is supervised at the full loop rate
+		const bool energized { std::abs(fCurrentDutyCycle) >= ramp_increment };
+		if ( hasAdc() && energized != fAdcFastRate ) {
+			fAdc->setRate( fAdcSubscription, (energized) ? adc_rate_energized : adc_rate_idle );
+			fAdcFastRate = energized;
 		}
+		lastFault = fault;
+		const std::lock_guard<std::mutex> lock(fMutex);
+		// the samples are supervised on arrival, the loop only records whether one came in
+		sampled = fAdcSampleFresh;
+		fAdcSampleFresh = false;
+		recordTelemetry( std::chrono::steady_clock::now(), fault, sampled );
+	}
+}
+
+// called from the conversion thread of the ADC scheduler
+void MotorDriver::processCurrentSample(const Ads1115Scheduler::Sample& sample)
+{
+	std::lock_guard<std::mutex> lock(fMutex);
+	fAdcSample = sample;
+	fAdcSampleFresh = true;
+	// the samples at rest track the offset of the current sense
+	const bool energized { std::abs(fCurrentDutyCycle) >= ramp_increment };
+	if ( !energized ) fOffsetBuffer.add(sample.voltage);
+	const double _current { ( sample.voltage - fOffsetBuffer.mean() ) * MOTOR_CURRENT_FACTOR };
+	fCurrent = _current;
+	if ( _current > fMaxCurrent ) fMaxCurrent = _current;
+	fUpdated = true;
+	// supervise right away, so that a trip cuts the output as soon as the conversion has landed
+	checkCurrent( _current, sample.time );
+}
+
+void MotorDriver::checkCurrent(double current, std::chrono::steady_clock::time_point time)
+{
+	const double dt { ( fLastCurrentTime == std::chrono::steady_clock::time_point { } ) ? 0. : std::chrono::duration<double>( time - fLastCurrentTime ).count() };
+	fLastCurrentTime = time;
+	if ( fCurrentLimit.i2t > 0. ) {
+		fI2t = std::max( fI2t + ( current * current - fCurrentLimit.continuous * fCurrentLimit.continuous ) * dt, 0. );
+	} else {
+		fI2t = 0.;
+	}
+	if ( fTripped ) return;
+	if ( fCurrentLimit.peak > 0. && std::abs(current) > fCurrentLimit.peak ) {
+		trip( TripEvent::Reason::Overcurrent, current, time );
+	} else if ( fCurrentLimit.i2t > 0. && fI2t > fCurrentLimit.i2t ) {
+		trip( TripEvent::Reason::I2t, current, time );
+	}
+}
+
+void MotorDriver::trip(TripEvent::Reason reason, double current, std::chrono::steady_clock::time_point time)
+{
+	fTargetDutyCycle = fCurrentDutyCycle = 0.;
+	setSpeed(0.);
+	setEnabled(false);
+	fTripped = true;
+	const double load { ( fCurrentLimit.i2t > 0. ) ? fI2t / fCurrentLimit.i2t : 0. };
+	fTripEvents.push_back( TripEvent { time, reason, current, load } );
+	if ( fTripEvents.size() > MAX_TRIP_EVENTS ) fTripEvents.pop_front();
+	triggerTelemetryLocked( (reason == TripEvent::Reason::I2t) ? "I2t trip" : "overcurrent trip" );
+}
+
+void MotorDriver::recordTelemetry(std::chrono::steady_clock::time_point time, bool fault, bool sampled)
+{
+	if ( fTelemetryFrozen ) return;
+	MotorTelemetryRecord& record { fTelemetry[fTelemetryHead] };
+	record.time = std::chrono::duration_cast<std::chrono::microseconds>( time.time_since_epoch() ).count();
+	record.commanded = fTargetDutyCycle;
+	record.duty = fCurrentDutyCycle;
+	record.current = static_cast<float>( fCurrent );
+	record.offset = ( hasAdc() ) ? static_cast<float>( fOffsetBuffer.mean() ) : 0.f;
+	record.flags = ( (fCurrentDir) ? MotorTelemetryRecord::DIRECTION : 0 )
+		| ( (fault) ? MotorTelemetryRecord::FAULT : 0 )
+		| ( (fTripped) ? MotorTelemetryRecord::TRIPPED : 0 )
+		| ( (sampled) ? MotorTelemetryRecord::CURRENT_SAMPLED : 0 );
+	fTelemetryHead = ( fTelemetryHead + 1 ) % fTelemetry.size();
+	fTelemetryCount = std::min( fTelemetryCount + 1, fTelemetry.size() );
+	if ( fTelemetryTriggered && fTelemetryPostTrigger-- == 0 ) {
+		fTelemetryTriggered = false;
+		fTelemetryFrozen = true;
+	}
+}
+
+void MotorDriver::triggerTelemetryLocked(const char* reason)
+{
+	if ( fTelemetryTriggered || fTelemetryFrozen ) return;
+	fTelemetryReason = reason;
+	fTelemetryPostTrigger = TELEMETRY_POST_TRIGGER_CYCLES;
+	fTelemetryTriggered = true;
+}
+
+void MotorDriver::triggerTelemetry(const char* reason)
+{
+	std::lock_guard<std::mutex> lock(fMutex);
+	triggerTelemetryLocked(reason);
+}
+
+auto MotorDriver::telemetry() -> MotorTelemetryDump
+{
+	MotorTelemetryDump dump { };
+	dump.records.reserve(fTelemetry.size());
+	std::lock_guard<std::mutex> lock(fMutex);
+	dump.reason = fTelemetryReason;
+	dump.steadyReference = std::chrono::duration_cast<std::chrono::microseconds>( std::chrono::steady_clock::now().time_since_epoch() ).count();
+	dump.systemReference = std::chrono::duration_cast<std::chrono::microseconds>( std::chrono::system_clock::now().time_since_epoch() ).count();
+	const std::size_t first { ( fTelemetryHead + fTelemetry.size() - fTelemetryCount ) % fTelemetry.size() };
+	for (std::size_t i = 0; i < fTelemetryCount; i++) {
+		dump.records.push_back( fTelemetry[ ( first + i ) % fTelemetry.size() ] );
 	}
+	return dump;
+}
+
+void MotorDriver::releaseTelemetry()
+{
+	std::lock_guard<std::mutex> lock(fMutex);
+	fTelemetryFrozen = false;
+	fTelemetryTriggered = false;
+	fTelemetryReason = "";
+}
+
+void MotorDriver::setCurrentLimit(const CurrentLimit& limit)
+{
+	std::lock_guard<std::mutex> lock(fMutex);
+	fCurrentLimit = limit;
+}
+
+auto MotorDriver::currentLimit() -> CurrentLimit
+{
+	std::lock_guard<std::mutex> lock(fMutex);
+	return fCurrentLimit;
+}
+
+auto MotorDriver::thermalLoad() -> double
+{
+	std::lock_guard<std::mutex> lock(fMutex);
+	if ( fCurrentLimit.i2t <= 0. ) return 0.;
+	return fI2t / fCurrentLimit.i2t;
+}
+
+auto MotorDriver::resetTrip() -> bool
+{
+	std::lock_guard<std::mutex> lock(fMutex);
+	if ( !fTripped ) return true;
+	if ( fCurrentLimit.i2t > 0. && fI2t > fCurrentLimit.i2t ) return false;
+	fTargetDutyCycle = 0.;
+	fTripped = false;
+	setEnabled(true);
+	return true;
+}
+
+auto MotorDriver::tripEvents() -> std::vector<TripEvent>
+{
+	std::lock_guard<std::mutex> lock(fMutex);
+	std::vector<TripEvent> events { fTripEvents.begin(), fTripEvents.end() };
+	fTripEvents.clear();
+	return events;
 }
 
 void MotorDriver::measureVoltageOffset() {
@@ -221,6 +366,8 @@ void MotorDriver::setSpeed(float speed_ratio) {
 
 void MotorDriver::move(float speed_ratio) {
 	const std::lock_guard<std::mutex> lock(fMutex);
+	// a tripped driver stays switched off until the trip is reset
+	if ( fTripped ) return;
 	fTargetDutyCycle = clamp(speed_ratio, -1.f, 1.f);
 }
 
@@ -229,8 +376,10 @@ void MotorDriver::stop() {
 }
 
 void MotorDriver::emergencyStop() {
-	this->move(0.);
-	setEnabled(true);
+	const std::lock_guard<std::mutex> lock(fMutex);
+	fTargetDutyCycle = 0.;
+	// a tripped driver stays disabled until the trip is reset
+	if ( !fTripped ) setEnabled(true);
 }
 
 void MotorDriver::setEnabled(bool enable) {
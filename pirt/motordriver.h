@@ -15,17 +15,25 @@
 #include <queue>
 #include <list>
 #include <mutex>
+#include <atomic>
+#include <deque>
 
 #include "gpioif.h"
 #include "utility.h"
+#include "loop_timer.h"
+#include "thread_policy.h"
+#include "motor_telemetry.h"
+#include "ads1115_scheduler.h"
 
 class GPIO;
-class ADS1115;
 
 namespace PiRaTe {
 
 constexpr unsigned int DEFAULT_PWM_FREQ { 20000 };
 constexpr unsigned int OFFSET_RINGBUFFER_DEPTH { 16 };
+constexpr std::size_t MAX_TRIP_EVENTS { 32 };
+constexpr std::size_t TELEMETRY_RECORDER_DEPTH { 2048 }; ///< number of ramp loop cycles kept by the flight recorder (20 s)
+constexpr std::size_t TELEMETRY_POST_TRIGGER_CYCLES { 50 }; ///< number of cycles recorded after a trigger before the recorder freezes
 
 /**
  * @brief Interface class for control of PWM-based DC motor driver boards.
@@ -36,9 +44,19 @@ constexpr unsigned int OFFSET_RINGBUFFER_DEPTH { 16 };
  * defined. The Dir pin is ignored in this case. Enable and Fault signals are not mandatory, but used and evaluated
  * when defined. Set unused signals to -1.
  * Some motor driver modules provide an analog signal for the supervision of the motor current. If this shall be
- * measured, a shared pointer to an instance of an {@link ADS1115} class can be provided additionally in the constructor.
+ * measured, a shared pointer to the {@link Ads1115Scheduler} of an ADS1115 ADC can be provided additionally in the constructor.
  * It is assumed, that the motor driver's current-supervision signal is connected to one input channel of the ADC.
- * Specify the corresponding ADS1115 channel in the constructor in this case.
+ * Specify the corresponding ADS1115 channel in the constructor in this case. The driver subscribes to the channel with
+ * {@link ADC_PRIORITY_MOTOR}.
+ * Each current sample is supervised as soon as it is pushed by the scheduler against a {@link MotorDriver::CurrentLimit}: an instantaneous
+ * trip level and an I²t model of the thermal load of motor and driver. When a limit is exceeded, the PWM output is
+ * switched off immediately (bypassing the ramp) and the driver is disabled through the Enable pin. The trip is latched
+ * until {@link MotorDriver::resetTrip} is called, the trip events are queued with time stamps for later retrieval.
+ * While the motor is energized, the current is sampled at the rate of the ramp loop, otherwise at a reduced rate.
+ * A driver fault stops the motor, but does not enable a tripped driver again.
+ * A flight recorder keeps the state of the last {@link TELEMETRY_RECORDER_DEPTH} cycles of the ramp loop in a fixed
+ * ring buffer ({@link MotorTelemetryRecord}). On a trigger (trip, driver fault or externally by {@link MotorDriver::triggerTelemetry})
+ * some more cycles are recorded and then the recorder freezes, until the content was fetched and the recorder released.
  * @note none
  * @author HG Zaunick
  */
@@ -58,20 +76,40 @@ public:
 		int Fault; ///< GPIO pin of the fault signal (low-active input). The internal pull-up will be enabled when using this signal)
     };
 
+	/**
+	* @brief Limits for the supervision of the motor current.
+	* The I²t model integrates (I² - continuous²) over time, clamped at zero. It trips, when the integral exceeds
+	* the i2t capacity, i.e. a current I may flow for i2t/(I² - continuous²) seconds. Below the continuous current,
+	* the load decays again with the same rate law.
+	*/
+	struct CurrentLimit {
+		double peak { 0. }; ///< instantaneous trip current in A, 0 disables the check
+		double continuous { 0. }; ///< current which may flow indefinitely in A
+		double i2t { 0. }; ///< thermal capacity above the continuous current in A²s, 0 disables the I²t model
+	};
+
+	struct TripEvent {
+		enum class Reason { Overcurrent, I2t };
+		std::chrono::steady_clock::time_point time { }; ///< time of the current sample which caused the trip
+		Reason reason { Reason::Overcurrent };
+		double current { 0. }; ///< the measured current in A
+		double load { 0. }; ///< the I²t load relative to the capacity
+	};
+
 	MotorDriver()=delete;
 	/**
 	* @brief The main constructor.
 	* Initializes an object with the given gpio object pointer and gpio pin configuration.
 	* @param gpio shared pointer to an initialized GPIO object
 	* @param invertDirection flag which indicates, that positive/negative direction will be swapped
-	* @param adc shared_ptr object to an initialized instance of {@link ADS1115} ADC (not mandatory)
+	* @param adc shared_ptr object to the conversion scheduler of the ADC sensing the motor current (not mandatory)
 	* @param adc_channel channel to use for supervision of motor current, when adc is specified
 	* @throws std::exception if the supplied gpio object is not initialized
 	*/
 
 	MotorDriver( std::shared_ptr<GPIO> gpio, Pins pins,
 				 bool invertDirection=false, 
-				 std::shared_ptr<ADS1115> adc = nullptr, 
+				 std::shared_ptr<Ads1115Scheduler> adc = nullptr, 
 				 std::uint8_t adc_channel = 0   );
 	
 	~MotorDriver();
@@ -90,20 +128,64 @@ public:
 	[[nodiscard]] auto hasDualDir() const -> bool { return ( (fPins.DirA > 0) && (fPins.DirB > 0)); }
 	[[nodiscard]] auto hasAdc() const -> bool { return (fAdc != nullptr); }
 	[[nodiscard]] auto readCurrent() -> double;
+	void setCurrentLimit(const CurrentLimit& limit);
+	[[nodiscard]] auto currentLimit() -> CurrentLimit;
+	/// I²t load relative to the capacity (0...1), 0 if the I²t model is disabled
+	[[nodiscard]] auto thermalLoad() -> double;
+	[[nodiscard]] auto isTripped() const -> bool { return fTripped; }
+	/**
+	 * @brief Release a latched trip and enable the driver again.
+	 * @return false if the I²t load still exceeds the capacity, the trip is kept in this case
+	 */
+	auto resetTrip() -> bool;
+	/// fetch and remove the queued trip events, oldest first
+	[[nodiscard]] auto tripEvents() -> std::vector<TripEvent>;
+	/**
+	 * @brief Trigger the flight recorder.
+	 * The recorder freezes after {@link TELEMETRY_POST_TRIGGER_CYCLES} more cycles, so that the reaction on the event
+	 * is contained as well. Triggers are ignored while a trigger is pending or the recorder is frozen.
+	 * @param reason description of the triggering event, must be a string literal (it is not copied)
+	 */
+	void triggerTelemetry(const char* reason);
+	[[nodiscard]] auto isTelemetryFrozen() const -> bool { return fTelemetryFrozen; }
+	/// the content of the flight recorder, oldest record first, together with the trigger reason and time references
+	[[nodiscard]] auto telemetry() -> MotorTelemetryDump;
+	/// resume recording after a freeze
+	void releaseTelemetry();
 	[[nodiscard]] auto readMaxCurrent() -> double;
 	void resetMaxCurrent();
 	
 	void setEnabled(bool enable);
-	[[nodiscard]] auto adc() -> std::shared_ptr<ADS1115>& { return fAdc; }
+	[[nodiscard]] auto adc() -> std::shared_ptr<Ads1115Scheduler>& { return fAdc; }
+	/// timing statistics of the ramp loop
+	[[nodiscard]] auto loopStatistics() const -> LoopTimer::Statistics { return fLoopTimer.statistics(); }
+	/// distribution of the wake-up latency of the ramp loop in us
+	[[nodiscard]] auto loopLatency() const -> const LoopTimer::LatencyHistogram& { return fLoopTimer.latency(); }
+	void clearLoopLatency() { fLoopTimer.clearLatency(); }
+	/// apply scheduling policy and CPU affinity to the ramp loop thread
+	auto setThreadPolicy(const ThreadPolicy& policy) -> bool { return applyThreadPolicy(fThread.get(), policy); }
 
 private:
     void threadLoop();
 	void setSpeed(float speed_ratio);
+	/// convert and supervise a current sample pushed by the ADC scheduler
+	void processCurrentSample(const Ads1115Scheduler::Sample& sample);
+	/// supervise a new current sample, must be called with fMutex locked
+	void checkCurrent(double current, std::chrono::steady_clock::time_point time);
+	/// switch off the output immediately and latch the trip, must be called with fMutex locked
+	void trip(TripEvent::Reason reason, double current, std::chrono::steady_clock::time_point time);
+	/// the following methods must be called with fMutex locked
+	void recordTelemetry(std::chrono::steady_clock::time_point time, bool fault, bool sampled);
+	void triggerTelemetryLocked(const char* reason);
     void measureVoltageOffset();
 	
 	std::shared_ptr<GPIO> fGpio { nullptr };
     Pins fPins;
-    std::shared_ptr<ADS1115> fAdc { nullptr };
+    std::shared_ptr<Ads1115Scheduler> fAdc { nullptr };
+	Ads1115Scheduler::SubscriptionId fAdcSubscription { -1 };
+	Ads1115Scheduler::Sample fAdcSample { }; ///< latest current sense sample pushed by the scheduler
+	bool fAdcSampleFresh { false };
+	bool fAdcFastRate { false };
 	unsigned int fPwmFreq { DEFAULT_PWM_FREQ };
 	unsigned int fPwmRange { 255 };
 	bool fUpdated { false };
@@ -116,12 +198,26 @@ private:
 	//double fVoltageOffset { 0. };
 	double fCurrent { 0. };
 	double fMaxCurrent { 0. };
+	CurrentLimit fCurrentLimit { };
+	double fI2t { 0. };
+	std::chrono::steady_clock::time_point fLastCurrentTime { };
+	std::atomic<bool> fTripped { false };
+	std::deque<TripEvent> fTripEvents { };
+
+	std::array<MotorTelemetryRecord, TELEMETRY_RECORDER_DEPTH> fTelemetry { };
+	std::size_t fTelemetryHead { 0 };
+	std::size_t fTelemetryCount { 0 };
+	std::size_t fTelemetryPostTrigger { 0 };
+	bool fTelemetryTriggered { false };
+	std::atomic<bool> fTelemetryFrozen { false };
+	const char* fTelemetryReason { "" };
 
     std::unique_ptr<std::thread> fThread { nullptr };
 
 	std::mutex fMutex;
 	
 	Ringbuffer<double, OFFSET_RINGBUFFER_DEPTH> fOffsetBuffer { };
+	LoopTimer fLoopTimer;
 };
 
 } // namespace PiRaTe
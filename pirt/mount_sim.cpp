@@ -0,0 +1,229 @@
+#include <algorithm>
+#include <cmath>
+
+#include "gpio_sim.h"
+#include "ssi_decoder.h"
+#include "mount_sim.h"
+
+namespace PiRaTe {
+
+constexpr double TWO_PI { 2. * M_PI };
+
+namespace {
+auto encoderReading(const MountSimulator::AxisParameters& parameters, double axisAngle) -> double
+{
+	const double turns { axisAngle / TWO_PI * parameters.encoderRatio };
+	return ( (parameters.invertEncoder) ? -turns : turns ) + parameters.encoderOffset;
+}
+} // namespace
+
+MountSimulator::MountSimulator(std::shared_ptr<SimGPIO> gpio, const std::vector<AxisParameters>& axes, std::uint32_t seed)
+	: fGpio { gpio }, fRandom { seed }
+{
+	for ( const auto& parameters: axes ) {
+		Axis axis { };
+		axis.parameters = parameters;
+		fAxes.push_back(axis);
+	}
+	for (std::size_t i = 0; i < fAxes.size(); i++) {
+		fGpio->setSpiResponder( fAxes[i].parameters.spiInterface, fAxes[i].parameters.spiChannel,
+			[this, i](unsigned int nBytes) { return this->encoderResponse(i, nBytes); } );
+	}
+}
+
+MountSimulator::~MountSimulator()
+{
+	stop();
+	for ( const auto& axis: fAxes ) {
+		fGpio->setSpiResponder( axis.parameters.spiInterface, axis.parameters.spiChannel, SimGPIO::SpiResponder { } );
+	}
+}
+
+void MountSimulator::start(double timeScale)
+{
+	fTimeScale = std::max(timeScale, 0.);
+	if ( fActiveLoop ) return;
+	{
+		std::lock_guard<std::mutex> lock(fMutex);
+		fLastStep = std::chrono::steady_clock::now();
+	}
+	fLoopTimer.reset();
+	fActiveLoop = true;
+	fThread = std::make_unique<std::thread>( [this]() { this->threadLoop(); } );
+}
+
+void MountSimulator::stop()
+{
+	fActiveLoop = false;
+	if ( fThread != nullptr && fThread->joinable() ) fThread->join();
+	fThread.reset();
+}
+
+void MountSimulator::threadLoop()
+{
+	while ( fActiveLoop ) {
+		fLoopTimer.wait();
+		const auto now { std::chrono::steady_clock::now() };
+		std::chrono::steady_clock::time_point last { };
+		{
+			std::lock_guard<std::mutex> lock(fMutex);
+			last = fLastStep;
+		}
+		advance( std::chrono::duration<double>(now - last).count() * fTimeScale, now );
+	}
+}
+
+void MountSimulator::step(double dt)
+{
+	advance( dt, std::chrono::steady_clock::now() );
+}
+
+void MountSimulator::advance(double dt, std::chrono::steady_clock::time_point now)
+{
+	if ( dt <= 0. ) return;
+	// the pins are sampled before taking the lock, the axis parameters do not change after construction
+	std::vector<Drive> drives { };
+	for ( const auto& axis: fAxes ) drives.push_back( readDrive(axis.parameters) );
+	const unsigned long nr_steps { static_cast<unsigned long>( std::ceil( dt / MOUNT_SIM_INTEGRATION_STEP ) ) };
+	const double h { dt / nr_steps };
+
+	std::lock_guard<std::mutex> lock(fMutex);
+	for (std::size_t i = 0; i < fAxes.size(); i++) {
+		fAxes[i].drive = drives[i];
+		for (unsigned long n = 0; n < nr_steps; n++) integrate(fAxes[i], h);
+	}
+	fSimTime += dt;
+	fLastStep = now;
+}
+
+auto MountSimulator::readDrive(const AxisParameters& parameters) const -> Drive
+{
+	const MotorDriver::Pins& pins { parameters.pins };
+	Drive drive { };
+	drive.enabled = ( pins.Enable > 0 ) ? fGpio->pin( static_cast<unsigned int>(pins.Enable) ).state : true;
+	if ( pins.Pwm < 0 ) return drive;
+	double duty { fGpio->pin( static_cast<unsigned int>(pins.Pwm) ).dutyCycle() };
+	// the driver sets the direction output high for the negative direction, unless inverted
+	bool negative { false };
+	if ( pins.DirA > 0 && pins.DirB > 0 ) {
+		const bool dir_a { fGpio->pin( static_cast<unsigned int>(pins.DirA) ).state };
+		const bool dir_b { fGpio->pin( static_cast<unsigned int>(pins.DirB) ).state };
+		// equal levels on both half bridges short the motor
+		if ( dir_a == dir_b ) duty = 0.;
+		negative = dir_a;
+	} else if ( pins.Dir > 0 ) {
+		negative = fGpio->pin( static_cast<unsigned int>(pins.Dir) ).state;
+	}
+	if ( parameters.invertDirection ) negative = !negative;
+	drive.duty = (negative) ? -duty : duty;
+	return drive;
+}
+
+auto MountSimulator::coupling(const Axis& axis) -> double
+{
+	const AxisParameters& p { axis.parameters };
+	const double delta { axis.motorAngle / p.gearRatio - axis.axisAngle };
+	const double play { 0.5 * p.backlash * M_PI / 180. };
+	if ( std::abs(delta) <= play ) return 0.;
+	const double deflection { delta - std::copysign(play, delta) };
+	const double torque { p.stiffness * deflection + p.damping * ( axis.motorVelocity / p.gearRatio - axis.axisVelocity ) };
+	// the teeth may push but not pull
+	return (deflection > 0.) ? std::max(torque, 0.) : std::min(torque, 0.);
+}
+
+void MountSimulator::integrate(Axis& axis, double dt)
+{
+	const AxisParameters& p { axis.parameters };
+	// armature circuit, the current vanishes immediately when the bridge is disabled
+	if ( axis.drive.enabled ) {
+		const double voltage { axis.drive.duty * p.supplyVoltage };
+		axis.current += ( voltage - p.resistance * axis.current - p.torqueConstant * axis.motorVelocity ) / p.inductance * dt;
+	} else {
+		axis.current = 0.;
+	}
+	const double torque { coupling(axis) };
+
+	// rotor, the gearbox torque is reduced by the gear ratio
+	axis.motorVelocity += ( p.torqueConstant * axis.current - p.motorFriction * axis.motorVelocity - torque / p.gearRatio ) / p.motorInertia * dt;
+	axis.motorAngle += axis.motorVelocity * dt;
+
+	// axis with stiction: it stays at rest as long as the driving torque does not exceed the Coulomb friction
+	const double drive_torque { torque - p.viscousFriction * axis.axisVelocity };
+	if ( axis.axisVelocity != 0. || std::abs(drive_torque) > p.coulombFriction ) {
+		const double direction { ( axis.axisVelocity != 0. ) ? std::copysign(1., axis.axisVelocity) : std::copysign(1., drive_torque) };
+		const double velocity { axis.axisVelocity + ( drive_torque - direction * p.coulombFriction ) / p.loadInertia * dt };
+		// friction stops the axis but does not reverse it
+		axis.axisVelocity = ( axis.axisVelocity != 0. && velocity * axis.axisVelocity < 0. ) ? 0. : velocity;
+	}
+	axis.axisAngle += axis.axisVelocity * dt;
+}
+
+auto MountSimulator::encoderResponse(std::size_t axis, unsigned int nBytes) -> std::vector<std::uint8_t>
+{
+	std::uint32_t word { 0 };
+	{
+		std::lock_guard<std::mutex> lock(fMutex);
+		const Axis& a { fAxes[axis] };
+		const AxisParameters& p { a.parameters };
+		double angle { a.axisAngle };
+		// in real-time operation, the position is extrapolated from the last simulation cycle to the instant of the read
+		if ( fActiveLoop ) angle += a.axisVelocity * std::chrono::duration<double>( std::chrono::steady_clock::now() - fLastStep ).count() * fTimeScale;
+		const double resolution { static_cast<double>( 1ULL << p.stBits ) };
+		double counts { encoderReading(p, angle) * resolution };
+		if ( p.encoderNoise > 0. ) counts += std::normal_distribution<double>(0., p.encoderNoise)(fRandom);
+		const double turns { std::floor( counts / resolution ) };
+		SsiFrame frame { };
+		frame.mt = static_cast<std::int32_t>(turns);
+		frame.st = static_cast<std::uint32_t>( std::floor( counts - turns * resolution ) );
+		word = encodeSsiFrame( frame, p.stBits, p.mtBits );
+		if ( p.bitErrorRate > 0. ) {
+			std::bernoulli_distribution bit_error(p.bitErrorRate);
+			for (unsigned int bit = 0; bit < 32; bit++) {
+				if ( bit_error(fRandom) ) word ^= 1U << bit;
+			}
+		}
+	}
+	fEncoderReads++;
+	// the frame is transmitted MSB first
+	std::vector<std::uint8_t> data(nBytes, 0);
+	for (unsigned int i = 0; i < std::min(nBytes, 4U); i++) data[i] = static_cast<std::uint8_t>( word >> (8 * (3 - i)) );
+	return data;
+}
+
+auto MountSimulator::state(std::size_t axis) const -> AxisState
+{
+	std::lock_guard<std::mutex> lock(fMutex);
+	const Axis& a { fAxes.at(axis) };
+	const AxisParameters& p { a.parameters };
+	AxisState state { };
+	state.current = a.current;
+	state.motorVelocity = a.motorVelocity;
+	state.axisPosition = a.axisAngle / TWO_PI;
+	state.axisVelocity = a.axisVelocity / TWO_PI;
+	const double delta { a.motorAngle / p.gearRatio - a.axisAngle };
+	const double play { 0.5 * p.backlash * M_PI / 180. };
+	if ( std::abs(delta) > play ) state.windup = ( delta - std::copysign(play, delta) ) * 180. / M_PI;
+	state.encoderPosition = encoderReading(p, a.axisAngle);
+	state.voltage = (a.drive.enabled) ? a.drive.duty * p.supplyVoltage : 0.;
+	state.enabled = a.drive.enabled;
+	return state;
+}
+
+void MountSimulator::setAxisPosition(std::size_t axis, double position)
+{
+	std::lock_guard<std::mutex> lock(fMutex);
+	Axis& a { fAxes.at(axis) };
+	a.axisAngle = position * TWO_PI;
+	a.motorAngle = a.axisAngle * a.parameters.gearRatio;
+	a.axisVelocity = 0.;
+	a.motorVelocity = 0.;
+	a.current = 0.;
+}
+
+auto MountSimulator::simulatedTime() const -> double
+{
+	std::lock_guard<std::mutex> lock(fMutex);
+	return fSimTime;
+}
+
+} // namespace PiRaTe
@@ -0,0 +1,164 @@
+#ifndef MOUNT_SIM_H
+#define MOUNT_SIM_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "gpioif.h"
+#include "motordriver.h"
+#include "loop_timer.h"
+#include "thread_policy.h"
+
+class SimGPIO;
+
+namespace PiRaTe {
+
+constexpr double MOUNT_SIM_INTEGRATION_STEP { 100e-6 }; ///< time step of the numerical integration of the plant in s
+constexpr std::chrono::microseconds MOUNT_SIM_LOOP_PERIOD { 1000 }; ///< period of the real-time simulation loop
+
+/**
+ * @brief Physical model of the mount axes driven through a {@link SimGPIO} backend.
+ * Each axis is modelled as a DC motor (armature resistance and inductance, torque/back-EMF constant, rotor inertia
+ * and viscous friction), which drives the axis through a gearbox with finite stiffness, damping and backlash.
+ * The axis is a rigid inertia with viscous and Coulomb friction (including stiction). The axis position is read by an
+ * absolute SSI encoder, which may be geared to the axis and adds gaussian position noise and random bit errors
+ * to the transmitted data word.
+ * The simulator reads the motor driver outputs (PWM duty cycle, direction and enable pins) from the SimGPIO object
+ * and answers the SPI reads of the encoders with frames computed from the current axis positions. Thus the driver
+ * classes ({@link MotorDriver}, {@link SsiPosEncoder}, {@link AxisServo}) run unmodified on top of the model.
+ * The I2C devices (motor current sense, voltage monitors) are not simulated, the motor currents of the model
+ * are available through {@link MountSimulator::state}.
+ * The plant is advanced either explicitly by {@link MountSimulator::step}, which does not depend on the wall clock and
+ * runs as fast as the CPU allows, or by a background thread in sync with the steady clock ({@link MountSimulator::start}),
+ * optionally accelerated by a time scale factor.
+ * All quantities are in SI units unless stated otherwise.
+ * @note The simulator must outlive the encoder objects reading from it.
+ * @author HG Zaunick
+ */
+class MountSimulator {
+public:
+	struct AxisParameters {
+		MotorDriver::Pins pins { -1, -1, -1, -1, -1, -1 }; ///< GPIO pins of the motor driver, same assignment as for the MotorDriver
+		bool invertDirection { false }; ///< same meaning as the invertDirection argument of the MotorDriver
+		GPIO::SPI_INTERFACE spiInterface { GPIO::SPI_INTERFACE::Main }; ///< SPI interface of the encoder
+		std::uint8_t spiChannel { 0 }; ///< SPI chip select of the encoder
+		// motor
+		double supplyVoltage { 24. }; ///< H-bridge supply voltage in V
+		double resistance { 4. }; ///< armature resistance in Ohm
+		double inductance { 2e-3 }; ///< armature inductance in H
+		double torqueConstant { 0.05 }; ///< torque constant in Nm/A, equal to the back-EMF constant in Vs/rad
+		double motorInertia { 1e-5 }; ///< rotor inertia in kg m^2
+		double motorFriction { 1e-5 }; ///< viscous friction of the rotor in Nm s/rad
+		// gearbox
+		double gearRatio { 25000. }; ///< motor revolutions per axis revolution
+		double backlash { 0.02 }; ///< total backlash of the gearbox in axis degrees
+		double stiffness { 1e6 }; ///< torsional stiffness of the gearbox in Nm/rad at the axis
+		double damping { 2e4 }; ///< torsional damping of the gearbox in Nm s/rad at the axis
+		// axis
+		double loadInertia { 2000. }; ///< inertia of the axis in kg m^2
+		double viscousFriction { 1000. }; ///< viscous friction of the axis in Nm s/rad
+		double coulombFriction { 200. }; ///< Coulomb (and static) friction torque of the axis in Nm
+		// encoder
+		double encoderRatio { 1. }; ///< encoder revolutions per axis revolution
+		double encoderOffset { 0. }; ///< encoder reading in rev at axis position zero
+		bool invertEncoder { false }; ///< encoder counts down for positive axis motion
+		std::uint8_t stBits { 12 }; ///< single-turn bit width
+		std::uint8_t mtBits { 12 }; ///< multi-turn bit width
+		double encoderNoise { 0. }; ///< rms of the gaussian position noise in LSB
+		double bitErrorRate { 0. }; ///< probability of an inverted bit in the transmitted data word
+	};
+
+	struct AxisState {
+		double current { 0. }; ///< motor current in A
+		double motorVelocity { 0. }; ///< rotor speed in rad/s
+		double axisPosition { 0. }; ///< axis position in rev
+		double axisVelocity { 0. }; ///< axis speed in rev/s
+		double windup { 0. }; ///< deflection of the gearbox beyond the backlash in axis degrees, 0 while inside the backlash
+		double encoderPosition { 0. }; ///< noise-free encoder reading in rev
+		double voltage { 0. }; ///< voltage applied by the H-bridge in V
+		bool enabled { false }; ///< the H-bridge is enabled
+	};
+
+	MountSimulator() = delete;
+	/**
+	 * @brief The main constructor.
+	 * Registers the encoders as SPI responders of the SimGPIO object. All axes start at rest at axis position zero.
+	 * @param gpio the GPIO simulator the driver classes are connected to
+	 * @param axes the parameters of the axes
+	 * @param seed seed of the random generator for encoder noise and bit errors, equal seeds yield identical runs in stepped mode
+	 */
+	MountSimulator(std::shared_ptr<SimGPIO> gpio, const std::vector<AxisParameters>& axes, std::uint32_t seed = 0);
+	/// stops the simulation thread and detaches the encoders from the SPI devices
+	~MountSimulator();
+
+	/**
+	 * @brief Advance the plant by the given time.
+	 * The outputs of the motor drivers are sampled once at the beginning and held for the whole interval.
+	 * @param dt the simulated time in s, split into integration steps of {@link MOUNT_SIM_INTEGRATION_STEP}
+	 */
+	void step(double dt);
+	/**
+	 * @brief Start the simulation thread, which advances the plant in sync with the steady clock.
+	 * Encoder reads between two simulation cycles are extrapolated to the instant of the read.
+	 * @param timeScale simulated seconds per second of wall time
+	 */
+	void start(double timeScale = 1.);
+	void stop();
+	[[nodiscard]] auto isRunning() const -> bool { return fActiveLoop; }
+
+	[[nodiscard]] auto nrAxes() const -> std::size_t { return fAxes.size(); }
+	[[nodiscard]] auto state(std::size_t axis) const -> AxisState;
+	/// move the axis to the given position in rev at rest, the gearbox is relaxed
+	void setAxisPosition(std::size_t axis, double position);
+	/// total simulated time in s
+	[[nodiscard]] auto simulatedTime() const -> double;
+	/// number of encoder frames transmitted so far
+	[[nodiscard]] auto encoderReads() const -> std::uint64_t { return fEncoderReads; }
+	[[nodiscard]] auto loopStatistics() const -> LoopTimer::Statistics { return fLoopTimer.statistics(); }
+	/// apply scheduling policy and CPU affinity to the simulation thread
+	auto setThreadPolicy(const ThreadPolicy& policy) -> bool { return applyThreadPolicy(fThread.get(), policy); }
+
+private:
+	struct Drive {
+		double duty { 0. }; ///< signed duty cycle (-1...1)
+		bool enabled { false };
+	};
+	struct Axis {
+		AxisParameters parameters { };
+		double current { 0. };
+		double motorAngle { 0. }; ///< rotor angle in rad
+		double motorVelocity { 0. };
+		double axisAngle { 0. }; ///< axis angle in rad
+		double axisVelocity { 0. };
+		Drive drive { };
+	};
+
+	void threadLoop();
+	void advance(double dt, std::chrono::steady_clock::time_point now);
+	[[nodiscard]] auto readDrive(const AxisParameters& parameters) const -> Drive;
+	static void integrate(Axis& axis, double dt);
+	[[nodiscard]] static auto coupling(const Axis& axis) -> double;
+	[[nodiscard]] auto encoderResponse(std::size_t axis, unsigned int nBytes) -> std::vector<std::uint8_t>;
+
+	std::shared_ptr<SimGPIO> fGpio { nullptr };
+	std::vector<Axis> fAxes { };
+	double fSimTime { 0. };
+	std::chrono::steady_clock::time_point fLastStep { };
+	std::mt19937 fRandom;
+	std::atomic<std::uint64_t> fEncoderReads { 0 };
+	std::atomic<double> fTimeScale { 1. };
+	std::atomic<bool> fActiveLoop { false };
+	mutable std::mutex fMutex;
+	LoopTimer fLoopTimer { MOUNT_SIM_LOOP_PERIOD };
+	std::unique_ptr<std::thread> fThread { nullptr };
+};
+
+} // namespace PiRaTe
+
+#endif // MOUNT_SIM_H
@@ -0,0 +1,177 @@
+/* benchmark of the axis control loop on top of the physical mount simulator
+ * usage: mountsim [slew distance in deg] [servo rate in Hz] [encoder rate in Hz]
+ * First, the open-loop response of the Az axis model is characterised in stepped mode, i.e. faster than real time.
+ * Then the Az axis is slewed in closed loop by the MotorDriver, SsiPosEncoder and AxisServo classes, which run
+ * in real time on the simulated hardware. The tracking error, the settling time, the loop statistics and
+ * the CPU time consumed by the process are reported.
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <cstdlib>
+#include <cmath>
+#include <chrono>
+#include <thread>
+
+#include <sys/resource.h>
+
+#include "gpio_sim.h"
+#include "mount_sim.h"
+#include "encoder.h"
+#include "motordriver.h"
+#include "axis_estimator.h"
+#include "axis_servo.h"
+#include "trajectory.h"
+
+constexpr PiRaTe::MotorDriver::Pins AZ_MOTOR_PINS {
+	.Pwm=12,
+	.Dir=-1,
+	.DirA=23,
+	.DirB=24,
+	.Enable=25,
+	.Fault=-1	};
+constexpr bool AZ_MOTOR_DIR_INVERT { true };
+constexpr double AZ_AXIS_TURNS_RATIO { 152./9. };
+constexpr std::uint8_t AZ_ENC_ST_BITS { 12 };
+constexpr std::uint8_t AZ_ENC_MT_BITS { 12 };
+constexpr unsigned int SSI_BAUD_RATE { 500000 };
+constexpr double SETTLE_TOLERANCE { 0.03 / 360. * AZ_AXIS_TURNS_RATIO }; // encoder rev
+constexpr PiRaTe::SCurveProfile::Limits SLEW_LIMITS { 0.9 / 360. * AZ_AXIS_TURNS_RATIO, 0.5 / 360. * AZ_AXIS_TURNS_RATIO, 1. / 360. * AZ_AXIS_TURNS_RATIO };
+
+auto azAxis() -> PiRaTe::MountSimulator::AxisParameters {
+	PiRaTe::MountSimulator::AxisParameters az { };
+	az.pins = AZ_MOTOR_PINS;
+	az.invertDirection = AZ_MOTOR_DIR_INVERT;
+	az.encoderRatio = AZ_AXIS_TURNS_RATIO;
+	az.stBits = AZ_ENC_ST_BITS;
+	az.mtBits = AZ_ENC_MT_BITS;
+	az.encoderNoise = 0.3;
+	return az;
+}
+
+auto cpuTime() -> double {
+	rusage usage { };
+	getrusage(RUSAGE_SELF, &usage);
+	return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec + 1e-6 * ( usage.ru_utime.tv_usec + usage.ru_stime.tv_usec );
+}
+
+int main(int argc, char* argv[]) {
+	const double slew_deg { (argc > 1) ? std::atof(argv[1]) : 10. };
+	const double servo_rate { (argc > 2) ? std::atof(argv[2]) : 200. };
+	const double encoder_rate { (argc > 3) ? std::atof(argv[3]) : 100. };
+
+	// open-loop step response at full duty cycle, simulated as fast as possible
+	double gain { 0. };
+	double tau { 0. };
+	{
+		std::shared_ptr<SimGPIO> gpio { new SimGPIO() };
+		PiRaTe::MountSimulator sim( gpio, { azAxis() } );
+		gpio->set_gpio_state(AZ_MOTOR_PINS.Enable, true);
+		gpio->set_gpio_state(AZ_MOTOR_PINS.DirA, true);
+		gpio->set_gpio_state(AZ_MOTOR_PINS.DirB, false);
+		gpio->hw_pwm_set_value(AZ_MOTOR_PINS.Pwm, 20000, 1000000U);
+		const auto start { std::chrono::steady_clock::now() };
+		constexpr double dt { 1e-3 };
+		double rise_time { 0. };
+		std::vector<double> speeds { };
+		for (double t = 0.; t < 20.; t += dt) {
+			sim.step(dt);
+			speeds.push_back( sim.state(0).axisVelocity * AZ_AXIS_TURNS_RATIO );
+		}
+		gain = speeds.back();
+		for (std::size_t i = 0; i < speeds.size(); i++) {
+			if ( std::abs(speeds[i]) >= 0.632 * std::abs(gain) ) {
+				rise_time = (i + 1) * dt;
+				break;
+			}
+		}
+		tau = rise_time;
+		const double wall { std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count() };
+		std::cout<<"open loop: gain="<<gain<<" enc.rev/s ("<<gain / AZ_AXIS_TURNS_RATIO * 360.<<" deg/s) tau="<<tau * 1e3<<"ms";
+		std::cout<<" windup="<<sim.state(0).windup<<"deg current="<<sim.state(0).current<<"A\n";
+		std::cout<<"           "<<sim.simulatedTime()<<"s simulated in "<<wall<<"s ("<<sim.simulatedTime() / wall<<"x real time)\n";
+	}
+
+	// closed-loop slew in real time
+	std::shared_ptr<SimGPIO> gpio { new SimGPIO() };
+	PiRaTe::MountSimulator sim( gpio, { azAxis() } );
+	sim.start();
+	std::unique_ptr<PiRaTe::SsiPosEncoder> encoder { nullptr };
+	try {
+		encoder.reset( new PiRaTe::SsiPosEncoder(gpio, GPIO::SPI_INTERFACE::Main, SSI_BAUD_RATE) );
+	} catch (std::exception& e) {
+		std::cerr<<"Could not initialize the simulated encoder.\n";
+		return EXIT_FAILURE;
+	}
+	encoder->setStBitWidth(AZ_ENC_ST_BITS);
+	encoder->setMtBitWidth(AZ_ENC_MT_BITS);
+	encoder->setSampleRate(encoder_rate);
+	PiRaTe::MotorDriver motor( gpio, AZ_MOTOR_PINS, AZ_MOTOR_DIR_INVERT );
+	if ( !motor.isInitialized() ) {
+		std::cerr<<"Could not initialize the motor driver.\n";
+		return EXIT_FAILURE;
+	}
+	PiRaTe::AxisEstimator estimator { };
+	PiRaTe::AxisEstimator::Config estimator_config { estimator.config() };
+	estimator_config.tau = tau;
+	estimator_config.gain = gain;
+	estimator.setConfig(estimator_config);
+	estimator.setResolution(AZ_ENC_ST_BITS);
+	{
+		PiRaTe::AxisServo servo( *encoder, estimator, motor );
+		PiRaTe::AxisServo::Config config { servo.config() };
+		config.rate = servo_rate;
+		config.motorGain = gain;
+		config.motorTau = tau;
+		config.tolerance = 0.5 * SETTLE_TOLERANCE;
+		servo.setConfig(config);
+		std::this_thread::sleep_for( std::chrono::milliseconds(500) );
+
+		const double start_pos { servo.state().position };
+		const PiRaTe::SCurveProfile profile( start_pos, start_pos + slew_deg / 360. * AZ_AXIS_TURNS_RATIO, SLEW_LIMITS );
+		const double cpu_start { cpuTime() };
+		const auto start { std::chrono::steady_clock::now() };
+		servo.setTrajectory(profile, start);
+		double max_error { 0. };
+		double sum_sq_error { 0. };
+		unsigned long nr_samples { 0 };
+		double settle_time { -1. };
+		double in_tolerance_since { -1. };
+		double t { 0. };
+		while ( t < profile.duration() + 30. ) {
+			std::this_thread::sleep_for( std::chrono::milliseconds(10) );
+			t = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+			const double error { std::abs( profile.sample(t).position - sim.state(0).encoderPosition ) };
+			if ( t <= profile.duration() ) {
+				max_error = std::max(max_error, error);
+				sum_sq_error += error * error;
+				nr_samples++;
+				continue;
+			}
+			if ( error > SETTLE_TOLERANCE ) {
+				in_tolerance_since = -1.;
+			} else if ( in_tolerance_since < 0. ) {
+				in_tolerance_since = t;
+			} else if ( t - in_tolerance_since > 1. ) {
+				settle_time = in_tolerance_since - profile.duration();
+				break;
+			}
+		}
+		const double wall { std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count() };
+		const double cpu { cpuTime() - cpu_start };
+		servo.disengage();
+
+		const double to_deg { 360. / AZ_AXIS_TURNS_RATIO };
+		std::cout<<"closed loop: slew of "<<slew_deg<<"deg in "<<profile.duration()<<"s";
+		std::cout<<" max. error="<<max_error * to_deg<<"deg rms error="<<std::sqrt( sum_sq_error / std::max(nr_samples, 1UL) ) * to_deg<<"deg";
+		if ( settle_time < 0. ) std::cout<<" not settled\n";
+		else std::cout<<" settled after "<<settle_time<<"s\n";
+		const PiRaTe::LoopTimer::Statistics stats { servo.loopStatistics() };
+		std::cout<<"servo loop: rate="<<stats.rate<<"Hz jitter="<<stats.jitter<<"us max="<<stats.maxJitter<<"us overruns="<<stats.overruns<<"\n";
+		std::cout<<"encoder frames: "<<sim.encoderReads()<<", bit errors: "<<encoder->bitErrorCount()<<"\n";
+		std::cout<<"cpu load: "<<std::setprecision(3)<<100. * cpu / wall<<"% of one core\n";
+	}
+	sim.stop();
+	return EXIT_SUCCESS;
+}
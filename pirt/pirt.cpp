@@ -26,8 +26,24 @@
 
 #include <encoder.h>
 #include <gpioif.h>
+#include <gpio_pigpiod.h>
+#include <gpio_linux.h>
+#include <gpio_sim.h>
+#include <mount_sim.h>
+#include <gpio_async.h>
+#include <gpio_cached.h>
+#include <gpio_input_monitor.h>
+#include <spidev.h>
+#include <ssi_decoder.h>
 #include <motordriver.h>
+#include <axis_servo.h>
+#include <trajectory.h>
+#include <tracking.h>
+#include <thread_policy.h>
+#include <motor_telemetry.h>
+#include <i2cbus.h>
 #include <ads1115.h>
+#include <ads1115_scheduler.h>
 
 namespace Connection
 {
@@ -38,6 +54,13 @@ class TCP;
 
 constexpr unsigned int SSI_BAUD_RATE { 500000 }; //< SPI baud rate for encoder read-out
 constexpr unsigned int POLL_INTERVAL_MS { 200 }; //< polling interval of this driver
+constexpr double ENCODER_SAMPLE_RATE_DEFAULT { 100. }; //< read-out rate of the position encoders in Hz
+constexpr char AZ_SPIDEV_DEFAULT[] { "/dev/spidev0.0" }; //< spidev device of the Az encoder (main SPI, CE0)
+constexpr char EL_SPIDEV_DEFAULT[] { "/dev/spidev1.0" }; //< spidev device of the Alt encoder (aux SPI, CE0)
+constexpr char TELEMETRY_DIR_DEFAULT[] { "/tmp" }; //< directory for the motor telemetry dumps
+constexpr char RADIOMETER_DIR_DEFAULT[] { "/tmp" }; //< directory for the radiometer stream files
+constexpr char RADIOMETER_CHANNEL[] { "Analog1" }; //< measurement channel of the radiometer detector, which can be streamed at full rate
+constexpr double RADIOMETER_RATE_DEFAULT { 860. }; //< requested sample rate of the radiometer stream in Hz
 constexpr double DEFAULT_AZ_AXIS_TURNS_RATIO { 152./9. }; //< ratio between Az encoder revolutions and Az axis revolutions
 constexpr double DEFAULT_EL_AXIS_TURNS_RATIO { 1. }; //< ratio between Alt encoder revolutions and Alt axis revolutions
 constexpr double MAX_AZ_OVERTURN { 0.5 }; //< maximum overturn in Az in revolutions at both ends
@@ -47,9 +70,8 @@ constexpr bool AZ_POS_DIR_INVERT { false }; //< invert helicity of Az axis
 constexpr bool ALT_POS_DIR_INVERT { true }; //< invert helicity of Alt axis
 constexpr double DEFAULT_AZ_AXIS_OFFSET { -181.25 }; //< offset between Az encoder-axis zero and real world Az-axis zero
 constexpr double DEFAULT_ALT_AXIS_OFFSET { 0.64 }; //< offset between Alt encoder-axis zero and real world Alt-axis zero
+constexpr double SIM_ALT_START_POSITION { 10./360. }; //< Alt position of the simulated mount after connecting in revolutions
 
-constexpr double POS_ACCURACY_COARSE { 4.0 }; //< coarse positioning accuracy threshold in degrees
-constexpr double POS_ACCURACY_FINE { 0.2 }; //< fine positioning accuracy threshold in degrees
 constexpr double TRACK_ACCURACY_AZ { 0.06 }; //< tracking accuracy for Az axis threshold in degrees
 constexpr double TRACK_ACCURACY_ALT { 0.04 }; //< tracking accuracy for Alt axis threshold in degrees
 
@@ -59,6 +81,10 @@ constexpr double MIN_AZ_MOTOR_THROTTLE_DEFAULT { 0.07 }; //< minimum applicable
 constexpr double MIN_ALT_MOTOR_THROTTLE_DEFAULT { 0.15 }; //< minimum applicable motor throttle, Alt motor
 constexpr double AZ_MOTOR_CURRENT_LIMIT_DEFAULT { 4.1 }; //< absolute motor current limit for Az motor in Ampere
 constexpr double ALT_MOTOR_CURRENT_LIMIT_DEFAULT { 3.0 }; //< absolute motor current limit for Alt motor in Ampere
+constexpr double AZ_MOTOR_CONTINUOUS_CURRENT_DEFAULT { 2.0 }; //< continuous current of the I2t model for Az motor in Ampere
+constexpr double ALT_MOTOR_CONTINUOUS_CURRENT_DEFAULT { 1.5 }; //< continuous current of the I2t model for Alt motor in Ampere
+constexpr double AZ_MOTOR_I2T_DEFAULT { 20. }; //< I2t capacity above the continuous current for Az motor in A^2s
+constexpr double ALT_MOTOR_I2T_DEFAULT { 10. }; //< I2t capacity above the continuous current for Alt motor in A^2s
 //constexpr double MOTOR_CURRENT_FACTOR { 1./0.14 }; //< conversion factor for motor current sense in A/V
 constexpr bool AZ_MOTOR_DIR_INVERT { true }; //< invert default (positive) direction of Az motor
 constexpr bool ALT_MOTOR_DIR_INVERT { true }; //< invert default (positive) direction of Alt motor
@@ -79,11 +105,36 @@ constexpr PiRaTe::MotorDriver::Pins ALT_MOTOR_PINS {
 	.Enable=26,
 	.Fault=-1	}; //< GPIO pin mapping to functions provided by motor driver
 
+// motor models of the axis estimators, a time constant of 0 disables the model until it is calibrated
+// the gain is the steady-state encoder speed at full duty cycle in encoder revolutions per second
+constexpr struct { double tau; double gain; } AZ_MOTOR_MODEL { 0., 0. };
+constexpr struct { double tau; double gain; } ALT_MOTOR_MODEL { 0., 0. };
+// nominal encoder speeds at full duty cycle, used by the axis servos as long as the motor models are not calibrated
+constexpr double AZ_MOTOR_NOMINAL_GAIN { 0.05 * ( (AZ_POS_DIR_INVERT) ? -1. : 1. ) };
+constexpr double ALT_MOTOR_NOMINAL_GAIN { 0.003 * ( (ALT_POS_DIR_INVERT) ? -1. : 1. ) };
+
+constexpr double SERVO_RATE_DEFAULT { 200. }; //< rate of the axis servo loops in Hz
+constexpr struct { double posKp; double posKi; double velKp; double velKi; } AZ_SERVO_GAINS { 2., 0.5, 2., 4. }; //< default gains of the Az servo loops
+constexpr struct { double posKp; double posKi; double velKp; double velKi; } ALT_SERVO_GAINS { 2., 0.5, 2., 4. }; //< default gains of the Alt servo loops
+constexpr PiRaTe::SCurveProfile::Limits AZ_SLEW_LIMITS { 0.9, 0.5, 1. }; //< default slew limits of the Az axis in deg/s, deg/s^2 and deg/s^3
+constexpr PiRaTe::SCurveProfile::Limits ALT_SLEW_LIMITS { 0.9, 0.5, 1. }; //< default slew limits of the Alt axis in deg/s, deg/s^2 and deg/s^3
+constexpr int ENCODER_THREAD_PRIORITY_DEFAULT { 60 }; //< default SCHED_FIFO priority of the encoder read-out threads
+constexpr int CONTROL_THREAD_PRIORITY_DEFAULT { 50 }; //< default SCHED_FIFO priority of the servo, motor ramp and GPIO I/O threads
+constexpr std::chrono::seconds JITTER_REPORT_DELAY { 60 }; //< time after a change of the thread policies until the loop latencies are reported
+constexpr std::uint64_t JITTER_REPORT_MIN_CYCLES { 100 }; //< minimum number of servo cycles for a meaningful latency report
+constexpr double KEYHOLE_RATE_FRACTION { 0.5 }; //< fraction of the Az slew velocity above which the Az axis is guided through the zenith keyhole while tracking
+
 constexpr std::uint8_t MOTOR_ADC_ADDR { 0x48 }; //< I2C address of ADS1115 ADC for motor current read-out
 constexpr std::uint8_t VOLTAGE_MONITOR_ADC_ADDR { 0x49 }; //< I2C address of ADS1115 ADC for voltage monitoring
+constexpr char I2C_BUS_DEVICE[] { "/dev/i2c-1" }; //< device file of the I2C bus with the ADCs
+constexpr int MOTOR_ADC_I2C_PRIORITY { 10 }; //< I2C transaction priority of the motor current ADC
+constexpr std::chrono::milliseconds MOTOR_ADC_I2C_DEADLINE { 2 }; //< I2C transaction deadline of the motor current ADC
+constexpr int ADC_READY_PIN_DEFAULT { -1 }; //< GPIO input wired to the ALERT/RDY pin of an ADS1115, -1 for polling the conversion status
 
 constexpr std::chrono::milliseconds DEFAULT_INT_TIME { 1000 };
 
+constexpr std::chrono::microseconds GPIO_INPUT_DEBOUNCE { 5000 }; //< minimum stable time of the digital inputs
+
 constexpr unsigned int MAX_TARGET_POINTING_IMPROVEMENT_TIME_MS { 250 };
 
 struct GpioPin {
@@ -128,6 +179,35 @@ const std::map<INDI::Telescope::TelescopeLocation, double> DefaultLocation =
 		{ INDI::Telescope::LOCATION_LONGITUDE, 13.621472 },
 		{ INDI::Telescope::LOCATION_ELEVATION, 200. } };
 
+/**
+ * @brief Convert a steady_clock time to an ISO 8601 UTC string with microsecond resolution.
+ */
+static auto steadyToIsoTime(std::chrono::steady_clock::time_point time) -> std::string
+{
+	const auto system_time { std::chrono::system_clock::now() - std::chrono::duration_cast<std::chrono::system_clock::duration>( std::chrono::steady_clock::now() - time ) };
+	const auto us { std::chrono::duration_cast<std::chrono::microseconds>( system_time.time_since_epoch() ).count() };
+	const time_t raw_time { static_cast<time_t>( us / 1000000 ) };
+	struct tm utc;
+	gmtime_r(&raw_time, &utc);
+	char ts[32];
+	strftime(ts, sizeof(ts), "%Y-%m-%dT%H:%M:%S", &utc);
+	char frac[16];
+	snprintf(frac, sizeof(frac), ".%06ldZ", static_cast<long>( us % 1000000 ));
+	return std::string(ts) + frac;
+}
+
+/**
+ * @brief The current UTC time as compact ISO 8601 string for file names.
+ */
+static auto utcFileTimestamp() -> std::string
+{
+	const time_t raw_time { time(nullptr) };
+	struct tm utc;
+	gmtime_r(&raw_time, &utc);
+	char timestamp[32];
+	strftime(timestamp, sizeof(timestamp), "%Y%m%dT%H%M%SZ", &utc);
+	return timestamp;
+}
 
 // the server will handle one unique instance of the driver
 static std::unique_ptr<PiRT> pirt(new PiRT());
@@ -252,25 +332,149 @@ bool PiRT::initProperties()
     LocationNP.s = IPS_OK;
     IDSetNumber(&LocationNP, NULL);
 
+	IUFillSwitch(&GpioBackendS[GPIO_BACKEND_PIGPIOD], "PIGPIOD", "pigpiod", ISS_ON);
+	IUFillSwitch(&GpioBackendS[GPIO_BACKEND_LINUX], "LINUX", "Linux native", ISS_OFF);
+	IUFillSwitch(&GpioBackendS[GPIO_BACKEND_SIM], "SIM", "Simulator", ISS_OFF);
+	IUFillSwitchVector(&GpioBackendSP, GpioBackendS, 3, getDeviceName(), "GPIO_BACKEND", "GPIO Backend", OPTIONS_TAB,
+           IP_RW, ISR_1OFMANY, 60, IPS_IDLE);
+	defineProperty(&GpioBackendSP);
+	IDSetSwitch(&GpioBackendSP, nullptr);
+
+	// scheduling of the hardware threads, a priority of 0 selects normal scheduling
+	IUFillNumber(&ThreadPolicyN[0], "ENCODER_PRIORITY", "Encoder Priority", "%2.0f", 0, PiRaTe::THREAD_PRIORITY_MAX, 1, ENCODER_THREAD_PRIORITY_DEFAULT);
+	IUFillNumber(&ThreadPolicyN[1], "CONTROL_PRIORITY", "Control Priority", "%2.0f", 0, PiRaTe::THREAD_PRIORITY_MAX, 1, CONTROL_THREAD_PRIORITY_DEFAULT);
+	IUFillNumber(&ThreadPolicyN[2], "CONTROL_CPU", "Control CPU (-1=any)", "%2.0f", -1, 63, 1, -1);
+	IUFillNumber(&ThreadPolicyN[3], "MONITOR_CPU", "Monitoring CPU (-1=any)", "%2.0f", -1, 63, 1, -1);
+	IUFillNumberVector(&ThreadPolicyNP, ThreadPolicyN, 4, getDeviceName(), "THREAD_POLICY", "Thread Policy", OPTIONS_TAB,
+           IP_RW, 60, IPS_IDLE);
+	defineProperty(&ThreadPolicyNP);
+	IUFillSwitch(&ThreadOptionsS[THREAD_OPTION_MLOCK], "MEMORY_LOCK", "Lock Memory", ISS_ON);
+	IUFillSwitch(&ThreadOptionsS[THREAD_OPTION_DEMOTE], "DEMOTE_MONITORING", "Demote Monitoring", ISS_ON);
+	IUFillSwitchVector(&ThreadOptionsSP, ThreadOptionsS, 2, getDeviceName(), "THREAD_OPTIONS", "Thread Options", OPTIONS_TAB,
+           IP_RW, ISR_NOFMANY, 60, IPS_IDLE);
+	defineProperty(&ThreadOptionsSP);
+
+	IUFillText(&TelemetryDirT, "TELEMETRY_DIR", "Directory", TELEMETRY_DIR_DEFAULT);
+	IUFillTextVector(&TelemetryDirTP, &TelemetryDirT, 1, getDeviceName(), "TELEMETRY_DUMPS", "Motor Telemetry Dumps", OPTIONS_TAB,
+           IP_RW, 60, IPS_IDLE);
+	defineProperty(&TelemetryDirTP);
+
+	IUFillText(&RadiometerDirT, "RADIOMETER_DIR", "Directory", RADIOMETER_DIR_DEFAULT);
+	IUFillTextVector(&RadiometerDirTP, &RadiometerDirT, 1, getDeviceName(), "RADIOMETER_FILES", "Radiometer Stream Files", OPTIONS_TAB,
+           IP_RW, 60, IPS_IDLE);
+	defineProperty(&RadiometerDirTP);
+
+	// GPIO inputs wired to the ALERT/RDY pins of the ADCs, applied on the next connect
+	IUFillNumber(&AdcReadyPinN[0], "MOTOR_ADC_RDY", "Motor ADC (-1=poll)", "%2.0f", -1, 27, 1, ADC_READY_PIN_DEFAULT);
+	IUFillNumber(&AdcReadyPinN[1], "MONITOR_ADC_RDY", "Monitor ADC (-1=poll)", "%2.0f", -1, 27, 1, ADC_READY_PIN_DEFAULT);
+	IUFillNumberVector(&AdcReadyPinNP, AdcReadyPinN, 2, getDeviceName(), "ADC_READY_PINS", "ADC Ready Pins", OPTIONS_TAB,
+           IP_RW, 60, IPS_IDLE);
+	defineProperty(&AdcReadyPinNP);
+
 	IUFillNumber(&EncoderBitRateN, "SSI_BITRATE", "SSI Bit Rate", "%5.0f Hz", 0, 5000000, 0, SSI_BAUD_RATE);
     IUFillNumberVector(&EncoderBitRateNP, &EncoderBitRateN, 1, getDeviceName(), "ENC_SPI_SETTINGS", "SPI Interface", "Encoders",
            IP_RW, 60, IPS_IDLE);
 	defineProperty(&EncoderBitRateNP);
     IDSetNumber(&EncoderBitRateNP, nullptr);
 
+	IUFillNumber(&EncoderSampleRateN, "SAMPLE_RATE", "Sample Rate", "%5.1f Hz", 1, 1000, 0, ENCODER_SAMPLE_RATE_DEFAULT);
+    IUFillNumberVector(&EncoderSampleRateNP, &EncoderSampleRateN, 1, getDeviceName(), "ENC_SAMPLING", "Sampling", "Encoders",
+           IP_RW, 60, IPS_IDLE);
+	defineProperty(&EncoderSampleRateNP);
+    IDSetNumber(&EncoderSampleRateNP, nullptr);
+
+	IUFillSwitch(&EncoderTransportS[ENC_TRANSPORT_PIGPIOD], "PIGPIOD", "pigpiod", ISS_ON);
+	IUFillSwitch(&EncoderTransportS[ENC_TRANSPORT_SPIDEV], "SPIDEV", "spidev", ISS_OFF);
+	IUFillSwitchVector(&EncoderTransportSP, EncoderTransportS, 2, getDeviceName(), "ENC_TRANSPORT", "SPI Transport", "Encoders",
+           IP_RW, ISR_1OFMANY, 60, IPS_IDLE);
+	defineProperty(&EncoderTransportSP);
+	IDSetSwitch(&EncoderTransportSP, nullptr);
+
+	IUFillText(&EncoderSpiDevT[0], "AZ_SPIDEV", "Az Device", AZ_SPIDEV_DEFAULT);
+	IUFillText(&EncoderSpiDevT[1], "EL_SPIDEV", "Alt Device", EL_SPIDEV_DEFAULT);
+	IUFillTextVector(&EncoderSpiDevTP, EncoderSpiDevT, 2, getDeviceName(), "ENC_SPIDEV", "spidev Devices", "Encoders",
+           IP_RW, 60, IPS_IDLE);
+	defineProperty(&EncoderSpiDevTP);
+	IDSetText(&EncoderSpiDevTP, nullptr);
+
+	IUFillNumber(&EncoderLatencyN[0], "AZ_LAT_MEAN", "Az Mean", "%5.0f us", 0, 0, 0, 0);
+	IUFillNumber(&EncoderLatencyN[1], "AZ_LAT_P50", "Az Median", "%5.0f us", 0, 0, 0, 0);
+	IUFillNumber(&EncoderLatencyN[2], "AZ_LAT_P99", "Az 99%", "%5.0f us", 0, 0, 0, 0);
+	IUFillNumber(&EncoderLatencyN[3], "AZ_LAT_MAX", "Az Max", "%5.0f us", 0, 0, 0, 0);
+	IUFillNumber(&EncoderLatencyN[4], "EL_LAT_MEAN", "Alt Mean", "%5.0f us", 0, 0, 0, 0);
+	IUFillNumber(&EncoderLatencyN[5], "EL_LAT_P50", "Alt Median", "%5.0f us", 0, 0, 0, 0);
+	IUFillNumber(&EncoderLatencyN[6], "EL_LAT_P99", "Alt 99%", "%5.0f us", 0, 0, 0, 0);
+	IUFillNumber(&EncoderLatencyN[7], "EL_LAT_MAX", "Alt Max", "%5.0f us", 0, 0, 0, 0);
+	IUFillNumberVector(&EncoderLatencyNP, EncoderLatencyN, 8, getDeviceName(), "ENC_LATENCY", "R/O Latency", "Encoders",
+           IP_RO, 60, IPS_IDLE);
+
+	IUFillNumber(&GpioQueueN[0], "QUEUE_DEPTH", "Queue Depth", "%4.0f", 0, 0, 0, 0);
+	IUFillNumber(&GpioQueueN[1], "QUEUE_MAX_DEPTH", "Max Depth", "%4.0f", 0, 0, 0, 0);
+	IUFillNumber(&GpioQueueN[2], "LAT_MEAN", "Mean Latency", "%5.0f us", 0, 0, 0, 0);
+	IUFillNumber(&GpioQueueN[3], "LAT_P99", "99% Latency", "%5.0f us", 0, 0, 0, 0);
+	IUFillNumber(&GpioQueueN[4], "LAT_MAX", "Max Latency", "%5.0f us", 0, 0, 0, 0);
+	IUFillNumber(&GpioQueueN[5], "COALESCED", "Coalesced", "%8.0f", 0, 0, 0, 0);
+	IUFillNumberVector(&GpioQueueNP, GpioQueueN, 6, getDeviceName(), "GPIO_QUEUE", "GPIO Queue", "Monitoring",
+           IP_RO, 60, IPS_IDLE);
+
+	IUFillNumber(&GpioCacheN[0], "SAVED_RATE", "Saved Calls", "%6.1f /s", 0, 0, 0, 0);
+	IUFillNumber(&GpioCacheN[1], "SAVED", "Saved Total", "%8.0f", 0, 0, 0, 0);
+	IUFillNumber(&GpioCacheN[2], "FORWARDED", "Forwarded Total", "%8.0f", 0, 0, 0, 0);
+	IUFillNumberVector(&GpioCacheNP, GpioCacheN, 3, getDeviceName(), "GPIO_CACHE", "GPIO Write Cache", "Monitoring",
+           IP_RO, 60, IPS_IDLE);
+
+	IUFillNumber(&LoopJitterN[0], "ENC_LAT_P50", "Encoder 50%", "%6.0f us", 0, 0, 0, 0);
+	IUFillNumber(&LoopJitterN[1], "ENC_LAT_P99", "Encoder 99%", "%6.0f us", 0, 0, 0, 0);
+	IUFillNumber(&LoopJitterN[2], "ENC_LAT_MAX", "Encoder Max", "%6.0f us", 0, 0, 0, 0);
+	IUFillNumber(&LoopJitterN[3], "SERVO_LAT_P50", "Servo 50%", "%6.0f us", 0, 0, 0, 0);
+	IUFillNumber(&LoopJitterN[4], "SERVO_LAT_P99", "Servo 99%", "%6.0f us", 0, 0, 0, 0);
+	IUFillNumber(&LoopJitterN[5], "SERVO_LAT_MAX", "Servo Max", "%6.0f us", 0, 0, 0, 0);
+	IUFillNumber(&LoopJitterN[6], "MOTOR_LAT_P50", "Motor Ramp 50%", "%6.0f us", 0, 0, 0, 0);
+	IUFillNumber(&LoopJitterN[7], "MOTOR_LAT_P99", "Motor Ramp 99%", "%6.0f us", 0, 0, 0, 0);
+	IUFillNumber(&LoopJitterN[8], "MOTOR_LAT_MAX", "Motor Ramp Max", "%6.0f us", 0, 0, 0, 0);
+	IUFillNumberVector(&LoopJitterNP, LoopJitterN, 9, getDeviceName(), "LOOP_LATENCY", "Loop Wake-up Latency", "Monitoring",
+           IP_RO, 60, IPS_IDLE);
+
+	for ( unsigned int i = 0; i < 8; i++ ) {
+		const std::uint8_t address { (i < 4) ? MOTOR_ADC_ADDR : VOLTAGE_MONITOR_ADC_ADDR };
+		const std::string name { "ADC" + std::to_string(i / 4) + "_CH" + std::to_string(i % 4) };
+		char label[16];
+		snprintf(label, sizeof(label), "0x%02x Ch%u", address, i % 4);
+		IUFillNumber(&AdcRateN[i], name.c_str(), label, "%5.1f /s", 0, 0, 0, 0);
+	}
+	IUFillNumberVector(&AdcRateNP, AdcRateN, 8, getDeviceName(), "ADC_RATES", "ADC Conversions", "Monitoring",
+           IP_RO, 60, IPS_IDLE);
+
+	IUFillNumber(&I2cBusN[0], "UTILIZATION", "Bus Load", "%5.1f %%", 0, 0, 0, 0);
+	IUFillNumber(&I2cBusN[1], "LATENCY_P50", "Latency 50%", "%6.0f us", 0, 0, 0, 0);
+	IUFillNumber(&I2cBusN[2], "LATENCY_P99", "Latency 99%", "%6.0f us", 0, 0, 0, 0);
+	IUFillNumber(&I2cBusN[3], "LATENCY_MAX", "Latency Max", "%6.0f us", 0, 0, 0, 0);
+	IUFillNumber(&I2cBusN[4], "DEADLINE_MISSES", "Deadline Misses", "%8.0f", 0, 0, 0, 0);
+	IUFillNumber(&I2cBusN[5], "ERRORS", "Errors", "%8.0f", 0, 0, 0, 0);
+	IUFillNumber(&I2cBusN[6], "ADC0_LOAD", "Motor ADC Load", "%5.1f %%", 0, 0, 0, 0);
+	IUFillNumber(&I2cBusN[7], "ADC1_LOAD", "Monitor ADC Load", "%5.1f %%", 0, 0, 0, 0);
+	IUFillNumberVector(&I2cBusNP, I2cBusN, 8, getDeviceName(), "I2C_BUS", "I2C Bus", "Monitoring",
+           IP_RO, 60, IPS_IDLE);
+
 	IUFillNumber(&AzEncoderN[0], "AZ_ENC_POS", "Position", "%5.4f rev", -32767, 32767, 0, 0);
 	IUFillNumber(&AzEncoderN[1], "AZ_ENC_ST", "ST", "%5.0f", 0, 65535, 0, 0);
 	IUFillNumber(&AzEncoderN[2], "AZ_ENC_MT", "MT", "%5.0f", -32767, 32767, 0, 0);
     IUFillNumber(&AzEncoderN[3], "AZ_ENC_ERR", "Bit Errors", "%5.0f", 0, 0, 0, 0);
     IUFillNumber(&AzEncoderN[4], "AZ_ENC_ROTIME", "R/O Time", "%5.0f us", 0, 0, 0, 0);
-    IUFillNumberVector(&AzEncoderNP, AzEncoderN, 5, getDeviceName(), "AZ_ENC", "Azimuth", "Encoders",
+    IUFillNumber(&AzEncoderN[5], "AZ_ENC_RATE", "Sample Rate", "%5.1f Hz", 0, 0, 0, 0);
+    IUFillNumber(&AzEncoderN[6], "AZ_ENC_JITTER", "Jitter (rms)", "%5.0f us", 0, 0, 0, 0);
+    IUFillNumber(&AzEncoderN[7], "AZ_ENC_OVERRUNS", "Overruns", "%5.0f", 0, 0, 0, 0);
+    IUFillNumberVector(&AzEncoderNP, AzEncoderN, 8, getDeviceName(), "AZ_ENC", "Azimuth", "Encoders",
            IP_RO, 60, IPS_IDLE);
 	IUFillNumber(&ElEncoderN[0], "EL_ENC_POS", "Position", "%5.4f rev", -32767, 32767, 0, 0);
     IUFillNumber(&ElEncoderN[1], "EL_ENC_ST", "ST", "%5.0f", 0, 65535, 0, 3);
     IUFillNumber(&ElEncoderN[2], "EL_ENC_MT", "MT", "%5.0f", -32767, 32767, 0, 4);
     IUFillNumber(&ElEncoderN[3], "EL_ENC_ERR", "Bit Errors", "%5.0f", 0, 0, 0, 0);
     IUFillNumber(&ElEncoderN[4], "EL_ENC_ROTIME", "R/O Time", "%5.0f us", 0, 0, 0, 0);
-    IUFillNumberVector(&ElEncoderNP, ElEncoderN, 5, getDeviceName(), "EL_ENC", "Elevation", "Encoders",
+    IUFillNumber(&ElEncoderN[5], "EL_ENC_RATE", "Sample Rate", "%5.1f Hz", 0, 0, 0, 0);
+    IUFillNumber(&ElEncoderN[6], "EL_ENC_JITTER", "Jitter (rms)", "%5.0f us", 0, 0, 0, 0);
+    IUFillNumber(&ElEncoderN[7], "EL_ENC_OVERRUNS", "Overruns", "%5.0f", 0, 0, 0, 0);
+    IUFillNumberVector(&ElEncoderNP, ElEncoderN, 8, getDeviceName(), "EL_ENC", "Elevation", "Encoders",
            IP_RO, 60, IPS_IDLE);
 	IUFillNumber(&AzEncSettingN[0], "AZ_ENC_ST_BITS", "ST bits", "%5.0f", 0, 24, 0, 12);
 	IUFillNumber(&AzEncSettingN[1], "AZ_ENC_MT_BITS", "MT bits", "%5.0f", 0, 24, 0, 12);
@@ -308,6 +512,54 @@ bool PiRT::initProperties()
 	IUFillNumber(&AxisAbsTurnsN[1], "ALT_AXIS_TURNS", "Alt", "%5.4f rev", 0, 0, 0, 0);
     IUFillNumberVector(&AxisAbsTurnsNP, AxisAbsTurnsN, 2, getDeviceName(), "AXIS_ABSOLUTE_TURNS", "Absolute Axis Turns", "Axes",
            IP_RO, 60, IPS_IDLE);
+
+	IUFillNumber(&AxisRatesN[0], "AZ_RATE", "Az Rate", "%8.5f deg/s", 0, 0, 0, 0);
+	IUFillNumber(&AxisRatesN[1], "AZ_RATE_ERR", "Az Rate Error", "%8.5f deg/s", 0, 0, 0, 0);
+	IUFillNumber(&AxisRatesN[2], "AZ_ACCEL", "Az Acceleration", "%8.5f deg/s^2", 0, 0, 0, 0);
+	IUFillNumber(&AxisRatesN[3], "AZ_REJECTS", "Az Rejects", "%5.0f", 0, 0, 0, 0);
+	IUFillNumber(&AxisRatesN[4], "ALT_RATE", "Alt Rate", "%8.5f deg/s", 0, 0, 0, 0);
+	IUFillNumber(&AxisRatesN[5], "ALT_RATE_ERR", "Alt Rate Error", "%8.5f deg/s", 0, 0, 0, 0);
+	IUFillNumber(&AxisRatesN[6], "ALT_ACCEL", "Alt Acceleration", "%8.5f deg/s^2", 0, 0, 0, 0);
+	IUFillNumber(&AxisRatesN[7], "ALT_REJECTS", "Alt Rejects", "%5.0f", 0, 0, 0, 0);
+    IUFillNumberVector(&AxisRatesNP, AxisRatesN, 8, getDeviceName(), "AXIS_RATES", "Estimated Rates", "Axes",
+           IP_RO, 60, IPS_IDLE);
+
+	IUFillNumber(&AxisModelN[0], "AZ_MOTOR_TAU", "Az Time Constant", "%5.3f s", 0, 10, 0, AZ_MOTOR_MODEL.tau);
+	IUFillNumber(&AxisModelN[1], "AZ_MOTOR_GAIN", "Az Gain", "%7.4f rev/s", -100, 100, 0, AZ_MOTOR_MODEL.gain);
+	IUFillNumber(&AxisModelN[2], "ALT_MOTOR_TAU", "Alt Time Constant", "%5.3f s", 0, 10, 0, ALT_MOTOR_MODEL.tau);
+	IUFillNumber(&AxisModelN[3], "ALT_MOTOR_GAIN", "Alt Gain", "%7.4f rev/s", -100, 100, 0, ALT_MOTOR_MODEL.gain);
+    IUFillNumberVector(&AxisModelNP, AxisModelN, 4, getDeviceName(), "AXIS_MOTOR_MODEL", "Motor Model", "Axes",
+           IP_RW, 60, IPS_IDLE);
+
+	IUFillNumber(&ServoSettingsN[0], "SERVO_RATE", "Loop Rate", "%5.0f Hz", PiRaTe::SERVO_MIN_RATE, PiRaTe::SERVO_MAX_RATE, 0, SERVO_RATE_DEFAULT);
+	IUFillNumber(&ServoSettingsN[1], "AZ_POS_KP", "Az Pos. Kp", "%6.3f /s", 0, 100, 0, AZ_SERVO_GAINS.posKp);
+	IUFillNumber(&ServoSettingsN[2], "AZ_POS_KI", "Az Pos. Ki", "%6.3f /s^2", 0, 100, 0, AZ_SERVO_GAINS.posKi);
+	IUFillNumber(&ServoSettingsN[3], "AZ_VEL_KP", "Az Vel. Kp", "%6.3f", 0, 100, 0, AZ_SERVO_GAINS.velKp);
+	IUFillNumber(&ServoSettingsN[4], "AZ_VEL_KI", "Az Vel. Ki", "%6.3f /s", 0, 100, 0, AZ_SERVO_GAINS.velKi);
+	IUFillNumber(&ServoSettingsN[5], "ALT_POS_KP", "Alt Pos. Kp", "%6.3f /s", 0, 100, 0, ALT_SERVO_GAINS.posKp);
+	IUFillNumber(&ServoSettingsN[6], "ALT_POS_KI", "Alt Pos. Ki", "%6.3f /s^2", 0, 100, 0, ALT_SERVO_GAINS.posKi);
+	IUFillNumber(&ServoSettingsN[7], "ALT_VEL_KP", "Alt Vel. Kp", "%6.3f", 0, 100, 0, ALT_SERVO_GAINS.velKp);
+	IUFillNumber(&ServoSettingsN[8], "ALT_VEL_KI", "Alt Vel. Ki", "%6.3f /s", 0, 100, 0, ALT_SERVO_GAINS.velKi);
+    IUFillNumberVector(&ServoSettingsNP, ServoSettingsN, 9, getDeviceName(), "SERVO_SETTINGS", "Servo Loops", "Axes",
+           IP_RW, 60, IPS_IDLE);
+
+	IUFillNumber(&ServoStatusN[0], "AZ_SERVO_ERROR", "Az Error", "%7.1f arcsec", 0, 0, 0, 0);
+	IUFillNumber(&ServoStatusN[1], "AZ_SERVO_OUTPUT", "Az Output", "%4.0f %%", -100, 100, 0, 0);
+	IUFillNumber(&ServoStatusN[2], "ALT_SERVO_ERROR", "Alt Error", "%7.1f arcsec", 0, 0, 0, 0);
+	IUFillNumber(&ServoStatusN[3], "ALT_SERVO_OUTPUT", "Alt Output", "%4.0f %%", -100, 100, 0, 0);
+	IUFillNumber(&ServoStatusN[4], "SERVO_LOOP_RATE", "Loop Rate", "%5.1f Hz", 0, 0, 0, 0);
+	IUFillNumber(&ServoStatusN[5], "SERVO_LOOP_JITTER", "Jitter (rms)", "%5.0f us", 0, 0, 0, 0);
+    IUFillNumberVector(&ServoStatusNP, ServoStatusN, 6, getDeviceName(), "SERVO_STATUS", "Servo Status", "Axes",
+           IP_RO, 60, IPS_IDLE);
+
+	IUFillNumber(&SlewLimitsN[0], "AZ_MAX_VEL", "Az Velocity", "%6.3f deg/s", 0.001, 100, 0, AZ_SLEW_LIMITS.velocity);
+	IUFillNumber(&SlewLimitsN[1], "AZ_MAX_ACC", "Az Acceleration", "%6.3f deg/s^2", 0.001, 100, 0, AZ_SLEW_LIMITS.acceleration);
+	IUFillNumber(&SlewLimitsN[2], "AZ_MAX_JERK", "Az Jerk", "%6.3f deg/s^3", 0.001, 1000, 0, AZ_SLEW_LIMITS.jerk);
+	IUFillNumber(&SlewLimitsN[3], "ALT_MAX_VEL", "Alt Velocity", "%6.3f deg/s", 0.001, 100, 0, ALT_SLEW_LIMITS.velocity);
+	IUFillNumber(&SlewLimitsN[4], "ALT_MAX_ACC", "Alt Acceleration", "%6.3f deg/s^2", 0.001, 100, 0, ALT_SLEW_LIMITS.acceleration);
+	IUFillNumber(&SlewLimitsN[5], "ALT_MAX_JERK", "Alt Jerk", "%6.3f deg/s^3", 0.001, 1000, 0, ALT_SLEW_LIMITS.jerk);
+    IUFillNumberVector(&SlewLimitsNP, SlewLimitsN, 6, getDeviceName(), "SLEW_LIMITS", "Slew Limits", "Axes",
+           IP_RW, 60, IPS_IDLE);
 	
 	IUFillNumber(&MotorStatusN[0], "AZ_MOTOR_SPEED", "Az", "%4.0f %%", -100, 100, 0, 0);
 	IUFillNumber(&MotorStatusN[1], "ALT_MOTOR_SPEED", "Alt", "%4.0f %%", -100, 100, 0, 0);
@@ -329,6 +581,22 @@ bool PiRT::initProperties()
     IUFillNumberVector(&MotorCurrentLimitNP, MotorCurrentLimitN, 2, getDeviceName(), "MOTOR_CURRENT_LIMITS", "Motor Current Limits", "Motors",
 		IP_RW, 60, IPS_IDLE);
 
+	IUFillNumber(&MotorI2tN[0], "AZ_MOTOR_CONT_CURRENT", "Az Continuous", "%4.2f A", 0, 20, 0, AZ_MOTOR_CONTINUOUS_CURRENT_DEFAULT);
+	IUFillNumber(&MotorI2tN[1], "AZ_MOTOR_I2T", "Az I2t", "%5.1f A^2s", 0, 1000, 0, AZ_MOTOR_I2T_DEFAULT);
+	IUFillNumber(&MotorI2tN[2], "ALT_MOTOR_CONT_CURRENT", "Alt Continuous", "%4.2f A", 0, 20, 0, ALT_MOTOR_CONTINUOUS_CURRENT_DEFAULT);
+	IUFillNumber(&MotorI2tN[3], "ALT_MOTOR_I2T", "Alt I2t", "%5.1f A^2s", 0, 1000, 0, ALT_MOTOR_I2T_DEFAULT);
+    IUFillNumberVector(&MotorI2tNP, MotorI2tN, 4, getDeviceName(), "MOTOR_I2T_LIMITS", "Motor I2t Limits", "Motors",
+		IP_RW, 60, IPS_IDLE);
+
+	IUFillNumber(&MotorLoadN[0], "AZ_MOTOR_LOAD", "Az", "%4.0f %%", 0, 100, 0, 0);
+	IUFillNumber(&MotorLoadN[1], "ALT_MOTOR_LOAD", "Alt", "%4.0f %%", 0, 100, 0, 0);
+    IUFillNumberVector(&MotorLoadNP, MotorLoadN, 2, getDeviceName(), "MOTOR_I2T_LOAD", "Motor I2t Load", "Motors",
+		IP_RO, 60, IPS_IDLE);
+
+	IUFillSwitch(&ErrorResetS, "MOTOR_TRIP_RESET", "Reset", ISS_OFF);
+	IUFillSwitchVector(&ErrorResetSP, &ErrorResetS, 1, getDeviceName(), "MOTOR_TRIP", "Motor Trip", "Motors",
+		IP_RW, ISR_ATMOST1, 60, IPS_IDLE);
+
 	IUFillNumber(&VoltageMonitorN[0], "VOLTAGE", "+0V", "%4.2f V", 0, 0, 0, 0);
     IUFillNumberVector(&VoltageMonitorNP, VoltageMonitorN, 0, getDeviceName(), "VOLTAGE_MONITOR", "Voltages", "Monitoring",
 		IP_RO, 60, IPS_IDLE);
@@ -336,10 +604,38 @@ bool PiRT::initProperties()
 	IUFillNumber(&VoltageMeasurementN[0], "MEASUREMENT0", "+0V", "%4.2f V", 0, 0, 0, 0);
     IUFillNumberVector(&VoltageMeasurementNP, VoltageMeasurementN, 0, getDeviceName(), "MEASUREMENTS", "Measurements", "Monitoring",
 		IP_RO, 60, IPS_IDLE);
+	IUFillNumber(&MeasurementNoiseN[0], "RMS0", "+0V rms", "%4.2f V", 0, 0, 0, 0);
+    IUFillNumberVector(&MeasurementNoiseNP, MeasurementNoiseN, 0, getDeviceName(), "MEASUREMENT_NOISE", "Measurement Noise", "Monitoring",
+		IP_RO, 60, IPS_IDLE);
+	// raw sample stream of the radiometer channel with the pointing at each sample
+	IUFillSwitch(&RadiometerStreamS[RADIOMETER_RECORD], "RECORD", "Record to File", ISS_OFF);
+	IUFillSwitch(&RadiometerStreamS[RADIOMETER_PUBLISH], "PUBLISH", "Publish BLOBs", ISS_OFF);
+	IUFillSwitchVector(&RadiometerStreamSP, RadiometerStreamS, 2, getDeviceName(), "RADIOMETER_STREAM", "Radiometer Stream", "Radiometer",
+           IP_RW, ISR_NOFMANY, 60, IPS_IDLE);
+	IUFillNumber(&RadiometerRateN, "RATE", "Sample Rate", "%4.0f Hz", 1, 860, 0, RADIOMETER_RATE_DEFAULT);
+    IUFillNumberVector(&RadiometerRateNP, &RadiometerRateN, 1, getDeviceName(), "RADIOMETER_RATE", "Stream Rate", "Radiometer",
+           IP_RW, 60, IPS_IDLE);
+	IUFillNumber(&RadiometerStatusN[0], "RATE", "Achieved Rate", "%5.1f Hz", 0, 0, 0, 0);
+	IUFillNumber(&RadiometerStatusN[1], "SAMPLES", "Samples", "%10.0f", 0, 0, 0, 0);
+	IUFillNumber(&RadiometerStatusN[2], "DROPPED", "Dropped", "%8.0f", 0, 0, 0, 0);
+	IUFillNumber(&RadiometerStatusN[3], "POINTING_MISSES", "Without Pointing", "%8.0f", 0, 0, 0, 0);
+	IUFillNumber(&RadiometerStatusN[4], "FILE_SIZE", "File Size", "%8.2f MB", 0, 0, 0, 0);
+	IUFillNumber(&RadiometerStatusN[5], "BLOCKS_DROPPED", "Unpublished Chunks", "%8.0f", 0, 0, 0, 0);
+    IUFillNumberVector(&RadiometerStatusNP, RadiometerStatusN, 6, getDeviceName(), "RADIOMETER_STATUS", "Stream Status", "Radiometer",
+		IP_RO, 60, IPS_IDLE);
+	IUFillBLOB(&RadiometerBlobB, "DATA", "Samples", ".pirtrad");
+	IUFillBLOBVector(&RadiometerBlobBP, &RadiometerBlobB, 1, getDeviceName(), "RADIOMETER_DATA", "Stream Data", "Radiometer",
+		IP_RO, 60, IPS_IDLE);
 	IUFillNumber(&MeasurementIntTimeN, "TIME", "time", "%5.2f s", 0, 0, 0, DEFAULT_INT_TIME.count() / 1000.);
     IUFillNumberVector(&MeasurementIntTimeNP, &MeasurementIntTimeN, 1, getDeviceName(), "INT_TIME", "Integration Time", "Monitoring",
            IP_RW, 60, IPS_IDLE);
 
+	IUFillNumber(&MeasurementPositionN[0], "AZ", "Azimuth", "%010.6m", 0, 360, 0, 0);
+	IUFillNumber(&MeasurementPositionN[1], "ALT", "Elevation", "%010.6m", -90, 90, 0, 0);
+	IUFillNumber(&MeasurementPositionN[2], "AGE", "Age", "%5.0f ms", 0, 0, 0, 0);
+    IUFillNumberVector(&MeasurementPositionNP, MeasurementPositionN, 3, getDeviceName(), "MEASUREMENT_POSITION", "Measurement Position", "Monitoring",
+           IP_RO, 60, IPS_IDLE);
+
 	
 	IUFillNumber(&TempMonitorN[0], "TEMP_SYSTEM", "CPU", "%4.2f °C", 0, 0, 0, 0);
 	IUFillNumberVector(&TempMonitorNP, TempMonitorN, 0, getDeviceName(), "TEMPERATURE_MONITOR", "Temperatures", "Monitoring",
@@ -396,16 +692,36 @@ bool PiRT::updateProperties()
 
 		defineProperty(&AzEncoderNP);
 		defineProperty(&ElEncoderNP);
+		defineProperty(&EncoderLatencyNP);
 		defineProperty(&AxisAbsTurnsNP);
+		defineProperty(&AxisRatesNP);
+		defineProperty(&AxisModelNP);
+		defineProperty(&ServoSettingsNP);
+		defineProperty(&ServoStatusNP);
+		defineProperty(&SlewLimitsNP);
 		defineProperty(&MotorStatusNP);
 		defineProperty(&MotorCurrentNP);
 		defineProperty(&MotorThresholdNP);
 		defineProperty(&MotorCurrentLimitNP);
+		defineProperty(&MotorI2tNP);
+		defineProperty(&MotorLoadNP);
+		defineProperty(&ErrorResetSP);
 		defineProperty(&VoltageMonitorNP);
 		defineProperty(&VoltageMeasurementNP);
+		defineProperty(&MeasurementNoiseNP);
 		defineProperty(&MeasurementIntTimeNP);
+		defineProperty(&MeasurementPositionNP);
 		defineProperty(&TempMonitorNP);
 		defineProperty(&DriverUpTimeNP);
+		defineProperty(&GpioQueueNP);
+		defineProperty(&GpioCacheNP);
+		defineProperty(&LoopJitterNP);
+		defineProperty(&AdcRateNP);
+		defineProperty(&I2cBusNP);
+		defineProperty(&RadiometerStreamSP);
+		defineProperty(&RadiometerRateNP);
+		defineProperty(&RadiometerStatusNP);
+		defineProperty(&RadiometerBlobBP);
 		
 		defineProperty(&OutputSwitchSP);
 		defineProperty(&GpioInputLP);
@@ -426,16 +742,36 @@ bool PiRT::updateProperties()
 
 		deleteProperty(AzEncoderNP.name);
 		deleteProperty(ElEncoderNP.name);
+		deleteProperty(EncoderLatencyNP.name);
 		deleteProperty(AxisAbsTurnsNP.name);
+		deleteProperty(AxisRatesNP.name);
+		deleteProperty(AxisModelNP.name);
+		deleteProperty(ServoSettingsNP.name);
+		deleteProperty(ServoStatusNP.name);
+		deleteProperty(SlewLimitsNP.name);
 		deleteProperty(MotorStatusNP.name);
 		deleteProperty(MotorCurrentNP.name);
 		deleteProperty(MotorThresholdNP.name);
 		deleteProperty(MotorCurrentLimitNP.name);
+		deleteProperty(MotorI2tNP.name);
+		deleteProperty(MotorLoadNP.name);
+		deleteProperty(ErrorResetSP.name);
 		deleteProperty(VoltageMonitorNP.name);
 		deleteProperty(VoltageMeasurementNP.name);
+		deleteProperty(MeasurementNoiseNP.name);
 		deleteProperty(MeasurementIntTimeNP.name);
+		deleteProperty(MeasurementPositionNP.name);
 		deleteProperty(TempMonitorNP.name);
 		deleteProperty(DriverUpTimeNP.name);
+		deleteProperty(GpioQueueNP.name);
+		deleteProperty(GpioCacheNP.name);
+		deleteProperty(LoopJitterNP.name);
+		deleteProperty(AdcRateNP.name);
+		deleteProperty(I2cBusNP.name);
+		deleteProperty(RadiometerStreamSP.name);
+		deleteProperty(RadiometerRateNP.name);
+		deleteProperty(RadiometerStatusNP.name);
+		deleteProperty(RadiometerBlobBP.name);
 		
 		deleteProperty(OutputSwitchSP.name);
 		deleteProperty(GpioInputLP.name);
@@ -452,6 +788,10 @@ bool PiRT::ISNewSwitch (const char *dev, const char *name, ISState *states, char
 {
 	if(strcmp(dev,getDeviceName())==0)
 	{
+		if(!strcmp(name,AbortSP.name)) {
+			// keep the motor history of aborted motions, the abort itself is handled by the base class
+			triggerFlightRecorders("abort");
+		}
 		//  Set output switch (relay switch)
 		if(!strcmp(name,OutputSwitchSP.name)) {
 			std::string tempstr { "Relay" };
@@ -474,12 +814,68 @@ bool PiRT::ISNewSwitch (const char *dev, const char *name, ISState *states, char
 			IUUpdateSwitch(&OutputSwitchSP, states, names, n);
 			IDSetSwitch( &OutputSwitchSP, tempstr.c_str() );
 			return true;
-		}	
+		} else if(!strcmp(name,GpioBackendSP.name)) {
+			// the backend is instantiated when connecting
+			IUUpdateSwitch(&GpioBackendSP, states, names, n);
+			GpioBackendSP.s = IPS_OK;
+			IDSetSwitch(&GpioBackendSP, (isConnected()) ? "GPIO backend will change on next connect" : nullptr);
+			return true;
+		} else if(!strcmp(name,EncoderTransportSP.name)) {
+			// the transport is selected when connecting
+			IUUpdateSwitch(&EncoderTransportSP, states, names, n);
+			EncoderTransportSP.s = IPS_OK;
+			IDSetSwitch(&EncoderTransportSP, (isConnected()) ? "Encoder transport will change on next connect" : nullptr);
+			return true;
+		} else if(!strcmp(name,ErrorResetSP.name)) {
+			// release latched motor trips
+			IUResetSwitch(&ErrorResetSP);
+			bool ok { true };
+			if ( az_motor != nullptr ) ok = az_motor->resetTrip() && ok;
+			if ( el_motor != nullptr ) ok = el_motor->resetTrip() && ok;
+			ErrorResetSP.s = (ok) ? IPS_OK : IPS_ALERT;
+			IDSetSwitch(&ErrorResetSP, (ok) ? "Motor trips reset" : "Motor I2t load still above capacity, trip kept");
+			return true;
+		} else if(!strcmp(name,ThreadOptionsSP.name)) {
+			IUUpdateSwitch(&ThreadOptionsSP, states, names, n);
+			ThreadOptionsSP.s = IPS_OK;
+			IDSetSwitch(&ThreadOptionsSP, nullptr);
+			if ( isConnected() ) applyThreadPolicies();
+			return true;
+		} else if(!strcmp(name,RadiometerStreamSP.name)) {
+			IUUpdateSwitch(&RadiometerStreamSP, states, names, n);
+			applyRadiometerStream();
+			return true;
+		}
 	}
 	//  Nobody has claimed this, so forward it to the base class' method
 	return INDI::Telescope::ISNewSwitch(dev,name,states,names,n);
 }
 
+bool PiRT::ISNewText(const char *dev, const char *name, char *texts[], char *names[], int n)
+{
+	if(strcmp(dev,getDeviceName())==0)
+	{
+		if(!strcmp(name,EncoderSpiDevTP.name)) {
+			IUUpdateText(&EncoderSpiDevTP, texts, names, n);
+			EncoderSpiDevTP.s = IPS_OK;
+			IDSetText(&EncoderSpiDevTP, nullptr);
+			return true;
+		} else if(!strcmp(name,TelemetryDirTP.name)) {
+			IUUpdateText(&TelemetryDirTP, texts, names, n);
+			TelemetryDirTP.s = IPS_OK;
+			IDSetText(&TelemetryDirTP, nullptr);
+			return true;
+		} else if(!strcmp(name,RadiometerDirTP.name)) {
+			// the directory is used for the next recording
+			IUUpdateText(&RadiometerDirTP, texts, names, n);
+			RadiometerDirTP.s = IPS_OK;
+			IDSetText(&RadiometerDirTP, nullptr);
+			return true;
+		}
+	}
+	return INDI::Telescope::ISNewText(dev,name,texts,names,n);
+}
+
 bool PiRT::ISNewNumber(const char *dev, const char *name, double values[], char *names[], int n)
 {
 	if(strcmp(dev,getDeviceName())==0)
@@ -520,6 +916,25 @@ bool PiRT::ISNewNumber(const char *dev, const char *name, double values[], char
 			unsigned int rate = EncoderBitRateNP.np[0].value;
 			DEBUGF(DBG_SCOPE, "Setting SSI bit rate to: %u Hz. Please reconnect client!", rate);
 			return true;
+		} else if(!strcmp(name, EncoderSampleRateNP.name))
+		{
+			// set encoder read-out rate
+			if ( values[0] < 1. || values[0] > 1000. ) {
+				EncoderSampleRateNP.s = IPS_ALERT;
+				IDSetNumber(&EncoderSampleRateNP, nullptr);
+				return false;
+			}
+			EncoderSampleRateNP.s = IPS_OK;
+			EncoderSampleRateN.value = values[0];
+			IDSetNumber(&EncoderSampleRateNP, nullptr);
+			updatePointingParameters();
+			if (isConnected()) {
+				if ( encoder_group != nullptr ) encoder_group->setSampleRate(EncoderSampleRateN.value);
+				az_encoder->setSampleRate(EncoderSampleRateN.value);
+				el_encoder->setSampleRate(EncoderSampleRateN.value);
+			}
+			DEBUGF(DBG_SCOPE, "Setting encoder sample rate to: %5.1f Hz", EncoderSampleRateN.value);
+			return true;
 		} else if(!strcmp(name, AzEncSettingNP.name)) {
 			// set Az encoder bit widths
 			unsigned int stBits = values[0];
@@ -532,6 +947,7 @@ bool PiRT::ISNewNumber(const char *dev, const char *name, double values[], char
 					az_encoder->setStBitWidth(stBits);
 					az_encoder->setMtBitWidth(mtBits);
 				}
+				azEstimator.setResolution(stBits);
 				IDSetNumber(&AzEncSettingNP, nullptr);
 				return true;
 			} else {
@@ -550,6 +966,7 @@ bool PiRT::ISNewNumber(const char *dev, const char *name, double values[], char
 					el_encoder->setStBitWidth(stBits);
 					el_encoder->setMtBitWidth(mtBits);
 				}
+				elEstimator.setResolution(stBits);
 				IDSetNumber(&ElEncSettingNP, nullptr);
 				return true;
 			} else {
@@ -564,8 +981,10 @@ bool PiRT::ISNewNumber(const char *dev, const char *name, double values[], char
 			IDSetNumber(&AzAxisSettingNP, nullptr);
 			axisRatio[0] = values[0];
 			axisOffset[0] = values[1];
+			updatePointingParameters();
 			DEBUGF(DBG_SCOPE, "Setting Az axis turns ratio to %5.4f rev.", axisRatio[0]);
 			DEBUGF(DBG_SCOPE, "Setting Az axis offset %5.4f rev.", axisOffset[0]);
+			applyServoSettings();
 			return true;
 		} else if(!strcmp(name, ElAxisSettingNP.name)) {
 			// El axis settings: encoder-to-axis turns ratio and offset
@@ -575,8 +994,10 @@ bool PiRT::ISNewNumber(const char *dev, const char *name, double values[], char
 			IDSetNumber(&ElAxisSettingNP, nullptr);
 			axisRatio[1] = values[0];
 			axisOffset[1] = values[1];
+			updatePointingParameters();
 			DEBUGF(DBG_SCOPE, "Setting El axis turns ratio to %5.4f rev.", axisRatio[1]);
 			DEBUGF(DBG_SCOPE, "Setting El axis offset %5.4f rev.", axisOffset[1]);
+			applyServoSettings();
 			return true;
 		} else if(!strcmp(name, MotorCurrentLimitNP.name)) {
 			// set motor current limit
@@ -585,6 +1006,24 @@ bool PiRT::ISNewNumber(const char *dev, const char *name, double values[], char
 			MotorCurrentLimitN[1].value = values[1];
 			IDSetNumber(&MotorCurrentLimitNP, nullptr);
 			DEBUGF(DBG_SCOPE, "Setting motor current limits to %5.3f A (Az) and %5.3f A (Alt)", MotorCurrentLimitN[0].value, MotorCurrentLimitN[1].value);
+			applyMotorCurrentLimits();
+			return true;
+		} else if(!strcmp(name, MotorI2tNP.name)) {
+			// set the continuous currents and thermal capacities of the I2t models
+			MotorI2tNP.s = IPS_OK;
+			for (int i = 0; i < 4; i++) MotorI2tN[i].value = values[i];
+			IDSetNumber(&MotorI2tNP, nullptr);
+			DEBUGF(DBG_SCOPE, "Setting motor I2t limits to %5.3f A %5.1f A^2s (Az) and %5.3f A %5.1f A^2s (Alt)", MotorI2tN[0].value, MotorI2tN[1].value, MotorI2tN[2].value, MotorI2tN[3].value);
+			applyMotorCurrentLimits();
+			return true;
+		} else if(!strcmp(name, AxisModelNP.name)) {
+			// set the motor model parameters of the axis estimators
+			AxisModelNP.s = IPS_OK;
+			for (int i = 0; i < 4; i++) AxisModelN[i].value = values[i];
+			IDSetNumber(&AxisModelNP, nullptr);
+			applyAxisModels();
+			applyServoSettings();
+			DEBUGF(DBG_SCOPE, "Setting motor models to tau=%5.3f s gain=%7.4f rev/s (Az) and tau=%5.3f s gain=%7.4f rev/s (Alt)", AxisModelN[0].value, AxisModelN[1].value, AxisModelN[2].value, AxisModelN[3].value);
 			return true;
 		} else if(!strcmp(name, MotorThresholdNP.name)) {
 			// set motor thresholds
@@ -593,6 +1032,56 @@ bool PiRT::ISNewNumber(const char *dev, const char *name, double values[], char
 			MotorThresholdN[1].value = values[1];
 			IDSetNumber(&MotorThresholdNP, nullptr);
 			DEBUGF(DBG_SCOPE, "Setting motor thresholds to %4.0f %% (Az) and %4.0f %% (Alt)", MotorThresholdN[0].value, MotorThresholdN[1].value);
+			applyServoSettings();
+			return true;
+		} else if(!strcmp(name, ServoSettingsNP.name)) {
+			// set the loop rate and gains of the axis servos
+			ServoSettingsNP.s = IPS_OK;
+			for (int i = 0; i < 9; i++) ServoSettingsN[i].value = values[i];
+			IDSetNumber(&ServoSettingsNP, nullptr);
+			applyServoSettings();
+			DEBUGF(DBG_SCOPE, "Setting servo loop rate to %5.0f Hz", ServoSettingsN[0].value);
+			return true;
+		} else if(!strcmp(name, SlewLimitsNP.name)) {
+			// set the velocity, acceleration and jerk limits of the slew trajectories
+			for (int i = 0; i < 6; i++) {
+				if ( values[i] <= 0. ) {
+					SlewLimitsNP.s = IPS_ALERT;
+					IDSetNumber(&SlewLimitsNP, nullptr);
+					DEBUG(INDI::Logger::DBG_ERROR, "Slew limits must be positive.");
+					return false;
+				}
+			}
+			SlewLimitsNP.s = IPS_OK;
+			for (int i = 0; i < 6; i++) SlewLimitsN[i].value = values[i];
+			IDSetNumber(&SlewLimitsNP, nullptr);
+			DEBUGF(DBG_SCOPE, "Setting slew limits to %6.3f deg/s %6.3f deg/s^2 %6.3f deg/s^3 (Az) and %6.3f deg/s %6.3f deg/s^2 %6.3f deg/s^3 (Alt)", SlewLimitsN[0].value, SlewLimitsN[1].value, SlewLimitsN[2].value, SlewLimitsN[3].value, SlewLimitsN[4].value, SlewLimitsN[5].value);
+			return true;
+		} else if(!strcmp(name, ThreadPolicyNP.name)) {
+			// scheduling priorities and cpu affinities of the hardware threads
+			ThreadPolicyNP.s = IPS_OK;
+			for (int i = 0; i < 4; i++) ThreadPolicyN[i].value = std::round( values[i] );
+			IDSetNumber(&ThreadPolicyNP, nullptr);
+			if ( isConnected() ) applyThreadPolicies();
+			return true;
+		} else if(!strcmp(name, AdcReadyPinNP.name)) {
+			// the conversion schedulers pick up the ready pins on the next connect
+			AdcReadyPinNP.s = IPS_OK;
+			for (int i = 0; i < 2; i++) AdcReadyPinN[i].value = std::round( values[i] );
+			IDSetNumber(&AdcReadyPinNP, nullptr);
+			if ( isConnected() ) DEBUG(INDI::Logger::DBG_SESSION, "The ADC ready pins take effect after reconnecting.");
+			return true;
+		} else if(!strcmp(name, RadiometerRateNP.name)) {
+			if ( values[0] < RadiometerRateN.min || values[0] > RadiometerRateN.max ) {
+				RadiometerRateNP.s = IPS_ALERT;
+				IDSetNumber(&RadiometerRateNP, nullptr);
+				DEBUGF(INDI::Logger::DBG_ERROR, "The radiometer stream rate must be within %.0f...%.0f Hz.", RadiometerRateN.min, RadiometerRateN.max);
+				return false;
+			}
+			RadiometerRateNP.s = IPS_OK;
+			RadiometerRateN.value = values[0];
+			IDSetNumber(&RadiometerRateNP, nullptr);
+			if ( radiometerStream != nullptr && radiometerStream->isActive() ) radiometerMeasurement->setSampleRate(RadiometerRateN.value);
 			return true;
 		} else if ( !strcmp(name, MeasurementIntTimeNP.name) ) {
 			if ( !voltageMeasurements.empty() && values[0] > 0. && values[0] < 1000.) {
@@ -614,6 +1103,18 @@ bool PiRT::ISNewNumber(const char *dev, const char *name, double values[], char
 	return INDI::Telescope::ISNewNumber(dev,name,values,names,n);
 }
 
+bool PiRT::saveConfigItems(FILE *fp)
+{
+	INDI::Telescope::saveConfigItems(fp);
+	IUSaveConfigNumber(fp, &ThreadPolicyNP);
+	IUSaveConfigSwitch(fp, &ThreadOptionsSP);
+	IUSaveConfigText(fp, &TelemetryDirTP);
+	IUSaveConfigText(fp, &RadiometerDirTP);
+	IUSaveConfigNumber(fp, &RadiometerRateNP);
+	IUSaveConfigNumber(fp, &AdcReadyPinNP);
+	return true;
+}
+
 bool PiRT::ISSnoopDevice(XMLEle *root) {
 	char *dev, *name;
  
@@ -667,6 +1168,8 @@ bool PiRT::Park() {
     // Mark state as parking
 	TrackState = SCOPE_PARKING;
 	TargetCoordSystem = SYSTEM_HOR;
+	slewPlanned = false;
+	inKeyhole = false;
 
     // Inform client we are slewing to a new position
     DEBUGF(INDI::Logger::DBG_SESSION, "Slewing to Park Pos ( Az: %s - Alt: %s )", AzStr, AltStr);
@@ -702,20 +1205,51 @@ bool PiRT::Connect()
 	const std::string port { tvp->tp[1].text };
 */
 
+	// the writer thread of the radiometer stream reads the encoders, stop it before anything is torn down
+	closeRadiometerStream();
 	// before instanciating a new GPIO interface, all objects which carry a reference
 	// to the old gpio object must be invalidated, to make sure
 	// that noone else uses the shared_ptr<GPIO> when it is newly created
+	inputMonitor.reset();
+	az_servo.reset();
+	el_servo.reset();
+	encoder_group.reset();
 	az_encoder.reset();
 	el_encoder.reset();
 	az_motor.reset();
 	el_motor.reset();
+	mountSimulator.reset();
+	// the conversion schedulers keep the GPIO for the ready pin edge callback,
+	// the monitors and measurements are subscribed to the schedulers
+	voltageMeasurements.clear();
+	voltageMonitors.clear();
+	adcSchedulers.clear();
 	
-//	gpio.reset( new GPIO(host, port) );
-	gpio.reset( new GPIO("localhost", "8888") );
-	if (!gpio->isInitialized()) {
-        DEBUG(INDI::Logger::DBG_ERROR, "Could not initialize GPIO interface. Is pigpiod running?");
+	gpio.reset();
+	gpio_cache.reset();
+	gpio_queue.reset();
+	std::shared_ptr<GPIO> gpio_backend { nullptr };
+//	gpio_backend.reset( new PigpiodGPIO(host, port) );
+	switch (IUFindOnSwitchIndex(&GpioBackendSP)) {
+		case GPIO_BACKEND_LINUX:
+			gpio_backend.reset( new LinuxGPIO() );
+			break;
+		case GPIO_BACKEND_SIM:
+			gpio_backend = createSimulatedGpio();
+			break;
+		default:
+			gpio_backend.reset( new PigpiodGPIO("localhost", "8888") );
+	}
+	if (!gpio_backend->isInitialized()) {
+        DEBUGF(INDI::Logger::DBG_ERROR, "Could not initialize GPIO interface (%s backend). Is pigpiod running?", gpio_backend->backendName().c_str());
 		return false;
 	}
+	// all pin and pwm commands are queued and pipelined by a dedicated I/O thread,
+	// writes which do not change the state of a pin are dropped before they enter the queue
+	gpio_queue.reset( new AsyncGPIO(gpio_backend) );
+	gpio_cache.reset( new CachedGPIO(gpio_queue) );
+	gpio = gpio_cache;
+    DEBUGF(INDI::Logger::DBG_SESSION, "GPIO interface ok (%s backend).", gpio->backendName().c_str());
 	
 	// set the baud rate on the SPI interface for communication with the pos encoders
 	unsigned int bitrate = static_cast<unsigned int>( EncoderBitRateNP.np[0].value );
@@ -724,8 +1258,20 @@ bool PiRT::Connect()
 		return false;
 	}
 
+	const bool useSpiDev { IUFindOnSwitchIndex(&EncoderTransportSP) == ENC_TRANSPORT_SPIDEV };
+
 	// initialize Az pos encoder connected to the main SPI interface
-	az_encoder.reset(new PiRaTe::SsiPosEncoder(gpio, GPIO::SPI_INTERFACE::Main, bitrate, 0, GPIO::SPI_MODE::POL1PHA1));
+	if (useSpiDev) {
+		std::shared_ptr<SpiDev> spidev { new SpiDev(EncoderSpiDevT[0].text, GPIO::SPI_MODE::POL1PHA1, bitrate, false, false) };
+		if (!spidev->isInitialized()) {
+			DEBUGF(INDI::Logger::DBG_ERROR, "Failed to open spidev device %s for Az position encoder.", EncoderSpiDevT[0].text);
+			return false;
+		}
+		if (spidev->isReplay()) DEBUGF(INDI::Logger::DBG_WARNING, "%s is no spidev device, replaying its content.", EncoderSpiDevT[0].text);
+		az_encoder.reset(new PiRaTe::SsiPosEncoder(spidev));
+	} else {
+		az_encoder.reset(new PiRaTe::SsiPosEncoder(gpio, GPIO::SPI_INTERFACE::Main, bitrate, 0, GPIO::SPI_MODE::POL1PHA1));
+	}
 	if (!az_encoder->isInitialized()) {
         DEBUG(INDI::Logger::DBG_ERROR, "Failed to connect to Az position encoder.");
 		return false;
@@ -734,9 +1280,20 @@ bool PiRT::Connect()
 
 	az_encoder->setStBitWidth(AzEncSettingN[0].value);
 	az_encoder->setMtBitWidth(AzEncSettingN[1].value);
+	az_encoder->setSampleRate(EncoderSampleRateN.value);
 
 	// initialize Alt pos encoder connected to the aux SPI interface
-	el_encoder.reset(new PiRaTe::SsiPosEncoder(gpio, GPIO::SPI_INTERFACE::Aux, bitrate));
+	if (useSpiDev) {
+		std::shared_ptr<SpiDev> spidev { new SpiDev(EncoderSpiDevT[1].text, GPIO::SPI_MODE::POL1PHA1, bitrate, false, false) };
+		if (!spidev->isInitialized()) {
+			DEBUGF(INDI::Logger::DBG_ERROR, "Failed to open spidev device %s for Alt position encoder.", EncoderSpiDevT[1].text);
+			return false;
+		}
+		if (spidev->isReplay()) DEBUGF(INDI::Logger::DBG_WARNING, "%s is no spidev device, replaying its content.", EncoderSpiDevT[1].text);
+		el_encoder.reset(new PiRaTe::SsiPosEncoder(spidev));
+	} else {
+		el_encoder.reset(new PiRaTe::SsiPosEncoder(gpio, GPIO::SPI_INTERFACE::Aux, bitrate));
+	}
 	if (!el_encoder->isInitialized()) {
         DEBUG(INDI::Logger::DBG_ERROR, "Failed to connect to Alt position encoder.");
 		return false;
@@ -744,11 +1301,43 @@ bool PiRT::Connect()
     DEBUG(INDI::Logger::DBG_SESSION, "Alt position encoder ok.");
 	el_encoder->setStBitWidth(ElEncSettingN[0].value);
 	el_encoder->setMtBitWidth(ElEncSettingN[1].value);
+	el_encoder->setSampleRate(EncoderSampleRateN.value);
+
+	// start the axis state estimators with the next encoder samples
+	applyAxisModels();
+	azEstimator.reset();
+	azEstimator.setResolution(AzEncSettingN[0].value);
+	elEstimator.reset();
+	elEstimator.setResolution(ElEncSettingN[0].value);
+
+	// read both encoders synchronously, so that Az/Alt samples share a common time stamp
+	try {
+		encoder_group.reset( new PiRaTe::SsiEncoderGroup( { az_encoder.get(), el_encoder.get() }, EncoderSampleRateN.value ) );
+	} catch (std::exception& e) {
+		encoder_group.reset();
+		DEBUG(INDI::Logger::DBG_WARNING, "Failed to set up synchronous encoder read-out. Falling back to individual read-out.");
+	}
+
+	// all I2C transactions are serialised by the bus manager, the devices open the bus themselves only as fallback
+	if ( i2cBus == nullptr ) {
+		i2cBus = std::make_shared<I2cBus>(I2C_BUS_DEVICE);
+		if ( !i2cBus->isInitialized() ) {
+			DEBUGF(INDI::Logger::DBG_WARNING, "Failed to open I2C bus %s for the transaction manager.", I2C_BUS_DEVICE);
+			i2cBus.reset();
+		}
+	}
+	auto createAdc = [this](std::uint8_t address) -> std::shared_ptr<ADS1115> {
+		if ( i2cBus == nullptr ) return std::shared_ptr<ADS1115>( new ADS1115(address) );
+		return std::shared_ptr<ADS1115>( new ADS1115(i2cBus, address) );
+	};
 
 	// search for the ADS1115 ADCs at the specified addresses and initialize them
 	// instantiate the first ADS1115 foreseen to read back the motor currents
-	std::shared_ptr<ADS1115> adc { new ADS1115(MOTOR_ADC_ADDR) };
+	std::shared_ptr<ADS1115> adc { createAdc(MOTOR_ADC_ADDR) };
 	if ( adc != nullptr && adc->devicePresent() ) {
+		// the motor current sense takes precedence over the other traffic on the bus
+		adc->setBusPriority(MOTOR_ADC_I2C_PRIORITY);
+		adc->setBusDeadline(MOTOR_ADC_I2C_DEADLINE);
 		adc->setPga(ADS1115::PGA4V);
 		adc->setRate(ADS1115::RATE860);
 		adc->setAGC(true);
@@ -763,9 +1352,12 @@ bool PiRT::Connect()
 		DEBUGF(INDI::Logger::DBG_ERROR, "ADS1115 at address 0x%02x not found.", MOTOR_ADC_ADDR);
 		deleteProperty(MotorCurrentNP.name);
 		deleteProperty(MotorCurrentLimitNP.name);
+		deleteProperty(MotorI2tNP.name);
+		deleteProperty(MotorLoadNP.name);
+		deleteProperty(ErrorResetSP.name);
 	}
 	// instantiate second ADS1115 for voltage monitoring
-	adc.reset( new ADS1115(VOLTAGE_MONITOR_ADC_ADDR) );
+	adc = createAdc(VOLTAGE_MONITOR_ADC_ADDR);
 	if ( adc != nullptr && adc->devicePresent() ) {
 		adc->setPga(ADS1115::PGA4V);
 		adc->setRate(ADS1115::RATE860);
@@ -780,19 +1372,43 @@ bool PiRT::Connect()
 	} else {
 		DEBUGF(INDI::Logger::DBG_ERROR, "ADS1115 at address 0x%02x not found.", VOLTAGE_MONITOR_ADC_ADDR);
 	}
+
+	// each ADC is read by one conversion scheduler, which pushes the samples to the motor drivers, monitors and measurements
+	for ( const auto& item: i2cDeviceMap ) {
+		std::shared_ptr<ADS1115> adc( std::dynamic_pointer_cast<ADS1115>(item.second) );
+		if ( adc == nullptr ) continue;
+		const int ready_pin { static_cast<int>( AdcReadyPinN[ (item.first == MOTOR_ADC_ADDR) ? 0 : 1 ].value ) };
+		std::shared_ptr<PiRaTe::Ads1115Scheduler> scheduler( new PiRaTe::Ads1115Scheduler(adc, gpio, ready_pin) );
+		if ( !scheduler->isInitialized() ) continue;
+		if ( scheduler->isDataReadyDriven() ) {
+			DEBUGF(INDI::Logger::DBG_SESSION, "ADC 0x%02x: conversions driven by ALERT/RDY on GPIO%d.", item.first, ready_pin);
+		}
+		adcSchedulers.emplace( item.first, std::move(scheduler) );
+	}
+	auto adcScheduler = [this](std::uint8_t address) -> std::shared_ptr<PiRaTe::Ads1115Scheduler> {
+		auto it = adcSchedulers.find(address);
+		return ( it == adcSchedulers.end() ) ? nullptr : it->second;
+	};
 	
 	// initialize Az motor driver
-	az_motor.reset( new PiRaTe::MotorDriver( gpio, AZ_MOTOR_PINS, AZ_MOTOR_DIR_INVERT, std::dynamic_pointer_cast<ADS1115>( i2cDeviceMap[MOTOR_ADC_ADDR] ), 0 ) );
+	az_motor.reset( new PiRaTe::MotorDriver( gpio, AZ_MOTOR_PINS, AZ_MOTOR_DIR_INVERT, adcScheduler(MOTOR_ADC_ADDR), 0 ) );
 	if ( !az_motor->isInitialized() ) {
         DEBUG(INDI::Logger::DBG_ERROR, "Failed to initialize Az motor driver.");
 		return false;
 	}
 	// initialize Alt motor driver
-	el_motor.reset( new PiRaTe::MotorDriver( gpio, ALT_MOTOR_PINS, ALT_MOTOR_DIR_INVERT, std::dynamic_pointer_cast<ADS1115>( i2cDeviceMap[MOTOR_ADC_ADDR] ), 1 ) );
+	el_motor.reset( new PiRaTe::MotorDriver( gpio, ALT_MOTOR_PINS, ALT_MOTOR_DIR_INVERT, adcScheduler(MOTOR_ADC_ADDR), 1 ) );
 	if ( !el_motor->isInitialized() ) {
         DEBUG(INDI::Logger::DBG_ERROR, "Failed to initialize El motor driver.");
 		return false;
 	}
+
+	applyMotorCurrentLimits();
+
+	// close the position loops of both axes, the servos feed the axis estimators with the encoder samples from now on
+	az_servo.reset( new PiRaTe::AxisServo( *az_encoder, azEstimator, *az_motor ) );
+	el_servo.reset( new PiRaTe::AxisServo( *el_encoder, elEstimator, *el_motor ) );
+	applyServoSettings();
 	
 	// initialize the temperature monitor
 	TempMonitorNP.nnp = 0;
@@ -803,12 +1419,10 @@ bool PiRT::Connect()
 	}
 
 	// set up the supply voltages to be monitored
-	voltageMonitors.clear();
 	int voltage_index = 0;
 	for ( auto item: supply_voltage_defs ) {
-		auto it = i2cDeviceMap.find( item.adc_address );
-		if (  it == i2cDeviceMap.end() ) continue;
-		std::shared_ptr<ADS1115> adc( std::dynamic_pointer_cast<ADS1115>(it->second) );
+		std::shared_ptr<PiRaTe::Ads1115Scheduler> adc { adcScheduler( item.adc_address ) };
+		if ( adc == nullptr ) continue;
 		std::shared_ptr<PiRaTe::Ads1115VoltageMonitor> mon( 
 			new PiRaTe::Ads1115VoltageMonitor( item.name, adc, item.adc_channel, item.nominal, item.divider_ratio, item.nominal/10. )
 		);
@@ -823,27 +1437,57 @@ bool PiRT::Connect()
 	}
 	
 	// set up the measurement voltages to be monitored
-	voltageMeasurements.clear();
+	updatePointingParameters();
 	voltage_index = 0;
 	for ( auto item: measurement_voltage_defs ) {
-		auto it = i2cDeviceMap.find( item.adc_address );
-		if (  it == i2cDeviceMap.end() ) continue;
-		std::shared_ptr<ADS1115> adc( std::dynamic_pointer_cast<ADS1115>(it->second) );
+		std::shared_ptr<PiRaTe::Ads1115Scheduler> adc { adcScheduler( item.adc_address ) };
+		if ( adc == nullptr ) continue;
 		std::shared_ptr<PiRaTe::Ads1115Measurement> meas( 
 			new PiRaTe::Ads1115Measurement( item.name, adc, item.adc_channel, item.divider_ratio, DEFAULT_INT_TIME )
 		);
+		if ( item.name == RADIOMETER_CHANNEL && meas->isInitialized() ) {
+			// the detector channel additionally feeds the raw sample stream, which interpolates the pointing for every sample
+			radiometerMeasurement = meas;
+			// the stream is closed before the encoders are released, on disconnect and on every failed connect
+			const PiRaTe::SsiPosEncoder* az_enc { az_encoder.get() };
+			const PiRaTe::SsiPosEncoder* el_enc { el_encoder.get() };
+			radiometerStream.reset( new PiRaTe::RadiometerStream( item.name, item.unit,
+				[this, az_enc, el_enc](std::chrono::steady_clock::time_point time, double& az, double& alt) {
+					HorCoords coords { };
+					if ( !pointingParameters().horizontalCoordsAt(*az_enc, *el_enc, time, coords) ) return false;
+					az = coords.Az.value();
+					alt = coords.Alt.value();
+					return true;
+				} ) );
+			PiRaTe::RadiometerStream* stream { radiometerStream.get() };
+			meas->registerSampleCallback( [stream](const PiRaTe::Ads1115Measurement::Sample& sample) { stream->push(sample.time, sample.value); } );
+		}
 		voltageMeasurements.emplace_back( std::move(meas) );
 		deleteProperty(VoltageMeasurementNP.name);
+		deleteProperty(MeasurementNoiseNP.name);
 		deleteProperty(MeasurementIntTimeNP.name);
 		IUFillNumber(&VoltageMeasurementN[voltage_index], ("MEASUREMENT"+std::to_string(voltage_index)).c_str(), (item.name).c_str(), ("%4.3f "+item.unit).c_str(), 0, 0, 0, 0.);
 		IUFillNumberVector(&VoltageMeasurementNP, VoltageMeasurementN, voltage_index+1, getDeviceName(), "MEASUREMENTS", "Measurements", "Monitoring",
 			IP_RO, 60, IPS_IDLE);
+		// noise of the single samples and signal-to-noise ratio of the integrated value
+		IUFillNumber(&MeasurementNoiseN[2*voltage_index], ("RMS"+std::to_string(voltage_index)).c_str(), (item.name+" rms").c_str(), ("%5.4f "+item.unit).c_str(), 0, 0, 0, 0.);
+		IUFillNumber(&MeasurementNoiseN[2*voltage_index+1], ("SNR"+std::to_string(voltage_index)).c_str(), (item.name+" SNR").c_str(), "%8.1f", 0, 0, 0, 0.);
+		IUFillNumberVector(&MeasurementNoiseNP, MeasurementNoiseN, 2*(voltage_index+1), getDeviceName(), "MEASUREMENT_NOISE", "Measurement Noise", "Monitoring",
+			IP_RO, 60, IPS_IDLE);
 		defineProperty(&VoltageMeasurementNP);
+		defineProperty(&MeasurementNoiseNP);
 		defineProperty(&MeasurementIntTimeNP);
 		
 		voltage_index++;
 	}
 
+	for ( const auto& item: adcSchedulers ) {
+		DEBUGF(INDI::Logger::DBG_SESSION, "ADC 0x%02x: %.0f%% of the conversion capacity requested.", item.first, 100. * item.second->demand());
+	}
+
+	// raise the control-critical threads to real-time priorities, all hardware threads are running now
+	applyThreadPolicies();
+
 	// set up the gpio pins for the relay switches
 	IUResetSwitch( &OutputSwitchSP);
 	for ( unsigned int i = 0; i<GpioOutputVector.size(); i++ ) {
@@ -852,9 +1496,24 @@ bool PiRT::Connect()
 	}	
 	
 	// set up the gpio pins for the digital inputs
+	std::vector<unsigned int> input_pins { };
 	for ( unsigned int i = 0; i<GpioInputVector.size(); i++ ) {
 		gpio->set_gpio_direction( GpioInputVector[i].gpio_pin, false );
+		input_pins.push_back( GpioInputVector[i].gpio_pin );
 	}	
+	try {
+		inputMonitor.reset( new PiRaTe::GpioInputMonitor( gpio, input_pins, GPIO_INPUT_DEBOUNCE ) );
+	} catch (std::exception& e) {
+        DEBUG(INDI::Logger::DBG_ERROR, "Failed to start the input monitoring.");
+		closeRadiometerStream();
+		return false;
+	}
+	for ( std::size_t index = 0; index < GpioInputVector.size(); index++ ) {
+		GpioInputL[index].s = ( inputMonitor->state( GpioInputVector[index].gpio_pin ) ) ? IPS_OK : IPS_IDLE;
+	}
+	GpioInputLP.s = IPS_OK;
+	IDSetLight( &GpioInputLP, nullptr );
+	if ( !inputMonitor->isEventDriven() ) DEBUG(INDI::Logger::DBG_WARNING, "GPIO backend provides no edge events, polling the inputs.");
 
 	INDI::Telescope::Connect();
 	
@@ -870,11 +1529,23 @@ bool PiRT::Connect()
 
 bool PiRT::Disconnect()
 {
+	jitterReportPending = false;
+	closeRadiometerStream();
+	inputMonitor.reset();
+	az_servo.reset();
+	el_servo.reset();
+	encoder_group.reset();
 	az_encoder.reset();
 	el_encoder.reset();
 	az_motor.reset();
 	el_motor.reset();
+	mountSimulator.reset();
+	voltageMeasurements.clear();
+	voltageMonitors.clear();
+	adcSchedulers.clear();
 	gpio.reset();
+	gpio_cache.reset();
+	gpio_queue.reset();
 	return true;
 }
 
@@ -955,6 +1626,8 @@ bool PiRT::Goto(double ra, double dec)
     // Mark state as slewing
     TrackState = SCOPE_SLEWING;
     TargetCoordSystem = SYSTEM_EQ;
+	slewPlanned = false;
+	inKeyhole = false;
     // Inform client we are slewing to a new position
     DEBUGF(INDI::Logger::DBG_SESSION, "Slewing to RA: %s - DEC: %s", RAStr, DecStr);
 
@@ -991,6 +1664,8 @@ bool PiRT::GotoHor(double az, double alt)
     // Mark state as slewing
     TrackState = SCOPE_SLEWING;
     TargetCoordSystem = SYSTEM_HOR;
+	slewPlanned = false;
+	inKeyhole = false;
 
     // Inform client we are slewing to a new position
     DEBUGF(INDI::Logger::DBG_SESSION, "Slewing to Az: %s - Alt: %s", AzStr, AltStr);
@@ -1006,9 +1681,11 @@ bool PiRT::GotoHor(double az, double alt)
 ***************************************************************************************/
 bool PiRT::Abort()
 {
-	az_motor->stop();
-	el_motor->stop();
+	az_servo->disengage();
+	el_servo->disengage();
 	targetPointingCycles = 0;
+	slewPlanned = false;
+	inKeyhole = false;
 	if ( TrackState == SCOPE_IDLE || TrackState == SCOPE_TRACKING || TrackState == SCOPE_PARKED ) return true;
 	else  TrackState = (isTracking() ? SCOPE_TRACKING : SCOPE_IDLE);
 
@@ -1018,8 +1695,9 @@ bool PiRT::Abort()
 
 bool PiRT::MoveNS(INDI_DIR_NS dir, TelescopeMotionCommand command)
 {
+	// manual motion overrides the closed-loop control
+	el_servo->disengage();
     if (command != MOTION_START) {
-		el_motor->stop();
 		return true;
 	}
 	int speedIndex = IUFindOnSwitchIndex( &SlewRateSP );
@@ -1047,8 +1725,9 @@ bool PiRT::MoveNS(INDI_DIR_NS dir, TelescopeMotionCommand command)
 
 bool PiRT::MoveWE(INDI_DIR_WE dir, TelescopeMotionCommand command)
 {
+	// manual motion overrides the closed-loop control
+	az_servo->disengage();
     if (command != MOTION_START) {
-		az_motor->stop();
 		return true;
 	}
 
@@ -1129,6 +1808,18 @@ HorCoords PiRT::Equ2Hor(const EquCoords& equ_coords) {
 	return HorCoords( az , alt );
 }
 
+auto PiRT::Equ2HorMotion(const EquCoords& equ_coords) -> PiRaTe::HorizontalMotion {
+	// local apparent sidereal time with the sub-second resolution of the system clock
+	const double JD { ln_get_julian_from_sys() };
+	double longitude { LocationN[LOCATION_LONGITUDE].value };
+	if (longitude > 180.) longitude -= 360.;
+	const double hourAngle { 15. * ln_get_apparent_sidereal_time(JD) + longitude - 15. * equ_coords.Ra.value() };
+	PiRaTe::HorizontalMotion motion { PiRaTe::trackingMotion( hourAngle, equ_coords.Dec.value(), LocationN[LOCATION_LATITUDE].value, KEYHOLE_RATE_FRACTION * SlewLimitsN[0].value ) };
+	// 0 deg Az should be S
+	motion.az = ln_range_degrees(motion.az - 180.);
+	return motion;
+}
+
 void PiRT::Equ2Hor(double ra, double dec, double* az, double* alt) {
   struct ln_date date;
   struct tm *utc;
@@ -1207,19 +1898,105 @@ void PiRT::updateMotorStatus() {
 		} else {
 			MotorCurrentNP.s=IPS_BUSY;
 		}
-		if (   MotorCurrentN[0].value > MotorCurrentLimitN[0].value ) {
-			// Motor current limit exceeded. Stop immediately
-			az_motor->stop();
-			MotorCurrentNP.s=IPS_ALERT;
-		}
-		if ( MotorCurrentN[1].value > MotorCurrentLimitN[1].value ) {
-			// Motor current limit exceeded. Stop immediately
-			el_motor->stop();
-			MotorCurrentNP.s=IPS_ALERT;
-		}
+		// the motor threads switch off the outputs on overcurrent, here the trips are only reported
+		bool tripped { false };
+		auto reportTrips = [this, &tripped](const char* axis, PiRaTe::MotorDriver& motor) {
+			for ( const auto& event: motor.tripEvents() ) {
+				DEBUGF(INDI::Logger::DBG_ERROR, "%s motor tripped at %s: %s at %4.2f A (I2t load %3.0f %%)", axis, steadyToIsoTime(event.time).c_str(),
+					(event.reason == PiRaTe::MotorDriver::TripEvent::Reason::I2t) ? "I2t limit exceeded" : "current limit exceeded",
+					event.current, 100. * event.load);
+				tripped = true;
+			}
+			return motor.isTripped();
+		};
+		const bool azTripped { reportTrips("Az", *az_motor) };
+		const bool altTripped { reportTrips("Alt", *el_motor) };
+		if ( azTripped || altTripped ) MotorCurrentNP.s=IPS_ALERT;
 		//DEBUGF(INDI::Logger::DBG_SESSION, "ADC value ch0: %f V ch1: %f ch3: %f V ch4: %f", v1,v2,v3,v4);
 		IDSetNumber(&MotorCurrentNP, nullptr);
+
+		MotorLoadN[0].value = 100. * az_motor->thermalLoad();
+		MotorLoadN[1].value = 100. * el_motor->thermalLoad();
+		MotorLoadNP.s = ( azTripped || altTripped ) ? IPS_ALERT : IPS_OK;
+		IDSetNumber(&MotorLoadNP, nullptr);
+		if ( ( azTripped || altTripped ) && ErrorResetSP.s != IPS_ALERT ) {
+			ErrorResetSP.s = IPS_ALERT;
+			IDSetSwitch(&ErrorResetSP, nullptr);
+		}
+		if ( tripped ) {
+			// stop all motion of the scope, the tripped motor is already switched off
+			Abort();
+		}
+	}
+
+	// write the flight recorder content of motors which had a fault, trip or abort
+	dumpTelemetry("Az", *az_motor);
+	dumpTelemetry("Alt", *el_motor);
+}
+
+void PiRT::triggerFlightRecorders(const char* reason) {
+	if ( az_motor != nullptr ) az_motor->triggerTelemetry(reason);
+	if ( el_motor != nullptr ) el_motor->triggerTelemetry(reason);
+}
+
+void PiRT::dumpTelemetry(const std::string& axis, PiRaTe::MotorDriver& motor) {
+	if ( !motor.isTelemetryFrozen() ) return;
+	PiRaTe::MotorTelemetryDump dump { motor.telemetry() };
+	motor.releaseTelemetry();
+	dump.name = axis;
+	const std::string path { std::string(TelemetryDirT.text) + "/pirt_motor_" + axis + "_" + utcFileTimestamp() + ".bin" };
+	if ( PiRaTe::writeMotorTelemetry(path, dump) ) {
+		DEBUGF(INDI::Logger::DBG_SESSION, "%s motor telemetry (%s, %zu cycles) written to %s", axis.c_str(), dump.reason.c_str(), dump.records.size(), path.c_str());
+	} else {
+		DEBUGF(INDI::Logger::DBG_ERROR, "Failed to write %s motor telemetry to %s", axis.c_str(), path.c_str());
+	}
+}
+
+void PiRT::applyRadiometerStream() {
+	if ( radiometerStream == nullptr ) {
+		IUResetSwitch(&RadiometerStreamSP);
+		RadiometerStreamSP.s = IPS_ALERT;
+		IDSetSwitch(&RadiometerStreamSP, "The radiometer channel %s is not available", RADIOMETER_CHANNEL);
+		return;
+	}
+	const bool record { RadiometerStreamS[RADIOMETER_RECORD].s == ISS_ON };
+	if ( record && !radiometerStream->isRecording() ) {
+		const std::string path { std::string(RadiometerDirT.text) + "/pirt_radiometer_" + utcFileTimestamp() + ".bin" };
+		if ( radiometerStream->startRecording(path) ) {
+			DEBUGF(INDI::Logger::DBG_SESSION, "Recording the %s stream to %s", RADIOMETER_CHANNEL, path.c_str());
+		} else {
+			RadiometerStreamS[RADIOMETER_RECORD].s = ISS_OFF;
+			DEBUGF(INDI::Logger::DBG_ERROR, "Failed to open the radiometer stream file %s", path.c_str());
+		}
+	} else if ( !record && radiometerStream->isRecording() ) {
+		const std::string path { radiometerStream->path() };
+		radiometerStream->stopRecording();
+		DEBUGF(INDI::Logger::DBG_SESSION, "Radiometer stream file %s closed", path.c_str());
+	}
+	radiometerStream->setPublishing( RadiometerStreamS[RADIOMETER_PUBLISH].s == ISS_ON );
+	// the channel is sampled at the stream rate only while the stream is in use
+	radiometerMeasurement->setSampleRate( ( radiometerStream->isActive() ) ? RadiometerRateN.value : PiRaTe::MEASUREMENT_SAMPLE_RATE_DEFAULT );
+	RadiometerStreamSP.s = ( radiometerStream->isActive() ) ? IPS_BUSY : IPS_IDLE;
+	if ( record && !radiometerStream->isRecording() ) RadiometerStreamSP.s = IPS_ALERT;
+	IDSetSwitch(&RadiometerStreamSP, nullptr);
+}
+
+void PiRT::closeRadiometerStream() {
+	if ( radiometerMeasurement != nullptr ) {
+		radiometerMeasurement->registerSampleCallback(nullptr);
+		radiometerMeasurement->setSampleRate(PiRaTe::MEASUREMENT_SAMPLE_RATE_DEFAULT);
 	}
+	// the destructor writes the buffered samples and closes the recording file
+	radiometerStream.reset();
+	radiometerMeasurement.reset();
+	radiometerBlock.clear();
+	IUResetSwitch(&RadiometerStreamSP);
+	RadiometerStreamSP.s = IPS_IDLE;
+}
+
+void PiRT::applyMotorCurrentLimits() {
+	if ( az_motor != nullptr ) az_motor->setCurrentLimit( { MotorCurrentLimitN[0].value, MotorI2tN[0].value, MotorI2tN[1].value } );
+	if ( el_motor != nullptr ) el_motor->setCurrentLimit( { MotorCurrentLimitN[1].value, MotorI2tN[2].value, MotorI2tN[3].value } );
 }
 
 void PiRT::updateMonitoring() {
@@ -1227,23 +2004,64 @@ void PiRT::updateMonitoring() {
 	DriverUpTimeN.value = upTime().count()/3600.;
 	IDSetNumber(&DriverUpTimeNP, nullptr);
 	
-	// update inputs
-	bool change_detected { false };
-	for ( std::size_t index = 0; index < GpioInputVector.size(); index++ ) {
-		const bool state = gpio->get_gpio_state( GpioInputVector[index].gpio_pin, nullptr );
-		if (( GpioInputL[index].s == IPS_OK && !state ) ||
-			( GpioInputL[index].s == IPS_IDLE && state )	)
-		{
-			// the state of the pin changed
-			change_detected = true;
-			GpioInputL[index].s = (state) ? IPS_OK : IPS_IDLE;
-			GpioInputLP.s = IPS_OK;
-			IDSetLight( &GpioInputLP, nullptr );
+	// update inputs, the property is only sent when edges occurred since the last poll
+	const std::vector<PiRaTe::GpioInputMonitor::Edge> edges { inputMonitor->update() };
+	if ( !edges.empty() ) {
+		std::string edge_log { };
+		for ( const auto& edge: edges ) {
+			auto input = std::find_if( GpioInputVector.begin(), GpioInputVector.end(), [&edge](const GpioPin& pin) { return pin.gpio_pin == edge.gpio_pin; } );
+			if ( input == GpioInputVector.end() ) continue;
+			if ( !edge_log.empty() ) edge_log += ", ";
+			edge_log += input->name + ( (edge.level) ? " rising at " : " falling at " ) + steadyToIsoTime(edge.time);
+		}
+		for ( std::size_t index = 0; index < GpioInputVector.size(); index++ ) {
+			GpioInputL[index].s = ( inputMonitor->state( GpioInputVector[index].gpio_pin ) ) ? IPS_OK : IPS_IDLE;
 		}
+		GpioInputLP.s = IPS_OK;
+		IDSetLight( &GpioInputLP, "%s", edge_log.c_str() );
+	}
+
+	const AsyncGPIO::Statistics gpioStats { gpio_queue->statistics() };
+	GpioQueueN[0].value = gpioStats.queueDepth;
+	GpioQueueN[1].value = gpioStats.maxQueueDepth;
+	GpioQueueN[2].value = gpio_queue->latency().mean();
+	GpioQueueN[3].value = gpio_queue->latency().quantile(0.99);
+	GpioQueueN[4].value = gpio_queue->latency().maximum();
+	GpioQueueN[5].value = gpioStats.coalesced;
+	GpioQueueNP.s = (gpioStats.errors > 0) ? IPS_ALERT : IPS_OK;
+	IDSetNumber(&GpioQueueNP, nullptr);
+
+	const CachedGPIO::Statistics cacheStats { gpio_cache->statistics() };
+	GpioCacheN[0].value = cacheStats.suppressedRate;
+	GpioCacheN[1].value = cacheStats.suppressed;
+	GpioCacheN[2].value = cacheStats.forwarded;
+	GpioCacheNP.s = IPS_OK;
+	IDSetNumber(&GpioCacheNP, nullptr);
+
+	// conversions per channel, missing ready edges are signalled as alert
+	AdcRateNP.s = IPS_OK;
+	for ( unsigned int i = 0; i < 8; i++ ) {
+		auto it = adcSchedulers.find( (i < 4) ? MOTOR_ADC_ADDR : VOLTAGE_MONITOR_ADC_ADDR );
+		AdcRateN[i].value = ( it == adcSchedulers.end() ) ? 0. : it->second->channelRate(i % 4);
+		if ( it != adcSchedulers.end() && it->second->readyTimeouts() > 0 ) AdcRateNP.s = IPS_ALERT;
 	}
-	if ( !change_detected && GpioInputLP.s == IPS_OK ) {
-		GpioInputLP.s = IPS_IDLE;
-		IDSetLight( &GpioInputLP, nullptr );
+	IDSetNumber(&AdcRateNP, nullptr);
+
+	if ( i2cBus != nullptr ) {
+		const I2cBus::Statistics busStats { i2cBus->statistics() };
+		I2cBusN[0].value = 100. * busStats.utilization;
+		I2cBusN[1].value = i2cBus->latency().quantile(0.5);
+		I2cBusN[2].value = i2cBus->latency().quantile(0.99);
+		I2cBusN[3].value = i2cBus->latency().maximum();
+		I2cBusN[4].value = busStats.deadlineMisses;
+		I2cBusN[5].value = busStats.errors;
+		I2cBusN[6].value = 100. * i2cBus->deviceStatistics(MOTOR_ADC_ADDR).utilization;
+		I2cBusN[7].value = 100. * i2cBus->deviceStatistics(VOLTAGE_MONITOR_ADC_ADDR).utilization;
+		I2cBusNP.s = IPS_OK;
+		for ( const auto address: i2cBus->devices() ) {
+			if ( i2cBus->deviceStatistics(address).errorRate > 0. ) I2cBusNP.s = IPS_ALERT;
+		}
+		IDSetNumber(&I2cBusNP, nullptr);
 	}
 
 	int voltage_index = 0;
@@ -1271,24 +2089,74 @@ void PiRT::updateMonitoring() {
 	}
 
 	voltage_index = 0;
+	std::chrono::steady_clock::time_point measurementTime { };
 	if ( !voltageMeasurements.empty() ) {
 		VoltageMeasurementNP.s=IPS_IDLE;
 		for ( auto meas: voltageMeasurements ) {
 			if ( !meas->isInitialized() ) {
 				VoltageMeasurementN[voltage_index].value = 0.;
+				MeasurementNoiseN[2*voltage_index].value = 0.;
+				MeasurementNoiseN[2*voltage_index+1].value = 0.;
 				VoltageMeasurementNP.s=IPS_ALERT;
 			} else {
-				double meanVoltage = meas->meanValue();
-				VoltageMeasurementN[voltage_index].value = meanVoltage;
+				const PiRaTe::Ads1115Measurement::Sample meanSample { meas->meanSample() };
+				VoltageMeasurementN[voltage_index].value = meanSample.value;
+				if ( voltage_index == 0 ) measurementTime = meanSample.time;
+				const PiRaTe::Ads1115Measurement::WindowStatistics stats { meas->windowStatistics() };
+				MeasurementNoiseN[2*voltage_index].value = stats.stddev;
+				MeasurementNoiseN[2*voltage_index+1].value = stats.snr;
 			}
 			voltage_index++;
 		}
 		if ( VoltageMeasurementNP.s != IPS_ALERT ) {
 			VoltageMeasurementNP.s = IPS_OK;
 		}
+		MeasurementNoiseNP.s = VoltageMeasurementNP.s;
 		IDSetNumber(&VoltageMeasurementNP, nullptr);
+		IDSetNumber(&MeasurementNoiseNP, nullptr);
+
+		// the pointing at the instant the averaged measurement refers to
+		HorCoords measurementCoords { };
+		if ( measurementTime != std::chrono::steady_clock::time_point { } && horizontalCoordsAt(measurementTime, measurementCoords) ) {
+			MeasurementPositionN[0].value = measurementCoords.Az.value();
+			MeasurementPositionN[1].value = measurementCoords.Alt.value();
+			MeasurementPositionN[2].value = std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - measurementTime ).count();
+			MeasurementPositionNP.s = IPS_OK;
+		} else {
+			MeasurementPositionNP.s = IPS_ALERT;
+		}
+		IDSetNumber(&MeasurementPositionNP, nullptr);
+	}
+
+	if ( radiometerStream != nullptr ) {
+		const PiRaTe::RadiometerStream::Statistics stats { radiometerStream->statistics() };
+		RadiometerStatusN[0].value = stats.rate;
+		RadiometerStatusN[1].value = stats.samples;
+		RadiometerStatusN[2].value = stats.dropped;
+		RadiometerStatusN[3].value = stats.pointingMisses;
+		RadiometerStatusN[4].value = stats.bytesWritten / 1e6;
+		RadiometerStatusN[5].value = stats.blocksDropped;
+		RadiometerStatusNP.s = ( radiometerStream->isActive() ) ? IPS_OK : IPS_IDLE;
+		if ( stats.dropped > 0 || stats.blocksDropped > 0 ) RadiometerStatusNP.s = IPS_ALERT;
+		IDSetNumber(&RadiometerStatusNP, nullptr);
+		// the writer stops recording on file errors
+		if ( RadiometerStreamS[RADIOMETER_RECORD].s == ISS_ON && !radiometerStream->isRecording() ) {
+			RadiometerStreamS[RADIOMETER_RECORD].s = ISS_OFF;
+			applyRadiometerStream();
+			RadiometerStreamSP.s = IPS_ALERT;
+			IDSetSwitch(&RadiometerStreamSP, "Recording of the radiometer stream stopped by a write error");
+		}
+		// the completed chunks are sent as one self-contained stream per poll
+		if ( radiometerStream->isPublishing() ) {
+			radiometerBlock = radiometerStream->takeBlocks();
+			if ( !radiometerBlock.empty() ) {
+				RadiometerBlobB.blob = &radiometerBlock[0];
+				RadiometerBlobB.bloblen = RadiometerBlobB.size = static_cast<int>( radiometerBlock.size() );
+				RadiometerBlobBP.s = IPS_OK;
+				IDSetBLOB(&RadiometerBlobBP, nullptr);
+			}
+		}
 	}
-	
 }
 
 void PiRT::updateTemperatures( PiRaTe::RpiTemperatureMonitor::TemperatureItem item ) {
@@ -1319,6 +2187,7 @@ void PiRT::updatePosition() {
 		if ( el_encoder == nullptr ) ElEncoderNP.s = IPS_ALERT;
 		return;
 	} 
+	updateAxisEstimators();
 	// read pos encoders
     if ( az_encoder->isUpdated() || el_encoder->isUpdated() ) {
 		AzEncoderN[0].value = az_encoder->absolutePosition();
@@ -1326,6 +2195,10 @@ void PiRT::updatePosition() {
 		AzEncoderN[2].value = static_cast<double>(az_encoder->nrTurns());
 		AzEncoderN[3].value = az_encoder->bitErrorCount();
 		AzEncoderN[4].value = az_encoder->lastReadOutDuration().count();
+		const PiRaTe::LoopTimer::Statistics azLoopStats { (encoder_group != nullptr) ? encoder_group->loopStatistics() : az_encoder->loopStatistics() };
+		AzEncoderN[5].value = azLoopStats.rate;
+		AzEncoderN[6].value = azLoopStats.jitter;
+		AzEncoderN[7].value = azLoopStats.overruns;
 		//DEBUGF(INDI::Logger::DBG_SESSION, "Az Encoder values: st=%d mt=%u t_ro=%u us", st, mt, us);
 		AzEncoderNP.s = (az_encoder->statusOk())? IPS_OK : IPS_ALERT;
 		IDSetNumber(&AzEncoderNP, nullptr);
@@ -1334,16 +2207,36 @@ void PiRT::updatePosition() {
 		ElEncoderN[2].value = static_cast<double>(el_encoder->nrTurns());
 		ElEncoderN[3].value = el_encoder->bitErrorCount();
 		ElEncoderN[4].value = el_encoder->lastReadOutDuration().count();
+		const PiRaTe::LoopTimer::Statistics elLoopStats { (encoder_group != nullptr) ? encoder_group->loopStatistics() : el_encoder->loopStatistics() };
+		ElEncoderN[5].value = elLoopStats.rate;
+		ElEncoderN[6].value = elLoopStats.jitter;
+		ElEncoderN[7].value = elLoopStats.overruns;
 		ElEncoderNP.s = (el_encoder->statusOk())? IPS_OK : IPS_ALERT;
 		IDSetNumber(&ElEncoderNP, nullptr);
 
-		const double az_revolutions { az_encoder->absolutePosition() };
-		const double el_revolutions { el_encoder->absolutePosition() };
-
-		azAbsTurns = ( az_revolutions / axisRatio[0] ) + axisOffset[0] / 360.;
-		altAbsTurns = ( el_revolutions / axisRatio[1] ) + axisOffset[1] / 360.;
-		if ( AZ_POS_DIR_INVERT ) azAbsTurns *= -1.;
-		if ( ALT_POS_DIR_INVERT ) altAbsTurns *= -1.;
+		const PiRaTe::SsiPosEncoder::LatencyHistogram& azLatency { az_encoder->readOutLatency() };
+		const PiRaTe::SsiPosEncoder::LatencyHistogram& elLatency { el_encoder->readOutLatency() };
+		EncoderLatencyN[0].value = azLatency.mean();
+		EncoderLatencyN[1].value = azLatency.quantile(0.5);
+		EncoderLatencyN[2].value = azLatency.quantile(0.99);
+		EncoderLatencyN[3].value = azLatency.maximum();
+		EncoderLatencyN[4].value = elLatency.mean();
+		EncoderLatencyN[5].value = elLatency.quantile(0.5);
+		EncoderLatencyN[6].value = elLatency.quantile(0.99);
+		EncoderLatencyN[7].value = elLatency.maximum();
+		EncoderLatencyNP.s = IPS_OK;
+		IDSetNumber(&EncoderLatencyNP, nullptr);
+
+		// evaluate the position at the poll instant rather than taking the last stored sample
+		// which may be up to one sample period old
+		const auto now { std::chrono::steady_clock::now() };
+		double az_revolutions { 0. };
+		double el_revolutions { 0. };
+		if ( !az_encoder->positionAt(now, az_revolutions, maxEncoderExtrapolation()) ) az_revolutions = az_encoder->absolutePosition();
+		if ( !el_encoder->positionAt(now, el_revolutions, maxEncoderExtrapolation()) ) el_revolutions = el_encoder->absolutePosition();
+
+		azAbsTurns = encoderToAxisTurns(AXIS_AZ, az_revolutions);
+		altAbsTurns = encoderToAxisTurns(AXIS_ALT, el_revolutions);
 		
 		AxisAbsTurnsN[0].value = azAbsTurns;
 		AxisAbsTurnsN[1].value = altAbsTurns;
@@ -1363,6 +2256,271 @@ void PiRT::updatePosition() {
 	}
 }
 
+auto PiRT::encoderToAxisTurns(int axis, double revolutions) const -> double {
+	return currentPointingParameters().axisTurns(axis, revolutions);
+}
+
+auto PiRT::axisTurnsToEncoder(int axis, double turns) const -> double {
+	const bool invert { (axis == AXIS_AZ) ? AZ_POS_DIR_INVERT : ALT_POS_DIR_INVERT };
+	if (invert) turns = -turns;
+	return ( turns - axisOffset[axis] / 360. ) * axisRatio[axis];
+}
+
+auto PiRT::maxEncoderExtrapolation() const -> std::chrono::steady_clock::duration {
+	// allow to extrapolate over two sampling periods, so that a missed read-out does not fail the evaluation
+	return std::chrono::duration_cast<std::chrono::steady_clock::duration>( std::chrono::duration<double>( 2. / std::max( EncoderSampleRateN.value, 1. ) ) );
+}
+
+auto PiRT::horizontalCoordsAt(std::chrono::steady_clock::time_point time, HorCoords& coords) const -> bool {
+	if ( az_encoder == nullptr || el_encoder == nullptr ) return false;
+	return currentPointingParameters().horizontalCoordsAt(*az_encoder, *el_encoder, time, coords);
+}
+
+auto PiRT::PointingParameters::axisTurns(int axis, double revolutions) const -> double {
+	const bool invert { (axis == AXIS_AZ) ? AZ_POS_DIR_INVERT : ALT_POS_DIR_INVERT };
+	const double turns { ( revolutions / axisRatio[axis] ) + axisOffset[axis] / 360. };
+	return (invert) ? -turns : turns;
+}
+
+auto PiRT::PointingParameters::horizontalCoordsAt(const PiRaTe::SsiPosEncoder& az_enc, const PiRaTe::SsiPosEncoder& el_enc,
+												  std::chrono::steady_clock::time_point time, HorCoords& coords) const -> bool {
+	double az_revolutions { 0. };
+	double el_revolutions { 0. };
+	if ( !az_enc.positionAt(time, az_revolutions, maxExtrapolation) ) return false;
+	if ( !el_enc.positionAt(time, el_revolutions, maxExtrapolation) ) return false;
+	coords.Az.setValue( 360. * axisTurns(AXIS_AZ, az_revolutions) );
+	coords.Alt.setValue( 360. * axisTurns(AXIS_ALT, el_revolutions) );
+	return true;
+}
+
+auto PiRT::currentPointingParameters() const -> PointingParameters {
+	PointingParameters params { };
+	for ( int axis: { AXIS_AZ, AXIS_ALT } ) {
+		params.axisRatio[axis] = axisRatio[axis];
+		params.axisOffset[axis] = axisOffset[axis];
+	}
+	params.maxExtrapolation = maxEncoderExtrapolation();
+	return params;
+}
+
+void PiRT::updatePointingParameters() {
+	const PointingParameters params { currentPointingParameters() };
+	std::lock_guard<std::mutex> lock(pointingMutex);
+	pointingSnapshot = params;
+}
+
+auto PiRT::pointingParameters() const -> PointingParameters {
+	std::lock_guard<std::mutex> lock(pointingMutex);
+	return pointingSnapshot;
+}
+
+auto PiRT::createSimulatedGpio() -> std::shared_ptr<GPIO> {
+	std::shared_ptr<SimGPIO> sim { new SimGPIO() };
+	// the simulated axes are wired like the real mount, the encoder offsets are chosen such
+	// that the axis positions of the model coincide with the axis turns derived from the encoders
+	PiRaTe::MountSimulator::AxisParameters az { };
+	az.pins = AZ_MOTOR_PINS;
+	az.invertDirection = AZ_MOTOR_DIR_INVERT;
+	az.spiInterface = GPIO::SPI_INTERFACE::Main;
+	az.encoderRatio = axisRatio[AXIS_AZ];
+	az.encoderOffset = -axisOffset[AXIS_AZ] / 360. * axisRatio[AXIS_AZ];
+	az.invertEncoder = AZ_POS_DIR_INVERT;
+	az.stBits = AzEncSettingN[0].value;
+	az.mtBits = AzEncSettingN[1].value;
+	PiRaTe::MountSimulator::AxisParameters alt { az };
+	alt.pins = ALT_MOTOR_PINS;
+	alt.invertDirection = ALT_MOTOR_DIR_INVERT;
+	alt.spiInterface = GPIO::SPI_INTERFACE::Aux;
+	alt.encoderRatio = axisRatio[AXIS_ALT];
+	alt.encoderOffset = -axisOffset[AXIS_ALT] / 360. * axisRatio[AXIS_ALT];
+	alt.invertEncoder = ALT_POS_DIR_INVERT;
+	alt.stBits = ElEncSettingN[0].value;
+	alt.mtBits = ElEncSettingN[1].value;
+	alt.loadInertia = 500.;
+	alt.coulombFriction = 100.;
+	mountSimulator.reset( new PiRaTe::MountSimulator( sim, { az, alt } ) );
+	// start with the dish pointing above the lower Alt limit
+	mountSimulator->setAxisPosition(AXIS_ALT, SIM_ALT_START_POSITION);
+	mountSimulator->start();
+	return sim;
+}
+
+void PiRT::applyAxisModels() {
+	PiRaTe::AxisEstimator::Config config { azEstimator.config() };
+	config.tau = AxisModelN[0].value;
+	config.gain = AxisModelN[1].value;
+	azEstimator.setConfig(config);
+	config = elEstimator.config();
+	config.tau = AxisModelN[2].value;
+	config.gain = AxisModelN[3].value;
+	elEstimator.setConfig(config);
+}
+
+void PiRT::applyServoSettings() {
+	if ( az_servo == nullptr || el_servo == nullptr ) return;
+	// the servos work in encoder revolutions, the tolerances are converted from axis degrees
+	PiRaTe::AxisServo::Config config { az_servo->config() };
+	config.rate = ServoSettingsN[0].value;
+	config.positionKp = ServoSettingsN[1].value;
+	config.positionKi = ServoSettingsN[2].value;
+	config.velocityKp = ServoSettingsN[3].value;
+	config.velocityKi = ServoSettingsN[4].value;
+	config.motorTau = AxisModelN[0].value;
+	config.motorGain = ( AxisModelN[1].value != 0. ) ? AxisModelN[1].value : AZ_MOTOR_NOMINAL_GAIN;
+	config.deadband = MotorThresholdN[0].value / 100.;
+	config.tolerance = 0.5 * TRACK_ACCURACY_AZ / 360. * axisRatio[AXIS_AZ];
+	az_servo->setConfig(config);
+	config = el_servo->config();
+	config.rate = ServoSettingsN[0].value;
+	config.positionKp = ServoSettingsN[5].value;
+	config.positionKi = ServoSettingsN[6].value;
+	config.velocityKp = ServoSettingsN[7].value;
+	config.velocityKi = ServoSettingsN[8].value;
+	config.motorTau = AxisModelN[2].value;
+	config.motorGain = ( AxisModelN[3].value != 0. ) ? AxisModelN[3].value : ALT_MOTOR_NOMINAL_GAIN;
+	config.deadband = MotorThresholdN[1].value / 100.;
+	config.tolerance = 0.5 * TRACK_ACCURACY_ALT / 360. * axisRatio[AXIS_ALT];
+	el_servo->setConfig(config);
+}
+
+void PiRT::planSlew(double azTurns, double altTurns) {
+	// plan in encoder revolutions, the limits are converted from axis degrees
+	const double azScale { axisRatio[AXIS_AZ] / 360. };
+	const double altScale { axisRatio[AXIS_ALT] / 360. };
+	const std::vector<PiRaTe::SCurveProfile::Limits> limits {
+		{ azScale * SlewLimitsN[0].value, azScale * SlewLimitsN[1].value, azScale * SlewLimitsN[2].value },
+		{ altScale * SlewLimitsN[3].value, altScale * SlewLimitsN[4].value, altScale * SlewLimitsN[5].value } };
+	const std::vector<double> starts { axisTurnsToEncoder(AXIS_AZ, AxisAbsTurnsN[0].value), axisTurnsToEncoder(AXIS_ALT, AxisAbsTurnsN[1].value) };
+	const std::vector<double> targets { axisTurnsToEncoder(AXIS_AZ, azTurns), axisTurnsToEncoder(AXIS_ALT, altTurns) };
+	const std::vector<PiRaTe::SCurveProfile> profiles { PiRaTe::planSynchronizedMove(starts, targets, limits) };
+	const auto now { std::chrono::steady_clock::now() };
+	if ( !az_servo->setTrajectory(profiles[0], now) || !el_servo->setTrajectory(profiles[1], now) ) {
+		DEBUG(INDI::Logger::DBG_WARNING, "Axis servos can not follow the slew trajectory.");
+		return;
+	}
+	DEBUGF(DBG_SCOPE, "Slew trajectory planned: duration %5.1f s, peak rates %6.3f deg/s (Az) and %6.3f deg/s (Alt)", profiles[0].duration(), profiles[0].peakVelocity() / azScale, profiles[1].peakVelocity() / altScale);
+}
+
+void PiRT::updateServoStatus() {
+	if ( az_servo == nullptr || el_servo == nullptr ) return;
+	const PiRaTe::AxisServo::State azState { az_servo->state() };
+	const PiRaTe::AxisServo::State elState { el_servo->state() };
+	// position errors in axis arc seconds
+	ServoStatusN[0].value = 3600. * 360. * std::abs( encoderToAxisTurns(AXIS_AZ, azState.setpoint) - encoderToAxisTurns(AXIS_AZ, azState.position) );
+	ServoStatusN[1].value = 100. * azState.output;
+	ServoStatusN[2].value = 3600. * 360. * std::abs( encoderToAxisTurns(AXIS_ALT, elState.setpoint) - encoderToAxisTurns(AXIS_ALT, elState.position) );
+	ServoStatusN[3].value = 100. * elState.output;
+	const PiRaTe::LoopTimer::Statistics loopStats { az_servo->loopStatistics() };
+	ServoStatusN[4].value = loopStats.rate;
+	ServoStatusN[5].value = loopStats.jitter;
+	if ( azState.saturated || elState.saturated ) ServoStatusNP.s = IPS_BUSY;
+	else if ( azState.engaged || elState.engaged ) ServoStatusNP.s = IPS_OK;
+	else ServoStatusNP.s = IPS_IDLE;
+	IDSetNumber(&ServoStatusNP, nullptr);
+}
+
+void PiRT::applyThreadPolicies() {
+	if ( az_servo == nullptr || el_servo == nullptr || az_motor == nullptr || el_motor == nullptr ) return;
+	logJitterReport("Loop wake-up latency before applying the thread policies");
+
+	const int encoderPriority { static_cast<int>( ThreadPolicyN[0].value ) };
+	const int controlPriority { static_cast<int>( ThreadPolicyN[1].value ) };
+	const int controlCpu { static_cast<int>( ThreadPolicyN[2].value ) };
+	const int monitorCpu { static_cast<int>( ThreadPolicyN[3].value ) };
+	const PiRaTe::ThreadPolicy encoderPolicy { (encoderPriority > 0) ? PiRaTe::ThreadPolicy::fifo(encoderPriority, controlCpu) : PiRaTe::ThreadPolicy::normal(controlCpu) };
+	const PiRaTe::ThreadPolicy controlPolicy { (controlPriority > 0) ? PiRaTe::ThreadPolicy::fifo(controlPriority, controlCpu) : PiRaTe::ThreadPolicy::normal(controlCpu) };
+	// the I/O thread executes the pin commands of the control loops, so it must not be preempted by them
+	const PiRaTe::ThreadPolicy ioPolicy { (controlPriority > 0) ? PiRaTe::ThreadPolicy::fifo(controlPriority + 1, controlCpu) : PiRaTe::ThreadPolicy::normal(controlCpu) };
+	const PiRaTe::ThreadPolicy monitorPolicy { (ThreadOptionsS[THREAD_OPTION_DEMOTE].s == ISS_ON) ? PiRaTe::ThreadPolicy::batch(monitorCpu) : PiRaTe::ThreadPolicy::normal(monitorCpu) };
+
+	bool ok { true };
+	if ( encoder_group != nullptr ) ok = encoder_group->setThreadPolicy(encoderPolicy) && ok;
+	if ( az_encoder != nullptr ) ok = az_encoder->setThreadPolicy(encoderPolicy) && ok;
+	if ( el_encoder != nullptr ) ok = el_encoder->setThreadPolicy(encoderPolicy) && ok;
+	ok = az_servo->setThreadPolicy(controlPolicy) && ok;
+	ok = el_servo->setThreadPolicy(controlPolicy) && ok;
+	ok = az_motor->setThreadPolicy(controlPolicy) && ok;
+	ok = el_motor->setThreadPolicy(controlPolicy) && ok;
+	if ( gpio_queue != nullptr ) ok = gpio_queue->setThreadPolicy(ioPolicy) && ok;
+	if ( i2cBus != nullptr ) ok = i2cBus->setThreadPolicy(controlPolicy) && ok;
+	if ( tempMonitor != nullptr ) ok = tempMonitor->setThreadPolicy(monitorPolicy) && ok;
+	// the motor currents are supervised through the conversions of the motor ADC
+	for ( const auto& item: adcSchedulers ) {
+		ok = item.second->setThreadPolicy( (item.first == MOTOR_ADC_ADDR) ? controlPolicy : monitorPolicy ) && ok;
+	}
+	if ( !PiRaTe::lockMemory( ThreadOptionsS[THREAD_OPTION_MLOCK].s == ISS_ON ) ) ok = false;
+
+	ThreadPolicyNP.s = (ok) ? IPS_OK : IPS_ALERT;
+	IDSetNumber(&ThreadPolicyNP, nullptr);
+	if ( !ok ) DEBUG(INDI::Logger::DBG_WARNING, "Not all thread policies could be applied. Real-time priorities and memory locking require the CAP_SYS_NICE and CAP_IPC_LOCK capabilities.");
+	DEBUGF(INDI::Logger::DBG_SESSION, "Thread policies: encoders %s, control loops %s, GPIO I/O %s, monitoring %s",
+		encoderPolicy.toString().c_str(), controlPolicy.toString().c_str(), ioPolicy.toString().c_str(), monitorPolicy.toString().c_str());
+
+	// start the latency distributions afresh for the report after the change
+	if ( encoder_group != nullptr ) encoder_group->clearLoopLatency();
+	if ( az_encoder != nullptr ) az_encoder->clearLoopLatency();
+	az_servo->clearLoopLatency();
+	az_motor->clearLoopLatency();
+	jitterReportTime = std::chrono::steady_clock::now() + JITTER_REPORT_DELAY;
+	jitterReportPending = true;
+}
+
+void PiRT::logJitterReport(const std::string& title) {
+	if ( az_servo == nullptr || az_motor == nullptr || az_encoder == nullptr ) return;
+	if ( az_servo->loopLatency().entries() < JITTER_REPORT_MIN_CYCLES ) return;
+	DEBUGF(INDI::Logger::DBG_SESSION, "%s:", title.c_str());
+	auto report = [this](const char* loop, const PiRaTe::LoopTimer::LatencyHistogram& latency) {
+		DEBUGF(INDI::Logger::DBG_SESSION, "%-10s %8llu cycles, mean %6.0f us, 50%% %6.0f us, 90%% %6.0f us, 99%% %6.0f us, 99.9%% %6.0f us, max %6.0f us",
+			loop, static_cast<unsigned long long>( latency.entries() ), latency.mean(),
+			latency.quantile(0.5), latency.quantile(0.9), latency.quantile(0.99), latency.quantile(0.999), latency.maximum());
+	};
+	report( "encoder", (encoder_group != nullptr) ? encoder_group->loopLatency() : az_encoder->loopLatency() );
+	report( "servo", az_servo->loopLatency() );
+	report( "motor ramp", az_motor->loopLatency() );
+}
+
+void PiRT::updateLoopJitter() {
+	if ( az_servo == nullptr || az_motor == nullptr || az_encoder == nullptr ) return;
+	const PiRaTe::LoopTimer::LatencyHistogram& encoderLatency { (encoder_group != nullptr) ? encoder_group->loopLatency() : az_encoder->loopLatency() };
+	const PiRaTe::LoopTimer::LatencyHistogram& servoLatency { az_servo->loopLatency() };
+	const PiRaTe::LoopTimer::LatencyHistogram& motorLatency { az_motor->loopLatency() };
+	LoopJitterN[0].value = encoderLatency.quantile(0.5);
+	LoopJitterN[1].value = encoderLatency.quantile(0.99);
+	LoopJitterN[2].value = encoderLatency.maximum();
+	LoopJitterN[3].value = servoLatency.quantile(0.5);
+	LoopJitterN[4].value = servoLatency.quantile(0.99);
+	LoopJitterN[5].value = servoLatency.maximum();
+	LoopJitterN[6].value = motorLatency.quantile(0.5);
+	LoopJitterN[7].value = motorLatency.quantile(0.99);
+	LoopJitterN[8].value = motorLatency.maximum();
+	LoopJitterNP.s = IPS_OK;
+	IDSetNumber(&LoopJitterNP, nullptr);
+
+	if ( jitterReportPending && std::chrono::steady_clock::now() >= jitterReportTime ) {
+		jitterReportPending = false;
+		logJitterReport("Loop wake-up latency after applying the thread policies");
+	}
+}
+
+void PiRT::updateAxisEstimators() {
+	// the estimators are fed with the encoder samples by the axis servos
+	// convert from encoder revolutions to axis degrees
+	const double azScale { 360. / axisRatio[0] * ( (AZ_POS_DIR_INVERT) ? -1. : 1. ) };
+	const double altScale { 360. / axisRatio[1] * ( (ALT_POS_DIR_INVERT) ? -1. : 1. ) };
+	const PiRaTe::AxisEstimator::State azState { azEstimator.state() };
+	const PiRaTe::AxisEstimator::State elState { elEstimator.state() };
+	AxisRatesN[0].value = azScale * azState.velocity;
+	AxisRatesN[1].value = std::abs(azScale) * azState.velocityError();
+	AxisRatesN[2].value = azScale * azState.acceleration;
+	AxisRatesN[3].value = azEstimator.statistics().rejected;
+	AxisRatesN[4].value = altScale * elState.velocity;
+	AxisRatesN[5].value = std::abs(altScale) * elState.velocityError();
+	AxisRatesN[6].value = altScale * elState.acceleration;
+	AxisRatesN[7].value = elEstimator.statistics().rejected;
+	AxisRatesNP.s = ( azState.valid && elState.valid ) ? IPS_OK : IPS_IDLE;
+	IDSetNumber(&AxisRatesNP, nullptr);
+}
+
 void PiRT::updateTime() {
 
 	static struct timeval ltv { 0, 0 };
@@ -1448,6 +2606,8 @@ bool PiRT::ReadScopeStatus()
 
 	// update motor status
 	updateMotorStatus();
+	updateServoStatus();
+	updateLoopJitter();
 	
 	// update monitoring variables
 	updateMonitoring();
@@ -1455,13 +2615,23 @@ bool PiRT::ReadScopeStatus()
 
 	const unsigned int MAX_TARGET_POINTING_CYCLES { 1 + MAX_TARGET_POINTING_IMPROVEMENT_TIME_MS / std::max( getCurrentPollingPeriod(), 10U ) };
     
+	// rates of the target, only non-zero while tracking
+	PiRaTe::HorizontalMotion targetMotion { };
+
 	// the state machine to handle all operation conditions:
 	// SCOPE_IDLE, SCOPE_TRACKING, SCOPE_PARKING, SCOPE_PARKED and SCOPE_SLEWING
 	switch (TrackState)
 	{
 		case SCOPE_TRACKING:
 			TargetCoordSystem = SYSTEM_HOR;
-			targetHorizontalCoords = Equ2Hor(targetEquatorialCoords);
+			// position and rates of the target are evaluated analytically for the current instant,
+			// the rates are fed forward to the servos, which then only correct the residuals
+			targetMotion = Equ2HorMotion(targetEquatorialCoords);
+			targetHorizontalCoords = HorCoords { targetMotion.az, targetMotion.alt };
+			if ( targetMotion.keyhole != inKeyhole ) {
+				inKeyhole = targetMotion.keyhole;
+				DEBUG(INDI::Logger::DBG_SESSION, (inKeyhole) ? "Target enters the zenith keyhole, Az is guided at a limited rate." : "Target leaves the zenith keyhole.");
+			}
 		case SCOPE_PARKING:
 		case SCOPE_SLEWING:
 			if (TargetCoordSystem == SYSTEM_EQ) {
@@ -1506,32 +2676,37 @@ bool PiRT::ReadScopeStatus()
 				//DEBUGF(INDI::Logger::DBG_SESSION, "allowed dx=%f dy=%f", dx, dy);
 			}
 
-			// do the actual movement
-			// in Az
-			if ( std::abs(dx) > POS_ACCURACY_COARSE ) {
-				az_motor->move((dx>=0)?1.:-1.);
-			} else if ( std::abs(dx) > POS_ACCURACY_FINE ) {				
-				double mot = dx/POS_ACCURACY_COARSE;
-				if (std::abs(mot) < MotorThresholdN[0].value/100.) {
-					mot = (dx>0.) ? MotorThresholdN[0].value/100. : -MotorThresholdN[0].value/100.;
-				}
-				az_motor->move( mot );
-			} else if ( std::abs(dx) > TRACK_ACCURACY_AZ ) {
-				az_motor->move( (dx>0.) ? MotorThresholdN[0].value/100. : -MotorThresholdN[0].value/100. );
-			} else az_motor->stop();
-
-			// in Alt
-			if ( std::abs(dy) > POS_ACCURACY_COARSE ) {
-				el_motor->move((dy>=0)?1.:-1.);
-			} else if ( std::abs(dy) > POS_ACCURACY_FINE ) {				
-				double mot = dy/POS_ACCURACY_COARSE;
-				if (std::abs(mot) < MotorThresholdN[1].value/100.) {
-					mot = (dy>0.) ? MotorThresholdN[1].value/100. : -MotorThresholdN[1].value/100.;
+			// a new slew is executed as synchronised trajectories of both axes,
+			// which are streamed by the servos on their own
+			if ( ( TrackState == SCOPE_SLEWING || TrackState == SCOPE_PARKING ) && !slewPlanned ) {
+				planSlew( azAbsTurns + dx/360., altAbsTurns + dy/360. );
+				slewPlanned = true;
+			}
+			if ( az_servo->isFollowingTrajectory() || el_servo->isFollowingTrajectory() ) {
+				targetPointingCycles = 0;
+				break;
+			}
+
+			// hand the target over to the axis servos as absolute encoder positions
+			// the servos close the loops at their own rate, independent of this poll
+			if ( bool setpoint_guard = true ) {
+				const auto now { std::chrono::steady_clock::now() };
+				PiRaTe::AxisServo::Setpoint azSetpoint { };
+				azSetpoint.time = now;
+				azSetpoint.position = axisTurnsToEncoder( AXIS_AZ, azAbsTurns + dx/360. );
+				azSetpoint.velocity = axisTurnsToEncoder( AXIS_AZ, targetMotion.azRate/360. ) - axisTurnsToEncoder( AXIS_AZ, 0. );
+				azSetpoint.acceleration = axisTurnsToEncoder( AXIS_AZ, targetMotion.azAcceleration/360. ) - axisTurnsToEncoder( AXIS_AZ, 0. );
+				PiRaTe::AxisServo::Setpoint altSetpoint { };
+				altSetpoint.time = now;
+				altSetpoint.position = axisTurnsToEncoder( AXIS_ALT, altAbsTurns + dy/360. );
+				altSetpoint.velocity = axisTurnsToEncoder( AXIS_ALT, targetMotion.altRate/360. ) - axisTurnsToEncoder( AXIS_ALT, 0. );
+				altSetpoint.acceleration = axisTurnsToEncoder( AXIS_ALT, targetMotion.altAcceleration/360. ) - axisTurnsToEncoder( AXIS_ALT, 0. );
+				if ( !az_servo->setSetpoint(azSetpoint) || !el_servo->setSetpoint(altSetpoint) ) {
+					DEBUG(INDI::Logger::DBG_ERROR, "Axis servos can not engage without motor gain.");
+					Abort();
+					break;
 				}
-				el_motor->move( mot );
-			} else if ( std::abs(dy) > TRACK_ACCURACY_ALT ) {
-				el_motor->move( (dy>0.) ? MotorThresholdN[1].value/100. : -MotorThresholdN[1].value/100. );
-			} else el_motor->stop();
+			}
 
 			// Let's check if we reached target position for both axes
 			if ( 	std::abs(dx) < TRACK_ACCURACY_AZ 
@@ -1552,7 +2727,12 @@ bool PiRT::ReadScopeStatus()
 					//TrackState = SCOPE_PARKED;
 					SetParked(true);
 				}
-				Abort();
+				if ( TrackState == SCOPE_TRACKING ) {
+					// keep following the target
+					targetPointingCycles = 0;
+				} else {
+					Abort();
+				}
 			} else {
 				//targetPointingCycles = 0;
 			}
@@ -1571,6 +2751,7 @@ bool PiRT::ReadScopeStatus()
 		// no more movements towards negative direction allowed
 		DEBUGF(INDI::Logger::DBG_SESSION, "neg. Az overturn: azAbsTurns=%f limit=%f", azAbsTurns, -0.6-MAX_AZ_OVERTURN);
 		if ( az_motor->currentSpeed() < 0. ) {
+			triggerFlightRecorders("axis limit");
 			Abort();
 			fIsTracking = false;
 		}
@@ -1578,6 +2759,7 @@ bool PiRT::ReadScopeStatus()
 		// no more movements towards positive direction allowed
 		DEBUGF(INDI::Logger::DBG_SESSION, "pos. Az overturn: azAbsTurns=%f limit=%f", azAbsTurns, 0.6+MAX_AZ_OVERTURN);
 		if ( az_motor->currentSpeed() > 0. ) {
+			triggerFlightRecorders("axis limit");
 			Abort();
 			fIsTracking = false;
 		}
@@ -1586,6 +2768,7 @@ bool PiRT::ReadScopeStatus()
 	if ( altAbsTurns < ALT_LIMIT_LOW ) {
 		// no more movements towards negative direction allowed
 		if ( el_motor->currentSpeed() < 0. ) {
+			triggerFlightRecorders("axis limit");
 			Abort();
 			if (fIsTracking) TrackState = SCOPE_IDLE;
 			fIsTracking = false;
@@ -1593,6 +2776,7 @@ bool PiRT::ReadScopeStatus()
 	} else if ( altAbsTurns > ALT_LIMIT_HI ) {
 		// no more movements towards positive direction allowed
 		if ( el_motor->currentSpeed() > 0. ) {
+			triggerFlightRecorders("axis limit");
 			Abort();
 			if (fIsTracking) TrackState = SCOPE_IDLE;
 			fIsTracking = false;
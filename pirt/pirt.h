@@ -18,10 +18,15 @@
 #include <rpi_temperatures.h>
 #include <voltage_monitor.h>
 #include <ads1115_measurement.h>
+#include <radiometer_stream.h>
+#include <axis_estimator.h>
+#include <tracking.h>
 
 #include <map>
+#include <mutex>
 
 class i2cDevice;
+class I2cBus;
 
 struct HorCoords {
 	HorCoords() { Alt.registerGimbalFlipCallback( [this]() { this->Az.gimbalFlip(); } ); }
@@ -47,9 +52,15 @@ struct EquCoords {
 
 
 class GPIO;
+class AsyncGPIO;
+class CachedGPIO;
 namespace PiRaTe {
 	class SsiPosEncoder;
+	class SsiEncoderGroup;
+	class GpioInputMonitor;
 	class MotorDriver;
+	class AxisServo;
+	class MountSimulator;
 	//class RpiTemperatureMonitor;
 }
 class ADS1115;
@@ -77,6 +88,8 @@ class PiRT : public INDI::Telescope
     void TimerHit() override;
     virtual bool ISNewSwitch (const char *dev, const char *name, ISState *states, char *names[], int n) override;
 	virtual bool ISNewNumber(const char *dev, const char *name, double values[], char *names[], int n) override;
+	virtual bool ISNewText(const char *dev, const char *name, char *texts[], char *names[], int n) override;
+	virtual bool saveConfigItems(FILE *fp) override;
     virtual bool ISSnoopDevice(XMLEle *root) override;
 
 
@@ -105,12 +118,78 @@ class PiRT : public INDI::Telescope
     void Hor2Equ(const HorCoords& hor_coords, double* ra, double* dec);
     void Equ2Hor(double ra, double dec, double* az, double* alt);
     HorCoords Equ2Hor(const EquCoords& equ_coords);
+	/**
+	 * @brief Horizontal position and rates of an equatorial target at the current instant.
+	 * The azimuth is counted from south as everywhere in the driver. Near the zenith, the azimuth is guided
+	 * through the keyhole ({@link PiRaTe::trackingMotion}) according to the Az slew velocity limit.
+	 */
+	[[nodiscard]] auto Equ2HorMotion(const EquCoords& equ_coords) -> PiRaTe::HorizontalMotion;
 	EquCoords Hor2Equ(const HorCoords& hor_coords);
 	bool isInAbsoluteTurnRangeAz(double absRev);
 	bool isInAbsoluteTurnRangeAlt(double absRev);
 	
 	void updatePosition();
+	void updateAxisEstimators();
+	/**
+	 * @brief The horizontal position of the mount at the given instant.
+	 * The encoder positions are interpolated from the buffered samples (or extrapolated over at most
+	 * two sampling periods), so that the pointing can be assigned to measurements with their own time stamps.
+	 * @return false if no encoder data is available for the requested time
+	 */
+	[[nodiscard]] auto horizontalCoordsAt(std::chrono::steady_clock::time_point time, HorCoords& coords) const -> bool;
+	[[nodiscard]] auto encoderToAxisTurns(int axis, double revolutions) const -> double;
+	[[nodiscard]] auto axisTurnsToEncoder(int axis, double turns) const -> double;
+	[[nodiscard]] auto maxEncoderExtrapolation() const -> std::chrono::steady_clock::duration;
+	/**
+	 * @brief Copy of the parameters which convert the encoder positions to the horizontal position.
+	 * Threads outside of the INDI loop (the writer of the radiometer stream) evaluate the pointing with
+	 * a snapshot, since the members are changed by the clients at any time.
+	 */
+	struct PointingParameters {
+		double axisRatio[2] { 1., 1. };
+		double axisOffset[2] { 0., 0. };
+		std::chrono::steady_clock::duration maxExtrapolation { }; ///< maximum extrapolation of the encoder positions
+		[[nodiscard]] auto axisTurns(int axis, double revolutions) const -> double;
+		[[nodiscard]] auto horizontalCoordsAt(const PiRaTe::SsiPosEncoder& az_enc, const PiRaTe::SsiPosEncoder& el_enc,
+											  std::chrono::steady_clock::time_point time, HorCoords& coords) const -> bool;
+	};
+	/// the pointing parameters as currently set, must be called from the INDI loop
+	[[nodiscard]] auto currentPointingParameters() const -> PointingParameters;
+	/// store a snapshot of the current pointing parameters, called after every change of the parameters
+	void updatePointingParameters();
+	/// the last stored snapshot of the pointing parameters, may be called from any thread
+	[[nodiscard]] auto pointingParameters() const -> PointingParameters;
+	void applyAxisModels();
+	void applyServoSettings();
+	/**
+	 * @brief Plan synchronised, jerk-limited slews of both axes and hand them to the servos.
+	 * @param azTurns the Az target in absolute axis turns
+	 * @param altTurns the Alt target in absolute axis turns
+	 */
+	void planSlew(double azTurns, double altTurns);
+	void updateServoStatus();
+	/**
+	 * @brief Apply the configured scheduling policies to all hardware threads.
+	 * Encoder read-out, servo, motor ramp and GPIO I/O threads run with SCHED_FIFO priorities and optionally pinned
+	 * to one CPU core, monitoring threads are optionally demoted. The wake-up latency distribution of the control
+	 * loops before the change is logged and a second report is logged after {@link JITTER_REPORT_DELAY}.
+	 */
+	void applyThreadPolicies();
+	void updateLoopJitter();
+	void logJitterReport(const std::string& title);
+	/// GPIO simulator with a physical model of both axes for running the driver without hardware
+	[[nodiscard]] auto createSimulatedGpio() -> std::shared_ptr<GPIO>;
 	void updateMotorStatus();
+	/// hand the peak current limits and the I2t models to the motor drivers, which supervise the currents in their threads
+	void applyMotorCurrentLimits();
+	/// trigger the flight recorders of both motors, reason must be a string literal
+	void triggerFlightRecorders(const char* reason);
+	/// write the content of a frozen flight recorder to the telemetry directory and resume recording
+	void dumpTelemetry(const std::string& axis, PiRaTe::MotorDriver& motor);
+	/// start or stop recording and publishing of the radiometer stream according to RadiometerStreamSP
+	void applyRadiometerStream();
+	/// detach the radiometer stream from its channel and stop it, before the encoders or the measurements go away
+	void closeRadiometerStream();
 	void updateMonitoring();
 	void updateTemperatures( PiRaTe::RpiTemperatureMonitor::TemperatureItem item );
 	void updateTime();
@@ -126,8 +205,35 @@ class PiRT : public INDI::Telescope
     INumber EncoderBitRateN;
     INumberVectorProperty EncoderBitRateNP;
 
-	INumber AzEncoderN[5];
-	INumber ElEncoderN[5];
+    INumber EncoderSampleRateN;
+    INumberVectorProperty EncoderSampleRateNP;
+
+	enum {
+		GPIO_BACKEND_PIGPIOD,
+		GPIO_BACKEND_LINUX,
+		GPIO_BACKEND_SIM
+	};
+	ISwitch GpioBackendS[3];
+	ISwitchVectorProperty GpioBackendSP;
+
+	enum {
+		ENC_TRANSPORT_PIGPIOD,
+		ENC_TRANSPORT_SPIDEV
+	};
+	ISwitch EncoderTransportS[2];
+	ISwitchVectorProperty EncoderTransportSP;
+	IText EncoderSpiDevT[2];
+	ITextVectorProperty EncoderSpiDevTP;
+	INumber EncoderLatencyN[8];
+	INumberVectorProperty EncoderLatencyNP;
+
+	INumber GpioQueueN[6];
+	INumberVectorProperty GpioQueueNP;
+	INumber GpioCacheN[3];
+	INumberVectorProperty GpioCacheNP;
+
+	INumber AzEncoderN[8];
+	INumber ElEncoderN[8];
 	INumberVectorProperty AzEncoderNP;
 	INumberVectorProperty ElEncoderNP;
 	INumber AzEncSettingN[2], ElEncSettingN[2];
@@ -147,20 +253,74 @@ class PiRT : public INDI::Telescope
 
 	INumber MotorCurrentLimitN[2];
 	INumberVectorProperty MotorCurrentLimitNP;
+	INumber MotorI2tN[4];
+	INumberVectorProperty MotorI2tNP;
+	INumber MotorLoadN[2];
+	INumberVectorProperty MotorLoadNP;
 
 	INumber VoltageMonitorN[64];
 	INumberVectorProperty VoltageMonitorNP;
 	
 	INumber VoltageMeasurementN[16];
 	INumberVectorProperty VoltageMeasurementNP;
+	INumber MeasurementNoiseN[32];
+	INumberVectorProperty MeasurementNoiseNP;
 	INumber MeasurementIntTimeN;
     INumberVectorProperty MeasurementIntTimeNP;
+	INumber MeasurementPositionN[3];
+	INumberVectorProperty MeasurementPositionNP;
 
 	INumber TempMonitorN[64];
 	INumberVectorProperty TempMonitorNP;
 	
 	INumber AxisAbsTurnsN[2];
 	INumberVectorProperty AxisAbsTurnsNP;
+
+	INumber AxisRatesN[8];
+	INumberVectorProperty AxisRatesNP;
+
+	INumber AxisModelN[4];
+	INumberVectorProperty AxisModelNP;
+
+	INumber ServoSettingsN[9];
+	INumberVectorProperty ServoSettingsNP;
+	INumber ServoStatusN[6];
+	INumberVectorProperty ServoStatusNP;
+	INumber SlewLimitsN[6];
+	INumberVectorProperty SlewLimitsNP;
+
+	INumber ThreadPolicyN[4];
+	INumberVectorProperty ThreadPolicyNP;
+	enum {
+		THREAD_OPTION_MLOCK,
+		THREAD_OPTION_DEMOTE
+	};
+	ISwitch ThreadOptionsS[2];
+	ISwitchVectorProperty ThreadOptionsSP;
+	IText TelemetryDirT;
+	ITextVectorProperty TelemetryDirTP;
+	INumber AdcReadyPinN[2];
+	INumberVectorProperty AdcReadyPinNP;
+	INumber AdcRateN[8];
+	INumberVectorProperty AdcRateNP;
+	INumber I2cBusN[8];
+	INumberVectorProperty I2cBusNP;
+	IText RadiometerDirT;
+	ITextVectorProperty RadiometerDirTP;
+	enum {
+		RADIOMETER_RECORD,
+		RADIOMETER_PUBLISH
+	};
+	ISwitch RadiometerStreamS[2];
+	ISwitchVectorProperty RadiometerStreamSP;
+	INumber RadiometerRateN;
+	INumberVectorProperty RadiometerRateNP;
+	INumber RadiometerStatusN[6];
+	INumberVectorProperty RadiometerStatusNP;
+	IBLOB RadiometerBlobB;
+	IBLOBVectorProperty RadiometerBlobBP;
+	INumber LoopJitterN[9];
+	INumberVectorProperty LoopJitterNP;
 	
 	ISwitch OutputSwitchS[16];
 	ISwitchVectorProperty OutputSwitchSP;
@@ -181,16 +341,31 @@ class PiRT : public INDI::Telescope
 	
 	double axisRatio[2] { 1., 1. };
 	double axisOffset[2] { 0., 0. };
+	PointingParameters pointingSnapshot { };
+	mutable std::mutex pointingMutex;
 	
     IPState lastHorState;
     uint8_t DBG_SCOPE { INDI::Logger::DBG_IGNORE };
 	
 	std::shared_ptr<GPIO> gpio { nullptr };
+	std::shared_ptr<AsyncGPIO> gpio_queue { nullptr };
+	std::shared_ptr<CachedGPIO> gpio_cache { nullptr };
+	std::unique_ptr<PiRaTe::MountSimulator> mountSimulator { nullptr };
 	std::unique_ptr<PiRaTe::SsiPosEncoder> az_encoder { nullptr };
 	std::unique_ptr<PiRaTe::SsiPosEncoder> el_encoder { nullptr };
+	std::unique_ptr<PiRaTe::SsiEncoderGroup> encoder_group { nullptr };
+	std::unique_ptr<PiRaTe::GpioInputMonitor> inputMonitor { nullptr };
+	PiRaTe::AxisEstimator azEstimator { };
+	PiRaTe::AxisEstimator elEstimator { };
 	std::unique_ptr<PiRaTe::MotorDriver> az_motor { nullptr };
 	std::unique_ptr<PiRaTe::MotorDriver> el_motor { nullptr };
+	std::unique_ptr<PiRaTe::AxisServo> az_servo { nullptr };
+	std::unique_ptr<PiRaTe::AxisServo> el_servo { nullptr };
+	/// transaction manager of the I2C bus, shared by all I2C devices
+	std::shared_ptr<I2cBus> i2cBus { nullptr };
 	std::map<std::uint8_t, std::shared_ptr<i2cDevice>> i2cDeviceMap { };
+	/// conversion schedulers of the ADCs, which own the ADCs after the detection
+	std::map<std::uint8_t, std::shared_ptr<PiRaTe::Ads1115Scheduler>> adcSchedulers { };
 	std::shared_ptr<PiRaTe::RpiTemperatureMonitor> tempMonitor { nullptr };
 	HorCoords currentHorizontalCoords { 0. , 90. };
 	HorCoords targetHorizontalCoords { 0. , 90. };
@@ -198,6 +373,14 @@ class PiRT : public INDI::Telescope
 	
 	std::vector<std::shared_ptr<PiRaTe::Ads1115VoltageMonitor>> voltageMonitors { };
 	std::vector<std::shared_ptr<PiRaTe::Ads1115Measurement>> voltageMeasurements { };
+	/// the measurement of the radiometer detector and the stream of its raw samples
+	std::shared_ptr<PiRaTe::Ads1115Measurement> radiometerMeasurement { nullptr };
+	std::unique_ptr<PiRaTe::RadiometerStream> radiometerStream { nullptr };
+	std::string radiometerBlock { }; ///< content of the last published radiometer BLOB
 	std::chrono::time_point<std::chrono::system_clock> fStartTime { };
 	unsigned int targetPointingCycles { 0 };
+	bool slewPlanned { false };
+	bool inKeyhole { false };
+	bool jitterReportPending { false };
+	std::chrono::steady_clock::time_point jitterReportTime { };
 };
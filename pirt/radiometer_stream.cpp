@@ -0,0 +1,296 @@
+#include <iomanip>
+#include <sstream>
+#include <array>
+#include <utility>
+
+#include "radiometer_stream.h"
+#include "binary_io.h"
+
+namespace PiRaTe {
+
+constexpr std::array<char, 8> RADIOMETER_MAGIC { 'P', 'I', 'R', 'T', 'R', 'A', 'D', 'S' };
+constexpr std::uint16_t RADIOMETER_FORMAT_VERSION { 1 };
+constexpr std::uint32_t RADIOMETER_CHUNK_MARKER { 0x4b4e4843 }; // "CHNK"
+constexpr std::uint32_t MAX_RADIOMETER_STRING_LENGTH { 1024 };
+constexpr std::uint32_t MAX_RADIOMETER_CHUNK_RECORDS { 1U << 20 };
+
+using namespace BinaryIo;
+
+void writeRadiometerHeader(std::ostream& out, const RadiometerStreamInfo& info)
+{
+	out.write( RADIOMETER_MAGIC.data(), RADIOMETER_MAGIC.size() );
+	writeLe( out, RADIOMETER_FORMAT_VERSION );
+	writeString( out, info.name );
+	writeString( out, info.unit );
+	writeLe( out, info.steadyReference );
+	writeLe( out, info.systemReference );
+}
+
+void writeRadiometerChunk(std::ostream& out, const std::vector<RadiometerRecord>& records)
+{
+	writeLe( out, RADIOMETER_CHUNK_MARKER );
+	writeLe( out, static_cast<std::uint32_t>( records.size() ) );
+	for ( const auto& record: records ) {
+		writeLe( out, record.time );
+		writeFloat( out, record.value );
+		writeFloat( out, record.az );
+		writeFloat( out, record.alt );
+		writeLe( out, record.flags );
+	}
+}
+
+auto readRadiometerStream(const std::string& path, RadiometerStreamInfo& info, std::vector<RadiometerRecord>& records) -> bool
+{
+	std::ifstream in( path, std::ios::binary );
+	if ( !in ) {
+		std::cerr<<"Error opening radiometer stream file "<<path<<"\n";
+		return false;
+	}
+	std::array<char, RADIOMETER_MAGIC.size()> magic { };
+	in.read( magic.data(), magic.size() );
+	std::uint16_t version { 0 };
+	if ( !in || magic != RADIOMETER_MAGIC || !readLe(in, version) || version != RADIOMETER_FORMAT_VERSION ) {
+		std::cerr<<path<<" is no radiometer stream of a known format\n";
+		return false;
+	}
+	if ( !readString(in, info.name, MAX_RADIOMETER_STRING_LENGTH) || !readString(in, info.unit, MAX_RADIOMETER_STRING_LENGTH)
+		|| !readLe(in, info.steadyReference) || !readLe(in, info.systemReference) )
+	{
+		std::cerr<<"Error reading header of radiometer stream "<<path<<"\n";
+		return false;
+	}
+	records.clear();
+	unsigned long nr_chunks { 0 };
+	std::uint32_t marker { 0 };
+	while ( readLe(in, marker) ) {
+		std::uint32_t nr_records { 0 };
+		if ( marker != RADIOMETER_CHUNK_MARKER || !readLe(in, nr_records) || nr_records > MAX_RADIOMETER_CHUNK_RECORDS ) {
+			std::cerr<<"Radiometer stream "<<path<<" is corrupt after "<<nr_chunks<<" chunks\n";
+			return false;
+		}
+		const std::size_t chunk_start { records.size() };
+		for (std::uint32_t i = 0; i < nr_records; i++) {
+			RadiometerRecord record { };
+			if ( !readLe(in, record.time) || !readFloat(in, record.value) || !readFloat(in, record.az)
+				|| !readFloat(in, record.alt) || !readLe(in, record.flags) )
+			{
+				// the file was cut off while the last chunk was written
+				std::cerr<<"Radiometer stream "<<path<<" is truncated, skipping the incomplete chunk "<<nr_chunks<<"\n";
+				records.resize(chunk_start);
+				return true;
+			}
+			records.push_back(record);
+		}
+		nr_chunks++;
+	}
+	return true;
+}
+
+void writeRadiometerCsv(std::ostream& out, const RadiometerStreamInfo& info, const std::vector<RadiometerRecord>& records)
+{
+	out<<"# channel: "<<info.name<<" ["<<info.unit<<"]\n";
+	out<<"time_s,value,az_deg,alt_deg,pointing_valid\n";
+	out<<std::fixed;
+	for ( const auto& record: records ) {
+		const std::int64_t utc_us { record.time - info.steadyReference + info.systemReference };
+		out<<std::setprecision(6)<<utc_us * 1e-6<<","
+			<<std::setprecision(5)<<record.value<<","<<record.az<<","<<record.alt<<","
+			<<( (record.flags & RadiometerRecord::POINTING_VALID) ? 1 : 0 )<<"\n";
+	}
+}
+
+RadiometerStream::RadiometerStream(std::string name, std::string unit, PointingFn pointing)
+	: fPointing { std::move(pointing) }
+{
+	fInfo.name = std::move(name);
+	fInfo.unit = std::move(unit);
+	fInfo.steadyReference = std::chrono::duration_cast<std::chrono::microseconds>( std::chrono::steady_clock::now().time_since_epoch() ).count();
+	fInfo.systemReference = std::chrono::duration_cast<std::chrono::microseconds>( std::chrono::system_clock::now().time_since_epoch() ).count();
+	fPending.reserve(RADIOMETER_RING_DEPTH);
+	fChunk.reserve(RADIOMETER_CHUNK_RECORDS);
+	fActiveLoop = true;
+	fThread = std::make_unique<std::thread>( [this]() { this->writerLoop(); } );
+}
+
+RadiometerStream::~RadiometerStream()
+{
+	{
+		std::lock_guard<std::mutex> lock(fMutex);
+		fActiveLoop = false;
+	}
+	fCondition.notify_all();
+	if (fThread != nullptr) fThread->join();
+}
+
+void RadiometerStream::push(std::chrono::steady_clock::time_point time, double value)
+{
+	if ( !isActive() ) return;
+	fRing.push( Sample { time, value } );
+}
+
+auto RadiometerStream::startRecording(const std::string& path) -> bool
+{
+	std::lock_guard<std::mutex> lock(fMutex);
+	if ( fFile.is_open() ) fFile.close();
+	fFile.open( path, std::ios::binary | std::ios::trunc );
+	if ( !fFile ) {
+		std::cerr<<"Error opening radiometer stream file "<<path<<"\n";
+		fRecording = false;
+		return false;
+	}
+	writeRadiometerHeader(fFile, fInfo);
+	fFile.flush();
+	fPath = path;
+	fStatistics.bytesWritten = static_cast<std::uint64_t>( fFile.tellp() );
+	fRecording = true;
+	return true;
+}
+
+void RadiometerStream::stopRecording()
+{
+	std::unique_lock<std::mutex> lock(fMutex);
+	if ( !fFile.is_open() ) {
+		fRecording = false;
+		return;
+	}
+	// let the writer thread append the buffered samples before the file is closed
+	fCloseRequested = true;
+	fCondition.notify_all();
+	fCondition.wait(lock, [this]() { return !fCloseRequested || !fActiveLoop; });
+}
+
+void RadiometerStream::setPublishing(bool publish)
+{
+	std::lock_guard<std::mutex> lock(fMutex);
+	fPublishing = publish;
+	if ( !publish ) fBlocks.clear();
+}
+
+auto RadiometerStream::path() const -> std::string
+{
+	std::lock_guard<std::mutex> lock(fMutex);
+	return fPath;
+}
+
+auto RadiometerStream::takeBlocks() -> std::string
+{
+	std::lock_guard<std::mutex> lock(fMutex);
+	if ( fBlocks.empty() ) return { };
+	std::ostringstream out { };
+	writeRadiometerHeader(out, fInfo);
+	return out.str() + std::exchange( fBlocks, std::string { } );
+}
+
+auto RadiometerStream::statistics() const -> Statistics
+{
+	std::lock_guard<std::mutex> lock(fMutex);
+	return fStatistics;
+}
+
+void RadiometerStream::writerLoop()
+{
+	while (true) {
+		bool closing { false };
+		bool terminating { false };
+		{
+			std::unique_lock<std::mutex> lock(fMutex);
+			fCondition.wait_for(lock, RADIOMETER_WRITER_PERIOD, [this]() { return fCloseRequested || !fActiveLoop; });
+			terminating = !fActiveLoop;
+			closing = fCloseRequested || terminating;
+		}
+		if ( isActive() || closing ) {
+			collect();
+			const auto now { std::chrono::steady_clock::now() };
+			// when closing, the latest samples get an extrapolated (or no) pointing instead of being lost
+			process( (closing) ? now : now - RADIOMETER_POINTING_DELAY );
+			if ( closing || ( !fChunk.empty() && now - fChunkStart >= RADIOMETER_CHUNK_PERIOD ) ) finishChunk();
+		} else {
+			// nothing is acquired, discard the leftovers of the previous acquisition
+			fCursor = fRing.head();
+			fPending.clear();
+			fChunk.clear();
+		}
+		if ( closing ) {
+			{
+				std::lock_guard<std::mutex> lock(fMutex);
+				fRecording = false;
+				if ( fFile.is_open() ) fFile.close();
+				fCloseRequested = false;
+			}
+			fCondition.notify_all();
+		}
+		if ( terminating ) break;
+	}
+}
+
+void RadiometerStream::collect()
+{
+	const std::uint64_t start { fCursor };
+	const std::size_t n { fRing.readSince(fCursor, fPending) };
+	const std::uint64_t lost { fCursor - start - n };
+	if ( lost == 0 ) return;
+	std::lock_guard<std::mutex> lock(fMutex);
+	fStatistics.dropped += lost;
+}
+
+void RadiometerStream::process(std::chrono::steady_clock::time_point cutoff)
+{
+	unsigned long misses { 0 };
+	std::size_t i { 0 };
+	for ( ; i < fPending.size() && fPending[i].time <= cutoff; i++ ) {
+		const Sample& sample { fPending[i] };
+		RadiometerRecord record { };
+		record.time = std::chrono::duration_cast<std::chrono::microseconds>( sample.time.time_since_epoch() ).count();
+		record.value = static_cast<float>( sample.value );
+		double az { 0. };
+		double alt { 0. };
+		if ( fPointing && fPointing(sample.time, az, alt) ) {
+			record.az = static_cast<float>( az );
+			record.alt = static_cast<float>( alt );
+			record.flags |= RadiometerRecord::POINTING_VALID;
+		} else {
+			misses++;
+		}
+		if ( fChunk.empty() ) fChunkStart = sample.time;
+		fChunk.push_back(record);
+		if ( fChunk.size() >= RADIOMETER_CHUNK_RECORDS ) finishChunk();
+	}
+	fPending.erase( fPending.begin(), fPending.begin() + i );
+	if ( i == 0 ) return;
+	std::lock_guard<std::mutex> lock(fMutex);
+	fStatistics.samples += i;
+	fStatistics.pointingMisses += misses;
+}
+
+void RadiometerStream::finishChunk()
+{
+	if ( fChunk.empty() ) return;
+	std::ostringstream out { };
+	writeRadiometerChunk(out, fChunk);
+	const std::string bytes { out.str() };
+	const double span { 1e-6 * ( fChunk.back().time - fChunk.front().time ) };
+	const double rate { ( span > 0. ) ? ( fChunk.size() - 1 ) / span : 0. };
+	fChunk.clear();
+
+	std::lock_guard<std::mutex> lock(fMutex);
+	fStatistics.chunks++;
+	fStatistics.rate = rate;
+	if ( fFile.is_open() ) {
+		fFile.write( bytes.data(), static_cast<std::streamsize>( bytes.size() ) );
+		// flush every chunk, so that a crash loses at most the chunk in progress
+		fFile.flush();
+		if ( !fFile ) {
+			std::cerr<<"Error writing radiometer stream file "<<fPath<<", recording stopped\n";
+			fFile.close();
+			fRecording = false;
+		} else {
+			fStatistics.bytesWritten += bytes.size();
+		}
+	}
+	if ( fPublishing ) {
+		if ( fBlocks.size() + bytes.size() > RADIOMETER_MAX_PENDING_BYTES ) fStatistics.blocksDropped++;
+		else fBlocks += bytes;
+	}
+}
+
+} // namespace PiRaTe
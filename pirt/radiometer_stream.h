@@ -0,0 +1,168 @@
+#ifndef RADIOMETER_STREAM_H
+#define RADIOMETER_STREAM_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <iostream>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+
+#include "utility.h"
+
+namespace PiRaTe {
+
+constexpr std::size_t RADIOMETER_RING_DEPTH { 8192 }; ///< buffered raw samples, about 9.5 s at 860 Hz
+constexpr std::size_t RADIOMETER_CHUNK_RECORDS { 1024 }; ///< maximum number of records per chunk
+constexpr std::chrono::milliseconds RADIOMETER_CHUNK_PERIOD { 1000 }; ///< maximum time span of a chunk
+constexpr std::chrono::milliseconds RADIOMETER_WRITER_PERIOD { 100 }; ///< cycle time of the writer thread
+constexpr std::chrono::milliseconds RADIOMETER_POINTING_DELAY { 100 }; ///< minimum age of a sample before its pointing is interpolated
+constexpr std::size_t RADIOMETER_MAX_PENDING_BYTES { 4U << 20 }; ///< limit of the blocks waiting for publication
+
+/**
+ * @brief One raw conversion of the radiometer channel with the pointing at its time stamp.
+ */
+struct RadiometerRecord {
+	enum Flags : std::uint8_t {
+		POINTING_VALID = 0x01 ///< encoder data was available for the interpolation of az and alt
+	};
+	std::int64_t time { 0 }; ///< steady clock time in us at the middle of the conversion
+	float value { 0. }; ///< the measured value in the unit of the channel
+	float az { 0. }; ///< azimuth in deg (counted from south) at the sample time
+	float alt { 0. }; ///< altitude in deg at the sample time
+	std::uint8_t flags { 0 };
+};
+
+/**
+ * @brief Description of a radiometer stream file.
+ */
+struct RadiometerStreamInfo {
+	std::string name { }; ///< name of the measurement channel
+	std::string unit { }; ///< unit of the values
+	std::int64_t steadyReference { 0 }; ///< steady clock time in us at the start of the stream...
+	std::int64_t systemReference { 0 }; ///< ...and the corresponding system (UTC) time in us since the epoch
+};
+
+/**
+ * @brief Write the header of a radiometer stream.
+ * The stream starts with the magic "PIRTRADS", a format version, the name and unit as length-prefixed strings
+ * and the time references as 64 bit integers. It is followed by any number of chunks, written by
+ * {@link writeRadiometerChunk}. All numbers are stored little-endian.
+ */
+void writeRadiometerHeader(std::ostream& out, const RadiometerStreamInfo& info);
+/**
+ * @brief Write a chunk of records.
+ * A chunk consists of the marker "CHNK", the number of records and the packed records (21 bytes each).
+ * Since every chunk is self-delimiting, a file which was cut off (e.g. by a power failure) loses at most its last chunk.
+ */
+void writeRadiometerChunk(std::ostream& out, const std::vector<RadiometerRecord>& records);
+/**
+ * @brief Read a radiometer stream written by {@link writeRadiometerHeader} and {@link writeRadiometerChunk}.
+ * A truncated last chunk is reported and skipped.
+ * @return false if the file could not be read or has an unknown format
+ */
+auto readRadiometerStream(const std::string& path, RadiometerStreamInfo& info, std::vector<RadiometerRecord>& records) -> bool;
+/**
+ * @brief Write the records as CSV with a header line.
+ * The time column is the UTC time in seconds since the epoch, reconstructed through the time references of the stream.
+ */
+void writeRadiometerCsv(std::ostream& out, const RadiometerStreamInfo& info, const std::vector<RadiometerRecord>& records);
+
+/**
+ * @brief Acquisition of every raw sample of a measurement channel together with the pointing of the mount.
+ * The samples are pushed by the ADC conversion thread into a lock-free ring, which costs the producer a few
+ * stores per sample. A writer thread collects them, interpolates the horizontal position at the time stamp of
+ * each sample (delayed by {@link RADIOMETER_POINTING_DELAY}, so that the encoder readings after the sample
+ * are available) and packs the records into chunks. The chunks are appended to the recording file and, if
+ * publishing is enabled, queued for the clients as self-contained blocks (header plus chunks).
+ * Samples are only buffered while recording or publishing is active.
+ * @author HG Zaunick
+ */
+class RadiometerStream {
+public:
+	struct Statistics {
+		unsigned long samples { 0 }; ///< number of processed samples
+		unsigned long dropped { 0 }; ///< samples overwritten in the ring before they were processed
+		unsigned long pointingMisses { 0 }; ///< samples without encoder data
+		unsigned long chunks { 0 }; ///< number of completed chunks
+		unsigned long blocksDropped { 0 }; ///< chunks not published, because the clients did not fetch the blocks
+		std::uint64_t bytesWritten { 0 }; ///< size of the current recording file
+		double rate { 0. }; ///< sample rate within the last chunk in Hz
+	};
+	/// returns the horizontal position (az, alt in deg) at the given instant, false if it is not available
+	using PointingFn = std::function<bool(std::chrono::steady_clock::time_point time, double& az, double& alt)>;
+
+	RadiometerStream() = delete;
+	/**
+	 * @brief The main constructor.
+	 * Starts the writer thread.
+	 * @param name name of the measurement channel
+	 * @param unit unit of the values
+	 * @param pointing the interpolation of the mount position, called from the writer thread
+	 */
+	RadiometerStream(std::string name, std::string unit, PointingFn pointing);
+	~RadiometerStream();
+
+	/// append a sample, must only be called from one (the conversion) thread
+	void push(std::chrono::steady_clock::time_point time, double value);
+	/**
+	 * @brief Start writing the stream to a new file.
+	 * A running recording is closed before.
+	 * @return false if the file could not be opened
+	 */
+	auto startRecording(const std::string& path) -> bool;
+	/// write the remaining samples and close the recording file
+	void stopRecording();
+	void setPublishing(bool publish);
+	[[nodiscard]] auto isRecording() const -> bool { return fRecording; }
+	[[nodiscard]] auto isPublishing() const -> bool { return fPublishing; }
+	[[nodiscard]] auto isActive() const -> bool { return fRecording || fPublishing; }
+	[[nodiscard]] auto path() const -> std::string;
+	/**
+	 * @brief The blocks completed since the last call for the publication to clients.
+	 * @return the header followed by the pending chunks, i.e. the content of a valid stream file,
+	 * or an empty string if no chunk is pending
+	 */
+	[[nodiscard]] auto takeBlocks() -> std::string;
+	[[nodiscard]] auto statistics() const -> Statistics;
+
+private:
+	struct Sample {
+		std::chrono::steady_clock::time_point time { };
+		double value { 0. };
+	};
+
+	void writerLoop();
+	void collect();
+	void process(std::chrono::steady_clock::time_point cutoff);
+	void finishChunk();
+
+	RadiometerStreamInfo fInfo { };
+	PointingFn fPointing { };
+	SampleRing<Sample, RADIOMETER_RING_DEPTH> fRing { };
+	std::uint64_t fCursor { 0 };
+	std::vector<Sample> fPending { }; ///< collected samples waiting for their pointing, writer thread only
+	std::vector<RadiometerRecord> fChunk { }; ///< the chunk being filled, writer thread only
+	std::chrono::steady_clock::time_point fChunkStart { }; ///< time stamp of the first sample of the chunk
+	std::ofstream fFile { };
+	std::string fPath { };
+	std::string fBlocks { }; ///< chunks waiting for publication
+	Statistics fStatistics { };
+	std::atomic<bool> fRecording { false };
+	std::atomic<bool> fPublishing { false };
+	bool fCloseRequested { false };
+	std::atomic<bool> fActiveLoop { false };
+	mutable std::mutex fMutex;
+	std::condition_variable fCondition;
+	std::unique_ptr<std::thread> fThread { nullptr };
+};
+
+} // namespace PiRaTe
+
+#endif // RADIOMETER_STREAM_H
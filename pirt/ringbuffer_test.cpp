@@ -0,0 +1,161 @@
+/* test of the Ringbuffer running statistics against a direct computation over the stored values
+ * usage: ringbuffer_test
+ * Covers the fill-up, the wrap-around, the recomputation of the sums after N overwritten values, mean, stddev,
+ * median and percentiles and clear() for ring sizes with and without remainder of the vectorised reduction.
+ * Returns a non-zero exit code if any check fails.
+ */
+
+#include <iostream>
+#include <algorithm>
+#include <cstdlib>
+#include <cmath>
+#include <deque>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "utility.h"
+
+namespace {
+
+unsigned long nr_checks { 0 };
+unsigned long nr_failures { 0 };
+
+void check(bool ok, const std::string& what)
+{
+	nr_checks++;
+	if ( ok ) return;
+	nr_failures++;
+	std::cerr<<"FAILED: "<<what<<"\n";
+}
+
+void checkClose(double value, double expected, double tolerance, const std::string& what)
+{
+	check( std::abs( value - expected ) <= tolerance, what+": "+std::to_string(value)+" != "+std::to_string(expected) );
+}
+
+// statistics of the reference values, computed directly
+struct Reference {
+	std::deque<double> values { };
+
+	auto mean() const -> double { return ( values.empty() ) ? 0. : std::accumulate( values.begin(), values.end(), 0. ) / values.size(); }
+	auto stddev() const -> double {
+		if ( values.size() < 2 ) return 0.;
+		const double m { mean() };
+		double sum_sq { 0. };
+		for ( double v: values ) sum_sq += ( v - m ) * ( v - m );
+		return std::sqrt( sum_sq / ( values.size() - 1 ) );
+	}
+	auto percentile(double p) const -> double {
+		if ( values.empty() ) return 0.;
+		std::vector<double> sorted( values.begin(), values.end() );
+		std::sort( sorted.begin(), sorted.end() );
+		const double pos { p * ( sorted.size() - 1 ) };
+		const std::size_t lower { static_cast<std::size_t>( pos ) };
+		if ( lower + 1 >= sorted.size() ) return sorted[lower];
+		return sorted[lower] + ( pos - lower ) * ( sorted[lower + 1] - sorted[lower] );
+	}
+};
+
+template <std::size_t N>
+void compare(const PiRaTe::Ringbuffer<double, N>& ring, const Reference& ref, double tolerance, const std::string& what)
+{
+	const std::string prefix { "Ringbuffer<"+std::to_string(N)+"> "+what+" " };
+	check( ring.entries() == ref.values.size(), prefix+"entries" );
+	check( ring.full() == ( ref.values.size() == N ), prefix+"full" );
+	if ( !ref.values.empty() ) check( ring.last() == ref.values.back(), prefix+"last" );
+	checkClose( ring.mean(), ref.mean(), tolerance, prefix+"mean" );
+	checkClose( ring.stddev(), ref.stddev(), tolerance, prefix+"stddev" );
+	checkClose( ring.median(), ref.percentile(0.5), 0., prefix+"median" );
+	for ( double p: { 0., 0.25, 0.5, 0.9, 1. } ) {
+		checkClose( ring.percentile(p), ref.percentile(p), 1e-12 * std::abs( ref.percentile(p) ), prefix+"percentile("+std::to_string(p)+")" );
+	}
+}
+
+template <std::size_t N>
+void testRingbuffer()
+{
+	std::mt19937 generator { 42 };
+	std::normal_distribution<double> noise { 0., 1. };
+	PiRaTe::Ringbuffer<double, N> ring { };
+	Reference ref { };
+
+	compare( ring, ref, 0., "empty" );
+
+	// fill-up
+	for ( std::size_t i = 0; i < N; i++ ) {
+		const double value { 10. + noise(generator) };
+		ring.add(value);
+		ref.values.push_back(value);
+		compare( ring, ref, 1e-12, "fill-up "+std::to_string(i + 1) );
+	}
+
+	// wrap-around, over several recomputations of the sums
+	for ( std::size_t i = 0; i < 5 * N + 3; i++ ) {
+		const double value { 10. + noise(generator) };
+		ring.add(value);
+		ref.values.push_back(value);
+		ref.values.pop_front();
+		compare( ring, ref, 1e-12, "wrap-around "+std::to_string(i + 1) );
+	}
+
+	// a large offset with small noise: the incremental update loses precision,
+	// which the recomputation after N overwrites must restore
+	const double offset { 1e6 };
+	for ( std::size_t i = 0; i < 1000 * N; i++ ) {
+		const double value { offset + 1e-3 * noise(generator) };
+		ring.add(value);
+		ref.values.push_back(value);
+		ref.values.pop_front();
+	}
+	// fill the ring with N more values, so that the last recomputation happened in between
+	for ( std::size_t i = 0; i < N; i++ ) {
+		const double value { offset + 1e-3 * noise(generator) };
+		ring.add(value);
+		ref.values.push_back(value);
+		ref.values.pop_front();
+		compare( ring, ref, 1e-7, "re-sum "+std::to_string(i + 1) );
+	}
+	checkClose( ring.stddev() / ref.stddev(), 1., 1e-3, "Ringbuffer<"+std::to_string(N)+"> re-sum relative stddev" );
+
+	// known distribution: the values 1...N in shuffled order
+	ring.clear();
+	ref.values.clear();
+	compare( ring, ref, 0., "clear" );
+	std::vector<double> ranks( N );
+	std::iota( ranks.begin(), ranks.end(), 1. );
+	std::shuffle( ranks.begin(), ranks.end(), generator );
+	for ( double value: ranks ) {
+		ring.add(value);
+		ref.values.push_back(value);
+	}
+	compare( ring, ref, 1e-12, "after clear" );
+	const std::string prefix { "Ringbuffer<"+std::to_string(N)+"> ranks " };
+	checkClose( ring.percentile(0.), 1., 0., prefix+"percentile(0)" );
+	checkClose( ring.percentile(1.), static_cast<double>(N), 0., prefix+"percentile(1)" );
+	checkClose( ring.median(), 0.5 * ( N + 1 ), 1e-12, prefix+"median" );
+	checkClose( ring.mean(), 0.5 * ( N + 1 ), 1e-12, prefix+"mean" );
+	checkClose( ring.stddev(), std::sqrt( N * ( N + 1 ) / 12. ), 1e-12, prefix+"stddev" );
+
+	// a partially filled ring after clear must not see the values of before
+	ring.clear();
+	ref.values.clear();
+	for ( double value: { 100., 300., 200. } ) {
+		ring.add(value);
+		ref.values.push_back(value);
+		if ( ref.values.size() > N ) ref.values.pop_front();
+	}
+	compare( ring, ref, 1e-12, "partial after clear" );
+}
+
+} // anonymous namespace
+
+int main() {
+	testRingbuffer<2>();
+	testRingbuffer<5>();
+	testRingbuffer<16>();
+	testRingbuffer<100>();
+	std::cout<<nr_checks<<" checks, "<<nr_failures<<" failed\n";
+	return ( nr_failures == 0 ) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -15,6 +15,8 @@
 #include <thread>
 #include <mutex>
 
+#include "thread_policy.h"
+
 namespace PiRaTe {
 
 	
@@ -38,6 +40,8 @@ public:
 	[[nodiscard]] auto getTemperatureItem(std::size_t source_index) -> TemperatureItem;
 	
 	void registerTempReadyCallback(std::function<void(TemperatureItem)> fn) {	fTempReadyFn = fn;	}
+	/// apply scheduling policy and CPU affinity to the read-out thread
+	auto setThreadPolicy(const ThreadPolicy& policy) -> bool { return applyThreadPolicy(fThread.get(), policy); }
 	
 private:
     void threadLoop();
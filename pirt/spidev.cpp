@@ -0,0 +1,109 @@
+#include <iostream>
+#include <stdio.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <cstring>
+#include <sys/ioctl.h>
+#include <linux/spi/spidev.h>
+
+#include "spidev.h"
+
+SpiDev::SpiDev(const std::string& device, GPIO::SPI_MODE mode, unsigned int baudrate, bool lsb_first, bool use_cs)
+	: fDevice { device }, fBaudrate { baudrate }
+{
+	fHandle = ::open(fDevice.c_str(), O_RDWR);
+	if (fHandle < 0) {
+		std::cerr<<"Error opening spi device "<<fDevice<<": "<<std::strerror(errno)<<"\n";
+		return;
+	}
+	std::uint8_t spi_mode = static_cast<std::uint8_t>(mode);
+	if (lsb_first) spi_mode |= SPI_LSB_FIRST;
+	if (!use_cs) spi_mode |= SPI_NO_CS;
+	std::uint8_t bits_per_word = 8;
+	std::uint32_t speed = baudrate;
+	if ( ::ioctl(fHandle, SPI_IOC_WR_MODE, &spi_mode) < 0
+		|| ::ioctl(fHandle, SPI_IOC_WR_BITS_PER_WORD, &bits_per_word) < 0
+		|| ::ioctl(fHandle, SPI_IOC_WR_MAX_SPEED_HZ, &speed) < 0 )
+	{
+		if (errno == ENOTTY || errno == EINVAL) {
+			// not a spidev device, fall back to replaying the file content
+			fReplay = true;
+			return;
+		}
+		std::cerr<<"Error configuring spi device "<<fDevice<<": "<<std::strerror(errno)<<"\n";
+		::close(fHandle);
+		fHandle = -1;
+	}
+}
+
+SpiDev::~SpiDev()
+{
+	if (fHandle >= 0) ::close(fHandle);
+}
+
+auto SpiDev::read(unsigned int nBytes) -> std::vector<std::uint8_t>
+{
+	std::vector<Transfer> transfers(1);
+	transfers[0].length = nBytes;
+	if (!transfer(transfers)) return std::vector<std::uint8_t> {};
+	return std::move(transfers[0].rx);
+}
+
+auto SpiDev::transfer(std::vector<Transfer>& transfers) -> bool
+{
+	if (fHandle < 0 || transfers.empty()) return false;
+	for (auto& tr: transfers) {
+		tr.rx.assign(tr.length, 0);
+	}
+	if (fReplay) {
+		std::lock_guard<std::mutex> guard(fMutex);
+		for (auto& tr: transfers) {
+			if (!replayRead(tr.rx.data(), tr.length)) {
+				fErrors++;
+				return false;
+			}
+		}
+		return true;
+	}
+	std::vector<struct spi_ioc_transfer> msg(transfers.size());
+	for (std::size_t i = 0; i < transfers.size(); i++) {
+		Transfer& tr { transfers[i] };
+		std::memset(&msg[i], 0, sizeof(struct spi_ioc_transfer));
+		if (tr.tx.size() < tr.length) tr.tx.resize(tr.length, 0);
+		msg[i].tx_buf = reinterpret_cast<unsigned long>(tr.tx.data());
+		msg[i].rx_buf = reinterpret_cast<unsigned long>(tr.rx.data());
+		msg[i].len = tr.length;
+		msg[i].speed_hz = fBaudrate;
+		msg[i].bits_per_word = 8;
+		msg[i].delay_usecs = tr.delay_us;
+		msg[i].cs_change = tr.cs_change;
+	}
+	// the spidev driver serializes concurrent messages on the same bus, no locking required here
+	int res = ::ioctl(fHandle, SPI_IOC_MESSAGE(msg.size()), msg.data());
+	if (res < 0) {
+		fErrors++;
+		return false;
+	}
+	return true;
+}
+
+auto SpiDev::replayRead(std::uint8_t* buffer, unsigned int nBytes) -> bool
+{
+	unsigned int count = 0;
+	bool wrapped = false;
+	while (count < nBytes) {
+		ssize_t res = ::pread(fHandle, buffer + count, nBytes - count, fReplayOffset);
+		if (res < 0) return false;
+		if (res == 0) {
+			// end of file: start over, but give up on empty files
+			if (wrapped && count == 0) return false;
+			fReplayOffset = 0;
+			wrapped = true;
+			continue;
+		}
+		count += res;
+		fReplayOffset += res;
+	}
+	return true;
+}
@@ -0,0 +1,79 @@
+#ifndef SPI_DEVICE_H
+#define SPI_DEVICE_H
+
+#include <string>
+#include <vector>
+#include <inttypes.h>  // uint8_t, etc
+#include <mutex>
+#include <atomic>
+
+#include "gpioif.h"
+
+/**
+ * @brief Native SPI interface class.
+ * This class accesses an SPI device directly through the Linux spidev driver (/dev/spidevX.Y) with
+ * SPI_IOC_MESSAGE ioctls, i.e. without the round trip to the pigpiod daemon.
+ * Several transfers can be batched into a single ioctl with {@link SpiDev::transfer}.
+ * @note If the device file does not support the spidev ioctls (e.g. a regular file), the object
+ * runs in replay mode: reads return consecutive chunks of the file's content, wrapping around at
+ * the end of the file. This allows testing the read-out chain with recorded or synthesized frames
+ * without SPI hardware.
+ * @author HG Zaunick
+ */
+class SpiDev {
+public:
+	/**
+	 * @brief A single SPI transfer of a batch.
+	 */
+	struct Transfer {
+		std::vector<std::uint8_t> tx { }; ///< bytes to send, may be empty for read-only transfers
+		std::vector<std::uint8_t> rx { }; ///< received bytes, resized to length by the transfer
+		unsigned int length { 0 }; ///< number of bytes to clock
+		std::uint16_t delay_us { 0 }; ///< delay after the transfer before the next one starts
+		bool cs_change { false }; ///< deselect the device between this and the next transfer
+	};
+
+	SpiDev() = delete;
+	/**
+	 * @brief The main constructor.
+	 * @param device the spidev device file, e.g. /dev/spidev0.0
+	 * @param mode the SPI mode
+	 * @param baudrate the SPI clock rate in Hz
+	 * @param lsb_first transmit the least significant bit first
+	 * @param use_cs drive the chip select line of the device
+	 */
+	SpiDev(const std::string& device, GPIO::SPI_MODE mode, unsigned int baudrate, bool lsb_first = false, bool use_cs = true);
+	~SpiDev();
+
+	[[nodiscard]] auto isInitialized() const -> bool { return (fHandle>=0); }
+	/// true if the device file does not support spidev ioctls and is replayed instead
+	[[nodiscard]] auto isReplay() const -> bool { return fReplay; }
+	[[nodiscard]] auto device() const -> const std::string& { return fDevice; }
+	[[nodiscard]] auto baudrate() const -> unsigned int { return fBaudrate; }
+
+	/**
+	 * @brief Read nBytes from the device in one transfer.
+	 * @return the received bytes, empty on error
+	 */
+	[[nodiscard]] auto read(unsigned int nBytes) -> std::vector<std::uint8_t>;
+	/**
+	 * @brief Execute a batch of transfers with a single SPI_IOC_MESSAGE ioctl.
+	 * @param transfers the transfers to execute, the rx members are filled upon success
+	 * @return true if all transfers completed
+	 */
+	auto transfer(std::vector<Transfer>& transfers) -> bool;
+	[[nodiscard]] auto errorCount() const -> unsigned long { return fErrors; }
+
+private:
+	auto replayRead(std::uint8_t* buffer, unsigned int nBytes) -> bool;
+
+	std::string fDevice { };
+	int fHandle { -1 };
+	unsigned int fBaudrate { 0 };
+	bool fReplay { false };
+	off_t fReplayOffset { 0 };
+	std::atomic<unsigned long> fErrors { 0 };
+	std::mutex fMutex;
+};
+
+#endif
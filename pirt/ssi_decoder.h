@@ -0,0 +1,93 @@
+#ifndef SSI_DECODER_H
+#define SSI_DECODER_H
+
+#include <cstdint>
+
+namespace PiRaTe {
+
+/**
+ * @brief Single-turn and multi-turn value of a decoded SSI data word.
+ */
+struct SsiFrame {
+	std::uint32_t st { 0 }; ///< single-turn value
+	std::int32_t mt { 0 }; ///< signed multi-turn value
+};
+
+/**
+ * @brief Convert a 32 bit gray code to binary.
+ * Computes the prefix-XOR of all higher bits in log2(32) = 5 steps instead of iterating over every bit.
+ */
+constexpr auto grayToBinary(std::uint32_t g) -> std::uint32_t
+{
+	g ^= g >> 1;
+	g ^= g >> 2;
+	g ^= g >> 4;
+	g ^= g >> 8;
+	g ^= g >> 16;
+	return g;
+}
+
+/**
+ * @brief Decode an SSI data word with bit widths known at runtime.
+ * Layout of the 32 bit data word (MSB first): start bit, MT sign bit, gray coded MT and ST values
+ * ({@code st_bits + mt_bits - 1} bits in total), padding.
+ * Negative multi-turn counts are offset by -1, otherwise one had to distinguish between -0 and +0 rotations.
+ * @note requires 0 < st_bits and st_bits + mt_bits <= 31
+ */
+constexpr auto decodeSsiFrame(std::uint32_t data, std::uint8_t st_bits, std::uint8_t mt_bits) -> SsiFrame
+{
+	const std::uint32_t payload { grayToBinary( ( data >> (32 - st_bits - mt_bits - 1) ) & ( (1U << (st_bits + mt_bits - 1)) - 1 ) ) };
+	SsiFrame frame { };
+	frame.st = payload & ( (1U << st_bits) - 1 );
+	frame.mt = static_cast<std::int32_t>( (payload >> st_bits) & ( (1U << mt_bits) - 1 ) );
+	if ( data & (1U << 30) ) frame.mt = -frame.mt - 1;
+	return frame;
+}
+
+/**
+ * @brief Encode single-turn and multi-turn values into an SSI data word.
+ * Inverse of {@link decodeSsiFrame}, used to synthesize encoder frames for simulation and replay.
+ * @note requires 0 < st_bits and st_bits + mt_bits <= 31
+ */
+constexpr auto encodeSsiFrame(const SsiFrame& frame, std::uint8_t st_bits, std::uint8_t mt_bits) -> std::uint32_t
+{
+	const bool negative { frame.mt < 0 };
+	const std::uint32_t mt { static_cast<std::uint32_t>( (negative) ? -(frame.mt + 1) : frame.mt ) };
+	const std::uint32_t payload { ( (mt << st_bits) | (frame.st & ( (1U << st_bits) - 1 )) ) & ( (1U << (st_bits + mt_bits - 1)) - 1 ) };
+	std::uint32_t data { 1U << 31 };
+	if (negative) data |= 1U << 30;
+	data |= ( payload ^ (payload >> 1) ) << (32 - st_bits - mt_bits - 1);
+	return data;
+}
+
+/**
+ * @brief SSI data word decoder specialised on the single-turn and multi-turn bit widths.
+ * All shifts and masks are compile-time constants. Decodes bit-identically to {@link decodeSsiFrame}.
+ * Only of use where the widths are known at compile time: an indirect call or a branch selecting the
+ * specialisation costs more than the runtime shifts of {@link decodeSsiFrame} save.
+ */
+template <unsigned int ST_BITS, unsigned int MT_BITS>
+struct SsiDecoder {
+	static_assert(ST_BITS > 0, "SSI decoder needs at least one single-turn bit");
+	static_assert(ST_BITS + MT_BITS <= 31, "SSI frame does not fit into the 32 bit data word");
+
+	static constexpr std::uint32_t PAYLOAD_SHIFT { 32 - ST_BITS - MT_BITS - 1 };
+	static constexpr std::uint32_t PAYLOAD_MASK { (1U << (ST_BITS + MT_BITS - 1)) - 1 };
+	static constexpr std::uint32_t ST_MASK { (1U << ST_BITS) - 1 };
+	static constexpr std::uint32_t MT_MASK { (1U << MT_BITS) - 1 };
+	static constexpr std::uint32_t SIGN_BIT { 1U << 30 };
+
+	static constexpr auto decode(std::uint32_t data) -> SsiFrame
+	{
+		const std::uint32_t payload { grayToBinary( (data >> PAYLOAD_SHIFT) & PAYLOAD_MASK ) };
+		SsiFrame frame { };
+		frame.st = payload & ST_MASK;
+		frame.mt = static_cast<std::int32_t>( (payload >> ST_BITS) & MT_MASK );
+		if ( data & SIGN_BIT ) frame.mt = -frame.mt - 1;
+		return frame;
+	}
+};
+
+} // namespace PiRaTe
+
+#endif // SSI_DECODER_H
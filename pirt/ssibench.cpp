@@ -0,0 +1,174 @@
+/* verification and benchmark of the SSI frame decoders in ssi_decoder.h
+ * usage: ssibench [number of random words per bit width combination]
+ * The decoders are compared with the former implementation of SsiPosEncoder, which converted the gray code bit by
+ * bit and unpacked the frame with runtime shifts: every sign and payload code (the 25 bits below the start bit) is
+ * checked for the specialised 12/12 and 13/12 bit decoders, and every ST/MT bit width combination for the generic
+ * decoder, exhaustively if the frame has at most 20 bits and with random words otherwise.
+ * Then the decoding time per frame of the former implementation and of the generic decoder is measured for every
+ * ST/MT bit width combination, and the one of the specialised decoders for their widths.
+ * The program returns a non-zero exit code on any mismatch.
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <cstdint>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include "ssi_decoder.h"
+
+using Clock = std::chrono::steady_clock;
+using PiRaTe::SsiFrame;
+
+constexpr unsigned int nr_code_bits { 25 };
+constexpr unsigned int max_exhaustive_bits { 20 };
+
+volatile std::uint32_t sink { 0 }; // keeps the decoding from being optimised away
+
+// the former gray decoding of SsiPosEncoder, iterating over every bit
+auto gray_decode(std::uint32_t g) -> std::uint32_t
+{
+	for (std::uint32_t bit = 1U << 31; bit > 1; bit >>= 1)
+	{
+		if (g & bit) g ^= bit >> 1;
+	}
+	return g;
+}
+
+// the former unpacking of the data word in SsiPosEncoder::processDataWord()
+auto referenceDecode(std::uint32_t data, std::uint8_t stBits, std::uint8_t mtBits) -> SsiFrame
+{
+	std::uint32_t temp = data >> (32 - stBits - mtBits - 1);
+	temp &= (1 << (stBits + mtBits - 1))-1;
+	temp = gray_decode(temp);
+	std::uint32_t st = temp & ((1 << (stBits)) - 1);
+	std::int32_t mt = (temp >> stBits) & ((1 << (mtBits)) - 1);
+	// negative counts have to be offset by -1
+	if ( data & (1<<30) ) mt = -mt-1;
+	return SsiFrame { st, mt };
+}
+
+auto operator!=(const SsiFrame& a, const SsiFrame& b) -> bool
+{
+	return a.st != b.st || a.mt != b.mt;
+}
+
+// the data word with the start bit set and the given code in the sign and payload bits below
+constexpr auto codeWord(std::uint32_t code) -> std::uint32_t
+{
+	return (1U << 31) | ( code << (31 - nr_code_bits) );
+}
+
+template <unsigned int ST_BITS, unsigned int MT_BITS>
+auto checkSpecialised() -> unsigned long
+{
+	unsigned long mismatches { 0 };
+	for ( std::uint32_t code = 0; code < (1U << nr_code_bits); code++ ) {
+		const std::uint32_t data { codeWord(code) };
+		const SsiFrame ref { referenceDecode(data, ST_BITS, MT_BITS) };
+		if ( PiRaTe::SsiDecoder<ST_BITS, MT_BITS>::decode(data) != ref ) mismatches++;
+		if ( PiRaTe::decodeSsiFrame(data, ST_BITS, MT_BITS) != ref ) mismatches++;
+	}
+	std::cout<<"SsiDecoder<"<<ST_BITS<<", "<<MT_BITS<<">: "<<(1U << nr_code_bits)<<" codes, "<<mismatches<<" mismatches\n";
+	return mismatches;
+}
+
+auto checkGeneric(unsigned long nr_random) -> unsigned long
+{
+	std::mt19937 generator { 42 };
+	std::uniform_int_distribution<std::uint32_t> word { };
+	unsigned long mismatches { 0 };
+	unsigned int nr_combinations { 0 };
+	for ( unsigned int st_bits = 1; st_bits <= 31; st_bits++ ) {
+		for ( unsigned int mt_bits = 0; st_bits + mt_bits <= 31; mt_bits++ ) {
+			nr_combinations++;
+			// sign bit plus gray coded payload
+			const unsigned int frame_bits { st_bits + mt_bits };
+			auto check = [&](std::uint32_t data) {
+				if ( PiRaTe::decodeSsiFrame(data, st_bits, mt_bits) != referenceDecode(data, st_bits, mt_bits) ) {
+					if ( mismatches == 0 ) std::cerr<<"first mismatch at ST/MT="<<st_bits<<"/"<<mt_bits<<" data=0x"<<std::hex<<data<<std::dec<<"\n";
+					mismatches++;
+				}
+			};
+			if ( frame_bits <= max_exhaustive_bits ) {
+				for ( std::uint32_t code = 0; code < (1U << frame_bits); code++ ) check( (1U << 31) | ( code << (31 - frame_bits) ) );
+			} else {
+				for ( unsigned long i = 0; i < nr_random; i++ ) check( word(generator) );
+			}
+		}
+	}
+	std::cout<<"decodeSsiFrame: "<<nr_combinations<<" bit width combinations, "<<mismatches<<" mismatches\n";
+	return mismatches;
+}
+
+template <typename Decoder>
+auto timeDecoder(const std::vector<std::uint32_t>& words, Decoder decode) -> double
+{
+	std::uint32_t sum { 0 };
+	const auto start { Clock::now() };
+	for ( std::uint32_t data: words ) {
+		const SsiFrame frame { decode(data) };
+		sum += frame.st + static_cast<std::uint32_t>(frame.mt);
+	}
+	const double time { std::chrono::duration<double, std::nano>( Clock::now() - start ).count() / words.size() };
+	sink = sum;
+	return time;
+}
+
+int main(int argc, char* argv[]) {
+	const long nr_random { (argc > 1) ? std::atol(argv[1]) : (1L << 20) };
+	if ( nr_random <= 0 ) {
+		std::cerr<<"usage: "<<argv[0]<<" [number of random words per bit width combination]\n";
+		return EXIT_FAILURE;
+	}
+
+	unsigned long mismatches { 0 };
+	mismatches += checkSpecialised<12, 12>();
+	mismatches += checkSpecialised<13, 12>();
+	mismatches += checkGeneric( static_cast<unsigned long>(nr_random) );
+
+	std::vector<std::uint32_t> words( 1U << 18 );
+	std::mt19937 generator { 4711 };
+	std::uniform_int_distribution<std::uint32_t> code { 0, (1U << nr_code_bits) - 1 };
+	for ( auto& data: words ) data = codeWord( code(generator) );
+
+	// the bit widths are runtime settings in the driver, they are not known to the compiler here either
+	std::cout<<"decoding time in ns/frame, "<<words.size()<<" words per bit width combination (former -> decodeSsiFrame)\n";
+	std::cout<<std::fixed<<std::setprecision(2);
+	double worst_speedup { 1e9 };
+	for ( unsigned int st_bits = 1; st_bits <= 31; st_bits++ ) {
+		double ref_sum { 0. };
+		double generic_sum { 0. };
+		double generic_max { 0. };
+		unsigned int n { 0 };
+		for ( unsigned int mt_bits = 0; st_bits + mt_bits <= 31; mt_bits++, n++ ) {
+			const std::uint8_t st { static_cast<std::uint8_t>(st_bits) };
+			const std::uint8_t mt { static_cast<std::uint8_t>(mt_bits) };
+			const double ref_time { timeDecoder( words, [st, mt](std::uint32_t data) { return referenceDecode(data, st, mt); } ) };
+			const double generic_time { timeDecoder( words, [st, mt](std::uint32_t data) { return PiRaTe::decodeSsiFrame(data, st, mt); } ) };
+			ref_sum += ref_time;
+			generic_sum += generic_time;
+			generic_max = std::max( generic_max, generic_time );
+			worst_speedup = std::min( worst_speedup, ref_time / generic_time );
+		}
+		std::cout<<"ST "<<std::setw(2)<<st_bits<<" bits, MT 0-"<<std::setw(2)<<n - 1<<" bits: "
+			<<std::setw(6)<<ref_sum / n<<" -> "<<generic_sum / n<<" (max "<<generic_max<<")\n";
+	}
+	std::cout<<"smallest speedup over all combinations: "<<worst_speedup<<"x\n";
+
+	const double generic_12_time { timeDecoder( words, [](std::uint32_t data) { return PiRaTe::decodeSsiFrame(data, 12, 12); } ) };
+	const double specialised_12_time { timeDecoder( words, [](std::uint32_t data) { return PiRaTe::SsiDecoder<12, 12>::decode(data); } ) };
+	const double generic_13_time { timeDecoder( words, [](std::uint32_t data) { return PiRaTe::decodeSsiFrame(data, 13, 12); } ) };
+	const double specialised_13_time { timeDecoder( words, [](std::uint32_t data) { return PiRaTe::SsiDecoder<13, 12>::decode(data); } ) };
+	std::cout<<"widths known at compile time: 12/12 decodeSsiFrame "<<generic_12_time<<", SsiDecoder "<<specialised_12_time
+		<<"; 13/12 decodeSsiFrame "<<generic_13_time<<", SsiDecoder "<<specialised_13_time<<"\n";
+
+	if ( mismatches > 0 ) {
+		std::cerr<<mismatches<<" decoded frames differ from the former implementation\n";
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,163 @@
+/* benchmark of the running statistics used by the measurement channels, monitors and motor drivers
+ * usage: statsbench [integration time in s] [sample rate in Hz] [number of samples]
+ * A stream of noisy samples is integrated over a sliding time window twice: by a deque of the samples which is
+ * summed up on every query (the former implementation of Ads1115Measurement) and by the incremental
+ * SlidingWindowStats accumulator. Then the same stream is fed to Ringbuffers of the sizes used by the motor
+ * current offset and the voltage monitors, compared with the former Ringbuffer, which summed up all entries on
+ * every query. The time per sample (add plus query of the mean) and the deviation of the results are reported.
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <cmath>
+#include <chrono>
+#include <deque>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "utility.h"
+
+using Clock = std::chrono::steady_clock;
+
+struct Sample {
+	Clock::time_point time;
+	double value;
+};
+
+// the former Ringbuffer, which recomputed the mean from all entries
+template <std::size_t N>
+class SummingRingbuffer {
+public:
+	void add(double val) {
+		m_buffer[m_index++] = val;
+		if (m_index >= N) {
+			m_index = 0;
+			m_full = true;
+		}
+	}
+	auto mean() const -> double {
+		return ( m_full ) ? std::accumulate(m_buffer.begin(), m_buffer.end(), 0.) / N
+						  : std::accumulate(m_buffer.begin(), m_buffer.begin() + m_index, 0.) / std::max<double>(m_index, 1.);
+	}
+private:
+	std::array<double, N> m_buffer { };
+	std::size_t m_index { 0 };
+	bool m_full { false };
+};
+
+template <std::size_t N>
+void benchRingbuffer(const std::vector<Sample>& samples) {
+	const std::size_t n { samples.size() };
+	std::vector<double> summing_means( n );
+	SummingRingbuffer<N> summing { };
+	auto start { Clock::now() };
+	for ( std::size_t i = 0; i < n; i++ ) {
+		summing.add( samples[i].value );
+		summing_means[i] = summing.mean();
+	}
+	const double summing_time { std::chrono::duration<double, std::nano>( Clock::now() - start ).count() / n };
+
+	std::vector<double> means( n );
+	PiRaTe::Ringbuffer<double, N> ring { };
+	start = Clock::now();
+	for ( std::size_t i = 0; i < n; i++ ) {
+		ring.add( samples[i].value );
+		means[i] = ring.mean();
+	}
+	const double ring_time { std::chrono::duration<double, std::nano>( Clock::now() - start ).count() / n };
+
+	start = Clock::now();
+	volatile double median { 0. }; // keeps the queries from being optimised away
+	constexpr std::size_t nr_median { 10000 };
+	for ( std::size_t i = 0; i < nr_median; i++ ) median = ring.median();
+	const double median_time { std::chrono::duration<double, std::nano>( Clock::now() - start ).count() / nr_median };
+
+	double max_deviation { 0. };
+	for ( std::size_t i = 0; i < n; i++ ) {
+		max_deviation = std::max( max_deviation, std::abs( means[i] - summing_means[i] ) );
+	}
+	// reference statistics of the final ring contents
+	std::vector<double> last( N );
+	for ( std::size_t i = 0; i < N; i++ ) last[i] = samples[n - N + i].value;
+	const double mean { std::accumulate( last.begin(), last.end(), 0. ) / N };
+	double sum_sq { 0. };
+	for ( double v: last ) sum_sq += ( v - mean ) * ( v - mean );
+	std::sort( last.begin(), last.end() );
+	const double ref_median { ( N % 2 ) ? last[N / 2] : 0.5 * ( last[N / 2 - 1] + last[N / 2] ) };
+
+	std::cout<<"Ringbuffer<"<<N<<">: "<<std::setprecision(4)<<summing_time<<" -> "<<ring_time<<" ns/sample (speedup ";
+	std::cout<<summing_time / ring_time<<"x), median "<<median_time<<" ns\n";
+	std::cout<<std::setprecision(6)<<"  max. deviation of the means: "<<max_deviation;
+	std::cout<<", stddev: "<<ring.stddev()<<" (direct "<<std::sqrt( sum_sq / ( N - 1 ) )<<")";
+	std::cout<<", median: "<<median<<" (direct "<<ref_median<<")\n";
+}
+
+int main(int argc, char* argv[]) {
+	const double int_time { (argc > 1) ? std::atof(argv[1]) : 10. };
+	const double rate { (argc > 2) ? std::atof(argv[2]) : 100. };
+	const long nr_samples { (argc > 3) ? std::atol(argv[3]) : 200000L };
+	if ( int_time <= 0. || rate <= 0. || nr_samples <= 0 ) {
+		std::cerr<<"usage: "<<argv[0]<<" [integration time in s] [sample rate in Hz] [number of samples]\n";
+		return EXIT_FAILURE;
+	}
+	const auto window { std::chrono::duration_cast<Clock::duration>( std::chrono::duration<double>(int_time) ) };
+	const auto period { std::chrono::duration_cast<Clock::duration>( std::chrono::duration<double>(1. / rate) ) };
+
+	// a slowly drifting signal with a large offset and white noise, sampled with jitter
+	std::mt19937 generator { 42 };
+	std::normal_distribution<double> noise { 0., 1e-3 };
+	std::normal_distribution<double> jitter { 0., 0.05 };
+	std::vector<Sample> samples( nr_samples );
+	Clock::time_point t { Clock::now() };
+	for ( long i = 0; i < nr_samples; i++ ) {
+		t += period + std::chrono::duration_cast<Clock::duration>( period * jitter(generator) );
+		samples[i] = { t, 1000. + 0.1 * std::sin( 1e-4 * i ) + noise(generator) };
+	}
+
+	std::vector<double> deque_means( nr_samples );
+	std::deque<Sample> buffer { };
+	auto start { Clock::now() };
+	for ( long i = 0; i < nr_samples; i++ ) {
+		while ( !buffer.empty() && buffer.front().time < samples[i].time - window ) buffer.pop_front();
+		buffer.push_back( samples[i] );
+		deque_means[i] = std::accumulate( buffer.begin(), buffer.end(), 0., [](double sum, const Sample& s) { return sum + s.value; } ) / buffer.size();
+	}
+	const double deque_time { std::chrono::duration<double, std::nano>( Clock::now() - start ).count() / nr_samples };
+
+	std::vector<double> stats_means( nr_samples );
+	PiRaTe::SlidingWindowStats stats( static_cast<std::size_t>( 1.25 * int_time * rate ) + 16, window );
+	start = Clock::now();
+	for ( long i = 0; i < nr_samples; i++ ) {
+		stats.add( samples[i].time, samples[i].value );
+		stats_means[i] = stats.mean();
+	}
+	const double stats_time { std::chrono::duration<double, std::nano>( Clock::now() - start ).count() / nr_samples };
+
+	double max_deviation { 0. };
+	for ( long i = 0; i < nr_samples; i++ ) {
+		max_deviation = std::max( max_deviation, std::abs( stats_means[i] - deque_means[i] ) );
+	}
+	// reference variance of the final window, summed up directly
+	double sum_sq { 0. };
+	const double mean { deque_means.back() };
+	for ( const auto& s: buffer ) sum_sq += ( s.value - mean ) * ( s.value - mean );
+	const double ref_stddev { ( buffer.size() > 1 ) ? std::sqrt( sum_sq / ( buffer.size() - 1 ) ) : 0. };
+
+	std::cout<<"window: "<<int_time<<"s at "<<rate<<"Hz, "<<stats.entries()<<" samples in the window, "<<nr_samples<<" samples total\n";
+	std::cout<<"deque + accumulate: "<<std::setprecision(4)<<deque_time<<" ns/sample\n";
+	std::cout<<"SlidingWindowStats: "<<stats_time<<" ns/sample (speedup "<<deque_time / stats_time<<"x)\n";
+	std::cout<<std::setprecision(6)<<"max. deviation of the means: "<<max_deviation<<"\n";
+	std::cout<<"stddev: "<<stats.stddev()<<" (direct "<<ref_stddev<<"), min="<<stats.min()<<" max="<<stats.max()<<" snr="<<stats.snr()<<"\n";
+	std::cout<<"samples dropped for capacity: "<<stats.truncated()<<"\n";
+
+	if ( nr_samples >= 100 ) {
+		benchRingbuffer<16>( samples );
+		benchRingbuffer<100>( samples );
+	}
+	return EXIT_SUCCESS;
+}
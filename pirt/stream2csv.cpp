@@ -0,0 +1,32 @@
+/* converter of the binary radiometer stream files and BLOBs of the indi_pirt driver into CSV
+ * usage: stream2csv <stream file> [csv file]
+ * without csv file, the table is written to stdout
+ */
+
+#include <iostream>
+#include <fstream>
+#include <string>
+
+#include "radiometer_stream.h"
+
+int main(int argc, char* argv[]) {
+	if ( argc < 2 || argc > 3 ) {
+		std::cerr<<"usage: "<<argv[0]<<" <stream file> [csv file]\n";
+		return 1;
+	}
+	PiRaTe::RadiometerStreamInfo info { };
+	std::vector<PiRaTe::RadiometerRecord> records { };
+	if ( !PiRaTe::readRadiometerStream(argv[1], info, records) ) return 1;
+	if ( argc == 3 ) {
+		std::ofstream out( argv[2] );
+		if ( !out ) {
+			std::cerr<<"Error opening "<<argv[2]<<" for writing\n";
+			return 1;
+		}
+		PiRaTe::writeRadiometerCsv(out, info, records);
+	} else {
+		PiRaTe::writeRadiometerCsv(std::cout, info, records);
+	}
+	std::cerr<<records.size()<<" samples of channel "<<info.name<<" converted\n";
+	return 0;
+}
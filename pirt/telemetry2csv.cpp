@@ -0,0 +1,31 @@
+/* converter of the binary motor telemetry dumps of the indi_pirt driver into CSV
+ * usage: telemetry2csv <dump file> [csv file]
+ * without csv file, the table is written to stdout
+ */
+
+#include <iostream>
+#include <fstream>
+#include <string>
+
+#include "motor_telemetry.h"
+
+int main(int argc, char* argv[]) {
+	if ( argc < 2 || argc > 3 ) {
+		std::cerr<<"usage: "<<argv[0]<<" <dump file> [csv file]\n";
+		return 1;
+	}
+	PiRaTe::MotorTelemetryDump dump { };
+	if ( !PiRaTe::readMotorTelemetry(argv[1], dump) ) return 1;
+	if ( argc == 3 ) {
+		std::ofstream out( argv[2] );
+		if ( !out ) {
+			std::cerr<<"Error opening "<<argv[2]<<" for writing\n";
+			return 1;
+		}
+		PiRaTe::writeMotorTelemetryCsv(out, dump);
+	} else {
+		PiRaTe::writeMotorTelemetryCsv(std::cout, dump);
+	}
+	std::cerr<<dump.records.size()<<" records of motor "<<dump.name<<" ("<<dump.reason<<") converted\n";
+	return 0;
+}
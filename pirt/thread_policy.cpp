@@ -0,0 +1,83 @@
+#include <iostream>
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+
+#include "thread_policy.h"
+
+namespace PiRaTe {
+
+auto ThreadPolicy::toString() const -> std::string
+{
+	std::string str { };
+	switch (scheduling) {
+		case Scheduling::Fifo:
+			str = "FIFO/" + std::to_string(priority);
+			break;
+		case Scheduling::Batch:
+			str = "BATCH";
+			break;
+		default:
+			str = "OTHER";
+	}
+	if ( cpu >= 0 ) str += " cpu " + std::to_string(cpu);
+	return str;
+}
+
+auto applyThreadPolicy(std::thread* thread, const ThreadPolicy& policy) -> bool
+{
+	if ( thread == nullptr ) return false;
+	const pthread_t handle { thread->native_handle() };
+	bool ok { true };
+
+	sched_param param { };
+	int sched_policy { SCHED_OTHER };
+	switch (policy.scheduling) {
+		case ThreadPolicy::Scheduling::Fifo:
+			sched_policy = SCHED_FIFO;
+			param.sched_priority = std::min( std::max( policy.priority, THREAD_PRIORITY_MIN ), THREAD_PRIORITY_MAX );
+			break;
+		case ThreadPolicy::Scheduling::Batch:
+			sched_policy = SCHED_BATCH;
+			break;
+		default:
+			break;
+	}
+	int res { pthread_setschedparam(handle, sched_policy, &param) };
+	if ( res != 0 ) {
+		std::cerr<<"Error setting thread scheduling policy "<<policy.toString()<<": "<<std::strerror(res)<<"\n";
+		ok = false;
+	}
+
+	// an unpinned thread may run on every core which is available to the process
+	cpu_set_t cpuset;
+	CPU_ZERO(&cpuset);
+	const int nr_cpus { static_cast<int>( std::max( std::thread::hardware_concurrency(), 1U ) ) };
+	if ( policy.cpu >= 0 && policy.cpu < nr_cpus ) {
+		CPU_SET(policy.cpu, &cpuset);
+	} else {
+		for (int cpu = 0; cpu < nr_cpus; cpu++) CPU_SET(cpu, &cpuset);
+	}
+	res = pthread_setaffinity_np(handle, sizeof(cpu_set_t), &cpuset);
+	if ( res != 0 ) {
+		std::cerr<<"Error setting thread affinity to cpu "<<policy.cpu<<": "<<std::strerror(res)<<"\n";
+		ok = false;
+	}
+	return ok;
+}
+
+auto lockMemory(bool lock) -> bool
+{
+	const int res { (lock) ? mlockall(MCL_CURRENT | MCL_FUTURE) : munlockall() };
+	if ( res != 0 ) {
+		std::cerr<<"Error "<<( (lock) ? "locking" : "unlocking" )<<" process memory: "<<std::strerror(errno)<<"\n";
+		return false;
+	}
+	return true;
+}
+
+} // namespace PiRaTe
@@ -0,0 +1,52 @@
+#ifndef THREAD_POLICY_H
+#define THREAD_POLICY_H
+
+#include <thread>
+#include <string>
+
+namespace PiRaTe {
+
+constexpr int THREAD_PRIORITY_MIN { 1 }; ///< lowest SCHED_FIFO priority
+constexpr int THREAD_PRIORITY_MAX { 99 }; ///< highest SCHED_FIFO priority
+
+/**
+ * @brief Scheduling class, priority and CPU affinity of a background thread.
+ * Control-critical loops (encoder read-out, servo, motor ramp, GPIO I/O) are run with the real-time
+ * policy SCHED_FIFO, so that they preempt all normal processes as soon as their deadline expires.
+ * Monitoring loops may be demoted to SCHED_BATCH, which marks them as CPU-bound and non-interactive for the
+ * scheduler. Real-time priorities require the CAP_SYS_NICE capability (or root privileges) resp. an
+ * appropriate RLIMIT_RTPRIO, otherwise applying the policy fails and the thread keeps its current policy.
+ * @author HG Zaunick
+ */
+struct ThreadPolicy {
+	enum class Scheduling { Normal, Batch, Fifo };
+	Scheduling scheduling { Scheduling::Normal };
+	int priority { 0 }; ///< priority for SCHED_FIFO (1...99), ignored for the other policies
+	int cpu { -1 }; ///< index of the CPU core the thread is pinned to, -1 allows all cores
+
+	[[nodiscard]] static auto normal(int cpu = -1) -> ThreadPolicy { return ThreadPolicy { Scheduling::Normal, 0, cpu }; }
+	[[nodiscard]] static auto batch(int cpu = -1) -> ThreadPolicy { return ThreadPolicy { Scheduling::Batch, 0, cpu }; }
+	[[nodiscard]] static auto fifo(int priority, int cpu = -1) -> ThreadPolicy { return ThreadPolicy { Scheduling::Fifo, priority, cpu }; }
+	/// human readable description, e.g. "FIFO/60 cpu 3"
+	[[nodiscard]] auto toString() const -> std::string;
+};
+
+/**
+ * @brief Apply scheduling policy and CPU affinity to a running thread.
+ * @param thread the thread, nothing is done for a nullptr
+ * @param policy the policy to apply
+ * @return true if both the scheduling policy and the affinity were set successfully
+ */
+auto applyThreadPolicy(std::thread* thread, const ThreadPolicy& policy) -> bool;
+
+/**
+ * @brief Lock all current and future pages of the process into RAM.
+ * This prevents page faults in the real-time loops, e.g. when memory was swapped out on a loaded system.
+ * @param lock true locks the memory (mlockall), false unlocks it again (munlockall)
+ * @return true on success
+ */
+auto lockMemory(bool lock) -> bool;
+
+} // namespace PiRaTe
+
+#endif // THREAD_POLICY_H
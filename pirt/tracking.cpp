@@ -0,0 +1,77 @@
+#include <cmath>
+
+#include "tracking.h"
+
+namespace PiRaTe {
+
+constexpr double DEG_TO_RAD { M_PI / 180. };
+constexpr double RATE_DIFFERENCE_INTERVAL { 1. }; ///< time step of the difference quotients of the rates in s
+
+namespace {
+auto range360(double angle) -> double
+{
+	angle = std::fmod(angle, 360.);
+	return (angle < 0.) ? angle + 360. : angle;
+}
+
+/// horizontal position and analytic rates, without accelerations
+auto horizontalRates(double hourAngle, double dec, double latitude) -> HorizontalMotion
+{
+	const double h { hourAngle * DEG_TO_RAD };
+	const double d { dec * DEG_TO_RAD };
+	const double phi { latitude * DEG_TO_RAD };
+	HorizontalMotion motion { };
+	const double sinAlt { std::sin(phi) * std::sin(d) + std::cos(phi) * std::cos(d) * std::cos(h) };
+	const double alt { std::asin( std::min( std::max( sinAlt, -1. ), 1. ) ) };
+	const double az { std::atan2( -std::cos(d) * std::sin(h), std::sin(d) * std::cos(phi) - std::cos(d) * std::sin(phi) * std::cos(h) ) };
+	motion.alt = alt / DEG_TO_RAD;
+	motion.az = range360( az / DEG_TO_RAD );
+	motion.altRate = SIDEREAL_RATE * std::cos(phi) * std::sin(az);
+	// diverges at the zenith, where the azimuth is undefined
+	motion.azRate = SIDEREAL_RATE * ( std::sin(phi) - std::cos(phi) * std::cos(az) * std::tan(alt) );
+	return motion;
+}
+} // namespace
+
+auto horizontalMotion(double hourAngle, double dec, double latitude) -> HorizontalMotion
+{
+	HorizontalMotion motion { horizontalRates(hourAngle, dec, latitude) };
+	const double dh { 0.5 * SIDEREAL_RATE * RATE_DIFFERENCE_INTERVAL };
+	const HorizontalMotion before { horizontalRates(hourAngle - dh, dec, latitude) };
+	const HorizontalMotion after { horizontalRates(hourAngle + dh, dec, latitude) };
+	motion.azAcceleration = ( after.azRate - before.azRate ) / RATE_DIFFERENCE_INTERVAL;
+	motion.altAcceleration = ( after.altRate - before.altRate ) / RATE_DIFFERENCE_INTERVAL;
+	return motion;
+}
+
+auto trackingMotion(double hourAngle, double dec, double latitude, double maxAzRate) -> HorizontalMotion
+{
+	HorizontalMotion motion { horizontalMotion(hourAngle, dec, latitude) };
+	if ( maxAzRate <= 0. ) return motion;
+	// a pass with the minimum zenith distance z peaks at an azimuth rate of w*cos(dec)/sin(z) at the transit,
+	// so the keyhole is the circle around the zenith within which this exceeds maxAzRate
+	const double d { dec * DEG_TO_RAD };
+	const double phi { latitude * DEG_TO_RAD };
+	const double keyholeRadius { std::asin( std::min( SIDEREAL_RATE * std::cos(d) / maxAzRate, 1. ) ) };
+	if ( std::abs(phi - d) >= keyholeRadius ) return motion;
+
+	// half width of the keyhole passage in hour angle
+	const double cosHalfWidth { ( std::cos(keyholeRadius) - std::sin(phi) * std::sin(d) ) / ( std::cos(phi) * std::cos(d) ) };
+	const double halfWidth { std::acos( std::min( std::max( cosHalfWidth, -1. ), 1. ) ) / DEG_TO_RAD };
+	const double h { std::remainder(hourAngle, 360.) };
+	if ( std::abs(h) >= halfWidth ) return motion;
+
+	// move uniformly from the entry to the exit azimuth in the direction of the target's motion at the entry
+	const HorizontalMotion entry { horizontalRates(-halfWidth, dec, latitude) };
+	const double exit { horizontalRates(halfWidth, dec, latitude).az };
+	double swing { range360( exit - entry.az ) };
+	if ( entry.azRate < 0. ) swing -= 360.;
+	const double duration { 2. * halfWidth / SIDEREAL_RATE };
+	motion.az = range360( entry.az + swing * ( h + halfWidth ) / ( 2. * halfWidth ) );
+	motion.azRate = swing / duration;
+	motion.azAcceleration = 0.;
+	motion.keyhole = true;
+	return motion;
+}
+
+} // namespace PiRaTe
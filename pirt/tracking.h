@@ -0,0 +1,50 @@
+#ifndef TRACKING_H
+#define TRACKING_H
+
+namespace PiRaTe {
+
+constexpr double SIDEREAL_RATE { 360.98564736629 / 86400. }; ///< rate of the hour angle in deg/s
+
+/**
+ * @brief Horizontal position of a fixed equatorial target together with its time derivatives.
+ * Azimuths are counted from north through east, all angles are in degrees and all rates in deg/s resp. deg/s^2.
+ */
+struct HorizontalMotion {
+	double az { 0. }; ///< azimuth (0...360 deg)
+	double alt { 0. }; ///< altitude
+	double azRate { 0. }; ///< dAz/dt
+	double altRate { 0. }; ///< dAlt/dt
+	double azAcceleration { 0. }; ///< d^2Az/dt^2
+	double altAcceleration { 0. }; ///< d^2Alt/dt^2
+	bool keyhole { false }; ///< true if the azimuth is guided through the keyhole around the zenith
+};
+
+/**
+ * @brief The horizontal position and its rates of change for an equatorial target.
+ * The rates are evaluated analytically from the hour angle, declination and latitude:
+ * dAlt/dt = w*cos(lat)*sin(Az) and dAz/dt = w*(sin(lat) - cos(lat)*cos(Az)*tan(Alt)), with w the sidereal rate.
+ * The accelerations are the symmetric difference quotients of the analytic rates.
+ * @param hourAngle the local hour angle of the target in degrees
+ * @param dec the declination of the target in degrees
+ * @param latitude the geographic latitude of the site in degrees
+ */
+[[nodiscard]] auto horizontalMotion(double hourAngle, double dec, double latitude) -> HorizontalMotion;
+
+/**
+ * @brief Horizontal motion for tracking with an alt-az mount with limited azimuth rate.
+ * The azimuth rate of a target diverges, when its transit passes close to the zenith: a pass with the minimum
+ * zenith distance z peaks at w*cos(dec)/sin(z). The keyhole is the circle around the zenith within which this peak
+ * rate exceeds maxAzRate. While a target passes through the keyhole, the azimuth is moved uniformly from the entry to the
+ * exit azimuth, in the direction in which the target's azimuth turns. The altitude is followed exactly all the time.
+ * The uniform rate is about 1.6 times maxAzRate for a pass through the zenith, so maxAzRate should be chosen
+ * accordingly below the velocity limit of the azimuth axis.
+ * @param hourAngle the local hour angle of the target in degrees
+ * @param dec the declination of the target in degrees
+ * @param latitude the geographic latitude of the site in degrees
+ * @param maxAzRate the azimuth rate in deg/s above which the keyhole is applied, 0 disables the keyhole
+ */
+[[nodiscard]] auto trackingMotion(double hourAngle, double dec, double latitude, double maxAzRate) -> HorizontalMotion;
+
+} // namespace PiRaTe
+
+#endif // TRACKING_H
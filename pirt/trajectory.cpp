@@ -0,0 +1,128 @@
+#include <algorithm>
+#include <cmath>
+
+#include "trajectory.h"
+
+namespace PiRaTe {
+
+constexpr unsigned int BISECTION_STEPS { 100 };
+
+auto SCurveProfile::accelerationTime(double velocity, const Limits& limits) -> double
+{
+	if ( velocity * limits.jerk < limits.acceleration * limits.acceleration ) {
+		// the acceleration limit is not reached, triangular acceleration profile
+		return 2. * std::sqrt( velocity / limits.jerk );
+	}
+	// trapezoidal acceleration profile
+	return velocity / limits.acceleration + limits.acceleration / limits.jerk;
+}
+
+auto SCurveProfile::moveTime(double distance, double velocity, const Limits& limits) -> double
+{
+	if ( velocity <= 0. ) return 0.;
+	const double ta { accelerationTime(velocity, limits) };
+	// the acceleration profile is symmetric, so the mean velocity while accelerating is half the peak velocity
+	const double cruise { std::max( distance - velocity * ta, 0. ) / velocity };
+	return 2. * ta + cruise;
+}
+
+auto SCurveProfile::maximumPeakVelocity(double distance, const Limits& limits) -> double
+{
+	// the distance to accelerate to and decelerate from velocity v is v*ta(v), which increases monotonously with v
+	if ( limits.velocity * accelerationTime(limits.velocity, limits) <= distance ) return limits.velocity;
+	double low { 0. };
+	double high { limits.velocity };
+	for (unsigned int i = 0; i < BISECTION_STEPS; i++) {
+		const double mid { 0.5 * ( low + high ) };
+		if ( mid * accelerationTime(mid, limits) > distance ) high = mid;
+		else low = mid;
+	}
+	return low;
+}
+
+auto SCurveProfile::minimumDuration(double distance, const Limits& limits) -> double
+{
+	distance = std::abs(distance);
+	if ( distance == 0. ) return 0.;
+	return moveTime( distance, maximumPeakVelocity(distance, limits), limits );
+}
+
+SCurveProfile::SCurveProfile(double start, double target, const Limits& limits, double duration)
+	: fStart { start }, fTarget { target }
+{
+	const double distance { std::abs( target - start ) };
+	if ( distance == 0. || limits.velocity <= 0. || limits.acceleration <= 0. || limits.jerk <= 0. ) return;
+
+	double velocity { maximumPeakVelocity(distance, limits) };
+	if ( duration > moveTime(distance, velocity, limits) ) {
+		// stretch the move by lowering the peak velocity, the move time decreases monotonously with the peak velocity
+		double low { 0. };
+		double high { velocity };
+		for (unsigned int i = 0; i < BISECTION_STEPS; i++) {
+			const double mid { 0.5 * ( low + high ) };
+			if ( moveTime(distance, mid, limits) > duration ) low = mid;
+			else high = mid;
+		}
+		velocity = high;
+	}
+	fPeakVelocity = velocity;
+
+	// jerk phase and constant acceleration phase of the acceleration profile
+	double tj { limits.acceleration / limits.jerk };
+	double tca { velocity / limits.acceleration - tj };
+	if ( tca < 0. ) {
+		tj = std::sqrt( velocity / limits.jerk );
+		tca = 0.;
+	}
+	const double ta { 2. * tj + tca };
+	const double tv { std::max( distance - velocity * ta, 0. ) / velocity };
+	const double j { ( target > start ) ? limits.jerk : -limits.jerk };
+	const std::array<double, 7> durations { tj, tca, tj, tv, tj, tca, tj };
+	const std::array<double, 7> jerks { j, 0., -j, 0., -j, 0., j };
+
+	// integrate the segments to obtain the state at the beginning of each
+	Sample state { start, 0., 0. };
+	fDuration = 0.;
+	for (std::size_t i = 0; i < fSegments.size(); i++) {
+		const double t { durations[i] };
+		fSegments[i] = Segment { t, jerks[i], state };
+		state.position += state.velocity * t + state.acceleration * t * t / 2. + jerks[i] * t * t * t / 6.;
+		state.velocity += state.acceleration * t + jerks[i] * t * t / 2.;
+		state.acceleration += jerks[i] * t;
+		fDuration += t;
+	}
+}
+
+auto SCurveProfile::sample(double t) const -> Sample
+{
+	if ( t <= 0. ) return Sample { fStart, 0., 0. };
+	if ( t >= fDuration ) return Sample { fTarget, 0., 0. };
+	for (const auto& segment : fSegments) {
+		if ( t > segment.duration ) {
+			t -= segment.duration;
+			continue;
+		}
+		const Sample& s { segment.begin };
+		return Sample {
+			s.position + s.velocity * t + s.acceleration * t * t / 2. + segment.jerk * t * t * t / 6.,
+			s.velocity + s.acceleration * t + segment.jerk * t * t / 2.,
+			s.acceleration + segment.jerk * t };
+	}
+	return Sample { fTarget, 0., 0. };
+}
+
+auto planSynchronizedMove(const std::vector<double>& starts, const std::vector<double>& targets, const std::vector<SCurveProfile::Limits>& limits) -> std::vector<SCurveProfile>
+{
+	std::vector<SCurveProfile> profiles { };
+	if ( starts.size() != targets.size() || starts.size() != limits.size() ) return profiles;
+	double duration { 0. };
+	for (std::size_t i = 0; i < starts.size(); i++) {
+		duration = std::max( duration, SCurveProfile::minimumDuration( targets[i] - starts[i], limits[i] ) );
+	}
+	for (std::size_t i = 0; i < starts.size(); i++) {
+		profiles.emplace_back( starts[i], targets[i], limits[i], duration );
+	}
+	return profiles;
+}
+
+} // namespace PiRaTe
@@ -0,0 +1,87 @@
+#ifndef TRAJECTORY_H
+#define TRAJECTORY_H
+
+#include <array>
+#include <vector>
+
+namespace PiRaTe {
+
+/**
+ * @brief Jerk-limited (S-curve) rest-to-rest motion profile of one axis.
+ * The profile consists of up to seven segments of constant jerk: jerk-up, constant acceleration and jerk-down
+ * while accelerating, a cruise at peak velocity and the mirrored sequence while decelerating. Segments vanish
+ * when the corresponding limit is not reached, e.g. short moves never reach the velocity limit and the
+ * acceleration phase degenerates to a triangular acceleration profile.
+ * By default the profile is time-optimal under the given limits. A longer duration may be requested,
+ * then the peak velocity is lowered such that the move ends exactly after the requested time. This is used
+ * to synchronise several axes with {@link planSynchronizedMove}.
+ * @author HG Zaunick
+ */
+class SCurveProfile {
+public:
+	struct Limits {
+		double velocity { 1. }; ///< maximum velocity (units/s)
+		double acceleration { 1. }; ///< maximum acceleration (units/s^2)
+		double jerk { 1. }; ///< maximum jerk (units/s^3)
+	};
+
+	struct Sample {
+		double position { 0. };
+		double velocity { 0. };
+		double acceleration { 0. };
+	};
+
+	SCurveProfile() = default;
+	/**
+	 * @brief Plan a move from rest at start to rest at target.
+	 * @param start the start position
+	 * @param target the target position
+	 * @param limits the velocity, acceleration and jerk limits, all must be positive
+	 * @param duration the requested duration of the move in s. Values below the minimum duration
+	 * (in particular the default of 0) yield the time-optimal profile.
+	 */
+	SCurveProfile(double start, double target, const Limits& limits, double duration = 0.);
+
+	/// the state at time t (s) after the start of the move, constant before the start and after the end
+	[[nodiscard]] auto sample(double t) const -> Sample;
+	[[nodiscard]] auto duration() const -> double { return fDuration; }
+	[[nodiscard]] auto start() const -> double { return fStart; }
+	[[nodiscard]] auto target() const -> double { return fTarget; }
+	[[nodiscard]] auto peakVelocity() const -> double { return fPeakVelocity; }
+	/// the duration of the time-optimal move over distance under the given limits
+	[[nodiscard]] static auto minimumDuration(double distance, const Limits& limits) -> double;
+
+private:
+	struct Segment {
+		double duration { 0. };
+		double jerk { 0. };
+		Sample begin { };
+	};
+	/// duration of the acceleration phase from rest to velocity
+	[[nodiscard]] static auto accelerationTime(double velocity, const Limits& limits) -> double;
+	/// duration of a move over distance with the given peak velocity, which must be reachable within distance
+	[[nodiscard]] static auto moveTime(double distance, double velocity, const Limits& limits) -> double;
+	/// the highest peak velocity which can be reached and left again within distance
+	[[nodiscard]] static auto maximumPeakVelocity(double distance, const Limits& limits) -> double;
+
+	double fStart { 0. };
+	double fTarget { 0. };
+	double fDuration { 0. };
+	double fPeakVelocity { 0. };
+	std::array<Segment, 7> fSegments { };
+};
+
+/**
+ * @brief Plan jerk-limited moves of several axes which start and arrive at the same time.
+ * The duration of all moves is the longest of the time-optimal durations of the individual axes,
+ * the faster axes are slowed down accordingly.
+ * @param starts the start positions of the axes
+ * @param targets the target positions of the axes
+ * @param limits the limits of the axes
+ * @return one profile per axis, empty if the argument sizes differ
+ */
+auto planSynchronizedMove(const std::vector<double>& starts, const std::vector<double>& targets, const std::vector<SCurveProfile::Limits>& limits) -> std::vector<SCurveProfile>;
+
+} // namespace PiRaTe
+
+#endif // TRAJECTORY_H
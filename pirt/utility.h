@@ -6,28 +6,209 @@
 #include <atomic>
 #include <chrono>
 #include <cmath>
+#include <cstdint>
 #include <iomanip>
 #include <numeric>
 #include <sstream>
 #include <string>
+#include <type_traits>
 #include <vector>
 
 namespace PiRaTe {
 
-	
+
+/**
+ * @brief Fixed-size ring of the last N values with running statistics.
+ * Mean and variance are updated incrementally with every added value (Welford's algorithm, extended by the
+ * removal of the overwritten value once the ring is full), so that the queries take constant time.
+ * To stop the accumulation of rounding errors, mean and variance are recomputed from the stored values after
+ * every N overwritten values. The recomputation is a branch-free reduction over the contiguous buffer with
+ * independent partial sums, which the compiler vectorises.
+ * Median and percentiles are determined by partial sorting of a copy of the values in O(N).
+ */
 template <typename T, std::size_t N>
 class Ringbuffer {
+    static_assert(std::is_floating_point<T>::value, "Ringbuffer requires a floating point type");
+    static_assert(N > 1, "Ringbuffer requires at least two entries");
+
 public:
     void add(T val);
-    [[nodiscard]] auto mean() const -> T;
-    [[nodiscard]] auto stddev() const -> T;
+    void clear();
+    [[nodiscard]] auto mean() const -> T { return m_mean; }
+    [[nodiscard]] auto stddev() const -> T { return std::sqrt(variance()); }
+    /// sample variance (n-1 normalisation)
     [[nodiscard]] auto variance() const -> T;
-    [[nodiscard]] auto entries() const -> std::size_t;
+    [[nodiscard]] auto entries() const -> std::size_t { return m_count; }
+    [[nodiscard]] auto full() const -> bool { return m_count == N; }
+    /// the most recently added value
+    [[nodiscard]] auto last() const -> T;
+    [[nodiscard]] auto median() const -> T { return percentile(0.5); }
+    /**
+     * @brief The p-quantile of the values.
+     * @param p the quantile (0...1), linear interpolation between the closest ranks
+     */
+    [[nodiscard]] auto percentile(double p) const -> T;
 
 private:
+    void resum();
+
     std::array<T, N> m_buffer { T {} };
-    std::size_t m_index;
-    bool m_full { false };
+    std::size_t m_index { 0 }; ///< position of the next value
+    std::size_t m_count { 0 };
+    std::size_t m_updates { 0 }; ///< values overwritten since the last recomputation
+    T m_mean { 0 };
+    T m_m2 { 0 }; ///< sum of the squared deviations from the mean
+};
+
+/**
+ * @brief Lock-free single-producer/multi-consumer ring of timestamped samples.
+ * One thread pushes items with {@link SampleRing::push}, any number of other threads may read
+ * without blocking the producer. Every item gets a running sequence index; consumers keep their own
+ * cursor and fetch everything published since with {@link SampleRing::readSince}.
+ * Each slot is guarded by a sequence counter (seqlock), so a reader detects when a slot was
+ * overwritten while it was copied and discards the item instead of returning torn data.
+ * @note T must be trivially copyable, N must be a power of two.
+ */
+template <typename T, std::size_t N>
+class SampleRing {
+    static_assert((N > 1) && ((N & (N - 1)) == 0), "SampleRing size must be a power of two");
+    static_assert(std::is_trivially_copyable<T>::value, "SampleRing items must be trivially copyable");
+public:
+    /// append an item, must only be called from the producer thread
+    void push(const T& item);
+    /// total number of items pushed so far, i.e. the sequence index of the next item
+    [[nodiscard]] auto head() const -> std::uint64_t { return m_head.load(std::memory_order_acquire); }
+    /// read the item with sequence index. returns false if the item is not (or no longer) available
+    [[nodiscard]] auto read(std::uint64_t index, T& item) const -> bool;
+    /// read the most recently pushed item
+    [[nodiscard]] auto latest(T& item) const -> bool;
+    /**
+     * @brief Call fn for every item published since cursor and advance the cursor.
+     * Items which were already overwritten by the producer are skipped.
+     * @return the number of items passed to fn
+     */
+    template <typename F>
+    auto readSince(std::uint64_t& cursor, F&& fn) const -> std::size_t;
+    /// append all items published since cursor to the vector items and advance the cursor
+    auto readSince(std::uint64_t& cursor, std::vector<T>& items) const -> std::size_t;
+    [[nodiscard]] static constexpr auto capacity() -> std::size_t { return N; }
+
+private:
+    struct Slot {
+        std::atomic<std::uint64_t> seq { 0 };
+        T item {};
+    };
+    std::array<Slot, N> m_slots {};
+    std::atomic<std::uint64_t> m_head { 0 };
+};
+
+/**
+ * @brief Statistics of the samples within a sliding time window.
+ * Sum, sum of squares, minimum and maximum of the samples are maintained incrementally, so that adding a
+ * sample and querying the statistics take constant (amortised) time independent of the number of samples in
+ * the window. The samples are kept in a ring of fixed capacity which is allocated once on construction;
+ * if the window holds more samples than the capacity, the oldest ones are dropped early (counted by
+ * {@link SlidingWindowStats::truncated}).
+ * The sums are accumulated relative to a reference value close to the mean to avoid cancellation in the
+ * variance, and are recomputed from the stored samples after every capacity evictions to stop the
+ * accumulation of rounding errors. Minimum and maximum are tracked with monotonic queues.
+ * @note The time stamps must be added in non-decreasing order. The class is not thread-safe.
+ */
+class SlidingWindowStats {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    SlidingWindowStats(std::size_t capacity, Clock::duration window);
+    /// change the window length, samples beyond the new window are removed with the next sample
+    void setWindow(Clock::duration window) { m_window = window; }
+    /// add a sample and remove those older than the window length before its time stamp
+    void add(Clock::time_point time, double value);
+    void clear();
+
+    [[nodiscard]] auto entries() const -> std::size_t { return m_count; }
+    [[nodiscard]] auto capacity() const -> std::size_t { return m_items.size(); }
+    [[nodiscard]] auto window() const -> Clock::duration { return m_window; }
+    [[nodiscard]] auto mean() const -> double;
+    /// sample variance (n-1 normalisation)
+    [[nodiscard]] auto variance() const -> double;
+    [[nodiscard]] auto stddev() const -> double { return std::sqrt(variance()); }
+    /// standard error of the mean, stddev/sqrt(n)
+    [[nodiscard]] auto standardError() const -> double;
+    /// signal-to-noise ratio of a single sample, |mean|/stddev, 0 if undefined
+    [[nodiscard]] auto snr() const -> double;
+    [[nodiscard]] auto min() const -> double;
+    [[nodiscard]] auto max() const -> double;
+    /// the mean time stamp of the samples, i.e. the instant the mean value refers to
+    [[nodiscard]] auto meanTime() const -> Clock::time_point;
+    /// number of samples dropped before leaving the window because the capacity was exhausted
+    [[nodiscard]] auto truncated() const -> std::uint64_t { return m_truncated; }
+
+private:
+    struct Item {
+        Clock::time_point time {};
+        double value { 0. };
+    };
+    // monotonic queue of sample sequence numbers, stored in a ring of the sample capacity
+    struct MonotonicQueue {
+        std::vector<std::uint64_t> seq {};
+        std::uint64_t head { 0 };
+        std::uint64_t tail { 0 };
+    };
+
+    [[nodiscard]] auto item(std::uint64_t seq) const -> const Item& { return m_items[seq % m_items.size()]; }
+    void popFront();
+    void resum();
+    template <typename Compare>
+    void pushQueue(MonotonicQueue& queue, std::uint64_t seq, double value, Compare keep);
+
+    std::vector<Item> m_items;
+    Clock::duration m_window;
+    std::uint64_t m_first { 0 }; ///< sequence number of the oldest sample
+    std::size_t m_count { 0 };
+    MonotonicQueue m_minQueue {};
+    MonotonicQueue m_maxQueue {};
+    double m_offset { 0. }; ///< reference value of the sums
+    double m_sum { 0. };
+    double m_sumSq { 0. };
+    double m_sumTime { 0. }; ///< sum of the time stamps relative to m_timeRef in s
+    Clock::time_point m_timeRef {};
+    std::size_t m_evictions { 0 };
+    std::uint64_t m_truncated { 0 };
+};
+
+/**
+ * @brief Fixed-binning histogram for latency measurements.
+ * N equidistant bins cover the range [min, max); values outside are counted as under-/overflow.
+ * Filling is meant for a single producer thread, all counters may be read concurrently.
+ */
+template <std::size_t N>
+class Histogram {
+    static_assert(N > 0, "Histogram needs at least one bin");
+public:
+    Histogram(double min, double max) : m_min { min }, m_max { max } {}
+    void fill(double value);
+    void clear();
+    [[nodiscard]] auto entries() const -> std::uint64_t { return m_entries.load(std::memory_order_relaxed); }
+    [[nodiscard]] auto bin(std::size_t i) const -> std::uint64_t { return m_bins[i].load(std::memory_order_relaxed); }
+    [[nodiscard]] auto binCenter(std::size_t i) const -> double { return m_min + (i + 0.5) * binWidth(); }
+    [[nodiscard]] auto binWidth() const -> double { return (m_max - m_min) / N; }
+    [[nodiscard]] auto underflow() const -> std::uint64_t { return m_underflow.load(std::memory_order_relaxed); }
+    [[nodiscard]] auto overflow() const -> std::uint64_t { return m_overflow.load(std::memory_order_relaxed); }
+    [[nodiscard]] auto mean() const -> double;
+    [[nodiscard]] auto maximum() const -> double { return m_maximum.load(std::memory_order_relaxed); }
+    /// the value below which the fraction q (0..1) of all entries lie, resolved to the bin width
+    [[nodiscard]] auto quantile(double q) const -> double;
+    [[nodiscard]] static constexpr auto nrBins() -> std::size_t { return N; }
+
+private:
+    double m_min;
+    double m_max;
+    std::array<std::atomic<std::uint64_t>, N> m_bins { };
+    std::atomic<std::uint64_t> m_underflow { 0 };
+    std::atomic<std::uint64_t> m_overflow { 0 };
+    std::atomic<std::uint64_t> m_entries { 0 };
+    std::atomic<double> m_sum { 0. };
+    std::atomic<double> m_maximum { 0. };
 };
 
 
@@ -40,50 +221,320 @@ private:
 template <typename T, std::size_t N>
 void Ringbuffer<T, N>::add(T val)
 {
-    m_buffer[m_index++] = val;
-    if (m_index >= N) {
-        m_index = 0;
-        m_full = true;
+    if (m_count < N) {
+        // the ring is not full yet, plain Welford update
+        m_buffer[m_index] = val;
+        m_count++;
+        const T delta { val - m_mean };
+        m_mean += delta / static_cast<T>(m_count);
+        m_m2 += delta * (val - m_mean);
+    } else {
+        // replace the oldest value: remove its contribution and add the new one in a single step
+        const T old { m_buffer[m_index] };
+        m_buffer[m_index] = val;
+        const T oldMean { m_mean };
+        m_mean += (val - old) / static_cast<T>(N);
+        m_m2 += (val - old) * (val - m_mean + old - oldMean);
+        if (++m_updates >= N) resum();
     }
+    m_index = (m_index + 1) % N;
 }
 
 template <typename T, std::size_t N>
-auto Ringbuffer<T, N>::mean() const -> T
+void Ringbuffer<T, N>::clear()
 {
-    T mean {};
-    if (!m_full) {
-        mean = std::accumulate(m_buffer.begin(), m_buffer.begin() + m_index, 0.0) / std::max<double>(m_index, 1.0);
-    } else {
-        mean = std::accumulate(m_buffer.begin(), m_buffer.end(), 0.0) / N;
+    m_index = m_count = m_updates = 0;
+    m_mean = m_m2 = T { 0 };
+}
+
+template <typename T, std::size_t N>
+auto Ringbuffer<T, N>::variance() const -> T
+{
+    if (m_count < 2) return T { 0 };
+    return std::max(m_m2, T { 0 }) / static_cast<T>(m_count - 1);
+}
+
+template <typename T, std::size_t N>
+auto Ringbuffer<T, N>::last() const -> T
+{
+    return m_buffer[(m_index + N - 1) % N];
+}
+
+// only called when the ring is full, two-pass reduction with four independent partial sums
+template <typename T, std::size_t N>
+void Ringbuffer<T, N>::resum()
+{
+    constexpr std::size_t lanes { 4 };
+    constexpr std::size_t blocks { N / lanes * lanes };
+    std::array<T, lanes> sum { T {} };
+    for (std::size_t i = 0; i < blocks; i += lanes) {
+        for (std::size_t k = 0; k < lanes; k++) sum[k] += m_buffer[i + k];
+    }
+    for (std::size_t i = blocks; i < N; i++) sum[0] += m_buffer[i];
+    const T mean { (sum[0] + sum[1] + sum[2] + sum[3]) / static_cast<T>(N) };
+    std::array<T, lanes> sq { T {} };
+    for (std::size_t i = 0; i < blocks; i += lanes) {
+        for (std::size_t k = 0; k < lanes; k++) sq[k] += (m_buffer[i + k] - mean) * (m_buffer[i + k] - mean);
     }
-    return mean;
+    for (std::size_t i = blocks; i < N; i++) sq[0] += (m_buffer[i] - mean) * (m_buffer[i] - mean);
+    m_mean = mean;
+    m_m2 = sq[0] + sq[1] + sq[2] + sq[3];
+    m_updates = 0;
 }
 
 template <typename T, std::size_t N>
-auto Ringbuffer<T, N>::stddev() const -> T
+auto Ringbuffer<T, N>::percentile(double p) const -> T
 {
-    return std::sqrt(this->variance);
+    if (m_count == 0) return T { 0 };
+    // the values occupy the first m_count slots until the ring is full
+    std::array<T, N> values { m_buffer };
+    const auto end { values.begin() + m_count };
+    const double pos { std::clamp(p, 0., 1.) * (m_count - 1) };
+    const std::size_t lower { static_cast<std::size_t>(pos) };
+    std::nth_element(values.begin(), values.begin() + lower, end);
+    const T low { values[lower] };
+    if (lower + 1 >= m_count || pos == lower) return low;
+    // after the partial sort, the next rank is the smallest of the upper part
+    const T high { *std::min_element(values.begin() + lower + 1, end) };
+    return low + static_cast<T>(pos - lower) * (high - low);
 }
+// -------------------------------
 
+// +++++++++++++++++++++++++++++++
+// class SampleRing
 template <typename T, std::size_t N>
-auto Ringbuffer<T, N>::variance() const -> T
+void SampleRing<T, N>::push(const T& item)
 {
-    T mean { this->mean() };
-    T variance {};
-    if (!m_full) {
-        variance = 1.0 / (m_index - 1) * std::inner_product(
-                       m_buffer.begin(), m_buffer.begin() + m_index, m_buffer.begin(), 0.0, [](T const& x, T const& y) { return x + y; }, [mean](T const& x, T const& y) { return (x - mean) * (y - mean); });
-    } else {
-        variance = 1.0 / (N - 1.0) * std::inner_product(
-                       m_buffer.begin(), m_buffer.end(), m_buffer.begin(), 0.0, [](T const& x, T const& y) { return x + y; }, [mean](T const& x, T const& y) { return (x - mean) * (y - mean); });
+    const std::uint64_t index { m_head.load(std::memory_order_relaxed) };
+    Slot& slot { m_slots[index & (N - 1)] };
+    // odd sequence number marks the slot as being written
+    slot.seq.store(2 * index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.item = item;
+    slot.seq.store(2 * index + 2, std::memory_order_release);
+    m_head.store(index + 1, std::memory_order_release);
+}
+
+template <typename T, std::size_t N>
+auto SampleRing<T, N>::read(std::uint64_t index, T& item) const -> bool
+{
+    const Slot& slot { m_slots[index & (N - 1)] };
+    const std::uint64_t seq { slot.seq.load(std::memory_order_acquire) };
+    if (seq != 2 * index + 2) return false;
+    T copy { slot.item };
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.seq.load(std::memory_order_relaxed) != seq) return false;
+    item = copy;
+    return true;
+}
+
+template <typename T, std::size_t N>
+auto SampleRing<T, N>::latest(T& item) const -> bool
+{
+    const std::uint64_t h { head() };
+    if (h == 0) return false;
+    return read(h - 1, item);
+}
+
+template <typename T, std::size_t N>
+template <typename F>
+auto SampleRing<T, N>::readSince(std::uint64_t& cursor, F&& fn) const -> std::size_t
+{
+    const std::uint64_t h { head() };
+    // items older than one buffer length are lost
+    if (h - cursor > N) cursor = h - N;
+    std::size_t count { 0 };
+    T item {};
+    for (; cursor < h; ++cursor) {
+        if (!read(cursor, item)) continue;
+        fn(item);
+        ++count;
     }
-    return variance;
+    return count;
 }
 
 template <typename T, std::size_t N>
-auto Ringbuffer<T, N>::entries() const -> std::size_t
+auto SampleRing<T, N>::readSince(std::uint64_t& cursor, std::vector<T>& items) const -> std::size_t
+{
+    return readSince(cursor, [&items](const T& item) { items.push_back(item); });
+}
+// -------------------------------
+
+// +++++++++++++++++++++++++++++++
+// class SlidingWindowStats
+inline SlidingWindowStats::SlidingWindowStats(std::size_t capacity, Clock::duration window)
+    : m_items(std::max<std::size_t>(capacity, 1)), m_window { window }
+{
+    m_minQueue.seq.resize(m_items.size());
+    m_maxQueue.seq.resize(m_items.size());
+}
+
+inline void SlidingWindowStats::add(Clock::time_point time, double value)
+{
+    while (m_count > 0 && item(m_first).time < time - m_window) popFront();
+    if (m_count == m_items.size()) {
+        popFront();
+        m_truncated++;
+    }
+    if (m_count == 0) {
+        m_offset = value;
+        m_timeRef = time;
+        m_sum = m_sumSq = m_sumTime = 0.;
+        m_evictions = 0;
+    }
+    const std::uint64_t seq { m_first + m_count };
+    m_items[seq % m_items.size()] = Item { time, value };
+    m_count++;
+    const double delta { value - m_offset };
+    m_sum += delta;
+    m_sumSq += delta * delta;
+    m_sumTime += std::chrono::duration<double>(time - m_timeRef).count();
+    pushQueue(m_minQueue, seq, value, [](double queued, double added) { return queued < added; });
+    pushQueue(m_maxQueue, seq, value, [](double queued, double added) { return queued > added; });
+}
+
+template <typename Compare>
+void SlidingWindowStats::pushQueue(MonotonicQueue& queue, std::uint64_t seq, double value, Compare keep)
+{
+    // samples which can not become the extremum anymore are dropped from the back
+    while (queue.tail > queue.head && !keep(item(queue.seq[(queue.tail - 1) % queue.seq.size()]).value, value)) queue.tail--;
+    queue.seq[queue.tail % queue.seq.size()] = seq;
+    queue.tail++;
+}
+
+inline void SlidingWindowStats::popFront()
+{
+    const Item& oldest { item(m_first) };
+    const double delta { oldest.value - m_offset };
+    m_sum -= delta;
+    m_sumSq -= delta * delta;
+    m_sumTime -= std::chrono::duration<double>(oldest.time - m_timeRef).count();
+    if (m_minQueue.tail > m_minQueue.head && m_minQueue.seq[m_minQueue.head % m_minQueue.seq.size()] == m_first) m_minQueue.head++;
+    if (m_maxQueue.tail > m_maxQueue.head && m_maxQueue.seq[m_maxQueue.head % m_maxQueue.seq.size()] == m_first) m_maxQueue.head++;
+    m_first++;
+    m_count--;
+    if (++m_evictions >= m_items.size()) resum();
+}
+
+inline void SlidingWindowStats::resum()
+{
+    m_evictions = 0;
+    if (m_count == 0) return;
+    // re-centre the sums on the current mean and the oldest time stamp
+    m_offset += m_sum / m_count;
+    m_timeRef = item(m_first).time;
+    m_sum = m_sumSq = m_sumTime = 0.;
+    for (std::uint64_t seq = m_first; seq < m_first + m_count; seq++) {
+        const double delta { item(seq).value - m_offset };
+        m_sum += delta;
+        m_sumSq += delta * delta;
+        m_sumTime += std::chrono::duration<double>(item(seq).time - m_timeRef).count();
+    }
+}
+
+inline void SlidingWindowStats::clear()
+{
+    m_first += m_count;
+    m_count = 0;
+    m_minQueue.head = m_minQueue.tail;
+    m_maxQueue.head = m_maxQueue.tail;
+    m_sum = m_sumSq = m_sumTime = 0.;
+    m_evictions = 0;
+}
+
+inline auto SlidingWindowStats::mean() const -> double
+{
+    if (m_count == 0) return 0.;
+    return m_offset + m_sum / m_count;
+}
+
+inline auto SlidingWindowStats::variance() const -> double
+{
+    if (m_count < 2) return 0.;
+    return std::max((m_sumSq - m_sum * m_sum / m_count) / (m_count - 1), 0.);
+}
+
+inline auto SlidingWindowStats::standardError() const -> double
 {
-    return ((m_full) ? N : m_index);
+    if (m_count < 2) return 0.;
+    return stddev() / std::sqrt(static_cast<double>(m_count));
+}
+
+inline auto SlidingWindowStats::snr() const -> double
+{
+    const double sigma { stddev() };
+    return (sigma > 0.) ? std::abs(mean()) / sigma : 0.;
+}
+
+inline auto SlidingWindowStats::min() const -> double
+{
+    if (m_count == 0) return 0.;
+    return item(m_minQueue.seq[m_minQueue.head % m_minQueue.seq.size()]).value;
+}
+
+inline auto SlidingWindowStats::max() const -> double
+{
+    if (m_count == 0) return 0.;
+    return item(m_maxQueue.seq[m_maxQueue.head % m_maxQueue.seq.size()]).value;
+}
+
+inline auto SlidingWindowStats::meanTime() const -> Clock::time_point
+{
+    if (m_count == 0) return Clock::time_point {};
+    return m_timeRef + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(m_sumTime / m_count));
+}
+// -------------------------------
+
+// +++++++++++++++++++++++++++++++
+// class Histogram
+template <std::size_t N>
+void Histogram<N>::fill(double value)
+{
+    if (value < m_min) {
+        m_underflow.fetch_add(1, std::memory_order_relaxed);
+    } else if (value >= m_max) {
+        m_overflow.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        const auto i { std::min( static_cast<std::size_t>( (value - m_min) / binWidth() ), N - 1 ) };
+        m_bins[i].fetch_add(1, std::memory_order_relaxed);
+    }
+    m_sum.store(m_sum.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    if (value > m_maximum.load(std::memory_order_relaxed)) m_maximum.store(value, std::memory_order_relaxed);
+    m_entries.fetch_add(1, std::memory_order_release);
+}
+
+template <std::size_t N>
+void Histogram<N>::clear()
+{
+    for (auto& bin : m_bins) bin.store(0, std::memory_order_relaxed);
+    m_underflow.store(0, std::memory_order_relaxed);
+    m_overflow.store(0, std::memory_order_relaxed);
+    m_sum.store(0., std::memory_order_relaxed);
+    m_maximum.store(0., std::memory_order_relaxed);
+    m_entries.store(0, std::memory_order_release);
+}
+
+template <std::size_t N>
+auto Histogram<N>::mean() const -> double
+{
+    const std::uint64_t n { m_entries.load(std::memory_order_acquire) };
+    if (n == 0) return 0.;
+    return m_sum.load(std::memory_order_relaxed) / n;
+}
+
+template <std::size_t N>
+auto Histogram<N>::quantile(double q) const -> double
+{
+    const std::uint64_t n { m_entries.load(std::memory_order_acquire) };
+    if (n == 0) return 0.;
+    const double threshold { std::min( std::max( q, 0. ), 1. ) * n };
+    double cumulated { static_cast<double>( m_underflow.load(std::memory_order_relaxed) ) };
+    if (cumulated >= threshold) return m_min;
+    for (std::size_t i = 0; i < N; i++) {
+        cumulated += m_bins[i].load(std::memory_order_relaxed);
+        if (cumulated >= threshold) return std::min( m_min + (i + 1) * binWidth(), maximum() );
+    }
+    return maximum();
 }
 // -------------------------------
 
@@ -8,13 +8,11 @@
 
 #include "voltage_monitor.h"
 
-#include <ads1115.h>
-
 #define DEFAULT_VERBOSITY 1
 
 namespace PiRaTe {
 	
-constexpr std::chrono::milliseconds loop_delay { 100 };
+constexpr double sample_rate { 10. }; //< sample rate of the supply voltages in Hz
 
 // helper functions for compilation with c++11
 // remove, when compiling with c++14 and add std:: to the lines where these functions are used
@@ -30,7 +28,7 @@ template <typename T> constexpr int sgn(T val) {
 }
 
 Ads1115VoltageMonitor::Ads1115VoltageMonitor(std::string name, 
-											 std::shared_ptr<ADS1115> adc, 
+											 std::shared_ptr<Ads1115Scheduler> adc, 
 											 std::uint8_t adc_channel, 
 											 double nominalVoltage,
 											 double divider_ratio,
@@ -41,56 +39,34 @@ Ads1115VoltageMonitor::Ads1115VoltageMonitor(std::string name,
 		fNominalVoltage { nominalVoltage },
 		fDividerRatio { divider_ratio }
 {
-	// initialize ADC if one was supplied in the argument list
-	if ( fAdc != nullptr && fAdc->devicePresent() ) {
-		//fAdc->setPga(ADS1115::PGA4V);
-		//fAdc->setRate(ADS1115::RATE860);
-		//fAdc->setAGC(true);
-	} else {
-		return;
-	}
 	fLoLimit = fNominalVoltage - max_abs_tolerance;
 	fHiLimit = fNominalVoltage + max_abs_tolerance;
-	fActiveLoop=true;
-// since C++14 using std::make_unique
-	// fThread = std::make_unique<std::thread>( [this]() { this->readLoop(); } );
-// C++11 is unfortunately more unconvenient with move from a locally generated pointer
-	std::unique_ptr<std::thread> thread( new std::thread( [this]() { this->threadLoop(); } ));
-	fThread = std::move(thread);
+	// subscribe to the ADC channel if an ADC was supplied in the argument list
+	if ( fAdc == nullptr || !fAdc->isInitialized() ) {
+		fAdc.reset();
+		return;
+	}
+	fSubscription = fAdc->subscribe( fAdcChannel, sample_rate, ADC_PRIORITY_MONITOR,
+		[this](const Ads1115Scheduler::Sample& sample) { this->processSample(sample); } );
 }
 
 Ads1115VoltageMonitor::~Ads1115VoltageMonitor()
 {
-	if (!fActiveLoop) return;
-	fActiveLoop = false;
-	if (fThread!=nullptr) fThread->join();
+	if ( hasAdc() ) fAdc->unsubscribe(fSubscription);
 }
 
 
-// this is the background thread loop
-void Ads1115VoltageMonitor::threadLoop()
+// called by the conversion scheduler for every sample
+void Ads1115VoltageMonitor::processSample(const Ads1115Scheduler::Sample& sample)
 {
-	auto lastReadOutTime = std::chrono::system_clock::now();
-	bool errorFlag = true;
-	while (fActiveLoop) {
-		auto currentTime = std::chrono::system_clock::now();
-		
-		if ( hasAdc() ) {
-			if ( bool readout_guard = true ) {
-				//std::lock_guard<std::mutex> lock(fMutex);
-				// read current voltage from adc
-				fMutex.lock();
-				fVoltage = fAdc->readVoltage(fAdcChannel) * fDividerRatio;
-				fMutex.unlock();
-			}
-			fMutex.lock();
-			fBuffer.add(fVoltage);
-			fUpdated = true;
-			fMutex.unlock();
-			if (fVoltageReadyFn) fVoltageReadyFn(fVoltage);
-		}
-		std::this_thread::sleep_for(loop_delay);
+	double voltage { 0. };
+	{
+		std::lock_guard<std::mutex> lock(fMutex);
+		fVoltage = voltage = sample.voltage * fDividerRatio;
+		fBuffer.add(fVoltage);
+		fUpdated = true;
 	}
+	if (fVoltageReadyFn) fVoltageReadyFn(voltage);
 }
 
 
@@ -19,17 +19,21 @@
 
 #include "gpioif.h"
 #include "utility.h"
-
-class ADS1115;
+#include "ads1115_scheduler.h"
 
 namespace PiRaTe {
 
+/**
+ * @brief Supervision of a supply voltage sampled by an ADS1115 ADC.
+ * The monitor subscribes to the ADC channel at its {@link Ads1115Scheduler} with {@link ADC_PRIORITY_MONITOR}
+ * and keeps the pushed samples in a ring buffer for averaging.
+ */
 class Ads1115VoltageMonitor {
 public:
     Ads1115VoltageMonitor()=delete;
 
     Ads1115VoltageMonitor(	std::string name,
-							std::shared_ptr<ADS1115> adc,
+							std::shared_ptr<Ads1115Scheduler> adc,
 							std::uint8_t adc_channel,
 							double nominalVoltage,
 							double divider_ratio = 1.,
@@ -39,7 +43,7 @@ public:
     ~Ads1115VoltageMonitor();
 
 	[[nodiscard]] auto isFault() -> bool;
-    [[nodiscard]] auto isInitialized() const -> bool { return fActiveLoop; }
+    [[nodiscard]] auto isInitialized() const -> bool { return (fSubscription >= 0); }
     [[nodiscard]] auto hasAdc() const -> bool { return (fAdc != nullptr); }
     [[nodiscard]] auto currentVoltage() -> double;
     [[nodiscard]] auto meanVoltage() -> double;
@@ -50,16 +54,15 @@ public:
 	[[nodiscard]] auto name() const -> std::string { return fName; }
 
 	void registerVoltageReadyCallback(std::function<void(double)> fn) {	fVoltageReadyFn = fn; }
+	[[nodiscard]] auto statistics() const -> Ads1115Scheduler::Statistics { return (hasAdc()) ? fAdc->statistics(fSubscription) : Ads1115Scheduler::Statistics { }; }
 
   private:
-    void threadLoop();
-    std::shared_ptr<ADS1115> fAdc { nullptr };
+    void processSample(const Ads1115Scheduler::Sample& sample);
+    std::shared_ptr<Ads1115Scheduler> fAdc { nullptr };
+	Ads1115Scheduler::SubscriptionId fSubscription { -1 };
 	bool fUpdated { false };
-    bool fActiveLoop { false };
 	std::uint8_t fAdcChannel { 0 };
 
-    std::unique_ptr<std::thread> fThread { nullptr };
-
 	std::mutex fMutex;
 	std::function<void(double)> fVoltageReadyFn { };
 	